@@ -0,0 +1,203 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file AllocStats.cpp
+/// @brief Heap accounting per pipeline phase, the global operator new and delete are only replaced when
+/// DELAUNAY_ALLOC_STATS is defined
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "AllocStats.h"
+#include "Tetrahedron.h"
+
+#ifdef DELAUNAY_ALLOC_STATS
+
+#include <cstdlib>
+#include <new>
+
+// Every block carries a header with its size and phase in front of it, so a free is charged to the phase that made
+// the block whichever phase is current. The counters are plain zero-initialised arrays, they are valid before any
+// constructor runs, and are updated with atomic builtins since the worker thread allocates too
+
+namespace
+{
+
+const char *s_phaseNames[AllocStats::PHASES] = { "other", "sampling", "insertion", "flips", "finalize", "voronoi" };
+
+struct BlockHeader
+{
+    size_t m_size;
+    int m_phase;
+};
+
+// keeps the block after the header aligned for any type
+const size_t s_headerSize = 16;
+
+AllocStats::Counters s_counters[AllocStats::PHASES];
+long long s_live;
+long long s_peak;
+__thread int s_phase = AllocStats::OTHER;
+
+void raise(long long *_peak, long long _value)
+{
+    long long peak = *_peak;
+    while(_value > peak && !__sync_bool_compare_and_swap(_peak,peak,_value))
+    {
+        peak = *_peak;
+    }
+}
+
+void* allocate(size_t _size)
+{
+    char *block = (char*)malloc(_size+s_headerSize);
+    if(block == NULL)
+    {
+        return NULL;
+    }
+    BlockHeader *header = (BlockHeader*)block;
+    header->m_size = _size;
+    header->m_phase = s_phase;
+    AllocStats::Counters &c = s_counters[s_phase];
+    __sync_fetch_and_add(&c.m_bytes,(long long)_size);
+    __sync_fetch_and_add(&c.m_allocations,1LL);
+    raise(&c.m_peak,__sync_add_and_fetch(&c.m_live,(long long)_size));
+    raise(&s_peak,__sync_add_and_fetch(&s_live,(long long)_size));
+    return block+s_headerSize;
+}
+
+void release(void *_ptr)
+{
+    if(_ptr == NULL)
+    {
+        return;
+    }
+    char *block = (char*)_ptr-s_headerSize;
+    BlockHeader *header = (BlockHeader*)block;
+    AllocStats::Counters &c = s_counters[header->m_phase];
+    __sync_fetch_and_add(&c.m_freedBytes,(long long)header->m_size);
+    __sync_fetch_and_add(&c.m_frees,1LL);
+    __sync_fetch_and_sub(&c.m_live,(long long)header->m_size);
+    __sync_fetch_and_sub(&s_live,(long long)header->m_size);
+    free(block);
+}
+
+void* allocateOrThrow(size_t _size)
+{
+    void *ptr = allocate(_size);
+    if(ptr == NULL)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+} // end anonymous namespace
+
+#if __cplusplus >= 201103L
+#define ALLOC_THROW
+#define ALLOC_NOTHROW noexcept
+#else
+#define ALLOC_THROW throw(std::bad_alloc)
+#define ALLOC_NOTHROW throw()
+#endif
+
+void* operator new(size_t _size) ALLOC_THROW { return allocateOrThrow(_size); }
+void* operator new[](size_t _size) ALLOC_THROW { return allocateOrThrow(_size); }
+void* operator new(size_t _size, const std::nothrow_t &) ALLOC_NOTHROW { return allocate(_size); }
+void* operator new[](size_t _size, const std::nothrow_t &) ALLOC_NOTHROW { return allocate(_size); }
+void operator delete(void *_ptr) ALLOC_NOTHROW { release(_ptr); }
+void operator delete[](void *_ptr) ALLOC_NOTHROW { release(_ptr); }
+void operator delete(void *_ptr, const std::nothrow_t &) ALLOC_NOTHROW { release(_ptr); }
+void operator delete[](void *_ptr, const std::nothrow_t &) ALLOC_NOTHROW { release(_ptr); }
+#if __cplusplus >= 201402L
+// the sized forms, the size is taken from the header like the plain ones
+void operator delete(void *_ptr, size_t) ALLOC_NOTHROW { release(_ptr); }
+void operator delete[](void *_ptr, size_t) ALLOC_NOTHROW { release(_ptr); }
+#endif
+
+AllocStats::Counters AllocStats::counters(Phase _phase)
+{
+    return s_counters[_phase];
+}
+
+long long AllocStats::liveBytes()
+{
+    return s_live;
+}
+
+long long AllocStats::peakBytes()
+{
+    return s_peak;
+}
+
+AllocStats::Phase AllocStats::currentPhase()
+{
+    return (Phase)s_phase;
+}
+
+AllocStats::Scope::Scope(Phase _phase)
+{
+    m_previous = s_phase;
+    s_phase = _phase;
+}
+
+AllocStats::Scope::~Scope()
+{
+    s_phase = m_previous;
+}
+
+void AllocStats::report(FILE *_out, unsigned int _tetrahedra)
+{
+    fprintf(_out,"%-10s %14s %12s %14s %14s\n","phase","bytes","allocations","live bytes","peak live");
+    long long meshBytes = 0;
+    for(int p=0; p<PHASES; ++p)
+    {
+        Counters c = s_counters[p];
+        fprintf(_out,"%-10s %14lld %12lld %14lld %14lld\n",s_phaseNames[p],c.m_bytes,c.m_allocations,c.m_live,c.m_peak);
+        if(p == INSERTION || p == FLIPS || p == FINALIZE)
+        {
+            meshBytes += c.m_live;
+        }
+    }
+    fprintf(_out,"peak heap %lld bytes, live %lld bytes\n",s_peak,s_live);
+    if(_tetrahedra != 0)
+    {
+        fprintf(_out,"%u tetrahedra, %.1f live bytes per tetrahedron from the build (sizeof(Tetrahedron) %u)\n",
+                _tetrahedra,(double)meshBytes/_tetrahedra,(unsigned int)sizeof(Tetrahedron));
+    }
+}
+
+#else
+
+AllocStats::Counters AllocStats::counters(Phase)
+{
+    Counters c = { 0, 0, 0, 0, 0, 0 };
+    return c;
+}
+
+long long AllocStats::liveBytes()
+{
+    return 0;
+}
+
+long long AllocStats::peakBytes()
+{
+    return 0;
+}
+
+AllocStats::Phase AllocStats::currentPhase()
+{
+    return OTHER;
+}
+
+AllocStats::Scope::Scope(Phase _phase)
+{
+    m_previous = _phase;
+}
+
+AllocStats::Scope::~Scope()
+{
+}
+
+void AllocStats::report(FILE *, unsigned int)
+{
+}
+
+#endif // DELAUNAY_ALLOC_STATS
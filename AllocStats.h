@@ -0,0 +1,84 @@
+#ifndef ALLOCSTATS_H
+#define ALLOCSTATS_H
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file AllocStats.h
+/// @author Maria Vineeta Bagya Seelan
+/// @version 1.1
+/// @date 16/08/13
+/// Revision History :
+/// Initial Version 16/08/13
+/// 1.1 currentPhase so the parallel loops charge their workers to the phase that started them
+/// @brief heap accounting per pipeline phase. With DELAUNAY_ALLOC_STATS defined the global operator new and delete
+/// @brief tag every block with the phase of the thread that allocated it, so the bytes, the allocation count, the
+/// @brief bytes still live and their peak are known for each phase. Without it the phases compile to nothing and
+/// @brief report prints nothing
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <cstdio>
+
+namespace AllocStats
+{
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the phases the allocations are attributed to
+    //----------------------------------------------------------------------------------------------------------------------
+    enum Phase { OTHER, SAMPLING, INSERTION, FLIPS, FINALIZE, VORONOI, PHASES };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the counters of one phase
+    //----------------------------------------------------------------------------------------------------------------------
+    struct Counters
+    {
+        long long m_bytes;
+        long long m_allocations;
+        long long m_freedBytes;
+        long long m_frees;
+        long long m_live;
+        long long m_peak;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the counters of a phase, all zero when the accounting is compiled out
+    /// @param [in] _phase the phase
+    //----------------------------------------------------------------------------------------------------------------------
+    Counters counters(Phase _phase);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessors for the live heap bytes of all phases and their peak
+    //----------------------------------------------------------------------------------------------------------------------
+    long long liveBytes();
+    long long peakBytes();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the phase of the calling thread, OTHER when the accounting is compiled out
+    //----------------------------------------------------------------------------------------------------------------------
+    Phase currentPhase();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief prints a table of the phases, the peak and the footprint per tetrahedron
+    /// @param [in] _out the stream to print to
+    /// @param [in] _tetrahedra the tetrahedra of the mesh, the bytes still live from the insertion, the flips and the
+    /// clean up are divided by it, 0 leaves the footprint out
+    //----------------------------------------------------------------------------------------------------------------------
+    void report(FILE *_out, unsigned int _tetrahedra);
+
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @class Scope
+    /// @brief attributes the allocations of the calling thread to a phase until it goes out of scope
+    //----------------------------------------------------------------------------------------------------------------------
+    class Scope
+    {
+    public:
+        Scope(Phase _phase);
+        ~Scope();
+    private:
+        int m_previous;
+        Scope(const Scope &);
+        Scope& operator=(const Scope &);
+    };
+}
+
+#ifdef DELAUNAY_ALLOC_STATS
+#define ALLOC_PHASE_CONCAT_INNER(_a,_b) _a##_b
+#define ALLOC_PHASE_CONCAT(_a,_b) ALLOC_PHASE_CONCAT_INNER(_a,_b)
+#define ALLOC_PHASE(_phase) AllocStats::Scope ALLOC_PHASE_CONCAT(allocPhase,__LINE__)(AllocStats::_phase)
+#else
+#define ALLOC_PHASE(_phase)
+#endif // DELAUNAY_ALLOC_STATS
+
+#endif // ALLOCSTATS_H
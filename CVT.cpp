@@ -0,0 +1,147 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file CVT.cpp
+/// @brief The centroids and energy of the clipped cells and the spatial order of the points
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "CVT.h"
+#include "Parallel.h"
+#include "Trace.h"
+#include <algorithm>
+
+// A cell is split into tetrahedra from its site to the triangles fanned out of every face. The volumes are signed, so
+// the sums are right wherever the site is, and the second moment of a tetrahedron with a vertex at the site is
+// V/10 times the sum of the squares and the pairwise products of the other three edge vectors
+
+namespace
+{
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief computes the centroid and the energy of a range of cells
+//----------------------------------------------------------------------------------------------------------------------
+class CentroidTask : public ParallelTask
+{
+public:
+    CentroidTask(const std::vector<ClippedCell> &_cells, const std::vector<ngl::Vec3> &_sites,
+                 std::vector<ngl::Vec3> &o_centroids, std::vector<double> &o_energies) :
+        m_cells(_cells), m_sites(_sites), m_centroids(o_centroids), m_energies(o_energies) {}
+
+    void run(unsigned int _begin, unsigned int _end)
+    {
+        for(unsigned int c=_begin; c<_end; ++c)
+        {
+            const ClippedCell &cell = m_cells[c];
+            const ngl::Vec3 &site = m_sites[c];
+            double volume = 0.0;
+            double energy = 0.0;
+            double moment[3] = { 0.0, 0.0, 0.0 };
+            for(unsigned int f=0; f<cell.m_faces.size(); ++f)
+            {
+                const std::vector<unsigned int> &verts = cell.m_faces[f].m_vert;
+                for(unsigned int i=1; i+1<verts.size(); ++i)
+                {
+                    double u[3][3];
+                    const ngl::Vec3 *corner[3] = { &cell.m_verts[verts[0]], &cell.m_verts[verts[i]],
+                                                   &cell.m_verts[verts[i+1]] };
+                    for(int k=0; k<3; ++k)
+                    {
+                        for(int j=0; j<3; ++j)
+                        {
+                            u[k][j] = (double)(*corner[k])[j]-site[j];
+                        }
+                    }
+                    double v = (u[0][0]*(u[1][1]*u[2][2]-u[1][2]*u[2][1]) -
+                                u[0][1]*(u[1][0]*u[2][2]-u[1][2]*u[2][0]) +
+                                u[0][2]*(u[1][0]*u[2][1]-u[1][1]*u[2][0]))/6.0;
+                    double squares = 0.0;
+                    for(int j=0; j<3; ++j)
+                    {
+                        squares += u[0][j]*u[0][j] + u[1][j]*u[1][j] + u[2][j]*u[2][j] +
+                                   u[0][j]*u[1][j] + u[0][j]*u[2][j] + u[1][j]*u[2][j];
+                        moment[j] += v*(u[0][j]+u[1][j]+u[2][j])/4.0;
+                    }
+                    volume += v;
+                    energy += v*squares/10.0;
+                }
+            }
+            m_energies[c] = energy;
+            m_centroids[c] = site;
+            if(volume > 0.0)
+            {
+                m_centroids[c] = ngl::Vec3(site.m_x+moment[0]/volume,site.m_y+moment[1]/volume,
+                                           site.m_z+moment[2]/volume);
+            }
+        }
+    }
+
+private:
+    const std::vector<ClippedCell> &m_cells;
+    const std::vector<ngl::Vec3> &m_sites;
+    std::vector<ngl::Vec3> &m_centroids;
+    std::vector<double> &m_energies;
+};
+
+// spreads the low 10 bits of _x three apart
+unsigned int spreadBits(unsigned int _x)
+{
+    _x &= 0x3ff;
+    _x = (_x | (_x<<16)) & 0x030000ff;
+    _x = (_x | (_x<<8)) & 0x0300f00f;
+    _x = (_x | (_x<<4)) & 0x030c30c3;
+    _x = (_x | (_x<<2)) & 0x09249249;
+    return _x;
+}
+
+} // end anonymous namespace
+
+double CVT::centroids(const std::vector<ClippedCell> &_cells, const std::vector<ngl::Vec3> &_sites,
+                      std::vector<ngl::Vec3> &o_centroids)
+{
+    TRACE_ZONE("CVT::centroids");
+    o_centroids.resize(_sites.size());
+    std::vector<double> energies(_sites.size());
+    CentroidTask centroids(_cells,_sites,o_centroids,energies);
+    Parallel::forRange(std::min(_cells.size(),_sites.size()),256,centroids);
+    // summed in order so the energy is the same on any number of threads
+    double energy = 0.0;
+    for(unsigned int c=0; c<energies.size(); ++c)
+    {
+        energy += energies[c];
+    }
+    return energy;
+}
+
+void CVT::spatialOrder(const std::vector<ngl::Vec3> &_points, std::vector<unsigned int> &o_order)
+{
+    o_order.resize(_points.size());
+    if(_points.empty())
+    {
+        return;
+    }
+    ngl::Vec3 minB = _points[0];
+    ngl::Vec3 maxB = _points[0];
+    for(unsigned int i=1; i<_points.size(); ++i)
+    {
+        for(int k=0; k<3; ++k)
+        {
+            minB[k] = std::min(minB[k],_points[i][k]);
+            maxB[k] = std::max(maxB[k],_points[i][k]);
+        }
+    }
+    std::vector<std::pair<unsigned int,unsigned int> > codes(_points.size());
+    for(unsigned int i=0; i<_points.size(); ++i)
+    {
+        unsigned int code = 0;
+        for(int k=0; k<3; ++k)
+        {
+            double extent = maxB[k]-minB[k];
+            unsigned int cell = extent > 0.0 ? (unsigned int)((_points[i][k]-minB[k])/extent*1023.0) : 0;
+            code |= spreadBits(cell)<<k;
+        }
+        codes[i] = std::make_pair(code,i);
+    }
+    std::sort(codes.begin(),codes.end());
+    for(unsigned int i=0; i<codes.size(); ++i)
+    {
+        o_order[i] = codes[i].second;
+    }
+}
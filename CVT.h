@@ -0,0 +1,38 @@
+#ifndef CVT_H
+#define CVT_H
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file CVT.h
+/// @author Maria Vineeta Bagya Seelan
+/// @version 1.0
+/// @date 16/08/13
+/// Revision History :
+/// Initial Version 16/08/13
+/// @brief the steps of a centroidal voronoi tessellation by Lloyd iterations: the centroid and the energy of every
+/// @brief clipped cell, and an order of the points that keeps the walks of the retriangulation short
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "CellClipper.h"
+
+namespace CVT
+{
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief computes the centroid of every cell in parallel together with the energy of the tessellation, the sum
+    /// over the cells of the integral of the squared distance to the site
+    /// @param [in] _cells the clipped cells, cell i belongs to site i
+    /// @param [in] _sites the sites
+    /// @param [out] o_centroids receives one centroid per site, a site whose cell is empty is its own centroid
+    /// @returns the energy
+    //----------------------------------------------------------------------------------------------------------------------
+    double centroids(const std::vector<ClippedCell> &_cells, const std::vector<ngl::Vec3> &_sites,
+                     std::vector<ngl::Vec3> &o_centroids);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sorts the points along a Morton curve over their bounds, points that follow each other in the order are
+    /// close in space
+    /// @param [in] _points the points
+    /// @param [out] o_order receives the point indices in curve order
+    //----------------------------------------------------------------------------------------------------------------------
+    void spatialOrder(const std::vector<ngl::Vec3> &_points, std::vector<unsigned int> &o_order);
+}
+
+#endif // CVT_H
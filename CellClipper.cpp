@@ -0,0 +1,469 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file CellClipper.cpp
+/// @brief Class that clips the voronoi cells to the bounding box and the mesh
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "CellClipper.h"
+#include "Parallel.h"
+#include "Trace.h"
+#include "AllocStats.h"
+#include <algorithm>
+#include <cmath>
+
+// A cell is kept as a convex polyhedron in double precision and cut by one plane at a time, keeping the side where
+// n.x <= d. The vertices are classified against the plane with a tolerance, every face is clipped on its own and the
+// points where the edges cross the plane are shared between the two faces of the edge, then they close the cut with
+// a new face. The first cuts are the bisectors, which leave a cell the size of its neighbourhood, so the query for
+// the mesh triangles only returns the few that are near the cell
+
+const unsigned int ClippedCell::s_boundary;
+
+namespace
+{
+
+struct DVec
+{
+    double m_x;
+    double m_y;
+    double m_z;
+};
+
+inline DVec dvec(double _x, double _y, double _z) { DVec v = { _x, _y, _z }; return v; }
+inline DVec dvec(const ngl::Vec3 &_v) { return dvec(_v.m_x,_v.m_y,_v.m_z); }
+inline DVec operator-(const DVec &_a, const DVec &_b) { return dvec(_a.m_x-_b.m_x,_a.m_y-_b.m_y,_a.m_z-_b.m_z); }
+inline DVec operator+(const DVec &_a, const DVec &_b) { return dvec(_a.m_x+_b.m_x,_a.m_y+_b.m_y,_a.m_z+_b.m_z); }
+inline DVec operator*(const DVec &_a, double _s) { return dvec(_a.m_x*_s,_a.m_y*_s,_a.m_z*_s); }
+inline double dot(const DVec &_a, const DVec &_b) { return _a.m_x*_b.m_x + _a.m_y*_b.m_y + _a.m_z*_b.m_z; }
+inline DVec cross(const DVec &_a, const DVec &_b)
+{
+    return dvec(_a.m_y*_b.m_z-_a.m_z*_b.m_y,_a.m_z*_b.m_x-_a.m_x*_b.m_z,_a.m_x*_b.m_y-_a.m_y*_b.m_x);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the half space n.x <= d, n is of unit length
+//----------------------------------------------------------------------------------------------------------------------
+struct Plane
+{
+    DVec m_n;
+    double m_d;
+};
+
+bool makePlane(const DVec &_n, double _d, Plane &o_plane)
+{
+    double length = std::sqrt(dot(_n,_n));
+    if(length == 0.0)
+    {
+        return false;
+    }
+    o_plane.m_n = _n*(1.0/length);
+    o_plane.m_d = _d/length;
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a convex polyhedron, the vertices of face f are m_faceVerts from m_faceOffsets[f] to m_faceOffsets[f+1],
+/// counter clockwise seen from outside
+//----------------------------------------------------------------------------------------------------------------------
+struct Polyhedron
+{
+    std::vector<DVec> m_verts;
+    std::vector<unsigned int> m_faceVerts;
+    std::vector<unsigned int> m_faceOffsets;
+    std::vector<Plane> m_planes;
+    std::vector<unsigned int> m_tags;
+
+    void clear()
+    {
+        m_verts.clear();
+        m_faceVerts.clear();
+        m_faceOffsets.assign(1,0);
+        m_planes.clear();
+        m_tags.clear();
+    }
+    unsigned int faceCount() const { return m_planes.size(); }
+    bool empty() const { return m_planes.empty(); }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the buffers a clip reuses from one plane to the next
+//----------------------------------------------------------------------------------------------------------------------
+struct ClipScratch
+{
+    std::vector<double> m_dist;
+    std::vector<int> m_side;
+    std::vector<unsigned int> m_remap;
+    // the edges already cut, as the two old vertices and the new one
+    std::vector<unsigned int> m_cuts;
+    std::vector<unsigned int> m_cap;
+    std::vector<std::pair<double,unsigned int> > m_angles;
+    std::vector<unsigned int> m_triangles;
+    std::vector<std::pair<double,unsigned int> > m_order;
+    Polyhedron m_other;
+};
+
+void makeBox(const ngl::Vec3 &_min, const ngl::Vec3 &_max, Polyhedron &o_box)
+{
+    // vertex i has bit 0 for x, bit 1 for y and bit 2 for z set at the maximum
+    static const unsigned int faces[6][4] = { {0,4,6,2}, {1,3,7,5}, {0,1,5,4}, {2,6,7,3}, {0,2,3,1}, {4,5,7,6} };
+    o_box.clear();
+    for(unsigned int i=0; i<8; ++i)
+    {
+        o_box.m_verts.push_back(dvec(i&1 ? _max.m_x : _min.m_x,i&2 ? _max.m_y : _min.m_y,i&4 ? _max.m_z : _min.m_z));
+    }
+    for(int f=0; f<6; ++f)
+    {
+        int axis = f/2;
+        bool upper = f%2 == 1;
+        Plane plane;
+        plane.m_n = dvec(axis == 0,axis == 1,axis == 2)*(upper ? 1.0 : -1.0);
+        plane.m_d = upper ? _max[axis] : -_min[axis];
+        o_box.m_faceVerts.insert(o_box.m_faceVerts.end(),faces[f],faces[f]+4);
+        o_box.m_faceOffsets.push_back(o_box.m_faceVerts.size());
+        o_box.m_planes.push_back(plane);
+        o_box.m_tags.push_back(ClippedCell::s_boundary);
+    }
+}
+
+unsigned int cutVertex(const Polyhedron &_in, unsigned int _a, unsigned int _b, ClipScratch &_scratch,
+                       Polyhedron &o_out)
+{
+    unsigned int lo = std::min(_a,_b);
+    unsigned int hi = std::max(_a,_b);
+    for(unsigned int i=0; i<_scratch.m_cuts.size(); i+=3)
+    {
+        if(_scratch.m_cuts[i] == lo && _scratch.m_cuts[i+1] == hi)
+        {
+            return _scratch.m_cuts[i+2];
+        }
+    }
+    // computed from the same end whichever face asks, so both faces get the same point
+    double t = _scratch.m_dist[lo]/(_scratch.m_dist[lo]-_scratch.m_dist[hi]);
+    unsigned int vert = o_out.m_verts.size();
+    o_out.m_verts.push_back(_in.m_verts[lo]+(_in.m_verts[hi]-_in.m_verts[lo])*t);
+    _scratch.m_cuts.push_back(lo);
+    _scratch.m_cuts.push_back(hi);
+    _scratch.m_cuts.push_back(vert);
+    _scratch.m_cap.push_back(vert);
+    return vert;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief adds the face that closes a cut, its vertices are the ones on the plane sorted by angle about its normal
+//----------------------------------------------------------------------------------------------------------------------
+void addCap(const Plane &_plane, unsigned int _tag, ClipScratch &_scratch, Polyhedron &io_out)
+{
+    const std::vector<unsigned int> &cap = _scratch.m_cap;
+    if(cap.size() < 3)
+    {
+        return;
+    }
+    DVec centre = dvec(0.0,0.0,0.0);
+    for(unsigned int i=0; i<cap.size(); ++i)
+    {
+        centre = centre+io_out.m_verts[cap[i]];
+    }
+    centre = centre*(1.0/cap.size());
+    // measure the angles from the point furthest from the centre, so the axis is never a null vector
+    DVec u = dvec(0.0,0.0,0.0);
+    for(unsigned int i=0; i<cap.size(); ++i)
+    {
+        DVec d = io_out.m_verts[cap[i]]-centre;
+        if(dot(d,d) > dot(u,u))
+        {
+            u = d;
+        }
+    }
+    DVec w = cross(_plane.m_n,u);
+    _scratch.m_angles.clear();
+    for(unsigned int i=0; i<cap.size(); ++i)
+    {
+        DVec d = io_out.m_verts[cap[i]]-centre;
+        _scratch.m_angles.push_back(std::make_pair(std::atan2(dot(d,w),dot(d,u)),cap[i]));
+    }
+    std::sort(_scratch.m_angles.begin(),_scratch.m_angles.end());
+    for(unsigned int i=0; i<_scratch.m_angles.size(); ++i)
+    {
+        io_out.m_faceVerts.push_back(_scratch.m_angles[i].second);
+    }
+    io_out.m_faceOffsets.push_back(io_out.m_faceVerts.size());
+    io_out.m_planes.push_back(_plane);
+    io_out.m_tags.push_back(_tag);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief cuts a polyhedron by a plane
+/// @param [in,out] io_poly the polyhedron, left empty when nothing is below the plane
+/// @param [in] _plane the plane, the part above it is cut off
+/// @param [in] _tag the tag of the face the cut adds
+/// @param [in] _eps the distance within which a vertex counts as on the plane
+/// @param [in] _scratch the buffers of the clip
+//----------------------------------------------------------------------------------------------------------------------
+void clipPolyhedron(Polyhedron &io_poly, const Plane &_plane, unsigned int _tag, double _eps, ClipScratch &_scratch)
+{
+    unsigned int verts = io_poly.m_verts.size();
+    _scratch.m_dist.resize(verts);
+    _scratch.m_side.resize(verts);
+    bool above = false;
+    bool below = false;
+    for(unsigned int v=0; v<verts; ++v)
+    {
+        double dist = dot(_plane.m_n,io_poly.m_verts[v])-_plane.m_d;
+        int side = dist > _eps ? 1 : (dist < -_eps ? -1 : 0);
+        _scratch.m_dist[v] = dist;
+        _scratch.m_side[v] = side;
+        above = above || side > 0;
+        below = below || side < 0;
+    }
+    if(!above)
+    {
+        return;
+    }
+    if(!below)
+    {
+        io_poly.clear();
+        return;
+    }
+
+    Polyhedron &out = _scratch.m_other;
+    out.clear();
+    _scratch.m_remap.resize(verts);
+    _scratch.m_cuts.clear();
+    _scratch.m_cap.clear();
+    for(unsigned int v=0; v<verts; ++v)
+    {
+        _scratch.m_remap[v] = out.m_verts.size();
+        if(_scratch.m_side[v] <= 0)
+        {
+            out.m_verts.push_back(io_poly.m_verts[v]);
+        }
+        if(_scratch.m_side[v] == 0)
+        {
+            _scratch.m_cap.push_back(_scratch.m_remap[v]);
+        }
+    }
+    for(unsigned int f=0; f<io_poly.faceCount(); ++f)
+    {
+        unsigned int begin = io_poly.m_faceOffsets[f];
+        unsigned int end = io_poly.m_faceOffsets[f+1];
+        unsigned int start = out.m_faceVerts.size();
+        for(unsigned int i=begin; i<end; ++i)
+        {
+            unsigned int a = io_poly.m_faceVerts[i];
+            unsigned int b = io_poly.m_faceVerts[i+1 < end ? i+1 : begin];
+            if(_scratch.m_side[a] <= 0)
+            {
+                out.m_faceVerts.push_back(_scratch.m_remap[a]);
+            }
+            if(_scratch.m_side[a]*_scratch.m_side[b] < 0)
+            {
+                out.m_faceVerts.push_back(cutVertex(io_poly,a,b,_scratch,out));
+            }
+        }
+        // a face that only touches the plane is gone
+        if(out.m_faceVerts.size()-start < 3)
+        {
+            out.m_faceVerts.resize(start);
+            continue;
+        }
+        out.m_faceOffsets.push_back(out.m_faceVerts.size());
+        out.m_planes.push_back(io_poly.m_planes[f]);
+        out.m_tags.push_back(io_poly.m_tags[f]);
+    }
+    addCap(_plane,_tag,_scratch,out);
+    std::swap(io_poly,out);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief tells whether a triangle may meet a convex polyhedron, false when it is above one of the face planes
+//----------------------------------------------------------------------------------------------------------------------
+bool mayTouch(const Polyhedron &_poly, const DVec *_tri, double _eps)
+{
+    for(unsigned int f=0; f<_poly.faceCount(); ++f)
+    {
+        const Plane &plane = _poly.m_planes[f];
+        if(dot(plane.m_n,_tri[0]) > plane.m_d+_eps && dot(plane.m_n,_tri[1]) > plane.m_d+_eps &&
+           dot(plane.m_n,_tri[2]) > plane.m_d+_eps)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief copies a polyhedron to a cell, leaving out the vertices no face uses
+//----------------------------------------------------------------------------------------------------------------------
+void toCell(const Polyhedron &_poly, ClipScratch &_scratch, ClippedCell &o_cell)
+{
+    o_cell.m_verts.clear();
+    o_cell.m_faces.clear();
+    _scratch.m_remap.assign(_poly.m_verts.size(),ClippedCell::s_boundary);
+    o_cell.m_faces.resize(_poly.faceCount());
+    for(unsigned int f=0; f<_poly.faceCount(); ++f)
+    {
+        VFace &face = o_cell.m_faces[f];
+        face.m_site = _poly.m_tags[f];
+        face.m_closed = true;
+        for(unsigned int i=_poly.m_faceOffsets[f]; i<_poly.m_faceOffsets[f+1]; ++i)
+        {
+            unsigned int v = _poly.m_faceVerts[i];
+            if(_scratch.m_remap[v] == ClippedCell::s_boundary)
+            {
+                _scratch.m_remap[v] = o_cell.m_verts.size();
+                const DVec &p = _poly.m_verts[v];
+                o_cell.m_verts.push_back(ngl::Vec3(p.m_x,p.m_y,p.m_z));
+            }
+            face.m_vert.push_back(_scratch.m_remap[v]);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief clips the cells of a range of sites
+//----------------------------------------------------------------------------------------------------------------------
+class ClipTask : public ParallelTask
+{
+public:
+    ClipTask(const Voronoi &_voronoi, const ngl::Vec3 &_min, const ngl::Vec3 &_max,
+             const std::vector<ngl::Vec3> &_vertTri, const TriangleBVH &_bvh, std::vector<ClippedCell> &o_cells) :
+        m_voronoi(_voronoi), m_min(_min), m_max(_max), m_vertTri(_vertTri), m_bvh(_bvh), m_cells(o_cells)
+    {
+        DVec diagonal = dvec(_max)-dvec(_min);
+        double size = std::sqrt(dot(diagonal,diagonal));
+        m_eps = 1e-9*size;
+        // the samples on the surface are rounded to float, they must still count as inside their own triangles
+        m_inside = 1e-5*size;
+    }
+
+    void run(unsigned int _begin, unsigned int _end)
+    {
+        ClipScratch scratch;
+        Polyhedron poly;
+        for(unsigned int s=_begin; s<_end; ++s)
+        {
+            clipCell(s,poly,scratch);
+            toCell(poly,scratch,m_cells[s]);
+        }
+    }
+
+private:
+    void clipCell(unsigned int _site, Polyhedron &o_poly, ClipScratch &_scratch) const
+    {
+        const VCell &cell = m_voronoi.getCells()[_site];
+        const std::vector<ngl::Vec3> &sites = m_voronoi.getTopology().getSites();
+        o_poly.clear();
+        // a site that is no vertex, a duplicated point, has no cell
+        if(cell.m_faces.empty())
+        {
+            return;
+        }
+        makeBox(m_min,m_max,o_poly);
+        DVec site = dvec(sites[_site]);
+        for(unsigned int f=0; f<cell.m_faces.size() && !o_poly.empty(); ++f)
+        {
+            DVec other = dvec(sites[cell.m_faces[f].m_site]);
+            Plane bisector;
+            if(makePlane(other-site,dot(other-site,(site+other)*0.5),bisector))
+            {
+                clipPolyhedron(o_poly,bisector,cell.m_faces[f].m_site,m_eps,_scratch);
+            }
+        }
+        if(m_bvh.empty() || o_poly.empty())
+        {
+            return;
+        }
+
+        ngl::Vec3 minB(m_max);
+        ngl::Vec3 maxB(m_min);
+        for(unsigned int v=0; v<o_poly.m_verts.size(); ++v)
+        {
+            const DVec &p = o_poly.m_verts[v];
+            minB = ngl::Vec3(std::min<double>(minB.m_x,p.m_x),std::min<double>(minB.m_y,p.m_y),
+                             std::min<double>(minB.m_z,p.m_z));
+            maxB = ngl::Vec3(std::max<double>(maxB.m_x,p.m_x),std::max<double>(maxB.m_y,p.m_y),
+                             std::max<double>(maxB.m_z,p.m_z));
+        }
+        m_bvh.query(minB,maxB,_scratch.m_triangles);
+        // the nearest triangles cut first, the cell then shrinks away from the ones behind them
+        _scratch.m_order.clear();
+        for(unsigned int i=0; i<_scratch.m_triangles.size(); ++i)
+        {
+            unsigned int t = _scratch.m_triangles[i];
+            DVec centre = (dvec(m_vertTri[3*t])+dvec(m_vertTri[3*t+1])+dvec(m_vertTri[3*t+2]))*(1.0/3.0);
+            _scratch.m_order.push_back(std::make_pair(dot(centre-site,centre-site),t));
+        }
+        std::sort(_scratch.m_order.begin(),_scratch.m_order.end());
+        for(unsigned int i=0; i<_scratch.m_order.size() && !o_poly.empty(); ++i)
+        {
+            unsigned int t = _scratch.m_order[i].second;
+            DVec tri[3] = { dvec(m_vertTri[3*t]), dvec(m_vertTri[3*t+1]), dvec(m_vertTri[3*t+2]) };
+            Plane plane;
+            if(!makePlane(cross(tri[1]-tri[0],tri[2]-tri[0]),0.0,plane))
+            {
+                continue;
+            }
+            plane.m_d = dot(plane.m_n,tri[0]);
+            if(dot(plane.m_n,site)-plane.m_d > m_inside || !mayTouch(o_poly,tri,m_eps))
+            {
+                continue;
+            }
+            clipPolyhedron(o_poly,plane,ClippedCell::s_boundary,m_eps,_scratch);
+        }
+    }
+
+    const Voronoi &m_voronoi;
+    ngl::Vec3 m_min;
+    ngl::Vec3 m_max;
+    const std::vector<ngl::Vec3> &m_vertTri;
+    const TriangleBVH &m_bvh;
+    std::vector<ClippedCell> &m_cells;
+    double m_eps;
+    double m_inside;
+};
+
+// six times the signed volume of a closed mesh, only the sign is used
+double meshVolume(const std::vector<ngl::Vec3> &_vertTri)
+{
+    double volume = 0.0;
+    for(unsigned int i=0; i+2<_vertTri.size(); i+=3)
+    {
+        volume += dot(dvec(_vertTri[i]),cross(dvec(_vertTri[i+1]),dvec(_vertTri[i+2])));
+    }
+    return volume;
+}
+
+} // end anonymous namespace
+
+CellClipper::CellClipper() : m_min(0.0,0.0,0.0), m_max(0.0,0.0,0.0)
+{
+}
+
+void CellClipper::setBounds(const ngl::Vec3 &_min, const ngl::Vec3 &_max)
+{
+    m_min = _min;
+    m_max = _max;
+}
+
+void CellClipper::setTriangles(const std::vector<ngl::Vec3> &_vertTri)
+{
+    m_vertTri = _vertTri;
+    // a mesh wound clockwise has a negative volume, turning its triangles makes every normal point out
+    if(meshVolume(m_vertTri) < 0.0)
+    {
+        for(unsigned int i=0; i+2<m_vertTri.size(); i+=3)
+        {
+            std::swap(m_vertTri[i+1],m_vertTri[i+2]);
+        }
+    }
+    m_bvh.build(m_vertTri);
+}
+
+void CellClipper::clip(const Voronoi &_voronoi, std::vector<ClippedCell> &o_cells) const
+{
+    TRACE_ZONE("CellClipper::clip");
+    ALLOC_PHASE(VORONOI);
+    o_cells.clear();
+    o_cells.resize(_voronoi.getCells().size());
+    ClipTask cells(_voronoi,m_min,m_max,m_vertTri,m_bvh,o_cells);
+    Parallel::forRange(o_cells.size(),64,cells);
+}
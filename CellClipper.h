@@ -0,0 +1,85 @@
+#ifndef CELLCLIPPER_H
+#define CELLCLIPPER_H
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file CellClipper.h
+/// @author Maria Vineeta Bagya Seelan
+/// @version 1.0
+/// @date 16/08/13
+/// Revision History :
+/// Initial Version 16/08/13
+/// @class CellClipper
+/// @brief cuts the voronoi cells down to the sampled mesh. Every cell starts as the bounding box, is cut by the
+/// @brief bisector plane to each of its Delaunay neighbours and then by the planes of the mesh triangles it reaches,
+/// @brief so unbounded cells on the hull come out closed as well. The cells are clipped in parallel
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Voronoi.h"
+#include "TriangleBVH.h"
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class ClippedCell
+/// @brief a closed convex polyhedron with its own vertices, empty when nothing of the cell is left
+//----------------------------------------------------------------------------------------------------------------------
+class ClippedCell
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the m_site of a face that comes from the mesh or the bounding box rather than a neighbouring site
+    //----------------------------------------------------------------------------------------------------------------------
+    static const unsigned int s_boundary = 0xffffffff;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief The vertices of the cell
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<ngl::Vec3> m_verts;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief The faces of the cell, their m_vert index m_verts and all of them are closed
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<VFace> m_faces;
+};
+
+class CellClipper
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief Constructor for a CellClipper with no mesh and an empty box
+    //----------------------------------------------------------------------------------------------------------------------
+    CellClipper();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that sets the box every cell starts from, it should hold all the sites
+    /// @param [in] _min the minimum corner of the box
+    /// @param [in] _max the maximum corner of the box
+    //----------------------------------------------------------------------------------------------------------------------
+    void setBounds(const ngl::Vec3 &_min, const ngl::Vec3 &_max);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that sets the mesh the cells are clipped to and indexes its triangles. The mesh should be
+    /// closed, its winding may be either way round. An empty mesh clips to the box alone
+    /// @param [in] _vertTri three vertices per triangle
+    //----------------------------------------------------------------------------------------------------------------------
+    void setTriangles(const std::vector<ngl::Vec3> &_vertTri);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that clips every cell of a voronoi diagram. A triangle cuts a cell when it meets the cell and
+    /// the site is on its inner side, which is exact for a convex mesh. Where the mesh is concave inside one cell the
+    /// cell is cut by the planes of both sides and loses the part that is only behind one of them
+    /// @param [in] _voronoi a voronoi diagram after buildCells
+    /// @param [out] o_cells receives one cell per site of _voronoi
+    //----------------------------------------------------------------------------------------------------------------------
+    void clip(const Voronoi &_voronoi, std::vector<ClippedCell> &o_cells) const;
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the box every cell starts from
+    //----------------------------------------------------------------------------------------------------------------------
+    ngl::Vec3 m_min;
+    ngl::Vec3 m_max;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the triangles of the mesh, wound counter clockwise seen from outside
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<ngl::Vec3> m_vertTri;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the hierarchy over m_vertTri
+    //----------------------------------------------------------------------------------------------------------------------
+    TriangleBVH m_bvh;
+};
+
+#endif // CELLCLIPPER_H
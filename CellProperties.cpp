@@ -0,0 +1,327 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file CellProperties.cpp
+/// @brief Class that computes the mass properties of the voronoi cells
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "CellProperties.h"
+#include "Parallel.h"
+#include "Trace.h"
+#include "AllocStats.h"
+#include <algorithm>
+#include <cmath>
+
+// Inside one tetrahedron the part of the cell of vertex s next to the edge st and the face stu is the tetrahedron of
+// s, the midpoint of st, the circumcentre of stu and the circumcentre of the tetrahedron. Taken with the sign of the
+// orientation of s, t, u and the fourth vertex w these 24 pieces per tetrahedron add up to the exact cells, even where
+// a circumcentre lies outside its tetrahedron, and the piece is a pyramid on the face st of height |st|/2 so it also
+// gives its share of the face area. The pieces are found per tetrahedron in fixed size loops, then every site adds up
+// those of the tetrahedra around it, so no cell polygons are built and no two threads write the same entry
+
+namespace
+{
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the pieces of the cells in one tetrahedron, per vertex slot and per slot of the other end of the edge
+//----------------------------------------------------------------------------------------------------------------------
+struct TetPieces
+{
+    double m_volume[4];
+    double m_moment[4][3];
+    double m_area[4][4];
+};
+
+inline double det3(const double *_a, const double *_b, const double *_c)
+{
+    return _a[0]*(_b[1]*_c[2]-_b[2]*_c[1]) - _a[1]*(_b[0]*_c[2]-_b[2]*_c[0]) + _a[2]*(_b[0]*_c[1]-_b[1]*_c[0]);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the circumcentre of a triangle relative to its first vertex
+/// @returns false for a degenerate triangle
+//----------------------------------------------------------------------------------------------------------------------
+bool triangleCentre(const double *_a, const double *_b, const double *_c, double *o_centre)
+{
+    double u[3];
+    double v[3];
+    for(int k=0; k<3; ++k)
+    {
+        u[k] = _b[k]-_a[k];
+        v[k] = _c[k]-_a[k];
+    }
+    double w[3] = { u[1]*v[2]-u[2]*v[1], u[2]*v[0]-u[0]*v[2], u[0]*v[1]-u[1]*v[0] };
+    double ww = w[0]*w[0]+w[1]*w[1]+w[2]*w[2];
+    if(ww == 0.0)
+    {
+        return false;
+    }
+    double uu = u[0]*u[0]+u[1]*u[1]+u[2]*u[2];
+    double vv = v[0]*v[0]+v[1]*v[1]+v[2]*v[2];
+    // |u|^2 (v x w) + |v|^2 (w x u), over 2|w|^2
+    double vw[3] = { v[1]*w[2]-v[2]*w[1], v[2]*w[0]-v[0]*w[2], v[0]*w[1]-v[1]*w[0] };
+    double wu[3] = { w[1]*u[2]-w[2]*u[1], w[2]*u[0]-w[0]*u[2], w[0]*u[1]-w[1]*u[0] };
+    for(int k=0; k<3; ++k)
+    {
+        o_centre[k] = _a[k] + (uu*vw[k]+vv*wu[k])/(2.0*ww);
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief computes the pieces of a range of tetrahedra
+//----------------------------------------------------------------------------------------------------------------------
+class PieceTask : public ParallelTask
+{
+public:
+    PieceTask(const TetTopology &_topology, const std::vector<ngl::Vec3> &_centres, std::vector<TetPieces> &o_pieces) :
+        m_topology(_topology), m_centres(_centres), m_pieces(o_pieces) {}
+
+    void run(unsigned int _begin, unsigned int _end)
+    {
+        const std::vector<ngl::Vec3> &sites = m_topology.getSites();
+        for(unsigned int t=_begin; t<_end; ++t)
+        {
+            double p[4][3];
+            for(int i=0; i<4; ++i)
+            {
+                const ngl::Vec3 &site = sites[m_topology.tetSite(t,i)];
+                p[i][0] = site.m_x;
+                p[i][1] = site.m_y;
+                p[i][2] = site.m_z;
+            }
+            double c[3] = { m_centres[t].m_x, m_centres[t].m_y, m_centres[t].m_z };
+            // the circumcentre of the face opposite each vertex
+            double q[4][3];
+            bool valid[4];
+            for(int l=0; l<4; ++l)
+            {
+                valid[l] = triangleCentre(p[(l+1)%4],p[(l+2)%4],p[(l+3)%4],q[l]);
+            }
+
+            TetPieces &pieces = m_pieces[t];
+            for(int i=0; i<4; ++i)
+            {
+                pieces.m_volume[i] = 0.0;
+                for(int k=0; k<3; ++k)
+                {
+                    pieces.m_moment[i][k] = 0.0;
+                }
+                for(int j=0; j<4; ++j)
+                {
+                    pieces.m_area[i][j] = 0.0;
+                }
+            }
+            for(int i=0; i<4; ++i)
+            {
+                for(int j=0; j<4; ++j)
+                {
+                    if(j == i)
+                    {
+                        continue;
+                    }
+                    double st[3];
+                    double m[3];
+                    double cs[3];
+                    for(int k=0; k<3; ++k)
+                    {
+                        st[k] = p[j][k]-p[i][k];
+                        m[k] = 0.5*st[k];
+                        cs[k] = c[k]-p[i][k];
+                    }
+                    double length = std::sqrt(st[0]*st[0]+st[1]*st[1]+st[2]*st[2]);
+                    if(length == 0.0)
+                    {
+                        continue;
+                    }
+                    // the two faces through the edge, u is their third vertex and w the one opposite
+                    for(int u=0; u<4; ++u)
+                    {
+                        int w = 6-i-j-u;
+                        if(u == i || u == j || !valid[w])
+                        {
+                            continue;
+                        }
+                        double us[3];
+                        double ws[3];
+                        double qs[3];
+                        for(int k=0; k<3; ++k)
+                        {
+                            us[k] = p[u][k]-p[i][k];
+                            ws[k] = p[w][k]-p[i][k];
+                            qs[k] = q[w][k]-p[i][k];
+                        }
+                        double orientation = det3(st,us,ws) < 0.0 ? -1.0 : 1.0;
+                        double volume = orientation*det3(m,qs,cs)/6.0;
+                        pieces.m_volume[i] += volume;
+                        for(int k=0; k<3; ++k)
+                        {
+                            pieces.m_moment[i][k] += volume*(m[k]+qs[k]+cs[k])/4.0;
+                        }
+                        pieces.m_area[i][j] += 6.0*volume/length;
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    const TetTopology &m_topology;
+    const std::vector<ngl::Vec3> &m_centres;
+    std::vector<TetPieces> &m_pieces;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief adds up the pieces of a range of sites, the first pass finds the scalars and the number of faces and the
+/// second, once the face offsets are known, writes the faces
+//----------------------------------------------------------------------------------------------------------------------
+class SiteTask : public ParallelTask
+{
+public:
+    SiteTask(const TetTopology &_topology, const std::vector<TetPieces> &_pieces, std::vector<unsigned char> &io_bounded,
+             std::vector<double> &io_volumes, std::vector<ngl::Vec3> &io_centroids, std::vector<double> &io_areas,
+             std::vector<unsigned int> &io_faceOffsets) :
+        m_topology(_topology), m_pieces(_pieces), m_bounded(io_bounded), m_volumes(io_volumes),
+        m_centroids(io_centroids), m_areas(io_areas), m_faceOffsets(io_faceOffsets),
+        m_faceSites(NULL), m_faceAreas(NULL), m_faceNormals(NULL) {}
+
+    void setFaces(std::vector<unsigned int> &o_faceSites, std::vector<double> &o_faceAreas,
+                  std::vector<ngl::Vec3> &o_faceNormals)
+    {
+        m_faceSites = &o_faceSites;
+        m_faceAreas = &o_faceAreas;
+        m_faceNormals = &o_faceNormals;
+    }
+
+    void run(unsigned int _begin, unsigned int _end)
+    {
+        const std::vector<ngl::Vec3> &sites = m_topology.getSites();
+        const std::vector<unsigned int> &siteTets = m_topology.getSiteTets();
+        std::vector<std::pair<unsigned int,double> > faces;
+        for(unsigned int s=_begin; s<_end; ++s)
+        {
+            unsigned int begin = m_topology.siteTetsBegin(s);
+            unsigned int end = m_topology.siteTetsEnd(s);
+            bool bounded = begin < end;
+            double volume = 0.0;
+            double moment[3] = { 0.0, 0.0, 0.0 };
+            faces.clear();
+            for(unsigned int i=begin; i<end && bounded; ++i)
+            {
+                unsigned int t = siteTets[i];
+                int slot = m_topology.slotOf(t,s);
+                const TetPieces &pieces = m_pieces[t];
+                volume += pieces.m_volume[slot];
+                for(int k=0; k<3; ++k)
+                {
+                    moment[k] += pieces.m_moment[slot][k];
+                }
+                for(int j=0; j<4; ++j)
+                {
+                    if(j == slot)
+                    {
+                        continue;
+                    }
+                    // a face of the hull through the site leaves the cell open
+                    if(m_topology.tetNeighbour(t,j) < 0)
+                    {
+                        bounded = false;
+                    }
+                    unsigned int other = m_topology.tetSite(t,j);
+                    unsigned int f = 0;
+                    while(f < faces.size() && faces[f].first != other)
+                    {
+                        ++f;
+                    }
+                    if(f == faces.size())
+                    {
+                        faces.push_back(std::make_pair(other,0.0));
+                    }
+                    faces[f].second += pieces.m_area[slot][j];
+                }
+            }
+            if(!bounded)
+            {
+                faces.clear();
+            }
+
+            if(m_faceSites == NULL)
+            {
+                m_bounded[s] = bounded;
+                m_volumes[s] = bounded ? volume : 0.0;
+                m_centroids[s] = sites[s];
+                if(bounded && volume > 0.0)
+                {
+                    m_centroids[s] = ngl::Vec3(sites[s].m_x+moment[0]/volume,sites[s].m_y+moment[1]/volume,
+                                               sites[s].m_z+moment[2]/volume);
+                }
+                double area = 0.0;
+                for(unsigned int f=0; f<faces.size(); ++f)
+                {
+                    area += faces[f].second;
+                }
+                m_areas[s] = area;
+                m_faceOffsets[s+1] = faces.size();
+                continue;
+            }
+
+            std::sort(faces.begin(),faces.end());
+            unsigned int offset = m_faceOffsets[s];
+            for(unsigned int f=0; f<faces.size(); ++f)
+            {
+                ngl::Vec3 normal = sites[faces[f].first]-sites[s];
+                normal.normalize();
+                (*m_faceSites)[offset+f] = faces[f].first;
+                (*m_faceAreas)[offset+f] = faces[f].second;
+                (*m_faceNormals)[offset+f] = normal;
+            }
+        }
+    }
+
+private:
+    const TetTopology &m_topology;
+    const std::vector<TetPieces> &m_pieces;
+    std::vector<unsigned char> &m_bounded;
+    std::vector<double> &m_volumes;
+    std::vector<ngl::Vec3> &m_centroids;
+    std::vector<double> &m_areas;
+    std::vector<unsigned int> &m_faceOffsets;
+    std::vector<unsigned int> *m_faceSites;
+    std::vector<double> *m_faceAreas;
+    std::vector<ngl::Vec3> *m_faceNormals;
+};
+
+} // end anonymous namespace
+
+CellProperties::CellProperties()
+{
+    m_faceOffsets.push_back(0);
+}
+
+void CellProperties::compute(const Voronoi &_voronoi)
+{
+    TRACE_ZONE("CellProperties::compute");
+    ALLOC_PHASE(VORONOI);
+    const TetTopology &topology = _voronoi.getTopology();
+    unsigned int sites = topology.siteCount();
+
+    std::vector<TetPieces> pieces(topology.tetCount());
+    PieceTask piecesTask(topology,_voronoi.getVertices(),pieces);
+    Parallel::forRange(pieces.size(),1024,piecesTask);
+
+    m_bounded.resize(sites);
+    m_volumes.resize(sites);
+    m_centroids.resize(sites);
+    m_areas.resize(sites);
+    m_faceOffsets.assign(sites+1,0);
+    SiteTask siteTask(topology,pieces,m_bounded,m_volumes,m_centroids,m_areas,m_faceOffsets);
+    Parallel::forRange(sites,256,siteTask);
+    for(unsigned int s=0; s<sites; ++s)
+    {
+        m_faceOffsets[s+1] += m_faceOffsets[s];
+    }
+
+    m_faceSites.resize(m_faceOffsets.back());
+    m_faceAreas.resize(m_faceOffsets.back());
+    m_faceNormals.resize(m_faceOffsets.back());
+    siteTask.setFaces(m_faceSites,m_faceAreas,m_faceNormals);
+    Parallel::forRange(sites,256,siteTask);
+}
@@ -0,0 +1,75 @@
+#ifndef CELLPROPERTIES_H
+#define CELLPROPERTIES_H
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file CellProperties.h
+/// @author Maria Vineeta Bagya Seelan
+/// @version 1.0
+/// @date 16/08/13
+/// Revision History :
+/// Initial Version 16/08/13
+/// @class CellProperties
+/// @brief the mass properties of the voronoi cells: volume, centroid and surface area of every cell and the area and
+/// @brief normal of every face. They are found from the circumcentres and the indexed tetrahedralization alone, no
+/// @brief cell polygons are built, and are stored as arrays indexed by site
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Voronoi.h"
+
+class CellProperties
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief Constructor for empty CellProperties
+    //----------------------------------------------------------------------------------------------------------------------
+    CellProperties();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that computes the properties of every cell in parallel
+    /// @param [in] _voronoi a voronoi diagram whose topology has its sites, after buildTopology or buildCells
+    //----------------------------------------------------------------------------------------------------------------------
+    void compute(const Voronoi &_voronoi);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the number of sites
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int siteCount() const { return m_volumes.size(); }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor that tells for every site whether its cell is bounded, 0 for the sites on the convex hull and
+    /// those that are no vertex. The cells that are not bounded have no volume, area or faces and the site as centroid
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<unsigned char>& getBounded() const { return m_bounded; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessors for the volume, centroid and surface area of every cell
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<double>& getVolumes() const { return m_volumes; }
+    const std::vector<ngl::Vec3>& getCentroids() const { return m_centroids; }
+    const std::vector<double>& getAreas() const { return m_areas; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessors for the faces, those of site i are the entries from getFaceOffsets()[i] to
+    /// getFaceOffsets()[i+1] in increasing order of the site on their other side
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<unsigned int>& getFaceOffsets() const { return m_faceOffsets; }
+    const std::vector<unsigned int>& getFaceSites() const { return m_faceSites; }
+    const std::vector<double>& getFaceAreas() const { return m_faceAreas; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the unit normal of every face, pointing out of its cell
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<ngl::Vec3>& getFaceNormals() const { return m_faceNormals; }
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the properties of the cells
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<unsigned char> m_bounded;
+    std::vector<double> m_volumes;
+    std::vector<ngl::Vec3> m_centroids;
+    std::vector<double> m_areas;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the properties of the faces, those of site i start at m_faceOffsets[i]
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<unsigned int> m_faceOffsets;
+    std::vector<unsigned int> m_faceSites;
+    std::vector<double> m_faceAreas;
+    std::vector<ngl::Vec3> m_faceNormals;
+};
+
+#endif // CELLPROPERTIES_H
@@ -0,0 +1,689 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file CoreCheck.cpp
+/// @brief Self checks of the headless core. Each check builds a small case and tests the result against an independent
+/// evaluation, the snapped triangulation against the exact floating point predicates, the rays of the triangle
+/// hierarchy against testing every triangle, the signed distance field and its sampling against the closed form of
+/// their mesh, the voronoi edges kept up to date from the snapshots of a progressive build against those of the
+/// finished mesh, the clipped cells against the volume of their mesh and the cell properties against the clipped
+/// cells, and the graphs against the Euler characteristic of a ball. It prints one line per check and exits non zero
+/// if any of them failed.
+/// usage : CoreCheck
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "MeshSamplerCore.h"
+#include "TriangleBVH.h"
+#include "DynamicVoronoi.h"
+#include "sdf/signed_distance_field_from_mesh.hpp"
+#include "ngl/Random.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <fstream>
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the number of checks that failed so far
+//----------------------------------------------------------------------------------------------------------------------
+static int s_failures = 0;
+
+static void expect(bool _ok, const char *_check, const char *_what)
+{
+    if(!_ok)
+    {
+        fprintf(stderr,"FAIL %s : %s\n",_check,_what);
+        ++s_failures;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief exact equality, the == of ngl::Vec3 is fuzzy
+//----------------------------------------------------------------------------------------------------------------------
+static bool samePosition(const ngl::Vec3 &_a, const ngl::Vec3 &_b)
+{
+    return _a.m_x == _b.m_x && _a.m_y == _b.m_y && _a.m_z == _b.m_z;
+}
+
+static float uniform()
+{
+    return rand()/(float)RAND_MAX;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief builds the tetrahedra around the origin the way MeshSamplerCore does for points within _range of it
+//----------------------------------------------------------------------------------------------------------------------
+static Tetrahedron* bigTetrahedron(int _range)
+{
+    Tetrahedron *t = new Tetrahedron(ngl::Vec3(_range,0,-_range),ngl::Vec3(0,_range,-_range),
+                                     ngl::Vec3(-_range,-_range,-_range),ngl::Vec3(0,0,_range));
+    for(int i=0; i<4; ++i)
+    {
+        t->m_neighbours[i] = NULL;
+    }
+    return t;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief triangulates the points in the snapped mode and tests that the points kept their place up to _moveTolerance,
+/// that every point is a vertex, that the topology indexes the tetrahedra by the snapped points and that the mesh is
+/// Delaunay for the exact floating point predicates: no tetrahedron is flat and no neighbour apex is inside a sphere
+//----------------------------------------------------------------------------------------------------------------------
+static void checkSnappedBuild(const char *_name, const std::vector<ngl::Vec3> &_points, float _moveTolerance)
+{
+    MeshSamplerCore sampler;
+    sampler.setPoints(_points);
+    sampler.setSnapToGrid(true);
+    sampler.triangulate();
+    sampler.buildVoronoi();
+    sampler.buildGraphs();
+    const std::vector<ngl::Vec3> &points = sampler.getPoints();
+    const std::vector<Tetrahedron*> &tets = sampler.getTetrahedra();
+    const TetTopology &topology = sampler.getVoronoi()->getTopology();
+
+    float moved = 0.0;
+    for(unsigned int i=0; i<points.size() && i<_points.size(); ++i)
+    {
+        moved = std::max(moved,(points[i]-_points[i]).length());
+    }
+    expect(points.size() == _points.size(),_name,"the snapped points are not one per point");
+    expect(moved <= _moveTolerance,_name,"the points moved further than the grid spacing");
+
+    // the sites are the snapped points, so every point is a site and every site has tetrahedra
+    expect(topology.siteCount() == points.size() && topology.tetCount() == tets.size(),_name,
+           "the topology is not indexed by the snapped points");
+    bool indexed = topology.siteCount() == points.size();
+    for(unsigned int t=0; t<tets.size() && indexed; ++t)
+    {
+        for(int i=0; i<4; ++i)
+        {
+            indexed = indexed && samePosition(points[topology.tetSite(t,i)],tets[t]->getVertexData()[i]);
+        }
+    }
+    for(unsigned int s=0; s<topology.siteCount() && indexed; ++s)
+    {
+        indexed = topology.siteTetsEnd(s) > topology.siteTetsBegin(s);
+    }
+    expect(indexed,_name,"a point is not a vertex of its tetrahedra");
+
+    // the exact predicates without the perturbation, a cospherical apex is allowed on the sphere
+    Predicates exact;
+    exact.setPerturbation(false);
+    unsigned int flat = 0;
+    unsigned int inside = 0;
+    for(unsigned int t=0; t<tets.size() && indexed; ++t)
+    {
+        const ngl::Vec3 *v = tets[t]->getVertexData();
+        if(exact.orient3d(v[0],v[1],v[2],v[3]) == 0.0)
+        {
+            ++flat;
+            continue;
+        }
+        for(int i=0; i<4; ++i)
+        {
+            int n = topology.tetNeighbour(t,i);
+            if(n < 0)
+            {
+                continue;
+            }
+            for(int j=0; j<4; ++j)
+            {
+                unsigned int apex = topology.tetSite(n,j);
+                if(topology.slotOf(t,apex) < 0 && exact.insphere3d(tets[t],points[apex]) > 0)
+                {
+                    ++inside;
+                }
+            }
+        }
+    }
+    expect(flat == 0,_name,"a tetrahedron is flat");
+    expect(inside == 0,_name,"a neighbour apex is inside a circumsphere");
+    printf("%-28s %6u points %7u tetrahedra  moved %.3g  flat %u  not delaunay %u\n",_name,
+           (unsigned int)points.size(),(unsigned int)tets.size(),moved,flat,inside);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the snapped mode on a uniform box far from the origin, on a grid with cospherical points and on a box about
+/// the origin, and a direct build that tests the integer predicates decided the calls among the points
+//----------------------------------------------------------------------------------------------------------------------
+static void checkSnapping()
+{
+    srand(7);
+    // a millimetre box at ten units keeps every float, a grid anchored at the origin would merge its points
+    std::vector<ngl::Vec3> far;
+    for(int i=0; i<2000; ++i)
+    {
+        far.push_back(ngl::Vec3(10.0f+0.001f*uniform(),10.0f+0.001f*uniform(),10.0f+0.001f*uniform()));
+    }
+    checkSnappedBuild("snapped far box",far,0.0);
+
+    std::vector<ngl::Vec3> lattice;
+    for(int x=0; x<8; ++x)
+    {
+        for(int y=0; y<8; ++y)
+        {
+            for(int z=0; z<8; ++z)
+            {
+                lattice.push_back(ngl::Vec3(-3.3f+0.1f*x,0.7f+0.1f*y,5.0f+0.1f*z));
+            }
+        }
+    }
+    checkSnappedBuild("snapped cospherical grid",lattice,1e-6);
+
+    std::vector<ngl::Vec3> box;
+    for(int i=0; i<5000; ++i)
+    {
+        box.push_back(ngl::Vec3(2.0f*uniform()-1.0f,2.0f*uniform()-1.0f,2.0f*uniform()-1.0f));
+    }
+    // 2^-22, the spacing for a box of half width one
+    checkSnappedBuild("snapped centred box",box,ldexpf(1.0f,-22));
+
+    Delaunay delaunay(bigTetrahedron(20));
+    delaunay.setSnapToGrid(true);
+    delaunay.compute(box);
+    const PredicateStats &stats = delaunay.getPredicateStats();
+    expect(stats.m_orient3d[SNAPPED_EXACT] > 0 && stats.m_insphere[SNAPPED_EXACT] > 0,"snapped predicates",
+           "no call took the integer predicates");
+    printf("%-28s %6lu orient3d %7lu insphere on the grid\n","snapped predicates",
+           (unsigned long)stats.m_orient3d[SNAPPED_EXACT],(unsigned long)stats.m_insphere[SNAPPED_EXACT]);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the rays of the triangle hierarchy against testing every triangle, on a mesh with a stack of duplicate
+/// triangles and a fan of different triangles sharing their centre. Neither can be split, so their leaves hold many
+/// more triangles than a leaf normally does
+//----------------------------------------------------------------------------------------------------------------------
+static void checkTriangleHierarchy()
+{
+    srand(11);
+    std::vector<ngl::Vec3> tris;
+    ngl::Vec3 stack(-0.5,0.25,0.125);
+    for(int i=0; i<40; ++i)
+    {
+        tris.push_back(stack+ngl::Vec3(0.125,0.0,0.0));
+        tris.push_back(stack+ngl::Vec3(-0.0625,0.125,0.0));
+        tris.push_back(stack+ngl::Vec3(-0.0625,-0.125,0.0));
+    }
+    // the offsets are powers of two apart, so every centroid rounds to the same centre
+    ngl::Vec3 fan(0.25,0.25,0.5);
+    for(int i=0; i<30; ++i)
+    {
+        ngl::Vec3 a(0.015625f*(1+i%4),0.0078125f*(i%3),0.0);
+        ngl::Vec3 b(-0.015625f*(i%5),0.03125f,0.015625f*(i%2));
+        tris.push_back(fan+a);
+        tris.push_back(fan+b);
+        tris.push_back(fan-a-b);
+    }
+    for(int i=0; i<500; ++i)
+    {
+        ngl::Vec3 c(2.0f*uniform()-1.0f,2.0f*uniform()-1.0f,2.0f*uniform()-1.0f);
+        for(int k=0; k<3; ++k)
+        {
+            tris.push_back(c+ngl::Vec3(0.2f*uniform()-0.1f,0.2f*uniform()-0.1f,0.2f*uniform()-0.1f));
+        }
+    }
+    TriangleBVH bvh;
+    bvh.build(tris);
+
+    unsigned int rays = 3000;
+    unsigned int wrong = 0;
+    unsigned long hits = 0;
+    std::vector<unsigned int> found;
+    std::vector<unsigned int> expected;
+    for(unsigned int r=0; r<rays; ++r)
+    {
+        ngl::Vec3 start(3.0f*uniform()-1.5f,3.0f*uniform()-1.5f,3.0f*uniform()-1.5f);
+        // a third of the rays go through each of the two piles, the rest anywhere
+        ngl::Vec3 end = r%3 == 0 ? stack : (r%3 == 1 ? fan : ngl::Vec3(uniform(),uniform(),uniform()));
+        bvh.intersect(start,end,found);
+        expected.clear();
+        ngl::Vec3 dir = start-end;
+        for(unsigned int t=0; t<tris.size()/3; ++t)
+        {
+            if(TriangleBVH::rayHit(tris[3*t],tris[3*t+1]-tris[3*t],tris[3*t+2]-tris[3*t],start,dir))
+            {
+                expected.push_back(t);
+            }
+        }
+        wrong += found != expected;
+        hits += found.size();
+    }
+    expect(wrong == 0,"triangle hierarchy","a ray found other triangles than testing every triangle");
+    printf("%-28s %6u rays %9lu hits  differing %u\n","triangle hierarchy",rays,hits,wrong);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the field and the SDF sampling of the octahedron |x|+|y|+|z| <= 1, written to an Obj next to the binary.
+/// The field must have the sign of the closed form and, inside, its distance (1-|x|-|y|-|z|)/sqrt(3) to the nearest
+/// face. Each count of points must come out exactly, all of them inside the octahedron, the same points for the same
+/// seed and other points for another seed, and the density must give 20 points per step
+//----------------------------------------------------------------------------------------------------------------------
+static void checkSDFSampling()
+{
+    const char *objName = "CoreCheck_octahedron.obj";
+    {
+        std::ofstream obj(objName);
+        obj<<"v 1 0 0\nv -1 0 0\nv 0 1 0\nv 0 -1 0\nv 0 0 1\nv 0 0 -1\n";
+        obj<<"f 1 3 5\nf 3 2 5\nf 2 4 5\nf 4 1 5\nf 3 1 6\nf 2 3 6\nf 4 2 6\nf 1 4 6\n";
+    }
+    sdf::signed_distance_field_from_mesh field;
+    expect(field.load_from_file(objName),"sdf field","the octahedron could not be read");
+    srand(17);
+    unsigned int wrongSign = 0;
+    float error = 0.0;
+    for(int i=0; i<20000; ++i)
+    {
+        ngl::Vec3 p(2.4f*uniform()-1.2f,2.4f*uniform()-1.2f,2.4f*uniform()-1.2f);
+        float s = fabsf(p.m_x)+fabsf(p.m_y)+fabsf(p.m_z);
+        float d = field(p.m_x,p.m_y,p.m_z);
+        if(fabsf(s-1.0f) > 1e-4f)
+        {
+            wrongSign += (d < 0.0f) != (s < 1.0f);
+        }
+        if(s < 1.0f)
+        {
+            error = std::max(error,fabsf(-d-(1.0f-s)/sqrtf(3.0f)));
+        }
+    }
+    expect(wrongSign == 0,"sdf field","a point has the wrong side of the octahedron");
+    expect(error < 1e-5f,"sdf field","an inside distance is not the distance to the nearest face");
+    printf("%-28s %6d points  wrong side %u  distance error %.3g\n","sdf field",20000,wrongSign,error);
+
+    MeshSamplerCore sampler;
+    expect(sampler.loadObj(objName),"sdf sampling","the octahedron could not be read");
+    unsigned int counts[4] = { 1, 7, 333, 10000 };
+    for(int c=0; c<4; ++c)
+    {
+        ngl::Random::instance()->setSeed(5);
+        sampler.SampleMesh_usingSDF(counts[c]);
+        std::vector<ngl::Vec3> points = sampler.getPoints();
+        unsigned int outside = 0;
+        for(unsigned int i=0; i<points.size(); ++i)
+        {
+            outside += fabsf(points[i].m_x)+fabsf(points[i].m_y)+fabsf(points[i].m_z) > 1.0f+1e-6f;
+        }
+        ngl::Random::instance()->setSeed(5);
+        sampler.SampleMesh_usingSDF(counts[c]);
+        bool repeated = points.size() == sampler.getPoints().size();
+        for(unsigned int i=0; i<points.size() && repeated; ++i)
+        {
+            repeated = samePosition(points[i],sampler.getPoints()[i]);
+        }
+        ngl::Random::instance()->setSeed(6);
+        sampler.SampleMesh_usingSDF(counts[c]);
+        bool reseeded = sampler.getPoints().size() == points.size() && !points.empty() &&
+                        !samePosition(sampler.getPoints()[0],points[0]);
+
+        expect(points.size() == counts[c],"sdf sampling","the count of points did not come out");
+        expect(outside == 0,"sdf sampling","a point is outside the mesh");
+        expect(repeated,"sdf sampling","the same seed gave other points");
+        expect(reseeded,"sdf sampling","another seed gave the same points");
+        printf("%-28s %6u points of %u  outside %u\n","sdf sampling",(unsigned int)points.size(),counts[c],outside);
+    }
+
+    sampler.setMethod(0);
+    sampler.setPointLocationType(0);
+    sampler.setDensity(37);
+    sampler.SampleMesh();
+    expect(sampler.getPoints().size() == 20u*37,"sdf sampling","the density did not give 20 points per step");
+    printf("%-28s %6u points for density %d\n","sdf sampling",(unsigned int)sampler.getPoints().size(),37);
+    remove(objName);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief an edge as its two end points in lexicographic order, so the same edge gives the same key either way round
+//----------------------------------------------------------------------------------------------------------------------
+struct EdgeKey
+{
+    float m_v[6];
+
+    bool operator<(const EdgeKey &_e) const
+    {
+        return std::lexicographical_compare(m_v,m_v+6,_e.m_v,_e.m_v+6);
+    }
+    bool operator==(const EdgeKey &_e) const
+    {
+        return std::equal(m_v,m_v+6,_e.m_v);
+    }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the sorted keys of the edges given as pairs of end points, a pair with equal ends is a free slot and is left
+/// out
+//----------------------------------------------------------------------------------------------------------------------
+static void edgeKeys(const std::vector<ngl::Vec3> &_ends, std::vector<EdgeKey> &o_keys)
+{
+    o_keys.clear();
+    for(unsigned int i=0; i+1<_ends.size(); i+=2)
+    {
+        const ngl::Vec3 &a = _ends[i];
+        const ngl::Vec3 &b = _ends[i+1];
+        if(samePosition(a,b))
+        {
+            continue;
+        }
+        float first[3] = { a.m_x, a.m_y, a.m_z };
+        float second[3] = { b.m_x, b.m_y, b.m_z };
+        bool swap = std::lexicographical_compare(second,second+3,first,first+3);
+        EdgeKey key;
+        std::copy(swap ? second : first,(swap ? second : first)+3,key.m_v);
+        std::copy(swap ? first : second,(swap ? first : second)+3,key.m_v+3);
+        o_keys.push_back(key);
+    }
+    std::sort(o_keys.begin(),o_keys.end());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief takes every snapshot of a progressive build and applies it to a DynamicVoronoi, as the GUI does
+//----------------------------------------------------------------------------------------------------------------------
+class SnapshotVoronoi : public DelaunayProgress
+{
+public:
+    bool report(int, int, int) { return true; }
+    bool isProgressive() { return true; }
+    void publish(TetDelta &_delta)
+    {
+        m_voronoi.apply(_delta);
+        _delta.clear();
+    }
+    DynamicVoronoi m_voronoi;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief builds the points progressively, with the weights if any, and tests that the edges kept up to date from the
+/// snapshots are exactly those Voronoi gives for the finished mesh
+//----------------------------------------------------------------------------------------------------------------------
+static void checkDynamicBuild(const char *_name, const std::vector<ngl::Vec3> &_points,
+                              const std::vector<ngl::Real> &_weights)
+{
+    MeshSamplerCore sampler;
+    sampler.setPoints(_points,_weights);
+    SnapshotVoronoi snapshots;
+    sampler.triangulate(&snapshots);
+    sampler.buildVoronoi();
+    std::vector<EdgeKey> live;
+    std::vector<EdgeKey> finished;
+    edgeKeys(snapshots.m_voronoi.getEdges(),live);
+    edgeKeys(sampler.getVoronoi()->getEdges(),finished);
+    unsigned int matching = 0;
+    for(unsigned int i=0, j=0; i<live.size() && j<finished.size();)
+    {
+        if(live[i] == finished[j])
+        {
+            ++matching;
+            ++i;
+            ++j;
+        }
+        else if(live[i] < finished[j])
+        {
+            ++i;
+        }
+        else
+        {
+            ++j;
+        }
+    }
+    expect(live.size() == finished.size() && matching == finished.size(),_name,
+           "the edges of the snapshots are not those of the finished mesh");
+    expect(snapshots.m_voronoi.tetCount() == sampler.getTetrahedra().size(),_name,
+           "the snapshots do not hold the tetrahedra of the finished mesh");
+    printf("%-28s %6u edges live %7u finished  matching %u\n",_name,(unsigned int)live.size(),
+           (unsigned int)finished.size(),matching);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the live voronoi edges of an unweighted and of a weighted build, where the vertices are power centres
+//----------------------------------------------------------------------------------------------------------------------
+static void checkDynamicVoronoi()
+{
+    srand(13);
+    std::vector<ngl::Vec3> points;
+    std::vector<ngl::Real> weights;
+    for(int i=0; i<5000; ++i)
+    {
+        points.push_back(ngl::Vec3(2.0f*uniform()-1.0f,2.0f*uniform()-1.0f,2.0f*uniform()-1.0f));
+        // radii up to a tenth, well above the spacing of the points so some of them are redundant
+        float radius = 0.1f*uniform();
+        weights.push_back(radius*radius);
+    }
+    checkDynamicBuild("dynamic voronoi",points,std::vector<ngl::Real>());
+    checkDynamicBuild("dynamic power diagram",points,weights);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the triangles of a prism of height _height over a polygon counter clockwise in the xy plane, its ends are fans
+/// from vertex _fan, which must see every other vertex
+//----------------------------------------------------------------------------------------------------------------------
+static std::vector<ngl::Vec3> prism(const float _xy[][2], int _count, int _fan, float _height)
+{
+    std::vector<ngl::Vec3> tris;
+    for(int i=1; i<_count-1; ++i)
+    {
+        int a = (_fan+i)%_count;
+        int b = (_fan+i+1)%_count;
+        ngl::Vec3 f(_xy[_fan][0],_xy[_fan][1],0.0f);
+        // the bottom seen from below and the top from above
+        tris.push_back(f);
+        tris.push_back(ngl::Vec3(_xy[b][0],_xy[b][1],0.0f));
+        tris.push_back(ngl::Vec3(_xy[a][0],_xy[a][1],0.0f));
+        tris.push_back(ngl::Vec3(f.m_x,f.m_y,_height));
+        tris.push_back(ngl::Vec3(_xy[a][0],_xy[a][1],_height));
+        tris.push_back(ngl::Vec3(_xy[b][0],_xy[b][1],_height));
+    }
+    for(int i=0; i<_count; ++i)
+    {
+        int j = (i+1)%_count;
+        ngl::Vec3 a0(_xy[i][0],_xy[i][1],0.0f);
+        ngl::Vec3 b0(_xy[j][0],_xy[j][1],0.0f);
+        ngl::Vec3 a1(_xy[i][0],_xy[i][1],_height);
+        ngl::Vec3 b1(_xy[j][0],_xy[j][1],_height);
+        tris.push_back(a0);
+        tris.push_back(b0);
+        tris.push_back(b1);
+        tris.push_back(a0);
+        tris.push_back(b1);
+        tris.push_back(a1);
+    }
+    return tris;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the volume and centroid of a clipped cell in double precision, from tetrahedra between its first vertex and
+/// the fan of every face
+//----------------------------------------------------------------------------------------------------------------------
+static double cellVolume(const ClippedCell &_cell, double o_centroid[3])
+{
+    double volume = 0.0;
+    o_centroid[0] = o_centroid[1] = o_centroid[2] = 0.0;
+    if(_cell.m_verts.empty())
+    {
+        return 0.0;
+    }
+    const ngl::Vec3 &o = _cell.m_verts[0];
+    for(unsigned int f=0; f<_cell.m_faces.size(); ++f)
+    {
+        const std::vector<unsigned int> &v = _cell.m_faces[f].m_vert;
+        for(unsigned int i=2; i<v.size(); ++i)
+        {
+            double e[3][3];
+            const ngl::Vec3 *corners[3] = { &_cell.m_verts[v[0]], &_cell.m_verts[v[i-1]], &_cell.m_verts[v[i]] };
+            for(int c=0; c<3; ++c)
+            {
+                e[c][0] = (double)corners[c]->m_x-o.m_x;
+                e[c][1] = (double)corners[c]->m_y-o.m_y;
+                e[c][2] = (double)corners[c]->m_z-o.m_z;
+            }
+            double six = e[0][0]*(e[1][1]*e[2][2]-e[1][2]*e[2][1])-e[0][1]*(e[1][0]*e[2][2]-e[1][2]*e[2][0])+
+                         e[0][2]*(e[1][0]*e[2][1]-e[1][1]*e[2][0]);
+            volume += six/6.0;
+            for(int k=0; k<3; ++k)
+            {
+                o_centroid[k] += six/6.0*(e[0][k]+e[1][k]+e[2][k])/4.0;
+            }
+        }
+    }
+    double origin[3] = { o.m_x, o.m_y, o.m_z };
+    for(int k=0; k<3; ++k)
+    {
+        o_centroid[k] = volume != 0.0 ? origin[k]+o_centroid[k]/volume : origin[k];
+    }
+    return volume;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief clips the cells of _count points inside a prism to it and returns the share of the prism volume _volume
+/// that the cells miss. With _properties the cells with no face on the mesh or the box, whose clipped polyhedron is
+/// the whole voronoi cell, must have the volume and centroid CellProperties finds
+//----------------------------------------------------------------------------------------------------------------------
+static double clippedShortfall(const char *_name, const std::vector<ngl::Vec3> &_tris, const std::vector<ngl::Vec3> &_points,
+                               double _volume, bool _properties)
+{
+    MeshSamplerCore sampler;
+    sampler.setTriangles(_tris);
+    sampler.setPoints(_points);
+    sampler.delaunay();
+    sampler.clipVoronoiCells();
+    const std::vector<ClippedCell> &cells = sampler.getClippedCells();
+    expect(cells.size() == _points.size(),_name,"there is not one clipped cell per point");
+    double total = 0.0;
+    std::vector<double> volumes(cells.size());
+    std::vector<ngl::Vec3> centroids(cells.size());
+    for(unsigned int i=0; i<cells.size(); ++i)
+    {
+        double c[3];
+        volumes[i] = cellVolume(cells[i],c);
+        centroids[i] = ngl::Vec3(c[0],c[1],c[2]);
+        total += volumes[i];
+    }
+    double shortfall = (_volume-total)/_volume;
+    printf("%-28s %6u points  volume %.6f of %.6f  shortfall %.2f%%\n",_name,(unsigned int)_points.size(),total,_volume,
+           100.0*shortfall);
+    if(!_properties)
+    {
+        return shortfall;
+    }
+
+    sampler.computeCellProperties();
+    const CellProperties &properties = sampler.getCellProperties();
+    unsigned int interior = 0;
+    double volumeError = 0.0;
+    double centroidError = 0.0;
+    for(unsigned int i=0; i<cells.size() && i<properties.siteCount(); ++i)
+    {
+        bool inner = properties.getBounded()[i] != 0;
+        for(unsigned int f=0; f<cells[i].m_faces.size() && inner; ++f)
+        {
+            inner = cells[i].m_faces[f].m_site != ClippedCell::s_boundary;
+        }
+        if(!inner)
+        {
+            continue;
+        }
+        ++interior;
+        double size = pow(volumes[i],1.0/3.0);
+        volumeError = std::max(volumeError,fabs(properties.getVolumes()[i]-volumes[i])/volumes[i]);
+        ngl::Vec3 d = properties.getCentroids()[i]-centroids[i];
+        centroidError = std::max(centroidError,sqrt((double)d.m_x*d.m_x+(double)d.m_y*d.m_y+(double)d.m_z*d.m_z)/size);
+    }
+    expect(interior > _points.size()/4,_name,"too few cells are inside the mesh");
+    expect(volumeError < 1e-4,_name,"an interior cell has another volume than its clipped polyhedron");
+    expect(centroidError < 1e-4,_name,"an interior cell has another centroid than its clipped polyhedron");
+    printf("%-28s %6u interior cells  volume error %.3g  centroid error %.3g\n","cell properties",interior,volumeError,
+           centroidError);
+    return shortfall;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the clipped cells of a cube fill it, those of an L shaped prism miss part of the concave corner as the
+/// planes of both sides cut the cells there, less so as the cells get smaller
+//----------------------------------------------------------------------------------------------------------------------
+static void checkClippedCells()
+{
+    const float square[4][2] = { {0.0f,0.0f}, {1.0f,0.0f}, {1.0f,1.0f}, {0.0f,1.0f} };
+    srand(21);
+    std::vector<ngl::Vec3> points;
+    for(int i=0; i<1000; ++i)
+    {
+        points.push_back(ngl::Vec3(uniform(),uniform(),uniform()));
+    }
+    double shortfall = clippedShortfall("clipped cube",prism(square,4,0,1.0f),points,1.0,true);
+    expect(fabs(shortfall) < 1e-5,"clipped cube","the cells do not fill the cube");
+
+    // the fan is from the reflex corner, which sees the others
+    const float ell[6][2] = { {0.0f,0.0f}, {2.0f,0.0f}, {2.0f,1.0f}, {1.0f,1.0f}, {1.0f,2.0f}, {0.0f,2.0f} };
+    const int counts[2] = { 200, 3000 };
+    const double bounds[2] = { 0.012, 0.003 };
+    for(int c=0; c<2; ++c)
+    {
+        srand(22);
+        points.clear();
+        while((int)points.size() < counts[c])
+        {
+            ngl::Vec3 p(2.0f*uniform(),2.0f*uniform(),uniform());
+            if(p.m_x < 1.0f || p.m_y < 1.0f)
+            {
+                points.push_back(p);
+            }
+        }
+        shortfall = clippedShortfall("clipped L prism",prism(ell,6,3,1.0f),points,3.0,false);
+        expect(shortfall > -1e-5,"clipped L prism","the cells hold more than the prism");
+        expect(shortfall < bounds[c],"clipped L prism","the cells miss more of the concave corner than expected");
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the tetrahedralization of points fills their convex hull, a ball, so its vertices, edges, faces and
+/// tetrahedra from the graphs must have V-E+F-T = 1. The faces are the shared ones once and the hull ones
+//----------------------------------------------------------------------------------------------------------------------
+static void checkEulerCharacteristic(const char *_name, const std::vector<ngl::Vec3> &_points,
+                                     const std::vector<ngl::Real> &_weights)
+{
+    MeshSamplerCore sampler;
+    sampler.setPoints(_points,_weights);
+    sampler.delaunay();
+    sampler.buildGraphs();
+    const TetGraphs &graphs = sampler.getGraphs();
+    long vertices = 0;
+    for(unsigned int i=0; i<graphs.getVertexTet().nodeCount(); ++i)
+    {
+        vertices += graphs.getVertexTet().end(i) > graphs.getVertexTet().begin(i);
+    }
+    long edges = graphs.getVertexVertex().m_indices.size()/2;
+    long tets = graphs.getTetTet().nodeCount();
+    long faces = 4*tets-(long)graphs.getTetTet().m_indices.size()/2;
+    long euler = vertices-edges+faces-tets;
+    expect(tets == (long)sampler.getTetrahedra().size(),_name,"the graphs do not hold every tetrahedron");
+    expect(euler == 1,_name,"V-E+F-T is not 1");
+    printf("%-28s V %ld  E %ld  F %ld  T %ld  V-E+F-T %ld\n",_name,vertices,edges,faces,tets,euler);
+}
+
+static void checkGraphs()
+{
+    srand(23);
+    std::vector<ngl::Vec3> points;
+    std::vector<ngl::Real> weights;
+    for(int i=0; i<3000; ++i)
+    {
+        points.push_back(ngl::Vec3(2.0f*uniform()-1.0f,2.0f*uniform()-1.0f,2.0f*uniform()-1.0f));
+        float radius = 0.1f*uniform();
+        weights.push_back(radius*radius);
+    }
+    checkEulerCharacteristic("euler characteristic",points,std::vector<ngl::Real>());
+    checkEulerCharacteristic("euler power diagram",points,weights);
+}
+
+int main()
+{
+    checkSnapping();
+    checkTriangleHierarchy();
+    checkSDFSampling();
+    checkDynamicVoronoi();
+    checkClippedCells();
+    checkGraphs();
+    if(s_failures != 0)
+    {
+        fprintf(stderr,"%d checks failed\n",s_failures);
+        return EXIT_FAILURE;
+    }
+    printf("all checks passed\n");
+    return EXIT_SUCCESS;
+}
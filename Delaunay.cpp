@@ -4,9 +4,14 @@
 //----------------------------------------------------------------------------------------------------------------------
 
 #include "Delaunay.h"
-#include "ngl/Mat3.h"
-#include "ngl/Mat4.h"
 #include "Point4.h"
+#include "Trace.h"
+#include "AllocStats.h"
+#include <algorithm>
+
+// walk, flip14 and checkDelaunay run once per point, the timeline records one call in s_traceEvery of each and the
+// number of tetrahedra as often, the whole insertion is the Delaunay::compute zone
+static const unsigned int s_traceEvery = 1024;
 
 Delaunay::Delaunay(Tetrahedron* _tetrahedron)
 {
@@ -14,18 +19,33 @@ Delaunay::Delaunay(Tetrahedron* _tetrahedron)
     m_tetrahedron = _tetrahedron;
     m_tetrahedron->m_tetid = ++m_tetCount;
     m_tetrahedra.push_back(m_tetrahedron);
-    m_third = new Tetrahedron();
     m_third = NULL;
     m_predicates = new Predicates();
     m_a = -1;
     m_b = -1;
+    m_snapToGrid = false;
+    m_progress = NULL;
+    m_cancelled = false;
+    m_deadCount = 0;
+    m_reportStep = 0;
+    m_recordDelta = false;
+    m_weighted = false;
+    m_redundantCount = 0;
 
 }
 
 Delaunay::~Delaunay()
 {
     delete m_predicates;
-    delete m_tetrahedron;
+    // every tetrahedron created is in one of the two lists, the first one given to the constructor included
+    for(unsigned int i=0; i<m_tetrahedra.size(); ++i)
+    {
+        delete m_tetrahedra[i];
+    }
+    for(unsigned int i=0; i<m_removed.size(); ++i)
+    {
+        delete m_removed[i];
+    }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -33,21 +53,94 @@ Delaunay::~Delaunay()
 //----------------------------------------------------------------------------------------------------------------------
 std::vector<Tetrahedron*> Delaunay::compute(std::vector<ngl::Vec3> _points)
 {
+    return build(_points,NULL);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// This function computes the regular tetrahedralization of weighted points the same way
+//----------------------------------------------------------------------------------------------------------------------
+std::vector<Tetrahedron*> Delaunay::compute(std::vector<ngl::Vec3> _points, const std::vector<ngl::Real> &_weights)
+{
+    if(_weights.size() != _points.size())
+    {
+        std::cerr<<"Delaunay : "<<_weights.size()<<" weights for "<<_points.size()<<" points, ignoring them"<<std::endl;
+        return build(_points,NULL);
+    }
+    return build(_points,&_weights);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// This function inserts the points one at a time and cleans up
+//----------------------------------------------------------------------------------------------------------------------
+std::vector<Tetrahedron*> Delaunay::build(std::vector<ngl::Vec3> &_points, const std::vector<ngl::Real> *_weights)
+{
+    TRACE_ZONE("Delaunay::compute");
+    ALLOC_PHASE(INSERTION);
 
     ngl::Real tolerance = 0.000001;
     int flag = 0;
     Tetrahedron *oldT = m_tetrahedron;
+    int total = _points.size();
+    m_cancelled = false;
+    m_reportStep = 0;
+    m_recordDelta = m_progress != NULL && m_progress->isProgressive();
+    m_delta.clear();
+    // the vertices of the big tetrahedron keep their zero weight
+    m_weighted = _weights != NULL;
+    m_redundantCount = 0;
+    // the counts describe this build only
+    m_predicates->resetStats();
+    for(int i=0; i<4; ++i)
+    {
+        m_bigVerts[i] = oldT->getVertexData()[i];
+    }
+
+    // on the snap grid the predicates are exact and two points are the same only if they are equal
+    m_predicates->clearSnapGrid();
+    bool snapped = m_snapToGrid && snapPoints(_points);
+
+    // the bounding box of the input points gives error bounds that hold for the whole run,
+    // only the calls that reach the big tetrahedron need the per-call filter
+    if(!_points.empty())
+    {
+        ngl::Vec3 minBound = _points[0];
+        ngl::Vec3 maxBound = _points[0];
+        for(unsigned int i=1; i<_points.size(); ++i)
+        {
+            ngl::Vec3 p = _points[i];
+            minBound.m_x = std::min(minBound.m_x,p.m_x);
+            minBound.m_y = std::min(minBound.m_y,p.m_y);
+            minBound.m_z = std::min(minBound.m_z,p.m_z);
+            maxBound.m_x = std::max(maxBound.m_x,p.m_x);
+            maxBound.m_y = std::max(maxBound.m_y,p.m_y);
+            maxBound.m_z = std::max(maxBound.m_z,p.m_z);
+        }
+        m_predicates->setBounds(minBound,maxBound);
+    }
 
     for(unsigned int i=0; i<_points.size(); ++i)
     {
+        if(cancelled(i,total))
+        {
+            return std::vector<Tetrahedron*>();
+        }
+        TRACE_COUNTER_SAMPLED("Delaunay::tetrahedra",m_tetrahedra.size()-m_deadCount,s_traceEvery);
         ngl::Vec3 point = _points[i];
         m_tetrahedron = walk(point,m_tetrahedron);
 
         // Degenerate case :Test if the point is exactly on the vertex
         for(int i=0; i<4; ++i)
         {
-            double dist = distance(m_tetrahedron->getVertexData()[i],point);
-            if(dist <= tolerance)
+            ngl::Vec3 v = m_tetrahedron->getVertexData()[i];
+            if(snapped)
+            {
+                if(v.m_x == point.m_x && v.m_y == point.m_y && v.m_z == point.m_z)
+                {
+                    flag = 1;
+                    break;
+                }
+            }
+            else if(distance(v,point) <= tolerance)
             {
                 flag = 1;
                 break;
@@ -58,10 +151,16 @@ std::vector<Tetrahedron*> Delaunay::compute(std::vector<ngl::Vec3> _points)
             flag = 0;
             continue;
         }
-        m_tetrahedron = flip14(m_tetrahedron,point);
-        Tetrahedron *tmp = new Tetrahedron();
-        tmp = NULL;
-        tmp = checkDelaunay();
+        ngl::Real weight = m_weighted ? (*_weights)[i] : 0.0;
+        // a weighted point that is not in conflict with the tetrahedron around it is under the lower hull of the
+        // lifted points, its power cell is empty and it never becomes a vertex
+        if(m_weighted && m_predicates->power3d(m_tetrahedron,point,weight) < 0)
+        {
+            ++m_redundantCount;
+            continue;
+        }
+        m_tetrahedron = flip14(m_tetrahedron,point,weight);
+        Tetrahedron *tmp = checkDelaunay();
         if(tmp!=NULL)
         {
             m_tetrahedron = tmp;
@@ -69,48 +168,162 @@ std::vector<Tetrahedron*> Delaunay::compute(std::vector<ngl::Vec3> _points)
         }
     }
 
-    // delete all tetrahedra that are modified
-    for(unsigned int i=0; i<m_tetrahedra.size();++i)
+    // the changes since the last report are published too, so a consumer that takes every snapshot ends with the whole
+    // live set
+    if(m_recordDelta && !m_delta.empty())
+    {
+        m_progress->publish(m_delta);
+    }
+
+    // the clean up runs to the end of compute, so the zones need no scope of their own
+    TRACE_ZONE("Delaunay::finalize");
+    ALLOC_PHASE(FINALIZE);
+    // the live set does not change from here on, the finished mesh replaces the snapshots
+    m_recordDelta = false;
+    m_delta.clear();
+
+    // delete all tetrahedra that are modified and those that contain the vertices of the big tetrahedron. The kept
+    // ones are moved down in place, so the clean up is one pass over the list and keeps its order
+    unsigned int kept = 0;
+    for(unsigned int i=0; i<m_tetrahedra.size(); ++i)
     {
+        if(cancelled(total,total))
+        {
+            // the moved down entries are copies, the list must hold every tetrahedron once to be freed
+            m_tetrahedra.erase(m_tetrahedra.begin()+kept,m_tetrahedra.begin()+i);
+            return std::vector<Tetrahedron*>();
+        }
         if(m_tetrahedra[i]->m_modified == true)
         {
-            m_tetrahedra.erase(m_tetrahedra.begin()+i);
-            i--;
+            m_removed.push_back(m_tetrahedra[i]);
+            continue;
+        }
+        bool big = false;
+        for(int j=0; j<4 && !big; ++j)
+        {
+            for(int k=0; k<4 && !big; ++k)
+            {
+                big = m_tetrahedra[i]->getVertexData()[j] == oldT->getVertexData()[k];
+            }
+        }
+        if(big)
+        {
+            m_removed.push_back(m_tetrahedra[i]);
         }
         else
         {
-            m_tetrahedra[i]->createVAO();
+            m_tetrahedra[kept++] = m_tetrahedra[i];
         }
     }
+    m_tetrahedra.resize(kept);
+    m_deadCount = 0;
+    // the vertices are the inserted points, which differ from the ones given in the snapped mode
+    m_points.swap(_points);
 
-    // for deleting tetrahedra that contains the vertices of the big tetrahedron
-    for(unsigned int i=0; i<m_tetrahedra.size(); ++i)
+    return m_tetrahedra;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// This function reports the progress and checks for a cancellation
+//----------------------------------------------------------------------------------------------------------------------
+bool Delaunay::cancelled(int _inserted, int _total)
+{
+    // reporting every step would cost more than the insertion itself
+    if(m_progress != NULL && !m_cancelled && (m_reportStep++)%256 == 0)
+    {
+        m_cancelled = !m_progress->report(_inserted,_total,m_tetrahedra.size()-m_deadCount);
+        if(m_recordDelta && !m_cancelled && !m_delta.empty())
+        {
+            m_progress->publish(m_delta);
+        }
+    }
+    return m_cancelled;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// This function records a new tetrahedron for the next snapshot
+//----------------------------------------------------------------------------------------------------------------------
+void Delaunay::recordCreated(const Tetrahedron *_t)
+{
+    const ngl::Vec3 *verts = _t->getVertexData();
+    const ngl::Real *weights = _t->getWeightData();
+    for(int i=0; i<4; ++i)
     {
-        int flag = 0;
         for(int j=0; j<4; ++j)
         {
-            for(int k=0; k<4; ++k)
+            if(verts[i] == m_bigVerts[j])
             {
-                if(m_tetrahedra[i]->getVertexData()[j] == oldT->getVertexData()[k])
-                {
-                    m_tetrahedra.erase(m_tetrahedra.begin()+i);
-                    i--;
-                    flag = 1;
-                }
-                if(flag == 1)
-                {
-                    break;
-                }
-            }
-            if(flag == 1)
-            {
-                break;
+                return;
             }
         }
+    }
+    TetRecord r;
+    r.m_tetid = _t->m_tetid;
+    for(int i=0; i<4; ++i)
+    {
+        r.m_verts[i] = verts[i];
+        r.m_weights[i] = weights[i];
+    }
+    m_delta.m_created.push_back(r);
+}
 
+//----------------------------------------------------------------------------------------------------------------------
+// This function chooses the snap grid and rounds the points to it
+//----------------------------------------------------------------------------------------------------------------------
+bool Delaunay::snapPoints(std::vector<ngl::Vec3> &_points)
+{
+    if(_points.empty())
+    {
+        return false;
+    }
+    // the grid spans the bounding box of the points, so all of its nodes go to the model
+    ngl::Vec3 minBound = _points[0];
+    ngl::Vec3 maxBound = _points[0];
+    float maxCoordinate = 0.0;
+    for(unsigned int i=0; i<_points.size(); ++i)
+    {
+        ngl::Vec3 p = _points[i];
+        minBound.m_x = std::min(minBound.m_x,p.m_x);
+        minBound.m_y = std::min(minBound.m_y,p.m_y);
+        minBound.m_z = std::min(minBound.m_z,p.m_z);
+        maxBound.m_x = std::max(maxBound.m_x,p.m_x);
+        maxBound.m_y = std::max(maxBound.m_y,p.m_y);
+        maxBound.m_z = std::max(maxBound.m_z,p.m_z);
+        maxCoordinate = std::max(maxCoordinate,std::abs(p.m_x));
+        maxCoordinate = std::max(maxCoordinate,std::abs(p.m_y));
+        maxCoordinate = std::max(maxCoordinate,std::abs(p.m_z));
+    }
+    float halfExtent = 0.5f*std::max(maxBound.m_x-minBound.m_x,
+                                     std::max(maxBound.m_y-minBound.m_y,maxBound.m_z-minBound.m_z));
+    // a node must still be a float, which a box far from zero allows only for a coarser spacing
+    float spacing = std::max(Predicates::snapSpacing(halfExtent),0.5f*Predicates::snapSpacing(maxCoordinate));
+    // the origin is a node itself, so it may be half a node off the centre of the box
+    if(halfExtent+spacing > ldexpf(spacing,Predicates::s_snapBits-1))
+    {
+        spacing *= 2.0f;
+    }
+    ngl::Vec3 centre = (minBound+maxBound)*0.5;
+    ngl::Vec3 origin(rintf(centre.m_x/spacing)*spacing,rintf(centre.m_y/spacing)*spacing,
+                     rintf(centre.m_z/spacing)*spacing);
+    m_predicates->setSnapGrid(origin,spacing);
+
+    // the calls on the big tetrahedron take the floating point stages, which needs it to be off the grid
+    const ngl::Vec3 *bigVerts = m_tetrahedron->getVertexData();
+    for(unsigned int i=0; i<4; ++i)
+    {
+        if(m_predicates->onGrid(bigVerts[i]))
+        {
+            std::cerr<<"Big tetrahedron reaches into the snap grid, using floating point predicates"<<std::endl;
+            m_predicates->clearSnapGrid();
+            return false;
+        }
     }
 
-    return m_tetrahedra;
+    for(unsigned int i=0; i<_points.size(); ++i)
+    {
+        _points[i] = m_predicates->snap(_points[i]);
+    }
+    return true;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -126,18 +339,166 @@ double Delaunay::distance(ngl::Vec3 _a, ngl::Vec3 _b)
     return distance;
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+// Flip tables
+//
+// Every flip is written in terms of vertex labels. Labels 0-3 are the vertices of the first old tetrahedron, starting
+// at the point p that sees the flipped face (for flip14 they are the old vertices in order), and label 4 is the one
+// vertex outside it, the apex d across the face or, for flip14, the inserted point. A table lists the labels of the
+// old and the new tetrahedra. The neighbour wiring of the new tetrahedra follows from the labels alone, so it is
+// derived once by buildFlipTable and a flip at run time is a fixed sequence of index moves and neighbour assignments,
+// with no searching for vertices or back pointers. This is the one place to check when a flip is suspected.
+//----------------------------------------------------------------------------------------------------------------------
+struct FlipTable
+{
+    int m_numOld;
+    int m_oldLabels[4][4];
+    int m_numNew;
+    int m_newLabels[4][4];
+    // position of the point p in every new tetrahedron, where the flip stack picks up
+    int m_pointSlot;
+    // the new tetrahedron returned as the next walk start
+    int m_result;
+    // derived wiring, for each new tetrahedron and face : the new neighbour and the face map to it, or -1 when the face
+    // lies on the boundary and then the old tetrahedron holding the face and its label opposite the face
+    int m_newNeighbour[4][4];
+    unsigned char m_newMap[4][4];
+    int m_oldTet[4][4];
+    int m_oldOpposite[4][4];
+};
+
+// flip14 : the point 4 splits the tetrahedron 0123 into four
+static const int s_old14[1][4] = { {0,1,2,3} };
+static const int s_new14[4][4] = { {0,1,2,4}, {0,1,3,4}, {0,2,3,4}, {1,2,3,4} };
+// flip23 : p=0 abc=123 d=4, the face abc shared by pabc and abcd is replaced by the edge pd
+static const int s_old23[2][4] = { {0,1,2,3}, {1,2,3,4} };
+static const int s_new23[3][4] = { {0,1,2,4}, {0,1,3,4}, {0,2,3,4} };
+// flip32 : p=0 a=1 b=2 c=3 d=4, the edge ab shared by pabc, abcd and pabd is replaced by the face pcd
+static const int s_old32[3][4] = { {0,1,2,3}, {1,2,3,4}, {0,1,2,4} };
+static const int s_new32[2][4] = { {0,1,3,4}, {0,2,3,4} };
+// flip41 : p=0 a=1 b=2 c=3 d=4, the vertex a inside pbcd is removed with its four tetrahedra pabc, abcd, pabd, pacd
+static const int s_old41[4][4] = { {0,1,2,3}, {1,2,3,4}, {0,1,2,4}, {0,1,3,4} };
+static const int s_new41[1][4] = { {0,2,3,4} };
+
+static bool hasLabel(const int _labels[4], int _label)
+{
+    return _labels[0]==_label || _labels[1]==_label || _labels[2]==_label || _labels[3]==_label;
+}
+
+static int slotOf(const int _labels[4], int _label)
+{
+    for(int i=0; i<4; ++i)
+    {
+        if(_labels[i] == _label)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static FlipTable buildFlipTable(int _numOld, const int _old[][4], int _numNew, const int _new[][4], int _pointSlot, int _result)
+{
+    FlipTable table;
+    table.m_numOld = _numOld;
+    table.m_numNew = _numNew;
+    table.m_pointSlot = _pointSlot;
+    table.m_result = _result;
+    for(int i=0; i<4; ++i)
+    {
+        for(int j=0; j<4; ++j)
+        {
+            table.m_oldLabels[i][j] = i < _numOld ? _old[i][j] : -1;
+            table.m_newLabels[i][j] = i < _numNew ? _new[i][j] : -1;
+        }
+    }
+
+    for(int k=0; k<table.m_numNew; ++k)
+    {
+        const int *labels = table.m_newLabels[k];
+        for(int f=0; f<4; ++f)
+        {
+            table.m_newNeighbour[k][f] = -1;
+            table.m_newMap[k][f] = 0;
+            table.m_oldTet[k][f] = -1;
+            table.m_oldOpposite[k][f] = -1;
+
+            // the face opposite slot f is shared with whichever tetrahedron holds its three labels
+            for(int n=0; n<table.m_numNew && table.m_newNeighbour[k][f]<0; ++n)
+            {
+                const int *other = table.m_newLabels[n];
+                if(n == k || !hasLabel(other,labels[(f+1)%4]) || !hasLabel(other,labels[(f+2)%4]) || !hasLabel(other,labels[(f+3)%4]))
+                {
+                    continue;
+                }
+                table.m_newNeighbour[k][f] = n;
+                for(int s=0; s<4; ++s)
+                {
+                    int m = slotOf(other,labels[s]);
+                    if(s == f)
+                    {
+                        m = 6 - slotOf(other,labels[(f+1)%4]) - slotOf(other,labels[(f+2)%4]) - slotOf(other,labels[(f+3)%4]);
+                    }
+                    table.m_newMap[k][f] |= m<<(2*s);
+                }
+            }
+            for(int o=0; o<table.m_numOld && table.m_newNeighbour[k][f]<0 && table.m_oldTet[k][f]<0; ++o)
+            {
+                const int *old = table.m_oldLabels[o];
+                if(!hasLabel(old,labels[(f+1)%4]) || !hasLabel(old,labels[(f+2)%4]) || !hasLabel(old,labels[(f+3)%4]))
+                {
+                    continue;
+                }
+                table.m_oldTet[k][f] = o;
+                for(int s=0; s<4; ++s)
+                {
+                    if(old[s]!=labels[(f+1)%4] && old[s]!=labels[(f+2)%4] && old[s]!=labels[(f+3)%4])
+                    {
+                        table.m_oldOpposite[k][f] = old[s];
+                    }
+                }
+            }
+            if(table.m_newNeighbour[k][f]<0 && table.m_oldTet[k][f]<0)
+            {
+                std::cerr<<"Flip table : face without a neighbour!"<<std::endl;
+            }
+        }
+    }
+    return table;
+}
+
+// the wiring is derived during static initialisation, before any Delaunay can run
+static const FlipTable s_flip14 = buildFlipTable(1,s_old14,4,s_new14,3,3);
+static const FlipTable s_flip23 = buildFlipTable(2,s_old23,3,s_new23,0,0);
+static const FlipTable s_flip32 = buildFlipTable(3,s_old32,2,s_new32,0,0);
+static const FlipTable s_flip41 = buildFlipTable(4,s_old41,1,s_new41,0,0);
+
+//----------------------------------------------------------------------------------------------------------------------
+// This function maps the label positions of _t into the neighbour across _face, the label opposite the face is
+// dropped and _apex takes the neighbour's opposite vertex
+//----------------------------------------------------------------------------------------------------------------------
+static void positionsAcross(const Tetrahedron *_t, int _face, const int _pos[5], int _apex, int _across[5])
+{
+    for(int l=0; l<5; ++l)
+    {
+        _across[l] = (_pos[l] < 0 || _pos[l] == _face) ? -1 : _t->acrossFace(_face,_pos[l]);
+    }
+    _across[_apex] = _t->acrossFace(_face,_face);
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 // This function checks for delaunay criterion and performs the flips accordingly
 //----------------------------------------------------------------------------------------------------------------------
 Tetrahedron* Delaunay::checkDelaunay()
 {
+    TRACE_ZONE_SAMPLED("Delaunay::checkDelaunay",s_traceEvery);
+    ALLOC_PHASE(FLIPS);
     int flipcase = -1;
-    ngl::Vec3 p,d;
+    ngl::Vec3 d;
     Tetrahedron *t,*ta;
-    Tetrahedron *next = new Tetrahedron();
-    next = NULL;
+    Tetrahedron *next = NULL;
     flipData f;
-    int pid, did;
+    int pid;
 
     while(!m_flipStack.empty())
     {
@@ -150,7 +511,6 @@ Tetrahedron* Delaunay::checkDelaunay()
             // Set the tetrahedron and the point
             t = f.m_t;
             pid = f.m_ptPos;
-            p = t->getVertexData()[pid];
 
             // Get the adjacent tetrahedron
             ta = t->m_neighbours[pid];
@@ -158,476 +518,229 @@ Tetrahedron* Delaunay::checkDelaunay()
             // ta may be NULL for the first tetrahedron :
             if(ta != NULL)
             {
-                // Get the apex of ta
-                did = getApex(t,ta);
-                d = ta->getVertexData()[did];
-
-                // Check circumsphere check(inSphere) for d
-                if(m_predicates->insphere3d(t,d) > 0)
+                // the apex of ta is the vertex opposite the shared face
+                int apex = t->acrossFace(pid,pid);
+                d = ta->getVertexData()[apex];
+
+                // Check circumsphere check(inSphere) for d, or the power test for a weighted d, with the
+                // perturbation it is never zero and d is either inside or outside
+                float conflict = m_weighted ? m_predicates->power3d(t,d,ta->getWeightData()[apex])
+                                            : m_predicates->insphere3d(t,d);
+                if(conflict > 0)
                 {
-                    bool r = isCoplanar(t);
-                    // Either apex(d) is non-existing,convex or concave or coplanar from p
-                    flipcase = checkcase(t,ta,p,d);
-                    if(flipcase == 3 && r == true)
-                    {
-                       //flipcase = 4;
-                    }
+                    // Either apex(d) is non-existing, convex or concave from p
+                    flipcase = checkcase(t,pid,d);
                     switch(flipcase)
                     {
                         case 1 : // Both t and ta are convex
-                                 next = flip23(t,pid,did);
+                                 next = flip23(t,pid);
                                  break;
                         case 2 : if(m_third != NULL)
                                  {
-                                    next = flip32(t,ta,m_third,pid,did);
+                                    next = flip32(t,m_third,pid);
                                     m_third = NULL;
                                  }
                                  break;
-                         case 3 : Tetrahedron* t3, *t4;
-                                  if(config44(t,ta,p,m_cid,t3,t4) == true)
-                                  {
-                                    // The tetrahedra are in config44
-                                    // next = flip44(t,ta,p,d,m_cid); - optional flip
-                                  }
-                                  break;
-                         case 4 : next = flip23(t,pid,did);
-                                  break;
+                        case 3 : next = flip41(t,pid,m_a);
+                                 break;
                         default : std::cerr<<"Invalid flipcase!!!"<<std::endl;
                     }
                 }
-                else if(m_predicates->insphere3d(t,d)==0)
-                {
-                    // The point is on sphere.
-                    // No special cases need to be done
-                }
-            else
-            {
-               // The point is outside sphere
             }
-           }
         }
-      }
+    }
     return next;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-// This function performs Flip14
+// This function replaces the old tetrahedra of a flip by the new ones described in the table
 //----------------------------------------------------------------------------------------------------------------------
-Tetrahedron* Delaunay::flip14(Tetrahedron* _tetra, ngl::Vec3 _point)
+Tetrahedron* Delaunay::applyFlip(const FlipTable &_table, Tetrahedron *_old[4], int _pos[4][5], const ngl::Vec3 _verts[5],
+                                 const ngl::Real _weights[5])
 {
-    std::vector<ngl::Vec3> verts = _tetra -> getVertexData();
-    std::vector<ngl::Vec3> newverts1;
-    newverts1.push_back(verts[0]);
-    newverts1.push_back(verts[1]);
-    newverts1.push_back(verts[2]);
-    newverts1.push_back(_point);
-    Tetrahedron *t1 = new Tetrahedron(newverts1);
-    t1->m_tetid = ++m_tetCount;
-
-    std::vector<ngl::Vec3> newverts2;
-    newverts2.push_back(verts[0]);
-    newverts2.push_back(verts[1]);
-    newverts2.push_back(verts[3]);
-    newverts2.push_back(_point);
-    Tetrahedron *t2 = new Tetrahedron(newverts2);
-    t2->m_tetid = ++m_tetCount;
-
-    std::vector<ngl::Vec3> newverts3;
-    newverts3.push_back(verts[0]);
-    newverts3.push_back(verts[2]);
-    newverts3.push_back(verts[3]);
-    newverts3.push_back(_point);
-    Tetrahedron *t3 = new Tetrahedron(newverts3);
-    t3->m_tetid = ++m_tetCount;
-
-    std::vector<ngl::Vec3> newverts4;
-    newverts4.push_back(verts[1]);
-    newverts4.push_back(verts[2]);
-    newverts4.push_back(verts[3]);
-    newverts4.push_back(_point);
-    Tetrahedron *t4 = new Tetrahedron(newverts4);
-    t4->m_tetid = ++m_tetCount;
-
-    // setting up neighbours for t1
-    t1->m_neighbours[0] = t4;
-    t1->m_neighbours[1] = t3;
-    t1->m_neighbours[2] = t2;
-    t1->m_neighbours[3] = _tetra->m_neighbours[3];
-
-    // setting up neighbours for t2
-    t2->m_neighbours[0] = t4;
-    t2->m_neighbours[1] = t3;
-    t2->m_neighbours[2] = t1;
-    t2->m_neighbours[3] = _tetra->m_neighbours[2];
-
-    // setting up neighbours for t3
-    t3->m_neighbours[0] = t4;
-    t3->m_neighbours[1] = t2;
-    t3->m_neighbours[2] = t1;
-    t3->m_neighbours[3] = _tetra->m_neighbours[1];
-
-    // setting up neighbours for t4
-    t4->m_neighbours[0] = t3;
-    t4->m_neighbours[1] = t2;
-    t4->m_neighbours[2] = t1;
-    t4->m_neighbours[3] = _tetra->m_neighbours[0];
-
-    // updating nighbours of the new tetrahedra
-    updateNeighbour(_tetra->m_neighbours[0],t4,_tetra);
-    updateNeighbour(_tetra->m_neighbours[1],t3,_tetra);
-    updateNeighbour(_tetra->m_neighbours[2],t2,_tetra);
-    updateNeighbour(_tetra->m_neighbours[3],t1,_tetra);
-
-    // Push new tetrahedra into the tetrahedra stack
-    m_tetrahedra.push_back(t1);
-    m_tetrahedra.push_back(t2);
-    m_tetrahedra.push_back(t3);
-    m_tetrahedra.push_back(t4);
-
-    // Push new tetrahedra into the flip stack
-    m_flipStack.push(createFlip(3,t1));
-    m_flipStack.push(createFlip(3,t2));
-    m_flipStack.push(createFlip(3,t3));
-    m_flipStack.push(createFlip(3,t4));
+    Tetrahedron *created[4];
+    for(int k=0; k<_table.m_numNew; ++k)
+    {
+        const int *labels = _table.m_newLabels[k];
+        created[k] = new Tetrahedron(_verts[labels[0]],_verts[labels[1]],_verts[labels[2]],_verts[labels[3]]);
+        created[k]->m_tetid = ++m_tetCount;
+        if(m_weighted)
+        {
+            ngl::Real weights[4] = { _weights[labels[0]], _weights[labels[1]], _weights[labels[2]], _weights[labels[3]] };
+            created[k]->setWeights(weights);
+        }
+    }
 
+    for(int k=0; k<_table.m_numNew; ++k)
+    {
+        Tetrahedron *t = created[k];
+        for(int f=0; f<4; ++f)
+        {
+            int n = _table.m_newNeighbour[k][f];
+            if(n >= 0)
+            {
+                t->m_neighbours[f] = created[n];
+                t->m_faceMap[f] = _table.m_newMap[k][f];
+                continue;
+            }
+
+            // boundary face : take over the outer neighbour of the old tetrahedron holding it
+            Tetrahedron *old = _old[_table.m_oldTet[k][f]];
+            const int *pos = _pos[_table.m_oldTet[k][f]];
+            int oldFace = pos[_table.m_oldOpposite[k][f]];
+            Tetrahedron *outer = old->m_neighbours[oldFace];
+            t->m_neighbours[f] = outer;
+            if(outer == NULL)
+            {
+                continue;
+            }
+
+            // compose new -> old -> outer, and invert it for the way back
+            int mirror = old->acrossFace(oldFace,oldFace);
+            unsigned char toOuter = 0;
+            unsigned char fromOuter = 0;
+            for(int s=0; s<4; ++s)
+            {
+                int m = (s == f) ? mirror : old->acrossFace(oldFace,pos[_table.m_newLabels[k][s]]);
+                toOuter |= m<<(2*s);
+                fromOuter |= s<<(2*m);
+            }
+            t->m_faceMap[f] = toOuter;
+            outer->m_neighbours[mirror] = t;
+            outer->m_faceMap[mirror] = fromOuter;
+        }
+    }
 
     // Updating status of the old tetrahedra
-    _tetra->m_modified = true;
+    for(int o=0; o<_table.m_numOld; ++o)
+    {
+        _old[o]->m_modified = true;
+    }
+    m_deadCount += _table.m_numOld;
+    if(m_recordDelta)
+    {
+        for(int o=0; o<_table.m_numOld; ++o)
+        {
+            m_delta.m_killed.push_back(_old[o]->m_tetid);
+        }
+        for(int k=0; k<_table.m_numNew; ++k)
+        {
+            recordCreated(created[k]);
+        }
+    }
 
-    return t4;
+    // Push the new tetrahedra into the tetrahedra stack and the flip stack
+    for(int k=0; k<_table.m_numNew; ++k)
+    {
+        m_tetrahedra.push_back(created[k]);
+        m_flipStack.push(createFlip(_table.m_pointSlot,created[k]));
+    }
+    return created[_table.m_result];
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-// This function performs Flip44
+// This function performs Flip14
 //----------------------------------------------------------------------------------------------------------------------
-Tetrahedron* Delaunay::flip44(Tetrahedron* _t1, Tetrahedron* _t2, ngl::Vec3 _p, ngl::Vec3 _d, int _cid)
+Tetrahedron* Delaunay::flip14(Tetrahedron* _tetra, ngl::Vec3 _point, ngl::Real _weight)
 {
-    int pid = findPoint(_t1,_p);
-    int did = findPoint(_t2,_d);
-    ngl::Vec3 c = _t1->getVertexData()[_cid];
-    int c2id = findPoint(_t2,c);
-    Tetrahedron *t3 = _t1->m_neighbours[_cid];
-    Tetrahedron *t4 = _t2->m_neighbours[c2id];
-    findSharedEdge(_t1,_t2,t3);
-
-    ngl::Vec3 v1 = _t1->getVertexData()[pid];
-    ngl::Vec3 v2 = _t1->getVertexData()[(pid+1)%4];
-    ngl::Vec3 v3 = _t1->getVertexData()[(pid+2)%4];
-    ngl::Vec3 v4 = t3->getVertexData()[_cid];
-    Tetrahedron *newt1 = new Tetrahedron(v1,v2,v3,v4);
-    v1 = _t1->getVertexData()[pid];
-    v2 = _t1->getVertexData()[(pid+1)%4];
-    v3 = _t1->getVertexData()[(pid+3)%4];
-    v4 = t3->getVertexData()[_cid];
-    Tetrahedron *newt2 = new Tetrahedron(v1,v2,v3,v4);
-    v1 = _t2->getVertexData()[did];
-    v2 = _t2->getVertexData()[(did+1)%4];
-    v3 = _t2->getVertexData()[(did+2)%4];
-    v4 = t4->getVertexData()[c2id];
-    Tetrahedron *newt3 = new Tetrahedron(v1,v2,v3,v4);
-    v1 = _t2->getVertexData()[did];
-    v2 = _t2->getVertexData()[(did+1)%4];
-    v3 = _t2->getVertexData()[(did+3)%4];
-    v4 = t4->getVertexData()[c2id];
-    Tetrahedron *newt4 = new Tetrahedron(v1,v2,v3,v4);
-
-    newt1->m_tetid = ++m_tetCount;
-    newt2->m_tetid = ++m_tetCount;
-    newt3->m_tetid = ++m_tetCount;
-    newt4->m_tetid = ++m_tetCount;
-
-    int a_t2 = findPoint(_t2,_t1->getVertexData()[m_a]);
-    int b_t2 = findPoint(_t2,_t1->getVertexData()[m_b]);
-    int a_t3 = findPoint(t3,_t1->getVertexData()[m_a]);
-    int b_t3 = findPoint(t3,_t1->getVertexData()[m_b]);
-    int a_t4 = findPoint(t4,_t1->getVertexData()[m_a]);
-    int b_t4 = findPoint(t4,_t1->getVertexData()[m_b]);
-    // neigbours for new t1
-    newt1->m_neighbours[0] = newt3;
-    newt1->m_neighbours[1] = t3->m_neighbours[b_t3];
-    newt1->m_neighbours[2] = newt2;
-    newt1->m_neighbours[3] = _t1->m_neighbours[m_b];
-
-    // neigbours for new t2
-    newt2->m_neighbours[0] = newt4;
-    newt2->m_neighbours[1] = t3->m_neighbours[a_t3];
-    newt2->m_neighbours[2] = newt1;
-    newt2->m_neighbours[3] = _t1->m_neighbours[m_a];
-
-    // neigbours for new t1
-    newt3->m_neighbours[0] = newt1;
-    newt3->m_neighbours[1] = t4->m_neighbours[b_t4];
-    newt3->m_neighbours[2] = newt4;
-    newt3->m_neighbours[3] = _t2->m_neighbours[b_t2];
-
-    // neigbours for new t2
-    newt4->m_neighbours[0] = newt2;
-    newt4->m_neighbours[1] = t4->m_neighbours[a_t4];
-    newt4->m_neighbours[2] = newt3;
-    newt4->m_neighbours[3] = _t2->m_neighbours[a_t2];
-
-    // update neighbours
-    updateNeighbour(t3->m_neighbours[b_t3],newt1,t3);
-    updateNeighbour(_t1->m_neighbours[m_b],newt1,_t1);
-    updateNeighbour(t3->m_neighbours[a_t3],newt2,t3);
-    updateNeighbour(_t1->m_neighbours[m_a],newt2,_t1);
-    updateNeighbour(t4->m_neighbours[b_t4],newt3,t4);
-    updateNeighbour(_t2->m_neighbours[b_t2],newt3,_t2);
-    updateNeighbour(t4->m_neighbours[a_t4],newt4,t4);
-    updateNeighbour(_t2->m_neighbours[a_t2],newt4,_t2);
-
-    // Update flipstack
-    m_flipStack.push(createFlip(0,newt1));
-    m_flipStack.push(createFlip(0,newt2));
-    m_flipStack.push(createFlip(0,newt3));
-    m_flipStack.push(createFlip(0,newt4));
-
-    // Push the new tetrahera created into tetrahedra stack
-    m_tetrahedra.push_back(newt1);
-    m_tetrahedra.push_back(newt2);
-    m_tetrahedra.push_back(newt3);
-    m_tetrahedra.push_back(newt4);
-
-    _t1->m_modified = true;
-    _t2->m_modified = true;
-    t3->m_modified = true;
-    t4->m_modified = true;
-
-    return newt1;
-
+    TRACE_ZONE_SAMPLED("Delaunay::flip14",s_traceEvery);
+    Tetrahedron *old[4] = { _tetra, NULL, NULL, NULL };
+    int pos[4][5] = { {0,1,2,3,-1} };
+    const ngl::Vec3 *v = _tetra->getVertexData();
+    ngl::Vec3 verts[5] = { v[0], v[1], v[2], v[3], _point };
+    const ngl::Real *w = _tetra->getWeightData();
+    ngl::Real weights[5] = { w[0], w[1], w[2], w[3], _weight };
+
+    return applyFlip(s_flip14,old,pos,verts,weights);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 // This function performs Flip23
 //----------------------------------------------------------------------------------------------------------------------
-Tetrahedron* Delaunay::flip23(Tetrahedron* _t, int _pid, int _did)
+Tetrahedron* Delaunay::flip23(Tetrahedron* _t, int _pid)
 {
-    ngl::Vec3 p = _t->getVertexData()[_pid];
-    Tetrahedron *ta = _t->m_neighbours[_pid];
-    ngl::Vec3 d = ta->getVertexData()[_did];
-
-    int aid = (_pid+1)%4;
-    int bid = (_pid+2)%4;
-    int cid = (_pid+3)%4;
-
-    ngl::Vec3 a = _t->getVertexData()[aid];
-    ngl::Vec3 b = _t->getVertexData()[bid];
-    ngl::Vec3 c = _t->getVertexData()[cid];
-
-    int a2id = findPoint(ta,_t->getVertexData()[aid]);
-    int b2id = findPoint(ta,_t->getVertexData()[bid]);
-    int c2id = findPoint(ta,_t->getVertexData()[cid]);
-
-    //create 3 new tetrahedra
-    Tetrahedron *t1 = new Tetrahedron(p,a,b,d);
-    Tetrahedron *t2 = new Tetrahedron(p,a,c,d);
-    Tetrahedron *t3 = new Tetrahedron(p,b,c,d);
-
-    t1->m_tetid = ++m_tetCount;
-    t2->m_tetid = ++m_tetCount;
-    t3->m_tetid = ++m_tetCount;
-
-    //Setup neighbours for t1
-    t1->m_neighbours[0] = ta->m_neighbours[c2id];
-    t1->m_neighbours[1] = t3;
-    t1->m_neighbours[2] = t2;
-    t1->m_neighbours[3] = _t->m_neighbours[cid];
-
-
-    //Setup neighbours for t2
-    t2->m_neighbours[0] = ta->m_neighbours[b2id];
-    t2->m_neighbours[1] = t3;
-    t2->m_neighbours[2] = t1;
-    t2->m_neighbours[3] = _t->m_neighbours[bid];
-
-    //Setup neighbours for t3
-    t3->m_neighbours[0] = ta->m_neighbours[a2id];
-    t3->m_neighbours[1] = t2;
-    t3->m_neighbours[2] = t1;
-    t3->m_neighbours[3] = _t->m_neighbours[aid];
-
-    //Setup neighbours of the neighbours
-    updateNeighbour(_t->m_neighbours[aid],t3,_t);
-    updateNeighbour(ta->m_neighbours[a2id],t3, ta);
-    updateNeighbour(_t->m_neighbours[bid],t2,_t);
-    updateNeighbour(ta->m_neighbours[b2id],t2,ta);
-    updateNeighbour(_t->m_neighbours[cid],t1,_t);
-    updateNeighbour(ta->m_neighbours[c2id],t1,ta);
-
-    // Updating status of the two tetrahedra modified
-     _t->m_modified = true;
-     ta->m_modified = true;
-
-     // Update flip stack
-     m_flipStack.push(createFlip(0,t1));
-     m_flipStack.push(createFlip(0,t2));
-     m_flipStack.push(createFlip(0,t3));
-
-     // Push the new tetrahera created into tetrahedra stack
-     m_tetrahedra.push_back(t1);
-     m_tetrahedra.push_back(t2);
-     m_tetrahedra.push_back(t3);
-
-     return t1;
+    Tetrahedron *old[4] = { _t, _t->m_neighbours[_pid], NULL, NULL };
+    int pos[4][5] = { {_pid,(_pid+1)%4,(_pid+2)%4,(_pid+3)%4,-1} };
+    positionsAcross(_t,_pid,pos[0],4,pos[1]);
+
+    const ngl::Vec3 *v = _t->getVertexData();
+    ngl::Vec3 verts[5] = { v[pos[0][0]], v[pos[0][1]], v[pos[0][2]], v[pos[0][3]], old[1]->getVertexData()[pos[1][4]] };
+    const ngl::Real *w = _t->getWeightData();
+    ngl::Real weights[5] = { w[pos[0][0]], w[pos[0][1]], w[pos[0][2]], w[pos[0][3]], old[1]->getWeightData()[pos[1][4]] };
+
+    return applyFlip(s_flip23,old,pos,verts,weights);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 // This function performs Flip32
 //----------------------------------------------------------------------------------------------------------------------
-Tetrahedron* Delaunay::flip32(Tetrahedron* _t1, Tetrahedron* _t2, Tetrahedron* _t3, int _pid, int _did)
+Tetrahedron* Delaunay::flip32(Tetrahedron* _t1, Tetrahedron* _t3, int _pid)
 {
-    int c1 = -1;
-    for(int i=0;i<4;++i)
-    {
-        if(i!=m_a && i!=_pid && i!=m_b)
-        {
-            c1 = i;
-            break;
-        }
-    }
-    if(c1 == -1)
-    {
-        std::cerr<<"Problem with c1!!!"<<std::endl;
-    }
-
-    // Create two new tetrahedra
-    Tetrahedron* t1 = new Tetrahedron(_t1->getVertexData()[_pid], _t1->getVertexData()[m_a], _t1->getVertexData()[c1], _t2->getVertexData()[_did]);
-    Tetrahedron* t2 = new Tetrahedron(_t1->getVertexData()[_pid], _t1->getVertexData()[m_b], _t1->getVertexData()[c1], _t2->getVertexData()[_did]);
+    // m_a and m_b are the edge being removed, c1 is the remaining vertex of _t1
+    int c1 = 6 - _pid - m_a - m_b;
 
-    t1->m_tetid = ++m_tetCount;
-    t2->m_tetid = ++m_tetCount;
+    Tetrahedron *old[4] = { _t1, _t1->m_neighbours[_pid], _t3, NULL };
+    int pos[4][5] = { {_pid,m_a,m_b,c1,-1} };
+    positionsAcross(_t1,_pid,pos[0],4,pos[1]);
+    positionsAcross(_t1,c1,pos[0],4,pos[2]);
 
-    // Find indices for m_a in t2 and t3
-    int a1 = findPoint(_t2,_t1->getVertexData()[m_a]);
-    int a2 = findPoint(_t3,_t1->getVertexData()[m_a]);
-
-    // Find indices for m_b in t2 and t3
-    int b1 = findPoint(_t2,_t1->getVertexData()[m_b]);
-    int b2 = findPoint(_t3,_t1->getVertexData()[m_b]);
-
-    // Set neighbours for t1
-    t1->m_neighbours[0] = _t2->m_neighbours[b1];
-    t1->m_neighbours[1] = t2;
-    t1->m_neighbours[2] = _t3->m_neighbours[b2];
-    t1->m_neighbours[3] = _t1->m_neighbours[m_b];
-
-    // Set neighbours for t2
-    t2->m_neighbours[0] = _t2->m_neighbours[a1];
-    t2->m_neighbours[1] = t1;
-    t2->m_neighbours[2] = _t3->m_neighbours[a2];
-    t2->m_neighbours[3] = _t1->m_neighbours[m_a];
-
-    //Setup neighbours of the neighbours:
-    updateNeighbour(_t1->m_neighbours[m_a],t2,_t1);
-    updateNeighbour(_t1->m_neighbours[m_b],t1,_t1);
-    updateNeighbour(_t2->m_neighbours[a1],t2,_t2);
-    updateNeighbour(_t2->m_neighbours[b1],t1,_t2);
-    updateNeighbour(_t3->m_neighbours[a2],t2,_t3);
-    updateNeighbour(_t3->m_neighbours[b2],t1,_t3);
-
-    _t1->m_modified = true;
-    _t2->m_modified = true;
-    _t3->m_modified = true;
-
-    // Update flip stack
-    m_flipStack.push(createFlip(0,t1));
-    m_flipStack.push(createFlip(0,t2));
-
-    // Push the new tetrahera created into tetrahedra stack
-    m_tetrahedra.push_back(t1);
-    m_tetrahedra.push_back(t2);
-
-    return t1;
+    const ngl::Vec3 *v = _t1->getVertexData();
+    ngl::Vec3 verts[5] = { v[_pid], v[m_a], v[m_b], v[c1], old[1]->getVertexData()[pos[1][4]] };
+    const ngl::Real *w = _t1->getWeightData();
+    ngl::Real weights[5] = { w[_pid], w[m_a], w[m_b], w[c1], old[1]->getWeightData()[pos[1][4]] };
 
+    return applyFlip(s_flip32,old,pos,verts,weights);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-// This function checks if four tetrahedra are in config44
+// This function performs Flip41
 //----------------------------------------------------------------------------------------------------------------------
-bool Delaunay::config44(Tetrahedron *_t1, Tetrahedron *_t2, ngl::Vec3 _p, int _cid, Tetrahedron* &_t3, Tetrahedron* &_t4)
+Tetrahedron* Delaunay::flip41(Tetrahedron* _t1, int _pid, int _vid)
 {
-    ngl::Vec3 c = _t1->getVertexData()[_cid];
-    int c2id = findPoint(_t2,c);
-
-    _t3 = _t1->m_neighbours[_cid];
-    _t4 = _t2->m_neighbours[c2id];
-
-    if(_t3!=NULL && _t4!=NULL)
+    // b and c are the other two vertices of the face p sees, abd is across c and acd across b
+    int bid = -1;
+    int cid = -1;
+    for(int i=0; i<4; ++i)
     {
-        int pid = findPoint(_t3,_p);
-        if(_t3->m_neighbours[pid] == _t4)
+        if(i == _pid || i == _vid)
         {
-            return true;
+            continue;
         }
-    }
-    return false;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-// This function retrieves the apex(vertex not shared) of the adjacent tetrahedra t
-//----------------------------------------------------------------------------------------------------------------------
-int Delaunay::getApex(Tetrahedron *_t1, Tetrahedron *_t2)
-{
-        //Checking for t1 between t2's neigbours
-        for(int i=0;i<4;i++)
+        if(bid < 0)
         {
-                if(_t2->m_neighbours[i]==_t1)
-                {
-                        return i;
-                }
+            bid = i;
+        }
+        else
+        {
+            cid = i;
         }
-        return -1;
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-// This function checks if the tetrahedron vertices are coplanar
-//----------------------------------------------------------------------------------------------------------------------
-bool Delaunay::isCoplanar(Tetrahedron *_t)
-{
-    ngl::Vec3 a = _t->getVertexData()[0];
-    ngl::Vec3 b = _t->getVertexData()[1];
-    ngl::Vec3 c = _t->getVertexData()[2];
-    ngl::Vec3 d = _t->getVertexData()[3];
-    ngl::Mat4 m;
-    m.m_00 = a.m_x;
-    m.m_01 = a.m_y;
-    m.m_02 = a.m_z;
-    m.m_03 = 1;
-
-    m.m_10 = b.m_x;
-    m.m_11 = b.m_y;
-    m.m_12 = b.m_z;
-    m.m_13 = 1;
-
-    m.m_20 = c.m_x;
-    m.m_21 = c.m_y;
-    m.m_22 = c.m_z;
-    m.m_23 = 1;
-
-    m.m_30 = d.m_x;
-    m.m_31 = d.m_y;
-    m.m_32 = d.m_z;
-    m.m_33 = 1;
-
-    double det = m.determinant();
-    if(det == 0)
-    {
-        return true;
-    }
-    else
-    {
-        return false;
     }
+
+    Tetrahedron *old[4] = { _t1, _t1->m_neighbours[_pid], _t1->m_neighbours[cid], _t1->m_neighbours[bid] };
+    int pos[4][5] = { {_pid,_vid,bid,cid,-1} };
+    positionsAcross(_t1,_pid,pos[0],4,pos[1]);
+    positionsAcross(_t1,cid,pos[0],4,pos[2]);
+    positionsAcross(_t1,bid,pos[0],4,pos[3]);
+
+    const ngl::Vec3 *v = _t1->getVertexData();
+    ngl::Vec3 verts[5] = { v[_pid], v[_vid], v[bid], v[cid], old[1]->getVertexData()[pos[1][4]] };
+    const ngl::Real *w = _t1->getWeightData();
+    ngl::Real weights[5] = { w[_pid], w[_vid], w[bid], w[cid], old[1]->getWeightData()[pos[1][4]] };
+
+    ++m_redundantCount;
+    return applyFlip(s_flip41,old,pos,verts,weights);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-// This function checks if a third tetrahedron exists, given t1 and t2
+// This function checks if a third tetrahedron exists around the edge of t1 and its neighbour across _pid that
+// does not contain the vertex _c1
 //----------------------------------------------------------------------------------------------------------------------
-Tetrahedron* Delaunay::findthird(Tetrahedron *_t1, Tetrahedron *_t2, int _c1)
+Tetrahedron* Delaunay::findthird(Tetrahedron *_t1, int _pid, int _c1)
 {
-        int c2= findPoint(_t2, _t1->getVertexData()[_c1]);
+        Tetrahedron *t2 = _t1->m_neighbours[_pid];
+        int c2 = _t1->acrossFace(_pid,_c1);
 
-        if(_t1->m_neighbours[_c1]==_t2->m_neighbours[c2])
+        if(_t1->m_neighbours[_c1]==t2->m_neighbours[c2])
         {
              return _t1->m_neighbours[_c1];
         }
@@ -637,88 +750,45 @@ Tetrahedron* Delaunay::findthird(Tetrahedron *_t1, Tetrahedron *_t2, int _c1)
         }
 }
 
-Tetrahedron* Delaunay::findthird(Tetrahedron *_t1, Tetrahedron *_t2)
-{
-    for(int i=0;i<4;++i)
-    {
-        for(int j=0;j<4;++j)
-        {
-            if(_t1->m_neighbours[i]==_t2->m_neighbours[j])
-            {
-                return _t1->m_neighbours[i];
-            }
-        }
-    }
-    return NULL;
-}
-
 //----------------------------------------------------------------------------------------------------------------------
-// This function finds the edge shared between two tetrahedron t1 and t2
+// This function checks if the union of t1 and its neighbour across _pid is concave or convex
 //----------------------------------------------------------------------------------------------------------------------
-void Delaunay::findSharedEdge(Tetrahedron *_t1, Tetrahedron *_t2, Tetrahedron* _t3)
-{
-    bool flag = true;
-    int count = 0;
-    for(int i=0;i<4;++i)
-    {
-       for(int j=0;j<4;++j)
-        {
-            if(_t1->getVertexData()[i] == _t2->getVertexData()[j])
-            {
-                for(int k=0;k<4;++k)
-                {
-
-                    if(_t1->getVertexData()[i] == _t3->getVertexData()[k])
-                    {
-                        if(count == 0)
-                        {
-                            m_a = i;
-                            count++;
-                            flag = true;
-                            break;
-                        }
-                        else
-                        {
-                            m_b = i;
-                            flag = true;
-                            break;
-                        }
-
-                    }
-                }
-                if(flag == true)
-                {
-                    flag = false;
-                    break;
-                }
-            }
-        }
-    }
-}
-//----------------------------------------------------------------------------------------------------------------------
-// This function checks if the union of the two tetrahedron t1 and t2 are concave, convex or coplanar
-//----------------------------------------------------------------------------------------------------------------------
-int Delaunay::checkcase(Tetrahedron* _t1,Tetrahedron* _t2, ngl::Vec3 _point, ngl::Vec3 _d)
+int Delaunay::checkcase(Tetrahedron* _t1, int _pid, ngl::Vec3 _d)
 {
    bool concave = false;
    int case1, case2, case3;
-   int pid = findPoint(_t1,_point);
-   m_cid = -1;
 
-   int aid = (pid+1)%4;
-   int bid = (pid+2)%4;
-   int cid = (pid+3)%4;
-   ngl::Vec3 a =  _t1->getVertexData()[aid];
+   int aid = (_pid+1)%4;
+   int bid = (_pid+2)%4;
+   int cid = (_pid+3)%4;
+   ngl::Vec3 p = _t1->getVertexData()[_pid];
+   ngl::Vec3 a = _t1->getVertexData()[aid];
    ngl::Vec3 b = _t1->getVertexData()[bid];
    ngl::Vec3 c = _t1->getVertexData()[cid];
 
-   case1 = oppSides(_point,a,b,c,_d);
-   case2 = oppSides(_point,a,c,b,_d);
-   case3 = oppSides(_point,b,c,a,_d);
+   case1 = oppSides(p,a,b,c,_d);
+   case2 = oppSides(p,a,c,b,_d);
+   case3 = oppSides(p,b,c,a,_d);
+
+   // pd passes beyond the vertex shared by two reflex edges. In a regular triangulation that vertex may have become
+   // redundant, it is removed when its only tetrahedra are the four around it, t, ta and the thirds around both edges
+   if(m_weighted && (case1 == 2) + (case2 == 2) + (case3 == 2) == 2)
+   {
+       int vid = case3 != 2 ? aid : (case2 != 2 ? bid : cid);
+       int uid = vid == aid ? bid : aid;
+       int wid = vid == cid ? bid : cid;
+       m_third = NULL;
+       m_a = vid;
+       if(findthird(_t1,_pid,uid) != NULL && findthird(_t1,_pid,wid) != NULL)
+       {
+           return 3;
+       }
+       return 2;
+   }
 
    if(case1 == 2)
    {
-       m_third = findthird(_t1,_t2,cid);
+       m_third = findthird(_t1,_pid,cid);
        m_a = aid;
        m_b = bid;
        concave = true;
@@ -729,7 +799,7 @@ int Delaunay::checkcase(Tetrahedron* _t1,Tetrahedron* _t2, ngl::Vec3 _point, ngl
    }
    if(case2 == 2)
    {
-       m_third = findthird(_t1,_t2,bid);
+       m_third = findthird(_t1,_pid,bid);
        m_a = aid;
        m_b = cid;
        concave = true;
@@ -740,7 +810,7 @@ int Delaunay::checkcase(Tetrahedron* _t1,Tetrahedron* _t2, ngl::Vec3 _point, ngl
    }
    if(case3 == 2)
    {
-       m_third = findthird(_t1,_t2,aid);
+       m_third = findthird(_t1,_pid,aid);
        m_a = bid;
        m_b = cid;
        concave = true;
@@ -753,62 +823,7 @@ int Delaunay::checkcase(Tetrahedron* _t1,Tetrahedron* _t2, ngl::Vec3 _point, ngl
    {
        return 2;
    }
-   if(case1==3)
-   {
-       m_cid = cid;
-       return 3;
-   }
-   if(case2==3)
-   {
-       m_cid = bid;
-       return 3;
-   }
-   if(case3==3)
-   {
-       m_cid = aid;
-       return 3;
-   }
-   else
-   {
-       return 1;
-   }
-
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-// This function finds the tetrahedron _findT in _oldT and updates it with _newT
-//----------------------------------------------------------------------------------------------------------------------
-void Delaunay::updateNeighbour(Tetrahedron *_oldt, Tetrahedron *_newt, Tetrahedron *_findt)
-{
-
-        int x=0;
-        if(_oldt!=NULL){
-
-                for(int i=0; i<4; i++){
-                        if(_oldt->m_neighbours[i]==_findt){
-                                _oldt->m_neighbours[i]=_newt;
-                                x=1;
-                        }
-                }
-                if(x==0){
-                        std::cerr<<"Error : Neighbour not found!"<<std::endl;
-                }
-        }
-}
-
-//----------------------------------------------------------------------------------------------------------------------
-// This function returns the position of the given point in the tetrahedron vertices
-//----------------------------------------------------------------------------------------------------------------------
-int Delaunay::findPoint(Tetrahedron* _t, ngl::Vec3 _point)
-{
-    for(int i=0; i<4; ++i)
-    {
-        if(_t->getVertexData()[i] == _point)
-        {
-            return i;
-        }
-    }
-    return -1;
+   return 1;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -827,25 +842,15 @@ flipData Delaunay::createFlip(int _pid, Tetrahedron* _t)
 //----------------------------------------------------------------------------------------------------------------------
 int Delaunay::oppSides(ngl::Vec3 _a, ngl::Vec3 _b, ngl::Vec3 _c, ngl::Vec3 _p1, ngl::Vec3 _p2)
 {
-    unsigned int result;
-    double a,b;
-    a = m_predicates->orient3d(_a,_b,_c,_p1);
-    b = m_predicates->orient3d(_a,_b,_c,_p2);
+    // the perturbed orientations are never zero
+    float a = m_predicates->orient3d(_a,_b,_c,_p1);
+    float b = m_predicates->orient3d(_a,_b,_c,_p2);
 
-    if((a>0 && b<0) || (a<0 && b>0))
+    if((a>0) != (b>0))
     {
-        result = 2;
+        return 2;
     }
-    if((a>0 && b>0) || (a<0 && b<0))
-    {
-        result = 1;
-    }
-    if(a==0 || b==0)
-    {
-        result = 3;
-    }
-
-    return result;
+    return 1;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -853,6 +858,7 @@ int Delaunay::oppSides(ngl::Vec3 _a, ngl::Vec3 _b, ngl::Vec3 _c, ngl::Vec3 _p1,
 //----------------------------------------------------------------------------------------------------------------------
 Tetrahedron* Delaunay::walk(ngl::Vec3 _p, Tetrahedron *_tetra)
 {
+    TRACE_ZONE_SAMPLED("Delaunay::walk",s_traceEvery);
     float op1, op2;
     bool next=false;
     while(true)
@@ -4,10 +4,13 @@
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Delaunay.h
 /// @author Maria Vineeta Bagya Seelan
-/// @version 1.0
+/// @version 1.3
 /// @date 28/03/13
 /// Revision History :
 /// Initial Version 28/03/13
+/// 1.1 weighted points, compute then builds their regular triangulation whose dual is the power diagram
+/// 1.2 the snap grid spans the bounding box of the points, getPoints returns the points as they were inserted
+/// 1.3 a TetRecord carries the weights of its vertices, so the snapshots of a weighted build give the power centres
 /// @class Delaunay
 /// @brief the Delaunay class that holds all members and functions needed to compute Delaunay Tetrahedralization
 //----------------------------------------------------------------------------------------------------------------------
@@ -18,6 +21,64 @@
 #include "Voronoi.h"
 #include <stack>
 
+struct FlipTable;
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a tetrahedron created during a progressive build, the vertices and their weights are copied so a snapshot
+/// never refers to the mesh that is still being built. The weights are all zero in an unweighted build
+//----------------------------------------------------------------------------------------------------------------------
+struct TetRecord
+{
+    int m_tetid;
+    ngl::Vec3 m_verts[4];
+    ngl::Real m_weights[4];
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the changes to the live tetrahedra since the last snapshot, the tetrahedra on the big tetrahedron are left
+/// out of m_created as they are not part of the final mesh
+//----------------------------------------------------------------------------------------------------------------------
+struct TetDelta
+{
+    std::vector<TetRecord> m_created;
+    std::vector<int> m_killed;
+
+    bool empty() const { return m_created.empty() && m_killed.empty(); }
+    void clear() { m_created.clear(); m_killed.clear(); }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class DelaunayProgress
+/// @brief interface compute reports to while it runs, it is called from the thread running compute every few hundred
+/// points and its answer is the cancellation token of the build
+//----------------------------------------------------------------------------------------------------------------------
+class DelaunayProgress
+{
+public:
+    virtual ~DelaunayProgress(){}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief called while the points are inserted and while the mesh is cleaned up
+    /// @param [in] _inserted the number of points processed so far
+    /// @param [in] _total the number of points
+    /// @param [in] _alive the number of tetrahedra in the current mesh
+    /// @returns false to cancel the build
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual bool report(int _inserted, int _total, int _alive) = 0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief asked once at the start of compute, true makes it record the changes to the live tetrahedra and publish
+    /// them while the points are inserted
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual bool isProgressive() { return false; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief called after report while the points are inserted in a progressive build, and once more when the last
+    /// point is in. The delta holds every change since the last snapshot that was taken, an implementation takes it by
+    /// swapping its vectors out or leaves it untouched if the previous snapshot has not been consumed yet, compute then
+    /// keeps appending to it. It must not wait for the consumer
+    /// @param [in] _delta the changes since the last snapshot taken
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void publish(TetDelta &){}
+};
+
 //----------------------------------------------------------------------------------------------------------------------
 /// @brief structure that stores the data required for flipping
 //----------------------------------------------------------------------------------------------------------------------
@@ -42,7 +103,7 @@ public:
     //----------------------------------------------------------------------------------------------------------------------
     Delaunay( Tetrahedron* _tetrahedron );
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief Destructor for Delaunay class
+    /// @brief Destructor for Delaunay class, it frees every tetrahedron of the build, the ones compute returned too
     //----------------------------------------------------------------------------------------------------------------------
     ~Delaunay();
     //----------------------------------------------------------------------------------------------------------------------
@@ -52,59 +113,148 @@ public:
     //----------------------------------------------------------------------------------------------------------------------
     std::vector<Tetrahedron*> compute( std::vector<ngl::Vec3> _points );
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that computes the regular (weighted Delaunay) tetrahedralization of weighted points with the
+    /// same walk and flips, the power test taking the place of insphere. A point whose power cell would be empty is
+    /// redundant and is left out, whether it is when it comes in or becomes so later. The circumcentres of the
+    /// tetrahedra are then their power centres, so the voronoi diagram built from them is the power diagram
+    /// @param [in] _points all the points needed to construct the triangulation
+    /// @param [in] _weights the weight of every point, the square of the radius of its sphere. Empty for the
+    /// unweighted build
+    /// @param [out] std::vector<Tetrahedron*> the tetrahedrons used in constructing the triangulation
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<Tetrahedron*> compute( std::vector<ngl::Vec3> _points, const std::vector<ngl::Real> &_weights );
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief function that generates Voronoi diagram
     /// @param [in] _point single point around which Voronoi cells are constructed
     /// @param [out] Voronoi the voronoi cell after construction
     //----------------------------------------------------------------------------------------------------------------------
     Voronoi *generateVoronoi(ngl::Vec3 _point);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the predicate call counters of the last compute
+    //----------------------------------------------------------------------------------------------------------------------
+    const PredicateStats& getPredicateStats() const { return m_predicates->getStats(); }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief turns the integer snapped mode on or off, when on compute quantizes the points to a power of
+    /// two grid spanning their bounding box and evaluates the predicates among them exactly in integer arithmetic
+    /// @param [in] _snap true to snap the points
+    //----------------------------------------------------------------------------------------------------------------------
+    void setSnapToGrid(bool _snap){ m_snapToGrid = _snap; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the points of the last compute as they were inserted, on the snap grid in the snapped
+    /// mode. The vertices of the tetrahedra are these points, not the ones given to compute
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<ngl::Vec3>& getPoints() const { return m_points; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sets the object compute reports its progress to and asks whether to go on
+    /// @param [in] _progress the progress object, NULL to run without reporting
+    //----------------------------------------------------------------------------------------------------------------------
+    void setProgress(DelaunayProgress *_progress){ m_progress = _progress; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor that tells whether the last compute was cancelled, its result is then empty
+    //----------------------------------------------------------------------------------------------------------------------
+    bool isCancelled() const { return m_cancelled; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the number of redundant points of the last weighted compute, the points that are no vertex
+    /// of the result though no other point is at their position
+    //----------------------------------------------------------------------------------------------------------------------
+    int getRedundantCount() const { return m_redundantCount; }
 
 private :
     std::stack<flipData> m_flipStack;
     std::vector<Tetrahedron*> m_tetrahedra;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the tetrahedra the clean up took out of m_tetrahedra, until they are freed with the rest
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<Tetrahedron*> m_removed;
     Tetrahedron* m_tetrahedron;
     Tetrahedron* m_third;
     Predicates *m_predicates;
     int m_a;
     int m_b;
-    int m_cid;
     int m_tetCount;
+    bool m_snapToGrid;
+    DelaunayProgress *m_progress;
+    bool m_cancelled;
+    int m_deadCount;
+    unsigned int m_reportStep;
+    bool m_recordDelta;
+    TetDelta m_delta;
+    ngl::Vec3 m_bigVerts[4];
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true while a weighted compute runs, the flips then use the power test
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_weighted;
+    int m_redundantCount;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the points of the last compute as they were inserted
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<ngl::Vec3> m_points;
 
 private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function called once per step of compute, reports the progress every few hundred steps and records a
+    /// cancellation
+    /// @param [in] _inserted the number of points processed so far
+    /// @param [in] _total the number of points
+    /// @param [out] returns true once the build is cancelled
+    //----------------------------------------------------------------------------------------------------------------------
+    bool cancelled(int _inserted, int _total);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that does the work of both computes
+    /// @param [in] _points the points, snapped in place in the snapped mode
+    /// @param [in] _weights the weights of the points, NULL for the unweighted build
+    /// @param [out] returns the tetrahedra
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<Tetrahedron*> build(std::vector<ngl::Vec3> &_points, const std::vector<ngl::Real> *_weights);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that adds a new tetrahedron to the delta of a progressive build unless it is on the big
+    /// tetrahedron
+    /// @param [in] _t the new tetrahedron
+    //----------------------------------------------------------------------------------------------------------------------
+    void recordCreated(const Tetrahedron *_t);
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief function that performs flip14
     /// @param [in] _tetra the tetrahedra to be flipped
     /// @param [in] _point the point to be inserted into DT
+    /// @param [in] _weight the weight of the point
     /// @param [out] returns the new tetrahedra created
     //----------------------------------------------------------------------------------------------------------------------
-    Tetrahedron* flip14(Tetrahedron* _tetra, ngl::Vec3 _point);
+    Tetrahedron* flip14(Tetrahedron* _tetra, ngl::Vec3 _point, ngl::Real _weight);
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief function that performs flip23
-    /// @param [in] _t the tetrahedra that contains point p
+    /// @param [in] _t the tetrahedra that contains point p, flipped with its neighbour across _pid
     /// @param [in] _pid position of the point in _t
-    /// @param [in] _did position of the apex in tetrahedron adjacent to _t
     /// @param [out] returns the new tetrahedra created
     //----------------------------------------------------------------------------------------------------------------------
-    Tetrahedron* flip23(Tetrahedron* _t, int _pid, int _did);
+    Tetrahedron* flip23(Tetrahedron* _t, int _pid);
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that performs flip14
-    /// @param [in] _t1 the tetrahedra to be flipped
-    /// @param [in] _t2 the tetrahedra to be flipped
-    /// @param [in] _t3 the tetrahedra to be flipped
+    /// @brief function that performs flip32 around the edge m_a m_b
+    /// @param [in] _t1 the tetrahedra that contains point p, flipped with its neighbour across _pid
+    /// @param [in] _t3 the third tetrahedra around the edge
     /// @param [in] _pid position of the point in _t1
-    /// @param [in] _did position of the apex in tetrahedron adjacent to _t2
     /// @param [out] returns the new tetrahedra created
     //----------------------------------------------------------------------------------------------------------------------
-    Tetrahedron* flip32(Tetrahedron* _t1, Tetrahedron* _t2, Tetrahedron* _t3, int _pid, int _did);
+    Tetrahedron* flip32(Tetrahedron* _t1, Tetrahedron* _t3, int _pid);
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that performs flip14
-    /// @param [in] _t1 the tetrahedra to be flipped
-    /// @param [in] _t2 the tetrahedra to be flipped
-    /// @param [in] _p the point to be inserted
-    /// @param [in] _d the point in _t2 opp _p
-    /// @param [in] _cid the position of the point shared by _t1 and _t2
-    /// @param [out] returns the new tetrahedra created
+    /// @brief function that performs flip41, it removes a redundant vertex of the face _t1 shares with its neighbour
+    /// across _pid together with the four tetrahedra around it
+    /// @param [in] _t1 the tetrahedra that contains point p
+    /// @param [in] _pid position of the point in _t1
+    /// @param [in] _vid position of the removed vertex in _t1
+    /// @param [out] returns the new tetrahedron
+    //----------------------------------------------------------------------------------------------------------------------
+    Tetrahedron* flip41(Tetrahedron* _t1, int _pid, int _vid);
     //----------------------------------------------------------------------------------------------------------------------
-    Tetrahedron* flip44(Tetrahedron* _t1, Tetrahedron* _t2, ngl::Vec3 _p, ngl::Vec3 _d, int _cid);
+    /// @brief function that replaces the old tetrahedra of a flip with the new ones given by a flip table
+    /// @param [in] _table the flip table
+    /// @param [in] _old the old tetrahedra, in table order
+    /// @param [in] _pos the position of each label in each old tetrahedron, -1 if it is not there
+    /// @param [in] _verts the vertex of each label
+    /// @param [in] _weights the weight of each label
+    /// @param [out] returns the new tetrahedron the table selects as the next walk start
+    //----------------------------------------------------------------------------------------------------------------------
+    Tetrahedron* applyFlip(const FlipTable &_table, Tetrahedron *_old[4], int _pos[4][5], const ngl::Vec3 _verts[5],
+                           const ngl::Real _weights[5]);
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief function that calculates distance between two points A and B
     /// @param [in] _a point A
@@ -113,13 +263,19 @@ private :
     //----------------------------------------------------------------------------------------------------------------------
     double distance(ngl::Vec3 _a, ngl::Vec3 _b);
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that sets up the snap grid over the bounding box of the points and snaps the points
+    /// @param [in] _points the points to be snapped
+    /// @param [out] returns false if the big tetrahedron reaches into the grid, the points are then left as they are
+    //----------------------------------------------------------------------------------------------------------------------
+    bool snapPoints(std::vector<ngl::Vec3> &_points);
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief function that calculates the orientation of two points w.r.t plane A,B,C
     /// @param [in] _a point A
     /// @param [in] _b point B
     /// @param [in] _c point C
     /// @param [in] _p1 point to be checked for orientation
     /// @param [in] _p2 point to be checked for orientation
-    /// @param [out] returns the valve depending on the orientation of _p1 and _p2
+    /// @param [out] returns 2 if _p1 and _p2 are on opposite sides, 1 otherwise
     //----------------------------------------------------------------------------------------------------------------------
     int oppSides(ngl::Vec3 _a, ngl::Vec3 _b, ngl::Vec3 _c, ngl::Vec3 _p1, ngl::Vec3 _p2);
     //----------------------------------------------------------------------------------------------------------------------
@@ -136,41 +292,21 @@ private :
     //----------------------------------------------------------------------------------------------------------------------
     Tetrahedron* checkDelaunay();
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that checks if T and Ta are concave, convex or coplanar
-    /// @param [in] _t1 tetrahedron to be checked
-    /// @param [in] _t2 tetrahedron to be checked
-    /// @param [out] returns the distance
-    //----------------------------------------------------------------------------------------------------------------------
-    int checkcase(Tetrahedron* _t1, Tetrahedron *_t2, ngl::Vec3 _point, ngl::Vec3 _d);
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that checks if T and Ta are concave, convex or coplanar
-    /// @param [in] _oldt tetrahedron to be checked
-    /// @param [in] _newt tetrahedron to be replaced with
-    /// @param [in] _findt tetrahedron to be searched for
-    //----------------------------------------------------------------------------------------------------------------------
-    void updateNeighbour(Tetrahedron *_oldt, Tetrahedron *_newt, Tetrahedron *_findt);
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that returns the position of teh apex in t2
+    /// @brief function that checks if T and Ta are concave or convex
     /// @param [in] _t1 tetrahedron to be checked
-    /// @param [in] _t2 tetrahedron to be checked
-    /// @param [out] returns the position of the apex
-    //----------------------------------------------------------------------------------------------------------------------
-    int getApex(Tetrahedron *_t1, Tetrahedron *_t2);
+    /// @param [in] _pid position of the point p in _t1, Ta is the neighbour across it
+    /// @param [in] _d the apex of Ta
+    /// @param [out] returns 1 if convex, 2 if concave, 3 if a weighted build can remove the vertex m_a with flip41
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that checks for the position index of p in T
-    /// @param [in] _t tetrahedron to be checked
-    /// @param [in] _point the point to be searched
-    /// @param [out] return the position index of point p in T
-    //----------------------------------------------------------------------------------------------------------------------
-    int findPoint(Tetrahedron *_t, ngl::Vec3 _point);
+    int checkcase(Tetrahedron* _t1, int _pid, ngl::Vec3 _d);
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that finds if a tetrahedron exist between t1 and t2
+    /// @brief function that finds if a tetrahedron exist between t1 and its neighbour t2 across _pid
     /// @param [in] _t1 tetrahedron to be checked
-    /// @param [in] _t2 tetrahedron to be checked
+    /// @param [in] _pid position of the point p in _t1
     /// @param [in] _c1 position of a vertex shared by t1 and t2 whose neighbour is checked
     /// @param [out] returns the third tetrahedron
     //----------------------------------------------------------------------------------------------------------------------
-    Tetrahedron* findthird(Tetrahedron *_t1, Tetrahedron *_t2, int _c1);
+    Tetrahedron* findthird(Tetrahedron *_t1, int _pid, int _c1);
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief function walks through the structure to find the tetrahedron that has the point p
     /// @param [in] _p point to be inserted
@@ -178,37 +314,6 @@ private :
     /// @param [in] returns the tetrahedron that contains p
     //----------------------------------------------------------------------------------------------------------------------
     Tetrahedron* walk(ngl::Vec3 _p, Tetrahedron *_t);
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that checks if vertices of t are coplanar
-    /// @param [in] _t tetrahedron to be checked
-    /// @param [out] returns if t is coplanar or not
-    //----------------------------------------------------------------------------------------------------------------------
-    bool isCoplanar(Tetrahedron *_t);
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that checks if t1 and t2 are in config with t3 and t4
-    /// @param [in] _t1 tetrahedron to be checked
-    /// @param [in] _t2 tetrahedron to be checked
-    /// @param [in] _p point to be inserted
-    /// @param [in] _cid position of a vertex shared by t1 and t2
-    /// @param [in] _t3 tetrahedron to be checked
-    /// @param [in] _t4 tetrahedron to be checked
-    /// @param [out] returns if they are in config44 or not
-    //----------------------------------------------------------------------------------------------------------------------
-    bool config44(Tetrahedron *_t1, Tetrahedron *_t2, ngl::Vec3 _p, int _cid, Tetrahedron *&_t3, Tetrahedron *&_t4);
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that finds if a tetrahedron exist between t1 and t2
-    /// @param [in] _t1 tetrahedron to be checked
-    /// @param [in] _t2 tetrahedron to be checked
-    /// @param [out] returns the third tetrahedron if exists
-    //----------------------------------------------------------------------------------------------------------------------
-    Tetrahedron* findthird(Tetrahedron *_t1, Tetrahedron *_t2);
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that finds if a shared edge exists between t1,t2 and t3
-    /// @param [in] _t1 tetrahedron to be checked
-    /// @param [in] _t2 tetrahedron to be checked
-    /// @param [in] _t3 tetrahedron to be checked
-    //----------------------------------------------------------------------------------------------------------------------
-    void findSharedEdge(Tetrahedron *_t1, Tetrahedron *_t2, Tetrahedron* _t3);
 };
 
 #endif // DELAUNAY_H
@@ -0,0 +1,467 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file DelaunayMesher.cpp
+/// @brief Headless command line mesher built on the GL-free core. It samples an Obj mesh, or reads a point file, builds
+/// the Delaunay tetrahedralization and writes it as TetGen .node/.ele files together with the Voronoi edges as an Obj
+/// of line elements, and on request the bounded Voronoi cells as polygons, the cells clipped to the mesh, the mass
+/// properties of the cells and the adjacency graphs in a binary file. Points given with a radius are triangulated into
+/// the regular tetrahedralization of their spheres, whose dual is the power diagram.
+/// usage : DelaunayMesher [options] input output_prefix
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "MeshSamplerCore.h"
+#include "ngl/Random.h"
+#include "Trace.h"
+#include "AllocStats.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief orders points by their exact coordinates, the vertices of the tetrahedra are copies of the input points
+//----------------------------------------------------------------------------------------------------------------------
+struct ExactLess
+{
+    bool operator()(const ngl::Vec3 &_a, const ngl::Vec3 &_b) const
+    {
+        if(_a.m_x != _b.m_x) { return _a.m_x < _b.m_x; }
+        if(_a.m_y != _b.m_y) { return _a.m_y < _b.m_y; }
+        return _a.m_z < _b.m_z;
+    }
+};
+
+static void usage()
+{
+    fprintf(stderr,"usage : DelaunayMesher [options] input output_prefix\n"
+                   "  input is an Obj mesh (.obj) or a point file with x y z on every line, x y z radius for the\n"
+                   "  power diagram of spheres\n"
+                   "  -d <density>    sampling density, as the density box of the UI (default 1)\n"
+                   "  -m sdf|ray      volume sampling method (default sdf)\n"
+                   "  -l volume|surface  where the samples are placed (default volume)\n"
+                   "  -s <seed>       seed of the sampler (default 1)\n"
+                   "  -c              also write the bounded voronoi cells to <prefix>_cells.obj\n"
+                   "  -k              also write the cells clipped to the mesh to <prefix>_clipped.obj\n"
+                   "  -p              also write the volume, centroid and area of the cells to <prefix>_properties.txt\n"
+                   "  -g              also write the adjacency graphs to <prefix>_graphs.bin\n"
+                   "  -r <iterations> move the points towards a centroidal voronoi tessellation first (default 0),\n"
+                   "                  the radii are then ignored\n"
+                   "  -e <tolerance>  relative energy change that stops the relaxation (default 1e-4)\n"
+                   "  -q              snap the points to a grid over their bounding box and triangulate them with\n"
+                   "                  exact integer predicates, the outputs hold the snapped points\n"
+                   "writes <prefix>.node, <prefix>.ele and <prefix>_voronoi.obj\n");
+}
+
+static bool hasObjExtension(const std::string &_filename)
+{
+    return _filename.size() > 4 && _filename.compare(_filename.size()-4,4,".obj") == 0;
+}
+
+static bool readPoints(const std::string &_filename, std::vector<ngl::Vec3> &o_points, std::vector<ngl::Real> &o_weights)
+{
+    std::ifstream file(_filename.c_str());
+    if(!file.is_open())
+    {
+        return false;
+    }
+    // the weight of a sphere is its squared radius, a line without one is a point of radius 0
+    std::string line;
+    bool weighted = false;
+    while(std::getline(file,line))
+    {
+        ngl::Vec3 p;
+        float radius = 0.0f;
+        int fields = sscanf(line.c_str(),"%f %f %f %f",&p.m_x,&p.m_y,&p.m_z,&radius);
+        if(fields < 3)
+        {
+            continue;
+        }
+        o_points.push_back(p);
+        o_weights.push_back(radius*radius);
+        weighted |= fields == 4;
+    }
+    if(!weighted)
+    {
+        o_weights.clear();
+    }
+    return true;
+}
+
+static bool writeTetrahedra(const std::string &_prefix, const std::vector<ngl::Vec3> &_points,
+                            const std::vector<Tetrahedron*> &_tetrahedra)
+{
+    // duplicated input points collapse onto one vertex, as they do in the triangulation
+    std::map<ngl::Vec3,int,ExactLess> index;
+    std::vector<ngl::Vec3> nodes;
+    for(unsigned int i=0; i<_points.size(); ++i)
+    {
+        if(index.insert(std::make_pair(_points[i],(int)nodes.size()+1)).second)
+        {
+            nodes.push_back(_points[i]);
+        }
+    }
+
+    FILE *node = fopen((_prefix+".node").c_str(),"w");
+    if(node == NULL)
+    {
+        return false;
+    }
+    fprintf(node,"%u 3 0 0\n",(unsigned int)nodes.size());
+    for(unsigned int i=0; i<nodes.size(); ++i)
+    {
+        fprintf(node,"%u %.9g %.9g %.9g\n",i+1,nodes[i].m_x,nodes[i].m_y,nodes[i].m_z);
+    }
+    fclose(node);
+
+    FILE *ele = fopen((_prefix+".ele").c_str(),"w");
+    if(ele == NULL)
+    {
+        return false;
+    }
+    fprintf(ele,"%u 4 0\n",(unsigned int)_tetrahedra.size());
+    for(unsigned int i=0; i<_tetrahedra.size(); ++i)
+    {
+        const ngl::Vec3 *verts = _tetrahedra[i]->getVertexData();
+        fprintf(ele,"%u",i+1);
+        for(int k=0; k<4; ++k)
+        {
+            fprintf(ele," %d",index[verts[k]]);
+        }
+        fprintf(ele,"\n");
+    }
+    fclose(ele);
+    return true;
+}
+
+static bool writeVoronoi(const std::string &_prefix, const Voronoi &_voronoi)
+{
+    FILE *obj = fopen((_prefix+"_voronoi.obj").c_str(),"w");
+    if(obj == NULL)
+    {
+        return false;
+    }
+    // every circumcentre is written once and the edges refer to them
+    const std::vector<ngl::Vec3> &vertices = _voronoi.getVertices();
+    for(unsigned int i=0; i<vertices.size(); ++i)
+    {
+        fprintf(obj,"v %.9g %.9g %.9g\n",vertices[i].m_x,vertices[i].m_y,vertices[i].m_z);
+    }
+    const std::vector<unsigned int> &edges = _voronoi.getEdgeIndices();
+    for(unsigned int i=0; i+1<edges.size(); i+=2)
+    {
+        fprintf(obj,"l %u %u\n",edges[i]+1,edges[i+1]+1);
+    }
+    fclose(obj);
+    return true;
+}
+
+static bool writeCells(const std::string &_prefix, const Voronoi &_voronoi)
+{
+    FILE *obj = fopen((_prefix+"_cells.obj").c_str(),"w");
+    if(obj == NULL)
+    {
+        return false;
+    }
+    // the cells share the voronoi vertices, one group per cell named after its point
+    const std::vector<ngl::Vec3> &vertices = _voronoi.getVertices();
+    for(unsigned int i=0; i<vertices.size(); ++i)
+    {
+        fprintf(obj,"v %.9g %.9g %.9g\n",vertices[i].m_x,vertices[i].m_y,vertices[i].m_z);
+    }
+    const std::vector<VCell> &cells = _voronoi.getCells();
+    for(unsigned int c=0; c<cells.size(); ++c)
+    {
+        if(!cells[c].m_bounded)
+        {
+            continue;
+        }
+        fprintf(obj,"g cell%u\n",c);
+        for(unsigned int f=0; f<cells[c].m_faces.size(); ++f)
+        {
+            const std::vector<unsigned int> &verts = cells[c].m_faces[f].m_vert;
+            fprintf(obj,"f");
+            for(unsigned int k=0; k<verts.size(); ++k)
+            {
+                fprintf(obj," %u",verts[k]+1);
+            }
+            fprintf(obj,"\n");
+        }
+    }
+    fclose(obj);
+    return true;
+}
+
+static bool writeClippedCells(const std::string &_prefix, const std::vector<ClippedCell> &_cells)
+{
+    FILE *obj = fopen((_prefix+"_clipped.obj").c_str(),"w");
+    if(obj == NULL)
+    {
+        return false;
+    }
+    // every cell has its own vertices, they follow each other so a face is offset by the vertices written before
+    unsigned int offset = 1;
+    for(unsigned int c=0; c<_cells.size(); ++c)
+    {
+        if(_cells[c].m_faces.empty())
+        {
+            continue;
+        }
+        fprintf(obj,"g cell%u\n",c);
+        const std::vector<ngl::Vec3> &vertices = _cells[c].m_verts;
+        for(unsigned int i=0; i<vertices.size(); ++i)
+        {
+            fprintf(obj,"v %.9g %.9g %.9g\n",vertices[i].m_x,vertices[i].m_y,vertices[i].m_z);
+        }
+        for(unsigned int f=0; f<_cells[c].m_faces.size(); ++f)
+        {
+            const std::vector<unsigned int> &verts = _cells[c].m_faces[f].m_vert;
+            fprintf(obj,"f");
+            for(unsigned int k=0; k<verts.size(); ++k)
+            {
+                fprintf(obj," %u",verts[k]+offset);
+            }
+            fprintf(obj,"\n");
+        }
+        offset += vertices.size();
+    }
+    fclose(obj);
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief writes 32 bit words in little endian order, whatever the order of the machine
+//----------------------------------------------------------------------------------------------------------------------
+static bool writeWords(FILE *_file, const unsigned int *_words, unsigned int _count)
+{
+    unsigned char buffer[4096];
+    for(unsigned int i=0; i<_count; i+=sizeof(buffer)/4)
+    {
+        unsigned int n = std::min<unsigned int>(_count-i,sizeof(buffer)/4);
+        for(unsigned int k=0; k<n; ++k)
+        {
+            for(int b=0; b<4; ++b)
+            {
+                buffer[4*k+b] = (unsigned char)(_words[i+k]>>(8*b));
+            }
+        }
+        if(fwrite(buffer,4,n,_file) != n)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool writeGraph(FILE *_file, const CSRGraph &_graph)
+{
+    unsigned int sizes[2] = { _graph.nodeCount(), (unsigned int)_graph.m_indices.size() };
+    return writeWords(_file,sizes,2) && writeWords(_file,&_graph.m_offsets[0],_graph.m_offsets.size()) &&
+           (_graph.m_indices.empty() || writeWords(_file,&_graph.m_indices[0],_graph.m_indices.size()));
+}
+
+static bool writeGraphs(const std::string &_prefix, const TetGraphs &_graphs)
+{
+    FILE *file = fopen((_prefix+"_graphs.bin").c_str(),"wb");
+    if(file == NULL)
+    {
+        return false;
+    }
+    // the layout is in the readme, the version goes up whenever it changes
+    unsigned int header[3] = { 1, _graphs.getVertexVertex().nodeCount(), _graphs.getTetTet().nodeCount() };
+    bool written = fwrite("TETGRAPH",1,8,file) == 8 && writeWords(file,header,3) &&
+                   writeGraph(file,_graphs.getVertexVertex()) && writeGraph(file,_graphs.getVertexTet()) &&
+                   writeGraph(file,_graphs.getTetTet());
+    return fclose(file) == 0 && written;
+}
+
+static bool writeProperties(const std::string &_prefix, const CellProperties &_properties)
+{
+    FILE *file = fopen((_prefix+"_properties.txt").c_str(),"w");
+    if(file == NULL)
+    {
+        return false;
+    }
+    fprintf(file,"# point bounded volume centroid_x centroid_y centroid_z area faces\n");
+    for(unsigned int s=0; s<_properties.siteCount(); ++s)
+    {
+        const ngl::Vec3 &centroid = _properties.getCentroids()[s];
+        fprintf(file,"%u %d %.9g %.9g %.9g %.9g %.9g %u\n",s,_properties.getBounded()[s],_properties.getVolumes()[s],
+                centroid.m_x,centroid.m_y,centroid.m_z,_properties.getAreas()[s],
+                _properties.getFaceOffsets()[s+1]-_properties.getFaceOffsets()[s]);
+    }
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    TRACE_THREAD_NAME("main");
+    int density = 1;
+    int method = 0;
+    int location = 0;
+    unsigned int seed = 1;
+    bool cells = false;
+    bool clipped = false;
+    bool properties = false;
+    bool graphs = false;
+    int iterations = 0;
+    double tolerance = 1e-4;
+    bool snap = false;
+    std::vector<std::string> files;
+    for(int i=1; i<argc; ++i)
+    {
+        bool hasValue = i+1 < argc;
+        if(strcmp(argv[i],"-d") == 0 && hasValue)
+        {
+            density = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i],"-m") == 0 && hasValue)
+        {
+            method = strcmp(argv[++i],"ray") == 0 ? 1 : 0;
+        }
+        else if(strcmp(argv[i],"-l") == 0 && hasValue)
+        {
+            location = strcmp(argv[++i],"surface") == 0 ? 1 : 0;
+        }
+        else if(strcmp(argv[i],"-s") == 0 && hasValue)
+        {
+            seed = strtoul(argv[++i],NULL,10);
+        }
+        else if(strcmp(argv[i],"-c") == 0)
+        {
+            cells = true;
+        }
+        else if(strcmp(argv[i],"-k") == 0)
+        {
+            clipped = true;
+        }
+        else if(strcmp(argv[i],"-p") == 0)
+        {
+            properties = true;
+        }
+        else if(strcmp(argv[i],"-g") == 0)
+        {
+            graphs = true;
+        }
+        else if(strcmp(argv[i],"-r") == 0 && hasValue)
+        {
+            iterations = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i],"-e") == 0 && hasValue)
+        {
+            tolerance = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i],"-q") == 0)
+        {
+            snap = true;
+        }
+        else if(argv[i][0] == '-')
+        {
+            usage();
+            return EXIT_FAILURE;
+        }
+        else
+        {
+            files.push_back(argv[i]);
+        }
+    }
+    if(files.size() != 2 || density < 1 || iterations < 0)
+    {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    MeshSamplerCore sampler;
+    sampler.setSnapToGrid(snap);
+    ngl::Random::instance()->setSeed(seed);
+    if(hasObjExtension(files[0]))
+    {
+        if(!sampler.loadObj(files[0]))
+        {
+            return EXIT_FAILURE;
+        }
+        sampler.setDensity(density);
+        sampler.setMethod(method);
+        sampler.setPointLocationType(location);
+        sampler.SampleMesh();
+    }
+    else
+    {
+        std::vector<ngl::Vec3> points;
+        std::vector<ngl::Real> weights;
+        if(!readPoints(files[0],points,weights))
+        {
+            fprintf(stderr,"Can't open %s\n",files[0].c_str());
+            return EXIT_FAILURE;
+        }
+        sampler.setPoints(points,weights);
+    }
+    if(sampler.getPoints().size() < 4)
+    {
+        fprintf(stderr,"Need at least 4 points, got %u\n",(unsigned int)sampler.getPoints().size());
+        return EXIT_FAILURE;
+    }
+
+    if(iterations > 0)
+    {
+        int moved = sampler.relaxCVT(iterations,tolerance);
+        const std::vector<double> &energies = sampler.getCVTEnergies();
+        printf("relaxed in %d iterations, energy %g to %g\n",moved,energies.front(),energies.back());
+    }
+    else
+    {
+        sampler.delaunay();
+    }
+    const std::string &prefix = files[1];
+    if(!writeTetrahedra(prefix,sampler.getPoints(),sampler.getTetrahedra()) ||
+       !writeVoronoi(prefix,*sampler.getVoronoi()))
+    {
+        fprintf(stderr,"Can't write %s\n",prefix.c_str());
+        return EXIT_FAILURE;
+    }
+    if(cells)
+    {
+        sampler.buildVoronoiCells();
+        if(!writeCells(prefix,*sampler.getVoronoi()))
+        {
+            fprintf(stderr,"Can't write %s\n",prefix.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+    if(clipped)
+    {
+        sampler.clipVoronoiCells();
+        if(!writeClippedCells(prefix,sampler.getClippedCells()))
+        {
+            fprintf(stderr,"Can't write %s\n",prefix.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+    if(properties)
+    {
+        sampler.computeCellProperties();
+        if(!writeProperties(prefix,sampler.getCellProperties()))
+        {
+            fprintf(stderr,"Can't write %s\n",prefix.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+    if(graphs)
+    {
+        sampler.buildGraphs();
+        if(!writeGraphs(prefix,sampler.getGraphs()))
+        {
+            fprintf(stderr,"Can't write %s\n",prefix.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+    printf("%u points, %u tetrahedra, %u voronoi edges\n",(unsigned int)sampler.getPoints().size(),
+           (unsigned int)sampler.getTetrahedra().size(),(unsigned int)sampler.getVoronoi()->getEdgeIndices().size()/2);
+    if(!sampler.getWeights().empty())
+    {
+        printf("%d redundant points\n",sampler.getRedundantCount());
+    }
+    AllocStats::report(stderr,sampler.getTetrahedra().size());
+    return EXIT_SUCCESS;
+}
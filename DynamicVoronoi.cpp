@@ -0,0 +1,309 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file DynamicVoronoi.cpp
+/// @brief Class that keeps the voronoi edges of a changing tetrahedralization up to date
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "DynamicVoronoi.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstring>
+
+// The snapshots carry no neighbours, only the vertices of each tetrahedron, but the vertices are copies of the input
+// points so the two tetrahedra on a face give it exactly the same three positions. Every face of a live tetrahedron
+// is kept in a hash table keyed on its sorted vertices, and a face that holds two tetrahedra is a voronoi edge between
+// their circumcentres. A snapshot is taken between two insertions, so its live set is a valid tetrahedralization and
+// no face ever holds more than two once the killed tetrahedra are removed before the created ones are added.
+// The table is probed linearly and a removal moves the following faces back rather than leaving a marker, so the
+// churn of a build, where most tetrahedra are killed soon after they are made, never fills it with dead buckets
+
+namespace
+{
+
+bool positionLess(const ngl::Vec3 &_a, const ngl::Vec3 &_b)
+{
+    if(_a.m_x != _b.m_x) { return _a.m_x < _b.m_x; }
+    if(_a.m_y != _b.m_y) { return _a.m_y < _b.m_y; }
+    return _a.m_z < _b.m_z;
+}
+
+bool positionEqual(const ngl::Vec3 &_a, const ngl::Vec3 &_b)
+{
+    return _a.m_x == _b.m_x && _a.m_y == _b.m_y && _a.m_z == _b.m_z;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief mixes the bits of a coordinate into a hash
+//----------------------------------------------------------------------------------------------------------------------
+inline unsigned int mix(unsigned int _hash, float _value)
+{
+    // 0 and -0 compare equal, so they must hash the same
+    if(_value == 0.0f)
+    {
+        _value = 0.0f;
+    }
+    unsigned int bits;
+    memcpy(&bits,&_value,sizeof(bits));
+    return (_hash^bits)*16777619u;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the hash of the three sorted vertices of a face
+//----------------------------------------------------------------------------------------------------------------------
+unsigned int hashFace(const ngl::Vec3 *_v)
+{
+    unsigned int hash = 2166136261u;
+    for(int i=0; i<3; ++i)
+    {
+        hash = mix(hash,_v[i].m_x);
+        hash = mix(hash,_v[i].m_y);
+        hash = mix(hash,_v[i].m_z);
+    }
+    // the low bits of the coordinates are all zero on a grid, so the bits are mixed down before the table masks them
+    hash ^= hash>>16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash>>13;
+    hash *= 0xc2b2ae35u;
+    return hash^(hash>>16);
+}
+
+} // end anonymous namespace
+
+DynamicVoronoi::DynamicVoronoi()
+{
+    clear();
+}
+
+void DynamicVoronoi::clear()
+{
+    m_tetSlot.clear();
+    m_liveTets.clear();
+    m_freeTets.clear();
+    m_faces.clear();
+    m_faceCount = 0;
+    m_edges.clear();
+    m_freeSlots.clear();
+    m_dirtySlots.clear();
+    m_edgeCount = 0;
+    m_tetCount = 0;
+}
+
+void DynamicVoronoi::apply(const TetDelta &_delta)
+{
+    TRACE_ZONE("DynamicVoronoi::apply");
+    // a tetrahedron created and killed within the same snapshot never becomes part of the diagram, the ids of a build
+    // are never reused so it is enough to look it up among the killed ones
+    std::vector<int> killed(_delta.m_killed);
+    std::sort(killed.begin(),killed.end());
+    for(unsigned int i=0; i<killed.size(); ++i)
+    {
+        removeTet(killed[i]);
+    }
+    for(unsigned int i=0; i<_delta.m_created.size(); ++i)
+    {
+        const TetRecord &r = _delta.m_created[i];
+        if(!std::binary_search(killed.begin(),killed.end(),r.m_tetid))
+        {
+            addTet(r);
+        }
+    }
+}
+
+DynamicVoronoi::FaceKey DynamicVoronoi::faceKey(const ngl::Vec3 *_verts, int _i)
+{
+    FaceKey key;
+    int k = 0;
+    for(int j=0; j<4; ++j)
+    {
+        if(j != _i)
+        {
+            key.m_v[k++] = _verts[j];
+        }
+    }
+    // three elements, so a small sorting network
+    if(positionLess(key.m_v[1],key.m_v[0])) { std::swap(key.m_v[0],key.m_v[1]); }
+    if(positionLess(key.m_v[2],key.m_v[1])) { std::swap(key.m_v[1],key.m_v[2]); }
+    if(positionLess(key.m_v[1],key.m_v[0])) { std::swap(key.m_v[0],key.m_v[1]); }
+    return key;
+}
+
+unsigned int DynamicVoronoi::findFace(const FaceKey &_key) const
+{
+    unsigned int mask = m_faces.size()-1;
+    unsigned int bucket = hashFace(_key.m_v)&mask;
+    while(m_faces[bucket].m_tets[0] >= 0)
+    {
+        const FaceKey &key = m_faces[bucket].m_key;
+        if(positionEqual(key.m_v[0],_key.m_v[0]) && positionEqual(key.m_v[1],_key.m_v[1]) &&
+           positionEqual(key.m_v[2],_key.m_v[2]))
+        {
+            break;
+        }
+        bucket = (bucket+1)&mask;
+    }
+    return bucket;
+}
+
+void DynamicVoronoi::eraseFace(unsigned int _bucket)
+{
+    unsigned int mask = m_faces.size()-1;
+    unsigned int hole = _bucket;
+    for(unsigned int next=(hole+1)&mask; m_faces[next].m_tets[0] >= 0; next=(next+1)&mask)
+    {
+        // a face moves into the hole unless its home bucket lies after the hole, it would then not be found there
+        unsigned int home = hashFace(m_faces[next].m_key.m_v)&mask;
+        if(((next-home)&mask) >= ((next-hole)&mask))
+        {
+            m_faces[hole] = m_faces[next];
+            hole = next;
+        }
+    }
+    m_faces[hole].m_tets[0] = -1;
+    --m_faceCount;
+}
+
+void DynamicVoronoi::growFaces()
+{
+    std::vector<FaceEntry> old;
+    old.swap(m_faces);
+    FaceEntry empty;
+    empty.m_tets[0] = -1;
+    empty.m_tets[1] = -1;
+    empty.m_slot = -1;
+    m_faces.assign(std::max<size_t>(2*old.size(),1024),empty);
+    for(unsigned int i=0; i<old.size(); ++i)
+    {
+        if(old[i].m_tets[0] >= 0)
+        {
+            m_faces[findFace(old[i].m_key)] = old[i];
+        }
+    }
+}
+
+void DynamicVoronoi::addTet(const TetRecord &_record)
+{
+    int id = _record.m_tetid;
+    if(id < 0)
+    {
+        return;
+    }
+    if(id >= (int)m_tetSlot.size())
+    {
+        m_tetSlot.resize(id+1,-1);
+    }
+    if(m_tetSlot[id] >= 0)
+    {
+        return;
+    }
+    unsigned int slot;
+    if(m_freeTets.empty())
+    {
+        slot = m_liveTets.size();
+        m_liveTets.resize(slot+1);
+    }
+    else
+    {
+        slot = m_freeTets.back();
+        m_freeTets.pop_back();
+    }
+    m_tetSlot[id] = slot;
+    LiveTet &t = m_liveTets[slot];
+    for(int i=0; i<4; ++i)
+    {
+        t.m_verts[i] = _record.m_verts[i];
+    }
+    // the same centre as the one Voronoi takes from the finished tetrahedron, the circumcentre or, with weights, the
+    // power centre
+    Tetrahedron shape(t.m_verts[0],t.m_verts[1],t.m_verts[2],t.m_verts[3]);
+    shape.setWeights(_record.m_weights);
+    t.m_centre = shape.getCirCenter();
+    ++m_tetCount;
+
+    for(int i=0; i<4; ++i)
+    {
+        // at most half full, so the probes stay short
+        if(2*(m_faceCount+1) > m_faces.size())
+        {
+            growFaces();
+        }
+        FaceKey key = faceKey(t.m_verts,i);
+        FaceEntry &face = m_faces[findFace(key)];
+        if(face.m_tets[0] < 0)
+        {
+            face.m_key = key;
+            face.m_tets[0] = slot;
+            face.m_tets[1] = -1;
+            face.m_slot = -1;
+            ++m_faceCount;
+        }
+        else if(face.m_tets[1] < 0)
+        {
+            face.m_tets[1] = slot;
+            face.m_slot = addEdge(m_liveTets[face.m_tets[0]].m_centre,t.m_centre);
+        }
+    }
+}
+
+void DynamicVoronoi::removeTet(int _tetid)
+{
+    if(_tetid < 0 || _tetid >= (int)m_tetSlot.size() || m_tetSlot[_tetid] < 0)
+    {
+        return;
+    }
+    int slot = m_tetSlot[_tetid];
+    const LiveTet &t = m_liveTets[slot];
+    for(int i=0; i<4; ++i)
+    {
+        unsigned int bucket = findFace(faceKey(t.m_verts,i));
+        FaceEntry &face = m_faces[bucket];
+        if(face.m_tets[0] < 0)
+        {
+            continue;
+        }
+        if(face.m_slot >= 0)
+        {
+            removeEdge(face.m_slot);
+            face.m_slot = -1;
+        }
+        if(face.m_tets[0] == slot)
+        {
+            face.m_tets[0] = face.m_tets[1];
+        }
+        face.m_tets[1] = -1;
+        if(face.m_tets[0] < 0)
+        {
+            eraseFace(bucket);
+        }
+    }
+    m_tetSlot[_tetid] = -1;
+    m_freeTets.push_back(slot);
+    --m_tetCount;
+}
+
+unsigned int DynamicVoronoi::addEdge(const ngl::Vec3 &_a, const ngl::Vec3 &_b)
+{
+    unsigned int slot;
+    if(m_freeSlots.empty())
+    {
+        slot = slotCount();
+        m_edges.resize(m_edges.size()+2);
+    }
+    else
+    {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    m_edges[2*slot] = _a;
+    m_edges[2*slot+1] = _b;
+    m_dirtySlots.push_back(slot);
+    ++m_edgeCount;
+    return slot;
+}
+
+void DynamicVoronoi::removeEdge(unsigned int _slot)
+{
+    // a line with both ends on one point produces no fragments
+    m_edges[2*_slot+1] = m_edges[2*_slot];
+    m_freeSlots.push_back(_slot);
+    m_dirtySlots.push_back(_slot);
+    --m_edgeCount;
+}
@@ -0,0 +1,168 @@
+#ifndef DYNAMICVORONOI_H
+#define DYNAMICVORONOI_H
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file DynamicVoronoi.h
+/// @author Maria Vineeta Bagya Seelan
+/// @version 1.1
+/// @date 16/08/13
+/// Revision History :
+/// Initial Version 16/08/13
+/// 1.1 the vertex of a tetrahedron of a weighted build is its power centre, from the weights in its record
+/// @class DynamicVoronoi
+/// @brief the voronoi vertices and edges of a tetrahedralization that is still changing. It is fed the TetDelta
+/// @brief snapshots a progressive Delaunay build publishes and only touches the edges around the created and killed
+/// @brief tetrahedra, so an update costs in proportion to the change rather than to the mesh. The edges live in
+/// @brief fixed slots that are reused once freed, and the slots changed since the last upload are listed so a renderer
+/// @brief can upload just those
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Delaunay.h"
+
+class DynamicVoronoi
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief Constructor for an empty DynamicVoronoi
+    //----------------------------------------------------------------------------------------------------------------------
+    DynamicVoronoi();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that forgets every tetrahedron, the ids of a new build say nothing about the old one
+    //----------------------------------------------------------------------------------------------------------------------
+    void clear();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that applies the changes of a snapshot, the killed tetrahedra take their edges with them and the
+    /// created ones get an edge to every neighbour already known
+    /// @param [in] _delta the changes since the last snapshot, ids it kills that were never created are ignored
+    //----------------------------------------------------------------------------------------------------------------------
+    void apply(const TetDelta &_delta);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the edge slots as pairs of end points, slot i is entries 2i and 2i+1. A free slot has both
+    /// end points equal so it draws nothing
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<ngl::Vec3>& getEdges() const { return m_edges; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the number of edge slots, free ones included
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int slotCount() const { return m_edges.size()/2; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessors for the number of edges and of tetrahedra, each one a voronoi vertex
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int edgeCount() const { return m_edgeCount; }
+    unsigned int tetCount() const { return m_tetCount; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the slots changed since the last clearDirty, possibly repeated and in no order
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<unsigned int>& getDirtySlots() const { return m_dirtySlots; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that empties the list of changed slots, called once they have been uploaded
+    //----------------------------------------------------------------------------------------------------------------------
+    void clearDirty() { m_dirtySlots.clear(); }
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a triangle given by its vertices in lexicographic order, so both tetrahedra on it give the same key
+    //----------------------------------------------------------------------------------------------------------------------
+    struct FaceKey
+    {
+        ngl::Vec3 m_v[3];
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a bucket of the face table, it holds the tetrahedra on a face, -1 when there is none, and the slot of the
+    /// edge between them, -1 until there are two. A bucket whose first tetrahedron is -1 is empty
+    //----------------------------------------------------------------------------------------------------------------------
+    struct FaceEntry
+    {
+        FaceKey m_key;
+        int m_tets[2];
+        int m_slot;
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a live tetrahedron, its vertices give the keys of its faces and its circumcentre, or its power centre in a
+    /// weighted build, is its voronoi vertex
+    //----------------------------------------------------------------------------------------------------------------------
+    struct LiveTet
+    {
+        ngl::Vec3 m_verts[4];
+        ngl::Vec3 m_centre;
+    };
+
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the live tetrahedron of every id, -1 if the id is not live
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<int> m_tetSlot;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the live tetrahedra, the free entries are reused before new ones are added
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<LiveTet> m_liveTets;
+    std::vector<unsigned int> m_freeTets;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the faces of the live tetrahedra in an open addressed hash table whose size is a power of two,
+    /// with the number of buckets in use
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<FaceEntry> m_faces;
+    unsigned int m_faceCount;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the end points of every edge slot
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<ngl::Vec3> m_edges;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the free edge slots, reused before new ones are added
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<unsigned int> m_freeSlots;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the slots changed since the last clearDirty
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<unsigned int> m_dirtySlots;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of edges and of live tetrahedra
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int m_edgeCount;
+    unsigned int m_tetCount;
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that builds the key of the face opposite a vertex
+    /// @param [in] _verts the four vertices of the tetrahedron
+    /// @param [in] _i the vertex opposite the face
+    //----------------------------------------------------------------------------------------------------------------------
+    static FaceKey faceKey(const ngl::Vec3 *_verts, int _i);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that finds the bucket of a face
+    /// @param [in] _key the face
+    /// @param [out] returns the bucket holding the face, or the empty bucket it would go in
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int findFace(const FaceKey &_key) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that empties a bucket and moves back the faces that were pushed past it
+    /// @param [in] _bucket the bucket
+    //----------------------------------------------------------------------------------------------------------------------
+    void eraseFace(unsigned int _bucket);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that doubles the face table, or creates it
+    //----------------------------------------------------------------------------------------------------------------------
+    void growFaces();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that adds a created tetrahedron and the edges to its known neighbours
+    /// @param [in] _record the tetrahedron
+    //----------------------------------------------------------------------------------------------------------------------
+    void addTet(const TetRecord &_record);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that removes a killed tetrahedron and its edges
+    /// @param [in] _tetid the id of the tetrahedron
+    //----------------------------------------------------------------------------------------------------------------------
+    void removeTet(int _tetid);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that puts an edge in a free slot, or a new one
+    /// @param [in] _a the first end point
+    /// @param [in] _b the second end point
+    /// @param [out] returns the slot
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int addEdge(const ngl::Vec3 &_a, const ngl::Vec3 &_b);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that frees an edge slot
+    //----------------------------------------------------------------------------------------------------------------------
+    void removeEdge(unsigned int _slot);
+};
+
+#endif // DYNAMICVORONOI_H
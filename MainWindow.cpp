@@ -7,6 +7,7 @@
 #include "Renderer.h"
 #include "ui_MainWindow.h"
 #include "qfiledialog.h"
+#include <QtGui/QStatusBar>
 
 //----------------------------------------------------------------------------------------------------------------------
 MainWindow::MainWindow(
@@ -36,6 +37,7 @@ MainWindow::MainWindow(
   connect(m_ui->m_vClear, SIGNAL(clicked()), m_gl, SLOT(clearVoronoi()));
   connect(m_ui->m_dWireframe, SIGNAL(stateChanged(int)), m_gl, SLOT(isDelaunayWireframeClicked(int)));
   connect(m_ui->m_pointOn, SIGNAL(activated(int)), this, SLOT(setPointType(int)));
+  connect(m_gl, SIGNAL(statusChanged(QString)), statusBar(), SLOT(showMessage(QString)));
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -63,6 +65,10 @@ void MainWindow::keyPressEvent(
   case Qt::Key_F : showFullScreen(); break;
   // show windowed
   case Qt::Key_N : showNormal(); break;
+  // show the triangulation while it is being built
+  case Qt::Key_P : m_gl->toggleProgressive(); break;
+  // snap the points to an integer grid and triangulate them exactly
+  case Qt::Key_G : m_gl->toggleSnapToGrid(); break;
   default : break;
   }
   // finally update the GLWindow and re-draw
@@ -0,0 +1,656 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file MeshBench.cpp
+/// @brief End to end benchmark of the headless core. It times the three sampling modes on an Obj mesh, the SDF one up to
+/// 10^7 points on a sphere of 81920 triangles when no mesh is given, rays cast through the triangle hierarchy of finer and finer spheres against testing every triangle,
+/// the Delaunay build on uniform, clustered, surface-only and grid-degenerate point sets of growing size, split into the insertion
+/// and the final clean up, the Voronoi construction, the parallel build of the Voronoi cells, of their mass
+/// properties and of the adjacency graphs. A progressive build of the uniform points then times the upkeep of its voronoi edges from the snapshots
+/// against a full rebuild, and the uniform points given random radii time the regular triangulation against the
+/// unweighted one. The results are written as JSON with the points/s, tets/s,
+/// per-phase times and the peak resident set size of the process after each run. Built with DELAUNAY_ALLOC_STATS the
+/// heap bytes held by each triangulation are added, with a table of the allocations per phase at the end.
+/// usage : MeshBench [-i mesh.obj] [-n min exponent] [-x max exponent] [-b budget seconds] [-s seed] [-o out.json]
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "MeshSamplerCore.h"
+#include "DynamicVoronoi.h"
+#include "TriangleBVH.h"
+#include "ngl/Random.h"
+#include "Trace.h"
+#include "AllocStats.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+static double now()
+{
+    timeval tv;
+    gettimeofday(&tv,NULL);
+    return tv.tv_sec + 1e-6*tv.tv_usec;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief peak resident set size of the process so far in kilobytes
+//----------------------------------------------------------------------------------------------------------------------
+static long peakRSS()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF,&usage);
+    return usage.ru_maxrss;
+}
+
+static float uniform()
+{
+    return rand()/(float)RAND_MAX;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief records when Delaunay::compute moves from the insertion to the clean up, the first report for the whole
+/// point count comes from the clean up loops
+//----------------------------------------------------------------------------------------------------------------------
+class PhaseClock : public DelaunayProgress
+{
+public:
+    PhaseClock() : m_finalizeStart(0.0) {}
+    bool report(int _inserted, int _total, int)
+    {
+        if(_inserted == _total && m_finalizeStart == 0.0)
+        {
+            m_finalizeStart = now();
+        }
+        return true;
+    }
+    double m_finalizeStart;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief takes every snapshot of a progressive build and applies it to a DynamicVoronoi, timing the updates alone
+//----------------------------------------------------------------------------------------------------------------------
+class DeltaClock : public DelaunayProgress
+{
+public:
+    DeltaClock() : m_snapshots(0), m_created(0), m_killed(0), m_seconds(0.0) {}
+    bool report(int, int, int) { return true; }
+    bool isProgressive() { return true; }
+    void publish(TetDelta &_delta)
+    {
+        m_delta.clear();
+        m_delta.m_created.swap(_delta.m_created);
+        m_delta.m_killed.swap(_delta.m_killed);
+        m_created += m_delta.m_created.size();
+        m_killed += m_delta.m_killed.size();
+        ++m_snapshots;
+        double start = now();
+        m_voronoi.apply(m_delta);
+        m_voronoi.clearDirty();
+        m_seconds += now()-start;
+    }
+    DynamicVoronoi m_voronoi;
+    TetDelta m_delta;
+    unsigned int m_snapshots;
+    unsigned int m_created;
+    unsigned int m_killed;
+    double m_seconds;
+};
+
+enum Workload { UNIFORM, CLUSTERED, SURFACE, GRID, WORKLOADS };
+static const char *s_workloadNames[WORKLOADS] = { "uniform", "clustered", "surface", "grid" };
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief builds _count points of a workload, all inside [-1,1]^3
+//----------------------------------------------------------------------------------------------------------------------
+static std::vector<ngl::Vec3> makePoints(Workload _workload, int _count)
+{
+    std::vector<ngl::Vec3> points;
+    points.reserve(_count);
+    switch(_workload)
+    {
+        case UNIFORM :
+            for(int i=0; i<_count; ++i)
+            {
+                points.push_back(ngl::Vec3(2*uniform()-1,2*uniform()-1,2*uniform()-1));
+            }
+            break;
+        case CLUSTERED :
+        {
+            // a few tight gaussian blobs, the walk crosses long thin tetrahedra between them
+            const int clusters = 8;
+            ngl::Vec3 centres[clusters];
+            for(int c=0; c<clusters; ++c)
+            {
+                centres[c] = ngl::Vec3(1.6*uniform()-0.8,1.6*uniform()-0.8,1.6*uniform()-0.8);
+            }
+            for(int i=0; i<_count; ++i)
+            {
+                ngl::Vec3 p = centres[i%clusters];
+                for(int k=0; k<3; ++k)
+                {
+                    // Box-Muller
+                    float g = sqrt(-2*log(std::max(uniform(),1e-7f)))*cos(2*M_PI*uniform());
+                    p[k] = std::max(-1.0f,std::min(1.0f,p[k]+0.05f*g));
+                }
+                points.push_back(p);
+            }
+            break;
+        }
+        case SURFACE :
+            // points on the unit sphere, as the surface sampling gives, every one is on the hull
+            for(int i=0; i<_count; ++i)
+            {
+                ngl::Vec3 p;
+                do
+                {
+                    p = ngl::Vec3(2*uniform()-1,2*uniform()-1,2*uniform()-1);
+                }
+                while(p.lengthSquared() < 1e-4 || p.lengthSquared() > 1);
+                p.normalize();
+                points.push_back(p);
+            }
+            break;
+        case GRID :
+        {
+            // a regular lattice, every cell has eight cospherical and six coplanar points
+            int side = std::max(2,(int)ceil(pow((double)_count,1.0/3.0)));
+            for(int i=0; i<_count; ++i)
+            {
+                int x = i%side;
+                int y = (i/side)%side;
+                int z = i/(side*side);
+                points.push_back(ngl::Vec3(2.0f*x/(side-1)-1,2.0f*y/(side-1)-1,2.0f*z/(side-1)-1));
+            }
+            break;
+        }
+        default : break;
+    }
+    return points;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the triangles of an icosahedron subdivided _levels times on the unit sphere, three vertices each
+//----------------------------------------------------------------------------------------------------------------------
+static std::vector<ngl::Vec3> makeSphere(int _levels)
+{
+    const float t = (1+sqrt(5.0f))/2;
+    const float v[12][3] = { {-1,t,0},{1,t,0},{-1,-t,0},{1,-t,0},{0,-1,t},{0,1,t},
+                             {0,-1,-t},{0,1,-t},{t,0,-1},{t,0,1},{-t,0,-1},{-t,0,1} };
+    const int f[20][3] = { {0,11,5},{0,5,1},{0,1,7},{0,7,10},{0,10,11},{1,5,9},{5,11,4},{11,10,2},{10,7,6},{7,1,8},
+                           {3,9,4},{3,4,2},{3,2,6},{3,6,8},{3,8,9},{4,9,5},{2,4,11},{6,2,10},{8,6,7},{9,8,1} };
+    std::vector<ngl::Vec3> tris;
+    for(int i=0; i<20; ++i)
+    {
+        for(int j=0; j<3; ++j)
+        {
+            ngl::Vec3 p(v[f[i][j]][0],v[f[i][j]][1],v[f[i][j]][2]);
+            p.normalize();
+            tris.push_back(p);
+        }
+    }
+    for(int l=0; l<_levels; ++l)
+    {
+        std::vector<ngl::Vec3> finer;
+        for(unsigned int i=0; i<tris.size(); i+=3)
+        {
+            ngl::Vec3 a = tris[i], b = tris[i+1], c = tris[i+2];
+            ngl::Vec3 ab = (a+b)*0.5f, bc = (b+c)*0.5f, ca = (c+a)*0.5f;
+            ab.normalize();
+            bc.normalize();
+            ca.normalize();
+            const ngl::Vec3 split[12] = { a,ab,ca, ab,b,bc, ca,bc,c, ab,bc,ca };
+            finer.insert(finer.end(),split,split+12);
+        }
+        tris.swap(finer);
+    }
+    return tris;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief writes a subdivided icosahedron to _filename, used when no mesh is given so the sampling always has an input
+//----------------------------------------------------------------------------------------------------------------------
+static bool writeSphere(const std::string &_filename, int _levels)
+{
+    std::vector<ngl::Vec3> tris = makeSphere(_levels);
+    FILE *obj = fopen(_filename.c_str(),"w");
+    if(obj == NULL)
+    {
+        return false;
+    }
+    // every corner gets its own vertex, the sampler only needs the triangles
+    for(unsigned int i=0; i<tris.size(); ++i)
+    {
+        fprintf(obj,"v %.9g %.9g %.9g\n",tris[i].m_x,tris[i].m_y,tris[i].m_z);
+    }
+    for(unsigned int i=0; i<tris.size(); i+=3)
+    {
+        fprintf(obj,"f %u %u %u\n",i+1,i+2,i+3);
+    }
+    fclose(obj);
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief collects the JSON records, one object per run
+//----------------------------------------------------------------------------------------------------------------------
+class Report
+{
+public:
+    Report() : m_first(true) {}
+    void begin(FILE *_out, const char *_mesh, unsigned int _seed)
+    {
+        m_out = _out;
+        fprintf(m_out,"{\n  \"benchmark\": \"MeshBench\",\n  \"mesh\": \"%s\",\n  \"seed\": %u,\n  \"runs\": [",_mesh,_seed);
+    }
+    void sample(const char *_mode, int _density, unsigned int _points, double _seconds)
+    {
+        open();
+        fprintf(m_out,"\"phase\": \"sample\", \"mode\": \"%s\", \"density\": %d, \"points\": %u, \"seconds\": %.6f, "
+                "\"points_per_s\": %.1f, \"peak_rss_kb\": %ld}",_mode,_density,_points,_seconds,rate(_points,_seconds),
+                peakRSS());
+    }
+    void rays(unsigned int _triangles, unsigned int _rays, unsigned int _hits, double _build, double _seconds,
+              unsigned int _bruteRays, double _bruteSeconds)
+    {
+        open();
+        fprintf(m_out,"\"phase\": \"rays\", \"triangles\": %u, \"rays\": %u, \"hits\": %u, \"build_seconds\": %.6f, "
+                "\"seconds\": %.6f, \"rays_per_s\": %.1f, \"brute_rays\": %u, \"brute_seconds\": %.6f, "
+                "\"brute_rays_per_s\": %.1f, \"peak_rss_kb\": %ld}",_triangles,_rays,_hits,_build,_seconds,
+                rate(_rays,_seconds),_bruteRays,_bruteSeconds,rate(_bruteRays,_bruteSeconds),peakRSS());
+    }
+    void triangulate(const char *_workload, unsigned int _points, unsigned int _tets, double _insert, double _finalize,
+                     long long _heapBytes)
+    {
+        double seconds = _insert+_finalize;
+        open();
+        fprintf(m_out,"\"phase\": \"triangulate\", \"workload\": \"%s\", \"points\": %u, \"tets\": %u, "
+                "\"seconds\": %.6f, \"insert_seconds\": %.6f, \"finalize_seconds\": %.6f, \"points_per_s\": %.1f, "
+                "\"tets_per_s\": %.1f, \"peak_rss_kb\": %ld",_workload,_points,_tets,seconds,_insert,_finalize,
+                rate(_points,seconds),rate(_tets,seconds),peakRSS());
+        // the heap is only known when the allocation accounting is compiled in
+        if(AllocStats::peakBytes() > 0)
+        {
+            fprintf(m_out,", \"heap_bytes\": %lld, \"heap_bytes_per_tet\": %.1f",_heapBytes,
+                    _tets > 0 ? (double)_heapBytes/_tets : 0.0);
+        }
+        fprintf(m_out,"}");
+    }
+    void voronoi(const char *_workload, unsigned int _points, unsigned int _tets, unsigned int _edges, double _seconds)
+    {
+        open();
+        fprintf(m_out,"\"phase\": \"voronoi\", \"workload\": \"%s\", \"points\": %u, \"tets\": %u, \"edges\": %u, "
+                "\"seconds\": %.6f, \"tets_per_s\": %.1f, \"peak_rss_kb\": %ld}",_workload,_points,_tets,_edges,
+                _seconds,rate(_tets,_seconds),peakRSS());
+    }
+    void cells(const char *_workload, unsigned int _points, unsigned int _bounded, unsigned int _faces,
+               double _seconds)
+    {
+        open();
+        fprintf(m_out,"\"phase\": \"cells\", \"workload\": \"%s\", \"points\": %u, \"bounded_cells\": %u, "
+                "\"faces\": %u, \"threads\": %u, \"seconds\": %.6f, \"cells_per_s\": %.1f, \"peak_rss_kb\": %ld}",
+                _workload,_points,_bounded,_faces,Parallel::threadCount(),_seconds,rate(_points,_seconds),peakRSS());
+    }
+    void properties(const char *_workload, unsigned int _points, unsigned int _bounded, unsigned int _faces,
+                    double _seconds)
+    {
+        open();
+        fprintf(m_out,"\"phase\": \"properties\", \"workload\": \"%s\", \"points\": %u, \"bounded_cells\": %u, "
+                "\"faces\": %u, \"threads\": %u, \"seconds\": %.6f, \"cells_per_s\": %.1f, \"peak_rss_kb\": %ld}",
+                _workload,_points,_bounded,_faces,Parallel::threadCount(),_seconds,rate(_points,_seconds),peakRSS());
+    }
+    void graphs(const char *_workload, unsigned int _points, const TetGraphs &_graphs, double _seconds)
+    {
+        open();
+        fprintf(m_out,"\"phase\": \"graphs\", \"workload\": \"%s\", \"points\": %u, \"vertex_vertex\": %u, "
+                "\"vertex_tet\": %u, \"tet_tet\": %u, \"threads\": %u, \"seconds\": %.6f, \"peak_rss_kb\": %ld}",
+                _workload,_points,(unsigned int)_graphs.getVertexVertex().m_indices.size(),
+                (unsigned int)_graphs.getVertexTet().m_indices.size(),(unsigned int)_graphs.getTetTet().m_indices.size(),
+                Parallel::threadCount(),_seconds,peakRSS());
+    }
+    void voronoiDelta(const char *_workload, unsigned int _points, const DeltaClock &_clock, unsigned int _edges,
+                      double _rebuild)
+    {
+        open();
+        fprintf(m_out,"\"phase\": \"voronoi_delta\", \"workload\": \"%s\", \"points\": %u, \"snapshots\": %u, "
+                "\"created\": %u, \"killed\": %u, \"edges\": %u, \"final_edges\": %u, \"seconds\": %.6f, "
+                "\"snapshot_us\": %.1f, \"changes_per_s\": %.1f, \"rebuild_seconds\": %.6f, \"peak_rss_kb\": %ld}",
+                _workload,_points,_clock.m_snapshots,_clock.m_created,_clock.m_killed,_clock.m_voronoi.edgeCount(),
+                _edges,_clock.m_seconds,_clock.m_snapshots > 0 ? 1e6*_clock.m_seconds/_clock.m_snapshots : 0.0,
+                rate(_clock.m_created+_clock.m_killed,_clock.m_seconds),_rebuild,peakRSS());
+    }
+    void power(const char *_workload, unsigned int _points, unsigned int _tets, int _redundant, double _seconds,
+               double _unweighted)
+    {
+        open();
+        fprintf(m_out,"\"phase\": \"power\", \"workload\": \"%s\", \"points\": %u, \"tets\": %u, \"redundant\": %d, "
+                "\"seconds\": %.6f, \"points_per_s\": %.1f, \"unweighted_seconds\": %.6f, "
+                "\"unweighted_points_per_s\": %.1f, \"peak_rss_kb\": %ld}",_workload,_points,_tets,_redundant,_seconds,
+                rate(_points,_seconds),_unweighted,rate(_points,_unweighted),peakRSS());
+    }
+    void skipped(const char *_workload, unsigned int _points)
+    {
+        open();
+        fprintf(m_out,"\"phase\": \"triangulate\", \"workload\": \"%s\", \"points\": %u, \"skipped\": true}",
+                _workload,_points);
+    }
+    void end()
+    {
+        fprintf(m_out,"\n  ],\n  \"peak_rss_kb\": %ld",peakRSS());
+        if(AllocStats::peakBytes() > 0)
+        {
+            fprintf(m_out,",\n  \"peak_heap_bytes\": %lld",AllocStats::peakBytes());
+        }
+        fprintf(m_out,"\n}\n");
+    }
+
+private:
+    void open()
+    {
+        fprintf(m_out,"%s\n    {",m_first ? "" : ",");
+        m_first = false;
+        fflush(m_out);
+    }
+    static double rate(unsigned int _count, double _seconds)
+    {
+        return _seconds > 0 ? _count/_seconds : 0.0;
+    }
+    FILE *m_out;
+    bool m_first;
+};
+
+static void usage()
+{
+    fprintf(stderr,"usage : MeshBench [-i mesh.obj] [-n min exponent] [-x max exponent] [-b budget seconds] "
+                   "[-s seed] [-o out.json]\n"
+                   "  the point sets run from 10^min to 10^max points (default 3 to 7), a workload stops growing\n"
+                   "  once its next size would take longer than the budget (default 120s)\n");
+}
+
+int main(int argc, char **argv)
+{
+    TRACE_THREAD_NAME("main");
+    std::string mesh;
+    std::string output;
+    int minExponent = 3;
+    int maxExponent = 7;
+    double budget = 120.0;
+    unsigned int seed = 1;
+    for(int i=1; i<argc; ++i)
+    {
+        if(i+1 >= argc)
+        {
+            usage();
+            return EXIT_FAILURE;
+        }
+        if(strcmp(argv[i],"-i") == 0)      { mesh = argv[++i]; }
+        else if(strcmp(argv[i],"-n") == 0) { minExponent = atoi(argv[++i]); }
+        else if(strcmp(argv[i],"-x") == 0) { maxExponent = atoi(argv[++i]); }
+        else if(strcmp(argv[i],"-b") == 0) { budget = atof(argv[++i]); }
+        else if(strcmp(argv[i],"-s") == 0) { seed = strtoul(argv[++i],NULL,10); }
+        else if(strcmp(argv[i],"-o") == 0) { output = argv[++i]; }
+        else
+        {
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    FILE *out = stdout;
+    if(!output.empty() && (out = fopen(output.c_str(),"w")) == NULL)
+    {
+        fprintf(stderr,"Can't write %s\n",output.c_str());
+        return EXIT_FAILURE;
+    }
+
+    // the SDF sampler reads the mesh from a file, so a generated sphere is written out when none is given
+    std::string sphere;
+    if(mesh.empty())
+    {
+        char name[] = "/tmp/MeshBenchXXXXXX";
+        int fd = mkstemp(name);
+        if(fd >= 0)
+        {
+            close(fd);
+            sphere = std::string(name);
+            mesh = sphere;
+            writeSphere(mesh,3);
+        }
+    }
+
+    Report report;
+    report.begin(out,sphere.empty() ? mesh.c_str() : "generated sphere",seed);
+
+    // sampling, each mode at a few densities on the same mesh
+    MeshSamplerCore sampler;
+    if(sampler.loadObj(mesh))
+    {
+        const char *modes[3] = { "sdf", "ray", "surface" };
+        const int densities[3] = { 1, 10, 100 };
+        for(int m=0; m<3; ++m)
+        {
+            for(int d=0; d<3; ++d)
+            {
+                ngl::Random::instance()->setSeed(seed);
+                sampler.setDensity(densities[d]);
+                sampler.setPointLocationType(m == 2 ? 1 : 0);
+                sampler.setMethod(m == 1 ? 1 : 0);
+                double start = now();
+                sampler.SampleMesh();
+                double seconds = now()-start;
+                report.sample(modes[m],densities[d],sampler.getPoints().size(),seconds);
+                fprintf(stderr,"sample %-8s density %-4d %9u points %9.3fs\n",modes[m],densities[d],
+                        (unsigned int)sampler.getPoints().size(),seconds);
+            }
+        }
+    }
+    // the SDF sampler up to 10^7 points inside the mesh, on a sphere of 81920 triangles when it is generated so the
+    // field is not the one of a coarse mesh, each count loads the field again as SampleMesh does
+    if(!sphere.empty())
+    {
+        writeSphere(mesh,6);
+    }
+    if(sampler.loadObj(mesh))
+    {
+        for(unsigned int count=100000; count<=10000000; count*=10)
+        {
+            ngl::Random::instance()->setSeed(seed);
+            double start = now();
+            sampler.SampleMesh_usingSDF(count);
+            double seconds = now()-start;
+            report.sample("sdf_count",0,sampler.getPoints().size(),seconds);
+            fprintf(stderr,"sample %-8s count %9u %9u points %9.3fs\n","sdf",count,
+                    (unsigned int)sampler.getPoints().size(),seconds);
+            if(seconds*10 > budget)
+            {
+                break;
+            }
+        }
+    }
+    if(!sphere.empty())
+    {
+        remove(sphere.c_str());
+    }
+
+    // rays through the hierarchy of spheres from 1280 to 327680 triangles, a share of them tested against every
+    // triangle as the ray sampler did before
+    for(int levels=3; levels<=7; levels+=2)
+    {
+        std::vector<ngl::Vec3> tris = makeSphere(levels);
+        double buildStart = now();
+        TriangleBVH bvh;
+        bvh.build(tris);
+        double build = now()-buildStart;
+
+        srand(seed);
+        const unsigned int rays = 100000;
+        std::vector<ngl::Vec3> ends(2*rays);
+        for(unsigned int i=0; i<ends.size(); ++i)
+        {
+            ends[i] = ngl::Vec3(2.4f*uniform()-1.2f,2.4f*uniform()-1.2f,2.4f*uniform()-1.2f);
+        }
+        unsigned int bruteRays = std::max(1u,std::min(rays,(unsigned int)(50000000/tris.size())));
+        std::vector<unsigned int> crossed;
+        unsigned int hits = 0;
+        unsigned int checkHits = 0;
+        double start = now();
+        for(unsigned int i=0; i<rays; ++i)
+        {
+            bvh.intersect(ends[2*i],ends[2*i+1],crossed);
+            hits += crossed.size();
+            checkHits += i < bruteRays ? crossed.size() : 0;
+        }
+        double seconds = now()-start;
+
+        unsigned int bruteHits = 0;
+        start = now();
+        for(unsigned int i=0; i<bruteRays; ++i)
+        {
+            ngl::Vec3 dir = ends[2*i]-ends[2*i+1];
+            for(unsigned int j=0; j<tris.size(); j+=3)
+            {
+                bruteHits += TriangleBVH::rayHit(tris[j],tris[j+1]-tris[j],tris[j+2]-tris[j],ends[2*i],dir);
+            }
+        }
+        double bruteSeconds = now()-start;
+        if(bruteHits != checkHits)
+        {
+            fprintf(stderr,"the hierarchy found %u hits where every triangle gives %u\n",checkHits,bruteHits);
+        }
+        report.rays(tris.size()/3,rays,hits,build,seconds,bruteRays,bruteSeconds);
+        fprintf(stderr,"rays %9u triangles %9.0f rays/s, every triangle %9.0f rays/s\n",(unsigned int)tris.size()/3,
+                seconds > 0 ? rays/seconds : 0.0,bruteSeconds > 0 ? bruteRays/bruteSeconds : 0.0);
+    }
+
+    // triangulation and voronoi, growing each workload until it outgrows the budget
+    for(int w=0; w<WORKLOADS; ++w)
+    {
+        bool skip = false;
+        for(int e=minExponent; e<=maxExponent; ++e)
+        {
+            int count = (int)(pow(10.0,e)+0.5);
+            if(skip)
+            {
+                report.skipped(s_workloadNames[w],count);
+                continue;
+            }
+            srand(seed);
+            MeshSamplerCore core;
+            core.setPoints(makePoints((Workload)w,count));
+
+            PhaseClock clock;
+            long long heapBefore = AllocStats::liveBytes();
+            double start = now();
+            core.triangulate(&clock);
+            double end = now();
+            double finalizeStart = clock.m_finalizeStart != 0.0 ? clock.m_finalizeStart : end;
+            unsigned int tets = core.getTetrahedra().size();
+            report.triangulate(s_workloadNames[w],count,tets,finalizeStart-start,end-finalizeStart,
+                               AllocStats::liveBytes()-heapBefore);
+
+            double voronoiStart = now();
+            core.buildVoronoi();
+            double voronoiSeconds = now()-voronoiStart;
+            report.voronoi(s_workloadNames[w],count,tets,core.getVoronoi()->getEdgeIndices().size()/2,voronoiSeconds);
+
+            double cellsStart = now();
+            core.buildVoronoiCells();
+            double cellsSeconds = now()-cellsStart;
+            const std::vector<VCell> &cells = core.getVoronoi()->getCells();
+            unsigned int bounded = 0;
+            unsigned int faces = 0;
+            for(unsigned int c=0; c<cells.size(); ++c)
+            {
+                bounded += cells[c].m_bounded;
+                faces += cells[c].m_faces.size();
+            }
+            report.cells(s_workloadNames[w],count,bounded,faces,cellsSeconds);
+
+            // the topology is already indexed by the cells, so this times the properties alone
+            double propertiesStart = now();
+            core.computeCellProperties();
+            double propertiesSeconds = now()-propertiesStart;
+            const CellProperties &properties = core.getCellProperties();
+            bounded = 0;
+            for(unsigned int c=0; c<properties.siteCount(); ++c)
+            {
+                bounded += properties.getBounded()[c];
+            }
+            report.properties(s_workloadNames[w],count,bounded,properties.getFaceSites().size(),propertiesSeconds);
+
+            double graphsStart = now();
+            core.buildGraphs();
+            double graphsSeconds = now()-graphsStart;
+            report.graphs(s_workloadNames[w],count,core.getGraphs(),graphsSeconds);
+
+            fprintf(stderr,"%-9s %9d points %9u tets  insert %9.3fs  finalize %9.3fs  voronoi %9.3fs  cells %9.3fs  "
+                    "properties %9.3fs  graphs %9.3fs\n",s_workloadNames[w],count,tets,finalizeStart-start,
+                    end-finalizeStart,voronoiSeconds,cellsSeconds,propertiesSeconds,graphsSeconds);
+            // the build is at least linear, so ten times the points takes at least ten times as long
+            skip = (end-start+voronoiSeconds+cellsSeconds+propertiesSeconds+graphsSeconds)*10 > budget;
+        }
+    }
+
+    // the live edges of a progressive build, each snapshot is about 256 points so the time per snapshot follows the
+    // change while the rebuild grows with the mesh. Recording the snapshots slows the build down, so
+    // this stops at 10^5 points
+    for(int e=minExponent; e<=std::min(maxExponent,5); ++e)
+    {
+        int count = (int)(pow(10.0,e)+0.5);
+        srand(seed);
+        MeshSamplerCore core;
+        core.setPoints(makePoints(UNIFORM,count));
+        DeltaClock clock;
+        core.triangulate(&clock);
+        double rebuildStart = now();
+        core.buildVoronoi();
+        double rebuildSeconds = now()-rebuildStart;
+        unsigned int edges = core.getVoronoi()->getEdgeIndices().size()/2;
+        report.voronoiDelta(s_workloadNames[UNIFORM],count,clock,edges,rebuildSeconds);
+        fprintf(stderr,"%-9s %9d points %9u snapshots  live edges %9u of %9u  updates %9.3fs  %9.1fus each  "
+                "rebuild %9.3fs\n",s_workloadNames[UNIFORM],count,clock.m_snapshots,clock.m_voronoi.edgeCount(),edges,
+                clock.m_seconds,clock.m_snapshots > 0 ? 1e6*clock.m_seconds/clock.m_snapshots : 0.0,rebuildSeconds);
+    }
+
+    // the same uniform points as spheres, the radii go up to half the mean spacing so a few of them are redundant
+    bool skip = false;
+    for(int e=minExponent; e<=maxExponent && !skip; ++e)
+    {
+        int count = (int)(pow(10.0,e)+0.5);
+        srand(seed);
+        std::vector<ngl::Vec3> points = makePoints(UNIFORM,count);
+        float maxRadius = 1.0f/pow((double)count,1.0/3.0);
+        std::vector<ngl::Real> weights(count);
+        for(int i=0; i<count; ++i)
+        {
+            float radius = maxRadius*uniform();
+            weights[i] = radius*radius;
+        }
+        MeshSamplerCore core;
+        core.setPoints(points);
+        double start = now();
+        core.triangulate();
+        double unweightedSeconds = now()-start;
+        core.setPoints(points,weights);
+        start = now();
+        core.triangulate();
+        double seconds = now()-start;
+        unsigned int tets = core.getTetrahedra().size();
+        report.power(s_workloadNames[UNIFORM],count,tets,core.getRedundantCount(),seconds,unweightedSeconds);
+        fprintf(stderr,"%-9s %9d spheres %9u tets  redundant %7d  weighted %9.3fs  unweighted %9.3fs\n",
+                s_workloadNames[UNIFORM],count,tets,core.getRedundantCount(),seconds,unweightedSeconds);
+        skip = (seconds+unweightedSeconds)*10 > budget;
+    }
+
+    report.end();
+    AllocStats::report(stderr,0);
+    if(out != stdout)
+    {
+        fclose(out);
+    }
+    return EXIT_SUCCESS;
+}
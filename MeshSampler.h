@@ -4,10 +4,12 @@
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Mesh.h
 /// @author Maria Vineeta Bagya Seelan
-/// @version 1.0
+/// @version 1.2
 /// @date 16/08/13
 /// Revision History :
 /// Initial Version 16/08/13
+/// 1.1 the sampling and the triangulation moved to MeshSamplerCore, this class adds the Obj and the drawing
+/// 1.2 the snapshots of a progressive triangulation update its voronoi edges too
 /// @class Mesh
 /// @brief the Mesh class holds all members and functions needed to load a mesh
 /// @brief and generate sample points within it
@@ -15,11 +17,13 @@
 
 #include "ngl/TransformStack.h"
 #include "ngl/Camera.h"
-#include "ngl/VAOPrimitives.h"
+#include "ngl/Colour.h"
 #include "ngl/Obj.h"
-#include "Delaunay.h"
+#include "MeshSamplerCore.h"
+#include "TetMeshRenderer.h"
+#include "PointRenderer.h"
 
-class MeshSampler
+class MeshSampler : public MeshSamplerCore
 {
 public:
     //----------------------------------------------------------------------------------------------------------------------
@@ -31,19 +35,10 @@ public:
     //----------------------------------------------------------------------------------------------------------------------
     ~MeshSampler(){}
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief method that loads the mesh initially
+    /// @brief method that loads the mesh initially and hands its triangles to the core
     //----------------------------------------------------------------------------------------------------------------------
     void loadMesh();
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief method that obtains volume samples of the mesh using Ray casting
-    //----------------------------------------------------------------------------------------------------------------------
-    void SampleMesh();
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief method that obtains volume samples of the mesh using SDF
-    //----------------------------------------------------------------------------------------------------------------------
-    void SampleMesh_usingSDF();
-    void SampleMesh_rayIntersection();
-    //----------------------------------------------------------------------------------------------------------------------
     /// @brief method that plots the points insided the volume of the mesh
     /// @param [in] _transformStack stores the transformation stack
     /// @param [in] _cam stores the camera data
@@ -98,29 +93,24 @@ public:
     //----------------------------------------------------------------------------------------------------------------------
     void drawVoronoi(ngl::TransformStack &_transformStack, ngl::Camera *_cam);
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that does the actual Delaunay calculation
-    //----------------------------------------------------------------------------------------------------------------------
-    void delaunay();
+    /// @brief function that hands the sample points to their markers, called on the GL thread after SampleMesh
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that sets the Obj file name
-    /// @param [in] _filename stores the filename
+    void uploadSamples();
     //----------------------------------------------------------------------------------------------------------------------
-    void setObjFilename( const std::string _filename );
+    /// @brief function that builds the GPU buffers of the mesh and the voronoi diagram, called on the GL thread after
+    /// delaunay
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that sets the density of points
-    /// @param [in] _density stores the density obtained from UI
+    void uploadDelaunay();
     //----------------------------------------------------------------------------------------------------------------------
-    void setDensity(int _density);
+    /// @brief function that applies a snapshot of a progressive triangulation to the GPU buffers of the mesh and of its
+    /// voronoi edges, called on the GL thread
+    /// @param [in] _delta the changes since the last snapshot
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that sets the location of points
-    /// @param [in] _type stores the value to be set
+    void uploadDelta(const TetDelta &_delta);
     //----------------------------------------------------------------------------------------------------------------------
-    void setPointLocationType(int _type);
+    /// @brief function that empties the GPU buffers of the mesh so a progressive triangulation starts from nothing
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that sets the sampling method
-    /// @param [in] _type stores the value to be set
-    //----------------------------------------------------------------------------------------------------------------------
-    void setMethod(int _type);
+    void clearDelaunayBuffers();
 
 protected:
     //----------------------------------------------------------------------------------------------------------------------
@@ -129,84 +119,44 @@ protected:
     /// @param [in] _cam stores the camera data
     //----------------------------------------------------------------------------------------------------------------------
     void loadMatricesToColourShader(ngl::TransformStack &_transformStack, ngl::Camera *_cam);
-
-private:
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief stores the surface points of the BBox
-    //----------------------------------------------------------------------------------------------------------------------
-    std::vector<ngl::Vec3> m_surfacePointsBBox;
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief stores the surface points on Mesh
-    //----------------------------------------------------------------------------------------------------------------------
-    std::vector<ngl::Vec3> m_surfacePointsMesh;
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief stores the starting point of the ray
-    //----------------------------------------------------------------------------------------------------------------------
-    std::vector<ngl::Vec3> m_rayStart;
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief stores the end point of the ray
-    //----------------------------------------------------------------------------------------------------------------------
-    std::vector<ngl::Vec3> m_rayEnd;
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief stores the volume points obtained by sampling the mesh
-    //----------------------------------------------------------------------------------------------------------------------
-    std::vector<ngl::Vec3> m_volumePoints;
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief stores the surface/volume points obtained by sampling the mesh
-    //----------------------------------------------------------------------------------------------------------------------
-    std::vector<ngl::Vec3> m_points;
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief stores the intersection points betweenray and mesh
+    /// @brief method to load the tx stack (+MVP) to the given shader
+    /// @param [in] _shader the name of the shader program
+    /// @param [in] _transformStack stores the transformation stack
+    /// @param [in] _cam stores the camera data
     //----------------------------------------------------------------------------------------------------------------------
-    std::vector<ngl::Vec3> m_hitPoints;
+    void loadMatricesToShader(const std::string &_shader, ngl::TransformStack &_transformStack, ngl::Camera *_cam);
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief stores the list of vertices of Mesh
+    /// @brief method that draws one set of point markers in a single colour
+    /// @param [in] _markers the instanced markers to draw
+    /// @param [in] _colour the colour of the markers
+    /// @param [in] _transformStack stores the transformation stack
+    /// @param [in] _cam stores the camera data
     //----------------------------------------------------------------------------------------------------------------------
-    std::vector<ngl::Vec3> m_vertTri;
+    void drawMarkers(PointRenderer &_markers, const ngl::Colour &_colour, ngl::TransformStack &_transformStack, ngl::Camera *_cam);
+
+private:
     //----------------------------------------------------------------------------------------------------------------------
     /// @brief our model
     //----------------------------------------------------------------------------------------------------------------------
     ngl::Obj *m_mesh;
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief stores the tetrahedrons generated
-    //----------------------------------------------------------------------------------------------------------------------
-    std::vector<Tetrahedron*> m_tetrahedra;
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief stores the voronoi cells generated
-    //----------------------------------------------------------------------------------------------------------------------
-    Voronoi* m_voronoi;
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief stores the mane of the mesh/obj selected in UI
+    /// @brief stores the GPU batch of the tetrahedra and the voronoi edges
     //----------------------------------------------------------------------------------------------------------------------
-    std::string m_objfilename;
+    TetMeshRenderer m_tetRenderer;
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief stores the density selected from UI
+    /// @brief stores the voronoi edges of the progressive triangulation, fed by the snapshots
     //----------------------------------------------------------------------------------------------------------------------
-    int m_density;
+    DynamicVoronoi m_liveVoronoi;
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief stores the value that describes the location of the points Surface/Volume
+    /// @brief stores the instanced markers of the volume points, the mesh surface points, the BBox surface points, the
+    /// intersection points and the voronoi vertices
     //----------------------------------------------------------------------------------------------------------------------
-    int m_ptLocation;
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief stores the sample points creation method
-    //----------------------------------------------------------------------------------------------------------------------
-    int m_method;
-
-private :
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that calculates the intersection points between ray and the mesh
-    //----------------------------------------------------------------------------------------------------------------------
-    void rayTriangleIntersect();
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that calculates random points on the BBox
-    //----------------------------------------------------------------------------------------------------------------------
-    void findPointsOnSurfaceBBox();
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that calculates random points on mesh surface
-    /// @param [in] _triangle stores the triangulated information of the mesh
-    //----------------------------------------------------------------------------------------------------------------------
-    void findPointsOnSurfaceMesh( Point3 _triangle );
-
+    PointRenderer m_volumeMarkers;
+    PointRenderer m_surfaceMeshMarkers;
+    PointRenderer m_surfaceBBoxMarkers;
+    PointRenderer m_hitMarkers;
+    PointRenderer m_voronoiVertexMarkers;
 };
 
 
@@ -0,0 +1,799 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file MeshSamplerCore.cpp
+/// @brief Class that samples the mesh and builds the tetrahedralization without any GL state
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "MeshSamplerCore.h"
+#include "ngl/Random.h"
+#include "ngl/Util.h"
+#include "Trace.h"
+#include "AllocStats.h"
+#include "CVT.h"
+#include "Parallel.h"
+#include "sdf/signed_distance_field_from_mesh.hpp"
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief finds the bounds of a set of points, an empty set gives the origin
+/// @param [in] _points the points
+/// @param [out] o_min the minimum corner
+/// @param [out] o_max the maximum corner
+//----------------------------------------------------------------------------------------------------------------------
+static void pointBounds(const std::vector<ngl::Vec3> &_points, ngl::Vec3 &o_min, ngl::Vec3 &o_max)
+{
+    o_min = ngl::Vec3(0.0,0.0,0.0);
+    o_max = ngl::Vec3(0.0,0.0,0.0);
+    for(unsigned int i=0;i<_points.size();++i)
+    {
+        for(int k=0;k<3;++k)
+        {
+            if(i==0 || _points[i][k] < o_min[k]) { o_min[k] = _points[i][k]; }
+            if(i==0 || _points[i][k] > o_max[k]) { o_max[k] = _points[i][k]; }
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the width of an interval once it is grown to be symmetric about the origin
+/// @param [in] _min the lower end
+/// @param [in] _max the upper end
+//----------------------------------------------------------------------------------------------------------------------
+static ngl::Real extentAboutOrigin(ngl::Real _min, ngl::Real _max)
+{
+    ngl::Real reach = std::max(std::fabs(_min),std::fabs(_max));
+    return std::max(_max-_min,2*reach);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief keeps the hits of a ray that enter and leave the mesh in pairs, the ray misses the mesh if it crosses an odd
+/// number of triangles. Repeated pairs are dropped and the hits sorted by their distance from the start of the ray
+/// @param [in] _start the start of the ray
+/// @param [in,out] io_hits the hits in the order of the triangles
+//----------------------------------------------------------------------------------------------------------------------
+static void pairRayHits(const ngl::Vec3 &_start, std::vector<ngl::Vec3> &io_hits)
+{
+    int count = io_hits.size();
+    if(count % 2 != 0) // odd surfaces => ray doesnt intersect the mesh
+    {
+        io_hits.clear();
+        return;
+    }
+    if(count <= 2)
+    {
+        return;
+    }
+    for(int j=0;j<count;j+=2)
+    {
+        for(int k=0;k<count;k+=2)
+        {
+            if(j!=k && k+1<count && j+1<count)
+            {
+                if((io_hits[j] == io_hits[k]) && (io_hits[j+1]==io_hits[k+1]))
+                {
+                    io_hits.erase(io_hits.begin()+k);
+                    io_hits.erase(io_hits.begin()+k+1);
+                    count = io_hits.size();
+                }
+            }
+        }
+    }
+    std::vector<float> length(count);
+    for(int k=0; k<count; ++k)
+    {
+        ngl::Vec3 diff = _start - io_hits[k];
+        length[k] = sqrt(pow(diff.m_x,2) + pow(diff.m_y,2) + pow(diff.m_z,2));
+    }
+    for(int k=0;k<count;++k)
+    {
+        for(int j=0;j<count;++j)
+        {
+            if(k!=j && length[k] > length[j])
+            {
+                std::swap(io_hits[k],io_hits[j]);
+                std::swap(length[k],length[j]);
+            }
+        }
+    }
+}
+
+namespace
+{
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief casts a range of rays into the mesh, the hierarchy finds the triangles each one crosses
+//----------------------------------------------------------------------------------------------------------------------
+class RayTask : public ParallelTask
+{
+public:
+    RayTask(const TriangleBVH &_bvh, const std::vector<ngl::Vec3> &_vertTri, const std::vector<ngl::Vec3> &_start,
+            const std::vector<ngl::Vec3> &_end, std::vector<std::vector<ngl::Vec3> > &o_hits) :
+        m_bvh(_bvh), m_vertTri(_vertTri), m_start(_start), m_end(_end), m_hits(o_hits) {}
+
+    void run(unsigned int _begin, unsigned int _end)
+    {
+        std::vector<unsigned int> triangles;
+        for(unsigned int i=_begin; i<_end; ++i)
+        {
+            m_bvh.intersect(m_start[i],m_end[i],triangles);
+            ngl::Vec3 dir = m_start[i] - m_end[i];
+            std::vector<ngl::Vec3> &hits = m_hits[i];
+            for(unsigned int j=0; j<triangles.size(); ++j)
+            {
+                unsigned int t = 3*triangles[j];
+                // Reference : http://softsurfer.com/Archive/algorithm_0105/algorithm_0105.htm#intersect_RayTriangle()
+                // get intersect point of ray with triangle plane
+                ngl::Vec3 n = ngl::calcNormal(m_vertTri[t],m_vertTri[t+1],m_vertTri[t+2]);
+                ngl::Vec3 tvec = m_start[i] - m_vertTri[t];
+                float a = -n.dot(tvec);
+                float b = n.dot(dir);
+                float r = a/b;
+                hits.push_back(m_start[i] + r * dir);
+            }
+            pairRayHits(m_start[i],hits);
+        }
+    }
+
+private:
+    const TriangleBVH &m_bvh;
+    const std::vector<ngl::Vec3> &m_vertTri;
+    const std::vector<ngl::Vec3> &m_start;
+    const std::vector<ngl::Vec3> &m_end;
+    std::vector<std::vector<ngl::Vec3> > &m_hits;
+};
+
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a counter based random number, the bits of a candidate number mixed with a key by the SplitMix64 finalizer,
+/// so any thread can make any number of the stream without sharing a state
+/// @param [in] _key the key of the stream
+/// @param [in] _counter the number in the stream
+/// @param [out] returns a number in [0,1)
+//----------------------------------------------------------------------------------------------------------------------
+inline float counterRandom(unsigned long long _key, unsigned long long _counter)
+{
+    unsigned long long z = _key + (_counter+1)*0x9e3779b97f4a7c15ull;
+    z = (z^(z>>30))*0xbf58476d1ce4e5b9ull;
+    z = (z^(z>>27))*0x94d049bb133111ebull;
+    z ^= z>>31;
+    return (z>>40)*(1.0f/16777216.0f);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief tests a batch of numbered candidates in the bounding box against the signed distance field, each chunk of
+/// the batch keeps its inside points at the front of its own range of a buffer. Candidate n takes the numbers 3n to
+/// 3n+2 of the stream, the points only depend on the key and the candidate numbers. The field is only read once it is
+/// loaded, so the threads share it
+//----------------------------------------------------------------------------------------------------------------------
+class SDFSampleTask : public ParallelTask
+{
+public:
+    static const unsigned int s_chunk = 4096;
+
+    SDFSampleTask(sdf::signed_distance_field_from_mesh &_field, const ngl::Vec3 &_min, const ngl::Vec3 &_max,
+                  unsigned long long _key) :
+        m_field(_field), m_min(_min), m_size(_max-_min), m_key(_key), m_first(0), m_count(0) {}
+
+    void setBatch(unsigned long long _first, unsigned int _count)
+    {
+        m_first = _first;
+        m_count = _count;
+        m_points.resize(_count);
+        m_inside.resize(chunkCount());
+    }
+
+    unsigned int chunkCount() const { return (m_count+s_chunk-1)/s_chunk; }
+    unsigned int insideCount(unsigned int _chunk) const { return m_inside[_chunk]; }
+    const ngl::Vec3* chunkPoints(unsigned int _chunk) const { return &m_points[_chunk*s_chunk]; }
+
+    void run(unsigned int _begin, unsigned int _end)
+    {
+        for(unsigned int c=_begin; c<_end; ++c)
+        {
+            unsigned int begin = c*s_chunk;
+            unsigned int end = std::min(begin+s_chunk,m_count);
+            unsigned int inside = begin;
+            for(unsigned int i=begin; i<end; ++i)
+            {
+                unsigned long long n = 3*(m_first+i);
+                ngl::Vec3 pos(m_min.m_x + m_size.m_x*counterRandom(m_key,n),
+                              m_min.m_y + m_size.m_y*counterRandom(m_key,n+1),
+                              m_min.m_z + m_size.m_z*counterRandom(m_key,n+2));
+                // rejecting points based on SDF
+                if(m_field(pos.m_x,pos.m_y,pos.m_z) < 0)
+                {
+                    m_points[inside++] = pos;
+                }
+            }
+            m_inside[c] = inside-begin;
+        }
+    }
+
+private:
+    sdf::signed_distance_field_from_mesh &m_field;
+    ngl::Vec3 m_min;
+    ngl::Vec3 m_size;
+    unsigned long long m_key;
+    unsigned long long m_first;
+    unsigned int m_count;
+    std::vector<ngl::Vec3> m_points;
+    std::vector<unsigned int> m_inside;
+};
+
+} // end anonymous namespace
+
+MeshSamplerCore::MeshSamplerCore()
+{
+    m_surfacePointsBBox.clear();
+    m_surfacePointsMesh.clear();
+    m_rayStart.clear();
+    m_rayEnd.clear();
+    m_volumePoints.clear();
+    m_vertTri.clear();
+    m_tetrahedra.clear();
+    m_voronoi = NULL;
+    m_delaunay = NULL;
+    m_objfilename = "models/prism.obj";
+    m_density = 1;
+    m_ptLocation = 0;
+    m_method = 0;
+    m_snapToGrid = false;
+}
+
+MeshSamplerCore::~MeshSamplerCore()
+{
+    delete m_voronoi;
+    delete m_delaunay;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool MeshSamplerCore::loadObj( const std::string &_filename )
+{
+    std::ifstream file(_filename.c_str());
+    if(!file.is_open())
+    {
+        std::cerr<<"Can't open "<<_filename<<std::endl;
+        return false;
+    }
+    std::vector<ngl::Vec3> verts;
+    std::vector<ngl::Vec3> vertTri;
+    std::string line;
+    while(std::getline(file,line))
+    {
+        std::istringstream tokens(line);
+        std::string type;
+        tokens>>type;
+        if(type == "v")
+        {
+            ngl::Vec3 v;
+            tokens>>v.m_x>>v.m_y>>v.m_z;
+            verts.push_back(v);
+        }
+        else if(type == "f")
+        {
+            // only the vertex index of each v/vt/vn triple is needed, negative indices count back from the end
+            std::vector<int> face;
+            std::string corner;
+            while(tokens>>corner)
+            {
+                int index = atoi(corner.c_str());
+                face.push_back(index < 0 ? verts.size()+index : index-1);
+            }
+            if(face.size() != 3)
+            {
+                std::cerr<<"Works only for triangulated meshes!!!"<<std::endl;
+                return false;
+            }
+            for(int j=0;j<3;++j)
+            {
+                if(face[j] < 0 || face[j] >= (int)verts.size())
+                {
+                    std::cerr<<"Bad face index in "<<_filename<<std::endl;
+                    return false;
+                }
+                vertTri.push_back(verts[face[j]]);
+            }
+        }
+    }
+    m_objfilename = _filename;
+    setTriangles(vertTri);
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshSamplerCore::setTriangles( const std::vector<ngl::Vec3> &_vertTri )
+{
+    m_vertTri = _vertTri;
+    pointBounds(m_vertTri,m_bboxMin,m_bboxMax);
+    m_bvh.build(m_vertTri);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshSamplerCore::setPoints( const std::vector<ngl::Vec3> &_points, const std::vector<ngl::Real> &_weights )
+{
+    m_points = _points;
+    m_weights = _weights;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshSamplerCore::setObjFilename(
+                                    const std::string _filename
+                                )
+{
+    m_objfilename = _filename;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshSamplerCore::setDensity(
+                                int _density
+                            )
+{
+    m_density = _density;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshSamplerCore::setPointLocationType(
+                                        int _type
+                                      )
+{
+    m_ptLocation = _type;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshSamplerCore::setMethod(
+                             int _type
+                           )
+{
+    m_method = _type;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshSamplerCore::findPointsOnSurfaceBBox()
+{
+    // corners of the bbox in the same order as ngl::BBox
+    ngl::Vec3 vertex_array[8];
+    vertex_array[0] = ngl::Vec3(m_bboxMin.m_x,m_bboxMax.m_y,m_bboxMin.m_z);
+    vertex_array[1] = ngl::Vec3(m_bboxMax.m_x,m_bboxMax.m_y,m_bboxMin.m_z);
+    vertex_array[2] = ngl::Vec3(m_bboxMax.m_x,m_bboxMax.m_y,m_bboxMax.m_z);
+    vertex_array[3] = ngl::Vec3(m_bboxMin.m_x,m_bboxMax.m_y,m_bboxMax.m_z);
+    vertex_array[4] = ngl::Vec3(m_bboxMin.m_x,m_bboxMin.m_y,m_bboxMin.m_z);
+    vertex_array[5] = ngl::Vec3(m_bboxMax.m_x,m_bboxMin.m_y,m_bboxMin.m_z);
+    vertex_array[6] = ngl::Vec3(m_bboxMax.m_x,m_bboxMin.m_y,m_bboxMax.m_z);
+    vertex_array[7] = ngl::Vec3(m_bboxMin.m_x,m_bboxMin.m_y,m_bboxMax.m_z);
+
+    std::vector<Point3> tri_bbox;
+    Point3 p1(vertex_array[0],vertex_array[1],vertex_array[3]);
+    tri_bbox.push_back(p1);
+    Point3 p2(vertex_array[2],vertex_array[3],vertex_array[1]);
+    tri_bbox.push_back(p2);
+    Point3 p3(vertex_array[4],vertex_array[5],vertex_array[7]);
+    tri_bbox.push_back(p3);
+    Point3 p4(vertex_array[6],vertex_array[7],vertex_array[5]);
+    tri_bbox.push_back(p4);
+
+    Point3 p5(vertex_array[2],vertex_array[1],vertex_array[6]);
+    tri_bbox.push_back(p5);
+    Point3 p6(vertex_array[5],vertex_array[6],vertex_array[1]);
+    tri_bbox.push_back(p6);
+    Point3 p7(vertex_array[0],vertex_array[4],vertex_array[3]);
+    tri_bbox.push_back(p7);
+    Point3 p8(vertex_array[3],vertex_array[7],vertex_array[4]);
+    tri_bbox.push_back(p8);
+
+    Point3 p9(vertex_array[1],vertex_array[5],vertex_array[0]);
+    tri_bbox.push_back(p9);
+    Point3 p10(vertex_array[4],vertex_array[0],vertex_array[5]);
+    tri_bbox.push_back(p10);
+    Point3 p11(vertex_array[6],vertex_array[7],vertex_array[2]);
+    tri_bbox.push_back(p11);
+    Point3 p12(vertex_array[3],vertex_array[2],vertex_array[7]);
+    tri_bbox.push_back(p12);
+
+    for(unsigned int i=0;i<tri_bbox.size();++i)
+    {
+        for(int j=0;j<m_density;++j)
+        {
+            // Generating random points on the surface of the bbox
+            ngl::Vec3 A,B,C;
+            A = tri_bbox[i].m_a;
+            B = tri_bbox[i].m_b;
+            C = tri_bbox[i].m_c;
+
+            ngl::Random *rng=ngl::Random::instance();
+            float a,b,c;
+            a = rng->randomPositiveNumber(1);
+            b = rng->randomPositiveNumber(1);
+            if(a+b > 1)
+            {
+               a = 1 - a;
+               b = 1 - b;
+            }
+            c = 1 - a - b;
+            ngl::Vec3 point;
+            point.m_x = (a*A.m_x) + (b*B.m_x) + (c*C.m_x);
+            point.m_y = (a*A.m_y) + (b*B.m_y) + (c*C.m_y);
+            point.m_z = (a*A.m_z) + (b*B.m_z) + (c*C.m_z);
+            m_surfacePointsBBox.push_back(point);
+        }
+    }
+}
+
+void MeshSamplerCore::findPointsOnSurfaceMesh( Point3 _triangle )
+{
+    // Generating random points on the surface of the bbox
+    ngl::Vec3 A,B,C;
+    A = _triangle.m_a;
+    B = _triangle.m_b;
+    C = _triangle.m_c;
+    for(int i=0;i<m_density;++i)
+    {
+        ngl::Random *rng=ngl::Random::instance();
+        float a,b,c;
+        a = rng->randomPositiveNumber(1);
+        b = rng->randomPositiveNumber(1);
+        if(a+b > 1)
+        {
+           a = 1 - a;
+           b = 1 - b;
+        }
+        c = 1 - a - b;
+        ngl::Vec3 point;
+        point.m_x = (a*A.m_x) + (b*B.m_x) + (c*C.m_x);
+        point.m_y = (a*A.m_y) + (b*B.m_y) + (c*C.m_y);
+        point.m_z = (a*A.m_z) + (b*B.m_z) + (c*C.m_z);
+        m_surfacePointsMesh.push_back(point);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshSamplerCore::SampleMesh_usingSDF()
+{
+    SampleMesh_usingSDF(m_density * 20);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshSamplerCore::SampleMesh_usingSDF(unsigned int _count)
+{
+    TRACE_ZONE("MeshSampler::SampleMesh_usingSDF");
+    unsigned int no_of_points = _count;
+    // Signed distance field
+    sdf::signed_distance_field_from_mesh s;
+    s.load_from_file(m_objfilename);
+    s.is_valid();
+    const float* max_bound = s.maximum_bound();
+    const float* min_bound = s.minimum_bound();
+
+    // the candidates are numbered from a key drawn once, so the seed of ngl::Random still picks the points. A draw
+    // only holds 16 good bits, four of them fill the 64 bits of the key
+    ngl::Random *rng = ngl::Random::instance();
+    unsigned long long key = 0;
+    for(int i=0; i<4; ++i)
+    {
+        key = (key<<16) | (unsigned int)(rng->randomPositiveNumber(1)*65535.0f);
+    }
+
+    m_volumePoints.resize(no_of_points);
+    unsigned int found = 0;
+    unsigned long long tried = 0;
+    SDFSampleTask task(s,ngl::Vec3(min_bound[0],min_bound[1],min_bound[2]),
+                       ngl::Vec3(max_bound[0],max_bound[1],max_bound[2]),key);
+    while(found < no_of_points)
+    {
+        // the first batch guesses half the candidates fall inside, the next ones go by the share found so far
+        unsigned int wanted = no_of_points-found;
+        double share = found > 0 ? (double)found/tried : 0.5;
+        unsigned int batch = (unsigned int)std::min(1.2*wanted/share+1024.0,(double)(1u<<22));
+        if(found == 0 && tried >= (1ull<<26))
+        {
+            std::cerr<<"No point of the bounding box is inside "<<m_objfilename<<std::endl;
+            break;
+        }
+        task.setBatch(tried,batch);
+        Parallel::forRange((batch+SDFSampleTask::s_chunk-1)/SDFSampleTask::s_chunk,1,task);
+        // the chunks are taken in order, so the points are the first inside ones whatever the number of threads
+        for(unsigned int c=0; c<task.chunkCount() && found<no_of_points; ++c)
+        {
+            unsigned int take = std::min(task.insideCount(c),no_of_points-found);
+            std::copy(task.chunkPoints(c),task.chunkPoints(c)+take,m_volumePoints.begin()+found);
+            found += take;
+        }
+        tried += batch;
+    }
+    m_volumePoints.resize(found);
+    m_points = m_volumePoints;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshSamplerCore::SampleMesh()
+{
+    TRACE_ZONE("MeshSampler::SampleMesh");
+    ALLOC_PHASE(SAMPLING);
+    m_surfacePointsBBox.clear();
+    m_surfacePointsMesh.clear();
+    m_rayStart.clear();
+    m_rayEnd.clear();
+    m_volumePoints.clear();
+    m_hitPoints.clear();
+    m_weights.clear();
+
+    if(m_ptLocation != 0)
+    {
+        for(unsigned int i=0; i<m_vertTri.size(); i+=3)
+        {
+            findPointsOnSurfaceMesh(Point3(m_vertTri[i], m_vertTri[i+1], m_vertTri[i+2]));
+        }
+        m_points = m_surfacePointsMesh;
+    }
+    else
+    {
+        if(m_method == 0)
+        {
+            // using SDF
+            SampleMesh_usingSDF();
+        }
+        else
+        {
+            // Ray intersection
+            SampleMesh_rayIntersection();
+            m_points = m_volumePoints;
+        }
+    }
+
+}
+
+void MeshSamplerCore::SampleMesh_rayIntersection()
+{
+    TRACE_ZONE("MeshSampler::SampleMesh_rayIntersection");
+    findPointsOnSurfaceBBox();
+
+        int size;
+        size = 2 * m_density; // number of tris(4) * density
+        for(int i=0; i<size; ++i)
+        {
+                    m_rayStart.push_back(m_surfacePointsBBox[i]);
+                    m_rayEnd.push_back(m_surfacePointsBBox[i+size]);
+
+        }
+        for(int i=2*size; i<3*size;++i)
+        {
+                    m_rayStart.push_back(m_surfacePointsBBox[i]);
+                    m_rayEnd.push_back(m_surfacePointsBBox[i+size]);
+
+        }
+        for(int i=4*size; i<5*size;++i)
+        {
+                    m_rayStart.push_back(m_surfacePointsBBox[i]);
+                    m_rayEnd.push_back(m_surfacePointsBBox[i+size]);
+        }
+
+        rayTriangleIntersect();
+        double length;
+        int noOfPoints;
+        for(unsigned int i=0;i<m_hitPoints.size();i+=2)
+        {
+            ngl::Vec3 diff = m_hitPoints[i] - m_hitPoints[i+1];
+            length = sqrt(pow(diff.m_x,2) + pow(diff.m_y,2) + pow(diff.m_z,2));
+            noOfPoints = ceil(length) * 2;
+            for(int j=0;j<noOfPoints;++j)
+            {
+                ngl::Vec3 points;
+                float t = j/(float)noOfPoints;
+                points = ngl::lerp(m_hitPoints[i],m_hitPoints[i+1],t);
+                m_volumePoints.push_back(points);
+            }
+        }
+
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshSamplerCore::rayTriangleIntersect()
+{
+    TRACE_ZONE("MeshSampler::rayTriangleIntersect");
+    // every ray keeps its hits apart so the rays run in parallel, they are then put together in the order of the rays
+    std::vector<std::vector<ngl::Vec3> > hits(m_rayStart.size());
+    RayTask task(m_bvh,m_vertTri,m_rayStart,m_rayEnd,hits);
+    Parallel::forRange(m_rayStart.size(),64,task);
+    for(unsigned int i=0;i<hits.size();++i)
+    {
+        m_hitPoints.insert(m_hitPoints.end(),hits[i].begin(),hits[i].end());
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool MeshSamplerCore::delaunay(DelaunayProgress *_progress)
+{
+    if(!triangulate(_progress))
+    {
+        return false;
+    }
+    buildVoronoi();
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool MeshSamplerCore::triangulate(DelaunayProgress *_progress)
+{
+   if(!triangulatePoints(m_points,m_weights,_progress))
+   {
+       return false;
+   }
+   // the sites are the points as they were inserted, the snapped ones in the snapped mode
+   m_points = m_delaunay->getPoints();
+   return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool MeshSamplerCore::triangulatePoints(const std::vector<ngl::Vec3> &_points, const std::vector<ngl::Real> &_weights,
+                                        DelaunayProgress *_progress)
+{
+   // the big tetrahedron is centred on the origin, so it is sized from the extent of the bbox about the origin.
+   // For the centred models this is the width of the bbox as before
+   ngl::Vec3 minB = m_bboxMin;
+   ngl::Vec3 maxB = m_bboxMax;
+   if(m_vertTri.empty())
+   {
+       // no mesh, the points were given directly
+       pointBounds(_points,minB,maxB);
+   }
+   int rangeX = extentAboutOrigin(minB.m_x,maxB.m_x);
+   int rangeY = extentAboutOrigin(minB.m_y,maxB.m_y);
+   int rangeZ = extentAboutOrigin(minB.m_z,maxB.m_z);
+   int maxA = std::max(rangeX,rangeY);
+   int range = std::max(std::max(maxA,rangeZ),1) * 10;
+   std::vector<ngl::Vec3> vertex;
+   vertex.push_back(ngl::Vec3(range, 0, -range));
+   vertex.push_back(ngl::Vec3(0, range, -range));
+   vertex.push_back(ngl::Vec3(-range, -range, -range));
+   vertex.push_back(ngl::Vec3(0, 0, range));
+   Tetrahedron *m_tetra;
+   m_tetra = new Tetrahedron(vertex);
+
+   // Initialising empty neighbours for the first tetrahedron
+   for(int i=0;i<4;++i)
+   {
+      m_tetra->m_neighbours[i] = NULL;
+   }
+
+   Delaunay *dt = new Delaunay(m_tetra);
+   dt->setProgress(_progress);
+   dt->setSnapToGrid(m_snapToGrid);
+   std::vector<Tetrahedron*> tetrahedra = _weights.empty() ? dt->compute(_points) : dt->compute(_points,_weights);
+   if(dt->isCancelled())
+   {
+       // keep the previous mesh, its buffers are still the ones drawn
+       delete dt;
+       return false;
+   }
+   // the previous tetrahedra are freed with their build, the diagram and the cells refer to them
+   delete m_voronoi;
+   m_voronoi = NULL;
+   m_clippedCells.clear();
+   m_cellProperties = CellProperties();
+   m_graphs = TetGraphs();
+   delete m_delaunay;
+   m_delaunay = dt;
+   m_tetrahedra = tetrahedra;
+   return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshSamplerCore::buildVoronoi()
+{
+   // the renderers copy what they draw, nothing else holds on to the previous diagram
+   delete m_voronoi;
+   m_voronoi = new Voronoi(m_tetrahedra);
+   m_clippedCells.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshSamplerCore::buildVoronoiCells()
+{
+   if(m_voronoi != NULL)
+   {
+       m_voronoi->buildCells(m_points);
+   }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshSamplerCore::clipVoronoiCells()
+{
+   if(m_voronoi == NULL)
+   {
+       return;
+   }
+   if(m_voronoi->getCells().empty())
+   {
+       buildVoronoiCells();
+   }
+   CellClipper clipper;
+   if(m_vertTri.empty())
+   {
+       ngl::Vec3 minB;
+       ngl::Vec3 maxB;
+       pointBounds(m_points,minB,maxB);
+       clipper.setBounds(minB,maxB);
+   }
+   else
+   {
+       clipper.setBounds(m_bboxMin,m_bboxMax);
+       clipper.setTriangles(m_vertTri);
+   }
+   clipper.clip(*m_voronoi,m_clippedCells);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshSamplerCore::computeCellProperties()
+{
+   if(m_voronoi == NULL)
+   {
+       return;
+   }
+   if(m_voronoi->getTopology().siteCount() == 0)
+   {
+       m_voronoi->buildTopology(m_points);
+   }
+   m_cellProperties.compute(*m_voronoi);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshSamplerCore::buildGraphs()
+{
+   if(m_voronoi == NULL)
+   {
+       return;
+   }
+   if(m_voronoi->getTopology().siteCount() == 0)
+   {
+       m_voronoi->buildTopology(m_points);
+   }
+   m_graphs.build(m_voronoi->getTopology());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+int MeshSamplerCore::relaxCVT(int _maxIterations, double _tolerance, DelaunayProgress *_progress)
+{
+   TRACE_ZONE("MeshSamplerCore::relaxCVT");
+   m_cvtEnergies.clear();
+   if(m_points.size() < 4)
+   {
+       return 0;
+   }
+   // the points only move a little in an iteration, so the order of the first one keeps every walk of the
+   // retriangulation short and the insertion close to linear in the number of points
+   std::vector<unsigned int> order;
+   CVT::spatialOrder(m_points,order);
+   std::vector<ngl::Vec3> points = m_points;
+   std::vector<ngl::Vec3> ordered(points.size());
+   int moves = -1;
+   while(moves < _maxIterations)
+   {
+       for(unsigned int i=0; i<order.size(); ++i)
+       {
+           ordered[i] = points[order[i]];
+       }
+       // a cancelled build keeps the points of the previous iteration with their mesh
+       if(!triangulatePoints(ordered,std::vector<ngl::Real>(),_progress))
+       {
+           break;
+       }
+       // the cells belong to the points as they were inserted, which are snapped in the snapped mode
+       const std::vector<ngl::Vec3> &inserted = m_delaunay->getPoints();
+       for(unsigned int i=0; i<order.size(); ++i)
+       {
+           points[order[i]] = inserted[i];
+       }
+       m_points = points;
+       ++moves;
+       buildVoronoi();
+       clipVoronoiCells();
+       double energy = CVT::centroids(m_clippedCells,m_points,points);
+       m_cvtEnergies.push_back(energy);
+       unsigned int steps = m_cvtEnergies.size();
+       if(steps > 1 && m_cvtEnergies[steps-2]-energy <= _tolerance*m_cvtEnergies[steps-2])
+       {
+           break;
+       }
+   }
+   return std::max(moves,0);
+}
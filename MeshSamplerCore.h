@@ -0,0 +1,327 @@
+#ifndef MESHSAMPLERCORE_H
+#define MESHSAMPLERCORE_H
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file MeshSamplerCore.h
+/// @author Maria Vineeta Bagya Seelan
+/// @version 1.12
+/// @date 16/08/13
+/// Revision History :
+/// Initial Version 16/08/13
+/// 1.1 delaunay split into triangulate and buildVoronoi so they can be timed apart
+/// 1.2 buildVoronoiCells for the cells of the points
+/// 1.3 clipVoronoiCells for the cells cut to the mesh
+/// 1.4 the tetrahedra of a build are freed with the next one
+/// 1.5 relaxCVT for Lloyd iterations towards a centroidal voronoi tessellation
+/// 1.6 computeCellProperties for the mass properties of the cells
+/// 1.7 buildGraphs for the adjacency of the tetrahedralization as flat arrays
+/// 1.8 weighted points, triangulated into a regular tetrahedralization whose voronoi diagram is the power diagram
+/// 1.9 the rays of the ray sampler are cast through a bounding volume hierarchy of the triangles, in parallel
+/// 1.10 the SDF sampler tests its candidates in parallel and returns exactly 20 points per density step
+/// 1.11 setSnapToGrid for the integer snapped triangulation, the points become the snapped ones
+/// 1.12 SampleMesh_usingSDF for any number of points, the density one takes 20 per step
+/// @class MeshSamplerCore
+/// @brief the part of the sampler that needs no GL, Qt or NGL Obj: it holds the triangles of the mesh, generates the
+/// @brief sample points and builds the Delaunay tetrahedralization and its Voronoi diagram. MeshSampler adds the
+/// @brief drawing on top of it and the headless tool uses it directly
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Delaunay.h"
+#include "CellClipper.h"
+#include "CellProperties.h"
+#include "TetGraphs.h"
+#include <string>
+#include <vector>
+
+class MeshSamplerCore
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief Constructor for MeshSamplerCore
+    //----------------------------------------------------------------------------------------------------------------------
+    MeshSamplerCore();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief Destructor for MeshSamplerCore, it frees the tetrahedra and the voronoi diagram
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual ~MeshSamplerCore();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that reads the vertices and faces of an Obj file without creating any GPU data, it also sets the
+    /// Obj file name used by the SDF sampling
+    /// @param [in] _filename the Obj file
+    /// @param [out] returns false if the file can't be read or has a face that is not a triangle
+    //----------------------------------------------------------------------------------------------------------------------
+    bool loadObj( const std::string &_filename );
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that sets the triangles of the mesh and its bounding box
+    /// @param [in] _vertTri three vertices per triangle
+    //----------------------------------------------------------------------------------------------------------------------
+    void setTriangles( const std::vector<ngl::Vec3> &_vertTri );
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that sets the points to triangulate directly, in place of SampleMesh
+    /// @param [in] _points the points
+    /// @param [in] _weights the weight of every point, the square of its radius, or empty for unweighted points. The
+    /// weights are used by triangulate and delaunay, relaxCVT, clipVoronoiCells and computeCellProperties treat the
+    /// points as unweighted
+    //----------------------------------------------------------------------------------------------------------------------
+    void setPoints( const std::vector<ngl::Vec3> &_points,
+                    const std::vector<ngl::Real> &_weights = std::vector<ngl::Real>() );
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief method that obtains surface or volume samples of the mesh with the current settings
+    //----------------------------------------------------------------------------------------------------------------------
+    void SampleMesh();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief method that obtains volume samples of the mesh using SDF, 20 points for every step of the density drawn
+    /// uniformly inside the mesh. Batches of candidates in the bounding box are tested against the field in parallel
+    /// until there are enough inside ones, the points depend on the seed of ngl::Random and not on the threads
+    //----------------------------------------------------------------------------------------------------------------------
+    void SampleMesh_usingSDF();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief method that obtains exactly _count volume samples of the mesh using SDF, as SampleMesh_usingSDF does for
+    /// the density. The points are then those of getPoints, fewer only if no candidate falls inside the mesh
+    /// @param [in] _count the number of points
+    //----------------------------------------------------------------------------------------------------------------------
+    void SampleMesh_usingSDF(unsigned int _count);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief method that obtains volume samples of the mesh using Ray casting
+    //----------------------------------------------------------------------------------------------------------------------
+    void SampleMesh_rayIntersection();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that does the actual Delaunay calculation and builds the voronoi diagram, it touches no GL state
+    /// so it can run on a worker thread
+    /// @param [in] _progress receives the progress of the build and can cancel it, may be NULL
+    /// @param [out] returns false if the build was cancelled, the previous mesh is then kept
+    //----------------------------------------------------------------------------------------------------------------------
+    bool delaunay(DelaunayProgress *_progress=NULL);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the first step of delaunay, builds the tetrahedralization of the points
+    /// @param [in] _progress receives the progress of the build and can cancel it, may be NULL
+    /// @param [out] returns false if the build was cancelled, the previous mesh is then kept
+    //----------------------------------------------------------------------------------------------------------------------
+    bool triangulate(DelaunayProgress *_progress=NULL);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the second step of delaunay, builds the voronoi diagram of the current tetrahedralization
+    //----------------------------------------------------------------------------------------------------------------------
+    void buildVoronoi();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief builds the voronoi cells of the current voronoi diagram, cell i belongs to point i of getPoints
+    //----------------------------------------------------------------------------------------------------------------------
+    void buildVoronoiCells();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief clips the voronoi cells to the mesh, or to the bounding box of the points when there is no mesh, and
+    /// builds the cells first if they are not there yet. Clipped cell i belongs to point i of getPoints
+    //----------------------------------------------------------------------------------------------------------------------
+    void clipVoronoiCells();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief moves the points towards a centroidal voronoi tessellation of the mesh by Lloyd iterations, each one
+    /// retriangulates the points, clips their cells and moves every point to the centroid of its cell. It stops once an
+    /// iteration lowers the energy by less than _tolerance of it, the mesh, diagram and clipped cells are then those of
+    /// the final points
+    /// @param [in] _maxIterations the most times the points are moved
+    /// @param [in] _tolerance the relative change of the energy below which the iterations stop
+    /// @param [in] _progress receives the progress of every triangulation and can cancel it, may be NULL
+    /// @param [out] returns the number of times the points were moved
+    //----------------------------------------------------------------------------------------------------------------------
+    int relaxCVT(int _maxIterations, double _tolerance, DelaunayProgress *_progress=NULL);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief computes the volume, centroid and area of the voronoi cells and the area and normal of their faces, cell
+    /// i belongs to point i of getPoints
+    //----------------------------------------------------------------------------------------------------------------------
+    void computeCellProperties();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief builds the site to site, site to tetrahedron and tetrahedron to tetrahedron graphs, site i is point i of
+    /// getPoints and tetrahedron t is entry t of getTetrahedra
+    //----------------------------------------------------------------------------------------------------------------------
+    void buildGraphs();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that sets the Obj file name
+    /// @param [in] _filename stores the filename
+    //----------------------------------------------------------------------------------------------------------------------
+    void setObjFilename( const std::string _filename );
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that sets the density of points
+    /// @param [in] _density stores the density obtained from UI
+    //----------------------------------------------------------------------------------------------------------------------
+    void setDensity(int _density);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that sets the location of points
+    /// @param [in] _type stores the value to be set
+    //----------------------------------------------------------------------------------------------------------------------
+    void setPointLocationType(int _type);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that sets the sampling method
+    /// @param [in] _type stores the value to be set
+    //----------------------------------------------------------------------------------------------------------------------
+    void setMethod(int _type);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief turns the integer snapped mode of the triangulation on or off, when on every triangulation rounds the
+    /// points to a grid over their bounding box and they keep the rounded positions, so the diagram, the cells and
+    /// the topology are those of the snapped points
+    /// @param [in] _snap true to snap the points
+    //----------------------------------------------------------------------------------------------------------------------
+    void setSnapToGrid(bool _snap){ m_snapToGrid = _snap; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the snapped mode
+    //----------------------------------------------------------------------------------------------------------------------
+    bool isSnapToGrid() const { return m_snapToGrid; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the points the last triangulation is built from
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<ngl::Vec3>& getPoints() const { return m_points; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the weights of the points, empty when they are unweighted
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<ngl::Real>& getWeights() const { return m_weights; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the number of weighted points the last triangulation left out as redundant, they have no
+    /// tetrahedra and no cell
+    //----------------------------------------------------------------------------------------------------------------------
+    int getRedundantCount() const { return m_delaunay != NULL ? m_delaunay->getRedundantCount() : 0; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the tetrahedra of the last triangulation
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<Tetrahedron*>& getTetrahedra() const { return m_tetrahedra; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the voronoi diagram of the last triangulation, NULL before the first one
+    //----------------------------------------------------------------------------------------------------------------------
+    const Voronoi* getVoronoi() const { return m_voronoi; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the cells of the last clipVoronoiCells
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<ClippedCell>& getClippedCells() const { return m_clippedCells; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the energy of every iteration of the last relaxCVT, the first is that of the points it was
+    /// given and the last that of the final points
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<double>& getCVTEnergies() const { return m_cvtEnergies; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the cell properties of the last computeCellProperties
+    //----------------------------------------------------------------------------------------------------------------------
+    const CellProperties& getCellProperties() const { return m_cellProperties; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the graphs of the last buildGraphs
+    //----------------------------------------------------------------------------------------------------------------------
+    const TetGraphs& getGraphs() const { return m_graphs; }
+
+protected:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the surface points of the BBox
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<ngl::Vec3> m_surfacePointsBBox;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the surface points on Mesh
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<ngl::Vec3> m_surfacePointsMesh;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the starting point of the ray
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<ngl::Vec3> m_rayStart;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the end point of the ray
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<ngl::Vec3> m_rayEnd;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the volume points obtained by sampling the mesh
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<ngl::Vec3> m_volumePoints;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the surface/volume points obtained by sampling the mesh
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<ngl::Vec3> m_points;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the weights of m_points, empty when they are unweighted
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<ngl::Real> m_weights;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the intersection points betweenray and mesh
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<ngl::Vec3> m_hitPoints;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the list of vertices of Mesh, three per triangle
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<ngl::Vec3> m_vertTri;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the hierarchy of the triangles the rays are cast through
+    //----------------------------------------------------------------------------------------------------------------------
+    TriangleBVH m_bvh;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the minimum and maximum corners of the mesh bounding box
+    //----------------------------------------------------------------------------------------------------------------------
+    ngl::Vec3 m_bboxMin;
+    ngl::Vec3 m_bboxMax;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the tetrahedrons generated
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<Tetrahedron*> m_tetrahedra;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the voronoi cells generated
+    //----------------------------------------------------------------------------------------------------------------------
+    Voronoi* m_voronoi;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the build of the current tetrahedra, which owns them
+    //----------------------------------------------------------------------------------------------------------------------
+    Delaunay* m_delaunay;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the voronoi cells clipped to the mesh
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<ClippedCell> m_clippedCells;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the energies of the last relaxCVT
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<double> m_cvtEnergies;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the mass properties of the cells
+    //----------------------------------------------------------------------------------------------------------------------
+    CellProperties m_cellProperties;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the adjacency graphs
+    //----------------------------------------------------------------------------------------------------------------------
+    TetGraphs m_graphs;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the mane of the mesh/obj selected in UI
+    //----------------------------------------------------------------------------------------------------------------------
+    std::string m_objfilename;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the density selected from UI
+    //----------------------------------------------------------------------------------------------------------------------
+    int m_density;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the value that describes the location of the points Surface/Volume
+    //----------------------------------------------------------------------------------------------------------------------
+    int m_ptLocation;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the sample points creation method
+    //----------------------------------------------------------------------------------------------------------------------
+    int m_method;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores whether the triangulation snaps the points
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_snapToGrid;
+
+private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that builds the tetrahedralization of a set of points, as triangulate
+    /// @param [in] _points the points, in the order they are inserted
+    /// @param [in] _weights the weights of the points, empty for an unweighted build
+    /// @param [in] _progress receives the progress of the build and can cancel it, may be NULL
+    /// @param [out] returns false if the build was cancelled, the previous mesh is then kept
+    //----------------------------------------------------------------------------------------------------------------------
+    bool triangulatePoints(const std::vector<ngl::Vec3> &_points, const std::vector<ngl::Real> &_weights,
+                           DelaunayProgress *_progress);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that calculates the intersection points between ray and the mesh, two for every time a ray goes
+    /// through it
+    //----------------------------------------------------------------------------------------------------------------------
+    void rayTriangleIntersect();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that calculates random points on the BBox
+    //----------------------------------------------------------------------------------------------------------------------
+    void findPointsOnSurfaceBBox();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that calculates random points on mesh surface
+    /// @param [in] _triangle stores the triangulated information of the mesh
+    //----------------------------------------------------------------------------------------------------------------------
+    void findPointsOnSurfaceMesh( Point3 _triangle );
+
+};
+
+#endif // MESHSAMPLERCORE_H
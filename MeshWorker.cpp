@@ -0,0 +1,131 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file MeshWorker.cpp
+/// @brief Class that runs the sampling and the triangulation on a worker thread
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "MeshWorker.h"
+#include "Trace.h"
+
+//----------------------------------------------------------------------------------------------------------------------
+MeshWorker::MeshWorker(
+                        MeshSampler *_mesh,
+                        QObject *_parent
+                      ):
+                        QThread(_parent)
+{
+    m_mesh = _mesh;
+    m_job = NONE;
+    m_result = NONE;
+    m_cancel = 0;
+    m_progressive = 0;
+    m_snapToGrid = 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshWorker::startJob( Job _job )
+{
+    m_job = _job;
+    m_result = NONE;
+    m_cancel = 0;
+    m_snapshot.clear();
+    m_lastSnapshot.start();
+    start();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshWorker::cancel()
+{
+    m_cancel = 1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+MeshWorker::Job MeshWorker::takeResult()
+{
+    Job result = m_result;
+    m_result = NONE;
+    return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool MeshWorker::report(int _inserted, int _total, int _alive)
+{
+    // queued to the GUI thread since the receivers live there
+    emit progress(_inserted,_total,_alive);
+    return m_cancel == 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshWorker::setProgressive( bool _progressive )
+{
+    m_progressive = _progressive ? 1 : 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool MeshWorker::isProgressive()
+{
+    return m_progressive != 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshWorker::setSnapToGrid( bool _snap )
+{
+    m_snapToGrid = _snap ? 1 : 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool MeshWorker::isSnapToGrid()
+{
+    return m_snapToGrid != 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshWorker::publish(TetDelta &_delta)
+{
+    // more than one snapshot per frame would only queue up, and the builder must never block on the GUI thread
+    if(m_lastSnapshot.elapsed() < 30 || !m_snapshotLock.tryLock())
+    {
+        return;
+    }
+    bool published = false;
+    if(m_snapshot.empty())
+    {
+        // swapping hands the vectors over in constant time and gives the builder the emptied ones back
+        m_snapshot.m_created.swap(_delta.m_created);
+        m_snapshot.m_killed.swap(_delta.m_killed);
+        published = true;
+    }
+    m_snapshotLock.unlock();
+    if(published)
+    {
+        m_lastSnapshot.restart();
+        emit snapshotReady();
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshWorker::takeSnapshot( TetDelta &_delta )
+{
+    QMutexLocker locker(&m_snapshotLock);
+    m_snapshot.m_created.swap(_delta.m_created);
+    m_snapshot.m_killed.swap(_delta.m_killed);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MeshWorker::run()
+{
+    TRACE_THREAD_NAME("MeshWorker");
+    TRACE_ZONE("MeshWorker::run");
+    // only CPU data is touched here, the GL thread uploads it once finished() has been delivered. The sampling is
+    // short and runs to the end, its points are always kept since the next triangulation reads them
+    bool completed = true;
+    switch(m_job)
+    {
+        case SAMPLE : m_mesh->SampleMesh();
+                      break;
+        case TRIANGULATE : m_mesh->setSnapToGrid(m_snapToGrid != 0);
+                           completed = m_mesh->delaunay(this);
+                           break;
+        default : break;
+    }
+    m_result = completed ? m_job : NONE;
+}
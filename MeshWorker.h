@@ -0,0 +1,151 @@
+#ifndef MESHWORKER_H
+#define MESHWORKER_H
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file MeshWorker.h
+/// @author Maria Vineeta Bagya Seelan
+/// @version 1.2
+/// @date 16/08/13
+/// Revision History :
+/// Initial Version 16/08/13
+/// 1.1 progressive mode publishing double buffered snapshots of the triangulation
+/// 1.2 snapped mode, the triangulation runs on the points snapped to an integer grid
+/// @class MeshWorker
+/// @brief thread that runs the sampling and the Delaunay/Voronoi build off the GUI thread, the results stay in the
+/// @brief MeshSampler and are uploaded by the GL thread once the job has finished
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QTime>
+#include "MeshSampler.h"
+
+class MeshWorker : public QThread, public DelaunayProgress
+{
+Q_OBJECT
+public :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the jobs the worker can run
+    //----------------------------------------------------------------------------------------------------------------------
+    enum Job { NONE, SAMPLE, TRIANGULATE };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief Constructor for MeshWorker
+    /// @param [in] _mesh the sampler the jobs run on
+    /// @param [in] _parent the parent object
+    //----------------------------------------------------------------------------------------------------------------------
+    MeshWorker(
+                MeshSampler *_mesh,
+                QObject *_parent = 0
+              );
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief starts a job, the worker must not be running
+    /// @param [in] _job the job to run
+    //----------------------------------------------------------------------------------------------------------------------
+    void startJob( Job _job );
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief asks the running job to stop, the triangulation stops within a few hundred points while the sampling
+    /// always runs to the end
+    //----------------------------------------------------------------------------------------------------------------------
+    void cancel();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief returns the job whose results are waiting to be uploaded and clears it, NONE if there is none or the
+    /// triangulation was cancelled. Only valid while the worker is not running
+    //----------------------------------------------------------------------------------------------------------------------
+    Job takeResult();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief called by Delaunay::compute on the worker thread, forwards the progress and answers the cancellation
+    /// @param [in] _inserted the number of points processed so far
+    /// @param [in] _total the number of points
+    /// @param [in] _alive the number of tetrahedra in the current mesh
+    //----------------------------------------------------------------------------------------------------------------------
+    bool report(int _inserted, int _total, int _alive);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief turns the progressive mode on or off, it applies from the next triangulation
+    /// @param [in] _progressive true to publish snapshots while the triangulation runs
+    //----------------------------------------------------------------------------------------------------------------------
+    void setProgressive( bool _progressive );
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the progressive mode
+    //----------------------------------------------------------------------------------------------------------------------
+    bool isProgressive();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief turns the snapped mode on or off, it applies from the next triangulation
+    /// @param [in] _snap true to snap the points to an integer grid and use the exact integer predicates
+    //----------------------------------------------------------------------------------------------------------------------
+    void setSnapToGrid( bool _snap );
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the snapped mode
+    //----------------------------------------------------------------------------------------------------------------------
+    bool isSnapToGrid();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief called by Delaunay::compute on the worker thread, hands the delta over if the last snapshot has been taken
+    /// and a frame has passed, it never waits for the GUI thread
+    /// @param [in] _delta the changes since the last snapshot taken
+    //----------------------------------------------------------------------------------------------------------------------
+    void publish(TetDelta &_delta);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief takes the published snapshot, called on the GUI thread after snapshotReady
+    /// @param [out] _delta receives the snapshot, it should be empty so its storage can be reused for the next one
+    //----------------------------------------------------------------------------------------------------------------------
+    void takeSnapshot( TetDelta &_delta );
+
+signals :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief emitted from the worker thread while the triangulation runs
+    /// @param [in] _inserted the number of points processed so far
+    /// @param [in] _total the number of points
+    /// @param [in] _alive the number of tetrahedra in the current mesh
+    //----------------------------------------------------------------------------------------------------------------------
+    void progress(int _inserted, int _total, int _alive);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief emitted from the worker thread when a snapshot has been published
+    //----------------------------------------------------------------------------------------------------------------------
+    void snapshotReady();
+
+protected :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the thread function, runs the current job
+    //----------------------------------------------------------------------------------------------------------------------
+    void run();
+
+private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the sampler the jobs run on
+    //----------------------------------------------------------------------------------------------------------------------
+    MeshSampler *m_mesh;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the job being run
+    //----------------------------------------------------------------------------------------------------------------------
+    Job m_job;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the finished job whose results have not been uploaded yet
+    //----------------------------------------------------------------------------------------------------------------------
+    Job m_result;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the cancellation token, set by the GUI thread and read by the worker
+    //----------------------------------------------------------------------------------------------------------------------
+    QAtomicInt m_cancel;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the progressive mode, read by the worker when a triangulation starts
+    //----------------------------------------------------------------------------------------------------------------------
+    QAtomicInt m_progressive;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the snapped mode, handed to the sampler when a triangulation starts
+    //----------------------------------------------------------------------------------------------------------------------
+    QAtomicInt m_snapToGrid;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the published snapshot, the worker only fills it when the GUI thread has emptied it
+    //----------------------------------------------------------------------------------------------------------------------
+    TetDelta m_snapshot;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief guards m_snapshot, the worker only ever tries it
+    //----------------------------------------------------------------------------------------------------------------------
+    QMutex m_snapshotLock;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief time since the last snapshot, used to publish at most one per frame
+    //----------------------------------------------------------------------------------------------------------------------
+    QTime m_lastSnapshot;
+};
+
+#endif // MESHWORKER_H
@@ -0,0 +1,233 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Parallel.cpp
+/// @brief The worker pool and the work stealing of the parallel loops
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Parallel.h"
+#include "Trace.h"
+#include "AllocStats.h"
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include <pthread.h>
+#include <unistd.h>
+
+// The pool is started by the first loop that needs it and its threads sleep on a condition variable between loops.
+// Every thread of a loop owns a share of the chunks, packed as begin and end into one 64 bit word. The owner takes
+// chunks from the front and a thief cuts off the back half, both with a compare and swap on the word, so a chunk
+// runs exactly once and no lock is held while the loop runs. A share is a plain value, so a swap that sees the same
+// word again is still correct
+
+namespace
+{
+
+typedef unsigned long long Share;
+
+inline Share makeShare(unsigned int _begin, unsigned int _end) { return ((Share)_end<<32) | _begin; }
+inline unsigned int shareBegin(Share _share) { return (unsigned int)_share; }
+inline unsigned int shareEnd(Share _share) { return (unsigned int)(_share>>32); }
+
+// each share sits on its own cache line as its owner and the thieves write it all the time
+struct WorkerShare
+{
+    volatile Share m_share;
+    char m_pad[64-sizeof(Share)];
+};
+
+struct Loop
+{
+    ParallelTask *m_task;
+    unsigned int m_count;
+    unsigned int m_grain;
+    unsigned int m_workers;
+    AllocStats::Phase m_phase;
+    WorkerShare *m_shares;
+};
+
+struct PoolThread
+{
+    unsigned int m_index;
+    unsigned int m_generation;
+};
+
+pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t s_wake = PTHREAD_COND_INITIALIZER;
+pthread_cond_t s_done = PTHREAD_COND_INITIALIZER;
+// held by the thread whose loop is on the pool
+pthread_mutex_t s_loopLock = PTHREAD_MUTEX_INITIALIZER;
+Loop *s_loop = NULL;
+unsigned int s_loopWorkers = 0;
+unsigned int s_generation = 0;
+unsigned int s_running = 0;
+unsigned int s_poolSize = 0;
+unsigned int s_threads = 0;
+__thread bool s_inLoop = false;
+
+bool takeChunk(WorkerShare &_share, unsigned int &o_chunk)
+{
+    while(true)
+    {
+        Share share = _share.m_share;
+        unsigned int begin = shareBegin(share);
+        unsigned int end = shareEnd(share);
+        if(begin >= end)
+        {
+            return false;
+        }
+        if(__sync_bool_compare_and_swap(&_share.m_share,share,makeShare(begin+1,end)))
+        {
+            o_chunk = begin;
+            return true;
+        }
+    }
+}
+
+bool steal(Loop &_loop, unsigned int _thief)
+{
+    for(unsigned int i=1; i<_loop.m_workers; ++i)
+    {
+        WorkerShare &victim = _loop.m_shares[(_thief+i)%_loop.m_workers];
+        while(true)
+        {
+            Share share = victim.m_share;
+            unsigned int begin = shareBegin(share);
+            unsigned int end = shareEnd(share);
+            if(begin >= end)
+            {
+                break;
+            }
+            unsigned int middle = end-(end-begin+1)/2;
+            if(__sync_bool_compare_and_swap(&victim.m_share,share,makeShare(begin,middle)))
+            {
+                // the thief's own share is empty, so no other thread swaps it while it is set
+                _loop.m_shares[_thief].m_share = makeShare(middle,end);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void work(Loop &_loop, unsigned int _worker)
+{
+    TRACE_ZONE("Parallel::forRange");
+    AllocStats::Scope phase(_loop.m_phase);
+    s_inLoop = true;
+    unsigned int chunk;
+    do
+    {
+        while(takeChunk(_loop.m_shares[_worker],chunk))
+        {
+            unsigned int begin = chunk*_loop.m_grain;
+            _loop.m_task->run(begin,std::min(_loop.m_count-begin,_loop.m_grain)+begin);
+        }
+    }
+    while(steal(_loop,_worker));
+    s_inLoop = false;
+}
+
+void* poolThread(void *_thread)
+{
+    PoolThread thread = *(PoolThread*)_thread;
+    delete (PoolThread*)_thread;
+    TRACE_THREAD_NAME("Worker");
+    pthread_mutex_lock(&s_lock);
+    while(true)
+    {
+        while(s_generation == thread.m_generation)
+        {
+            pthread_cond_wait(&s_wake,&s_lock);
+        }
+        thread.m_generation = s_generation;
+        // a thread that is not part of this loop may wake after it is over, it must not touch s_loop
+        if(thread.m_index >= s_loopWorkers)
+        {
+            continue;
+        }
+        Loop *loop = s_loop;
+        pthread_mutex_unlock(&s_lock);
+        work(*loop,thread.m_index);
+        pthread_mutex_lock(&s_lock);
+        if(--s_running == 0)
+        {
+            pthread_cond_signal(&s_done);
+        }
+    }
+    return NULL;
+}
+
+} // end anonymous namespace
+
+unsigned int Parallel::threadCount()
+{
+    if(s_threads == 0)
+    {
+        const char *env = getenv("DELAUNAY_THREADS");
+        long threads = env != NULL ? atol(env) : sysconf(_SC_NPROCESSORS_ONLN);
+        s_threads = threads > 0 ? threads : 1;
+    }
+    return s_threads;
+}
+
+void Parallel::setThreadCount(unsigned int _threads)
+{
+    s_threads = _threads > 0 ? _threads : 1;
+}
+
+void Parallel::forRange(unsigned int _count, unsigned int _grain, ParallelTask &_task)
+{
+    _grain = std::max(_grain,1u);
+    unsigned int chunks = _count/_grain + (_count%_grain != 0);
+    unsigned int workers = std::min(threadCount(),chunks);
+    if(workers <= 1 || s_inLoop || pthread_mutex_trylock(&s_loopLock) != 0)
+    {
+        if(_count > 0)
+        {
+            _task.run(0,_count);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&s_lock);
+    while(s_poolSize+1 < workers)
+    {
+        PoolThread *thread = new PoolThread;
+        thread->m_index = s_poolSize+1;
+        thread->m_generation = s_generation;
+        pthread_t id;
+        if(pthread_create(&id,NULL,poolThread,thread) != 0)
+        {
+            delete thread;
+            workers = s_poolSize+1;
+            break;
+        }
+        pthread_detach(id);
+        ++s_poolSize;
+    }
+
+    // the chunks are dealt out evenly, the stealing evens out what the deal gets wrong
+    std::vector<WorkerShare> shares(workers);
+    for(unsigned int w=0; w<workers; ++w)
+    {
+        shares[w].m_share = makeShare((unsigned long long)chunks*w/workers,(unsigned long long)chunks*(w+1)/workers);
+    }
+    Loop loop = { &_task, _count, _grain, workers, AllocStats::currentPhase(), &shares[0] };
+    s_loop = &loop;
+    s_loopWorkers = workers;
+    s_running = workers-1;
+    ++s_generation;
+    pthread_cond_broadcast(&s_wake);
+    pthread_mutex_unlock(&s_lock);
+
+    work(loop,0);
+
+    pthread_mutex_lock(&s_lock);
+    while(s_running > 0)
+    {
+        pthread_cond_wait(&s_done,&s_lock);
+    }
+    s_loop = NULL;
+    s_loopWorkers = 0;
+    pthread_mutex_unlock(&s_lock);
+    pthread_mutex_unlock(&s_loopLock);
+}
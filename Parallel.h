@@ -0,0 +1,54 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Parallel.h
+/// @author Maria Vineeta Bagya Seelan
+/// @version 1.0
+/// @date 16/08/13
+/// Revision History :
+/// Initial Version 16/08/13
+/// @brief parallel loops over index ranges for the GL-free core. The range is cut into chunks that are dealt out to a
+/// @brief pool of worker threads, each worker takes chunks from the front of its own share and an idle worker steals
+/// @brief the back half of a busy worker's share, so uneven chunks still keep every thread busy
+//----------------------------------------------------------------------------------------------------------------------
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class ParallelTask
+/// @brief the body of a parallel loop, run is called from several threads at once on disjoint ranges
+//----------------------------------------------------------------------------------------------------------------------
+class ParallelTask
+{
+public:
+    virtual ~ParallelTask(){}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief runs the body over a range
+    /// @param [in] _begin the first index
+    /// @param [in] _end one past the last index
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void run(unsigned int _begin, unsigned int _end) = 0;
+};
+
+namespace Parallel
+{
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the number of threads a loop runs on, the calling thread included. It is the number of
+    /// online processors unless $DELAUNAY_THREADS or setThreadCount says otherwise
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int threadCount();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sets the number of threads the following loops run on
+    /// @param [in] _threads the number of threads, 1 runs the loops on the calling thread
+    //----------------------------------------------------------------------------------------------------------------------
+    void setThreadCount(unsigned int _threads);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief runs _task over [0,_count) and returns when every index is done. A loop started from inside another
+    /// loop runs on the calling thread, as do loops started while one is already running on the pool
+    /// @param [in] _count the number of indices
+    /// @param [in] _grain the number of indices in a chunk, the smallest piece of work that is handed out
+    /// @param [in] _task the body of the loop
+    //----------------------------------------------------------------------------------------------------------------------
+    void forRange(unsigned int _count, unsigned int _grain, ParallelTask &_task);
+}
+
+#endif // PARALLEL_H
@@ -0,0 +1,135 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file PointRenderer.cpp
+/// @brief Class that draws a set of points as instanced spheres
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "PointRenderer.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
+
+// One sphere lives in its own buffer and every point is an instance of it, the position comes from a second buffer
+// advanced once per instance. Setting the points only copies them, the upload happens on the next draw so the
+// sampler can be run without a GL context
+
+PointRenderer::PointRenderer(ngl::Real _radius, int _precision)
+{
+    m_points.clear();
+    m_dirty = false;
+    m_capacity = 0;
+    m_radius = _radius;
+    m_precision = std::max(_precision,2);
+    m_sphereVerts = 0;
+    m_vao = 0;
+    m_sphereVBO = 0;
+    m_instanceVBO = 0;
+}
+
+PointRenderer::~PointRenderer()
+{
+    if(m_vao!=0)
+    {
+        glDeleteBuffers(1,&m_sphereVBO);
+        glDeleteBuffers(1,&m_instanceVBO);
+        glDeleteVertexArrays(1,&m_vao);
+    }
+}
+
+void PointRenderer::setPoints(const std::vector<ngl::Vec3> &_points)
+{
+    m_points = _points;
+    m_dirty = true;
+}
+
+void PointRenderer::clear()
+{
+    m_points.clear();
+    m_dirty = true;
+}
+
+void PointRenderer::createSphere()
+{
+    // the sphere is built from stacks and slices, each quad split into two triangles
+    int stacks = m_precision;
+    int slices = 2*m_precision;
+    std::vector<ngl::Vec3> ring((stacks+1)*(slices+1));
+    for(int i=0; i<=stacks; ++i)
+    {
+        float theta = M_PI*i/stacks;
+        for(int j=0; j<=slices; ++j)
+        {
+            float phi = 2.0*M_PI*j/slices;
+            ring[i*(slices+1)+j] = ngl::Vec3(m_radius*sin(theta)*cos(phi),m_radius*cos(theta),m_radius*sin(theta)*sin(phi));
+        }
+    }
+    std::vector<ngl::Vec3> tris;
+    tris.reserve(6*stacks*slices);
+    for(int i=0; i<stacks; ++i)
+    {
+        for(int j=0; j<slices; ++j)
+        {
+            int a = i*(slices+1)+j;
+            int b = a+slices+1;
+            tris.push_back(ring[a]);
+            tris.push_back(ring[b]);
+            tris.push_back(ring[a+1]);
+            tris.push_back(ring[a+1]);
+            tris.push_back(ring[b]);
+            tris.push_back(ring[b+1]);
+        }
+    }
+    m_sphereVerts = tris.size();
+
+    glGenVertexArrays(1,&m_vao);
+    glGenBuffers(1,&m_sphereVBO);
+    glGenBuffers(1,&m_instanceVBO);
+    glBindVertexArray(m_vao);
+    // sphere vertex is attribute 0 with x,y,z
+    glBindBuffer(GL_ARRAY_BUFFER,m_sphereVBO);
+    glBufferData(GL_ARRAY_BUFFER,tris.size()*sizeof(ngl::Vec3),&tris[0].m_x,GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(ngl::Vec3),0);
+    // point position is attribute 1, advanced once per instance
+    glBindBuffer(GL_ARRAY_BUFFER,m_instanceVBO);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,sizeof(ngl::Vec3),0);
+    glVertexAttribDivisor(1,1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER,0);
+}
+
+void PointRenderer::upload()
+{
+    TRACE_ZONE("PointRenderer::upload");
+    if(m_vao == 0)
+    {
+        createSphere();
+    }
+    glBindBuffer(GL_ARRAY_BUFFER,m_instanceVBO);
+    if(m_points.size() > m_capacity)
+    {
+        // grow geometrically so resampling at a higher density reallocates rarely
+        m_capacity = std::max((unsigned int)m_points.size(),std::max(2*m_capacity,1024u));
+        glBufferData(GL_ARRAY_BUFFER,m_capacity*sizeof(ngl::Vec3),NULL,GL_DYNAMIC_DRAW);
+    }
+    if(!m_points.empty())
+    {
+        glBufferSubData(GL_ARRAY_BUFFER,0,m_points.size()*sizeof(ngl::Vec3),&m_points[0].m_x);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER,0);
+    m_dirty = false;
+}
+
+void PointRenderer::draw()
+{
+    if(m_dirty)
+    {
+        upload();
+    }
+    if(m_vao!=0 && !m_points.empty())
+    {
+        glBindVertexArray(m_vao);
+        glDrawArraysInstanced(GL_TRIANGLES,0,m_sphereVerts,m_points.size());
+        glBindVertexArray(0);
+    }
+}
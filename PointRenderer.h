@@ -0,0 +1,97 @@
+#ifndef POINTRENDERER_H
+#define POINTRENDERER_H
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file PointRenderer.h
+/// @author Maria Vineeta Bagya Seelan
+/// @version 1.0
+/// @date 16/08/13
+/// Revision History :
+/// Initial Version 16/08/13
+/// @class PointRenderer
+/// @brief render adapter that draws a set of points as small spheres with one instanced call, the positions are kept
+/// @brief in an instance buffer that is only uploaded when the points change
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "ngl/Vec3.h"
+#include "ngl/Types.h"
+#include <vector>
+
+class PointRenderer
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief Constructor for PointRenderer, does not need a GL context
+    /// @param [in] _radius the radius of the marker sphere
+    /// @param [in] _precision the number of stacks of the marker sphere, it has twice as many slices
+    //----------------------------------------------------------------------------------------------------------------------
+    PointRenderer(ngl::Real _radius=0.01, int _precision=10);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief Destructor for PointRenderer, releases the GPU buffers
+    //----------------------------------------------------------------------------------------------------------------------
+    ~PointRenderer();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that replaces the points, they are copied and uploaded on the next draw
+    /// @param [in] _points the marker positions
+    //----------------------------------------------------------------------------------------------------------------------
+    void setPoints(const std::vector<ngl::Vec3> &_points);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that removes all the points
+    //----------------------------------------------------------------------------------------------------------------------
+    void clear();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the number of points
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int getPointCount() const { return m_points.size(); }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief method that draws a sphere at every point with one instanced call, expects a shader with the sphere
+    /// vertex at attribute 0 and the point position at attribute 1
+    //----------------------------------------------------------------------------------------------------------------------
+    void draw();
+
+private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief CPU copy of the instance buffer
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<ngl::Vec3> m_points;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true when m_points has changed since the last upload
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_dirty;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief number of points the instance buffer has room for
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int m_capacity;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief radius and number of stacks of the marker sphere
+    //----------------------------------------------------------------------------------------------------------------------
+    ngl::Real m_radius;
+    int m_precision;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief number of vertices in the marker sphere
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int m_sphereVerts;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief vertex array, sphere buffer and instance buffer, 0 until the first draw
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_vao;
+    GLuint m_sphereVBO;
+    GLuint m_instanceVBO;
+
+private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that creates the vertex array with the marker sphere as a triangle list
+    //----------------------------------------------------------------------------------------------------------------------
+    void createSphere();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that uploads the points, growing the instance buffer when it is too small
+    //----------------------------------------------------------------------------------------------------------------------
+    void upload();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief PointRenderer owns GPU buffers so it is not copyable
+    //----------------------------------------------------------------------------------------------------------------------
+    PointRenderer(const PointRenderer &);
+    PointRenderer& operator=(const PointRenderer &);
+};
+
+#endif // POINTRENDERER_H
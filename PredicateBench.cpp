@@ -0,0 +1,501 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file PredicateBench.cpp
+/// @brief Micro-benchmark for orient3d, insphere and insphere3d, the oriented test Delaunay::compute calls. For each
+/// workload it reports the time per call, the fraction of calls resolved at each filter stage and the number of signs
+/// that disagree with an exact big integer evaluation of the same determinant. It exits non zero if any sign does.
+/// usage : PredicateBench [calls per workload] [repetitions]
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Predicates.h"
+#include "Tetrahedron.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <sys/time.h>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief signed integer of arbitrary size, only what the reference determinants need
+//----------------------------------------------------------------------------------------------------------------------
+class BigInt
+{
+public:
+    BigInt() : m_negative(false) {}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief builds _value * 2^_shift
+    //----------------------------------------------------------------------------------------------------------------------
+    BigInt(long _value, int _shift) : m_negative(_value < 0)
+    {
+        unsigned long magnitude = _value < 0 ? -_value : _value;
+        while(magnitude != 0)
+        {
+            m_limbs.push_back((unsigned int)(magnitude & 0xffffffffUL));
+            magnitude = (magnitude >> 16) >> 16;
+        }
+        if(m_limbs.empty())
+        {
+            m_negative = false;
+            return;
+        }
+        // shift by whole limbs, then by the remaining bits
+        m_limbs.insert(m_limbs.begin(), _shift/32, 0u);
+        int bits = _shift%32;
+        if(bits != 0)
+        {
+            unsigned int carry = 0;
+            for(unsigned int i=0; i<m_limbs.size(); ++i)
+            {
+                unsigned int next = m_limbs[i] >> (32-bits);
+                m_limbs[i] = (m_limbs[i] << bits) | carry;
+                carry = next;
+            }
+            if(carry != 0)
+            {
+                m_limbs.push_back(carry);
+            }
+        }
+    }
+
+    int sign() const { return m_limbs.empty() ? 0 : (m_negative ? -1 : 1); }
+
+    BigInt operator-() const
+    {
+        BigInt r = *this;
+        r.m_negative = !m_negative && !m_limbs.empty();
+        return r;
+    }
+
+    BigInt operator+(const BigInt &_b) const
+    {
+        if(m_negative == _b.m_negative)
+        {
+            BigInt r = addMagnitude(*this,_b);
+            r.m_negative = m_negative && !r.m_limbs.empty();
+            return r;
+        }
+        int c = compareMagnitude(*this,_b);
+        if(c == 0)
+        {
+            return BigInt();
+        }
+        BigInt r = c > 0 ? subMagnitude(*this,_b) : subMagnitude(_b,*this);
+        r.m_negative = c > 0 ? m_negative : _b.m_negative;
+        return r;
+    }
+
+    BigInt operator-(const BigInt &_b) const { return *this + (-_b); }
+
+    BigInt operator*(const BigInt &_b) const
+    {
+        BigInt r;
+        if(m_limbs.empty() || _b.m_limbs.empty())
+        {
+            return r;
+        }
+        std::vector<unsigned long long> acc(m_limbs.size()+_b.m_limbs.size()+1,0);
+        for(unsigned int i=0; i<m_limbs.size(); ++i)
+        {
+            unsigned long long carry = 0;
+            for(unsigned int j=0; j<_b.m_limbs.size(); ++j)
+            {
+                unsigned long long t = acc[i+j] + (unsigned long long)m_limbs[i]*_b.m_limbs[j] + carry;
+                acc[i+j] = t & 0xffffffffULL;
+                carry = t >> 32;
+            }
+            acc[i+_b.m_limbs.size()] += carry;
+        }
+        for(unsigned int i=0; i<acc.size(); ++i)
+        {
+            r.m_limbs.push_back((unsigned int)acc[i]);
+        }
+        r.trim();
+        r.m_negative = m_negative != _b.m_negative;
+        return r;
+    }
+
+private:
+    void trim()
+    {
+        while(!m_limbs.empty() && m_limbs.back() == 0)
+        {
+            m_limbs.pop_back();
+        }
+    }
+
+    static int compareMagnitude(const BigInt &_a, const BigInt &_b)
+    {
+        if(_a.m_limbs.size() != _b.m_limbs.size())
+        {
+            return _a.m_limbs.size() > _b.m_limbs.size() ? 1 : -1;
+        }
+        for(int i=(int)_a.m_limbs.size()-1; i>=0; --i)
+        {
+            if(_a.m_limbs[i] != _b.m_limbs[i])
+            {
+                return _a.m_limbs[i] > _b.m_limbs[i] ? 1 : -1;
+            }
+        }
+        return 0;
+    }
+
+    static BigInt addMagnitude(const BigInt &_a, const BigInt &_b)
+    {
+        BigInt r;
+        unsigned long long carry = 0;
+        for(unsigned int i=0; i<std::max(_a.m_limbs.size(),_b.m_limbs.size()); ++i)
+        {
+            unsigned long long t = carry;
+            t += i<_a.m_limbs.size() ? _a.m_limbs[i] : 0;
+            t += i<_b.m_limbs.size() ? _b.m_limbs[i] : 0;
+            r.m_limbs.push_back((unsigned int)t);
+            carry = t >> 32;
+        }
+        if(carry != 0)
+        {
+            r.m_limbs.push_back((unsigned int)carry);
+        }
+        return r;
+    }
+
+    // |_a| - |_b| for |_a| > |_b|
+    static BigInt subMagnitude(const BigInt &_a, const BigInt &_b)
+    {
+        BigInt r;
+        long long borrow = 0;
+        for(unsigned int i=0; i<_a.m_limbs.size(); ++i)
+        {
+            long long t = (long long)_a.m_limbs[i] - borrow - (i<_b.m_limbs.size() ? _b.m_limbs[i] : 0);
+            borrow = t < 0;
+            r.m_limbs.push_back((unsigned int)(t + (borrow << 32)));
+        }
+        r.trim();
+        return r;
+    }
+
+    bool m_negative;
+    std::vector<unsigned int> m_limbs;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief one query, orient3d uses the first four points and insphere all five
+//----------------------------------------------------------------------------------------------------------------------
+struct Query
+{
+    ngl::Vec3 m_p[5];
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+// Exact reference: every float is an integer times a power of two, so scaling the coordinates of a query by the
+// smallest power present turns them into integers and leaves the sign of the determinant unchanged.
+//----------------------------------------------------------------------------------------------------------------------
+static void toIntegers(const Query &_q, int _n, BigInt _out[5][3])
+{
+    int minExponent = 0;
+    bool first = true;
+    for(int i=0; i<_n; ++i)
+    {
+        for(int c=0; c<3; ++c)
+        {
+            float v = c==0 ? _q.m_p[i].m_x : (c==1 ? _q.m_p[i].m_y : _q.m_p[i].m_z);
+            if(v != 0.0f)
+            {
+                int e;
+                frexpf(v,&e);
+                if(first || e < minExponent)
+                {
+                    minExponent = e;
+                    first = false;
+                }
+            }
+        }
+    }
+    for(int i=0; i<_n; ++i)
+    {
+        for(int c=0; c<3; ++c)
+        {
+            float v = c==0 ? _q.m_p[i].m_x : (c==1 ? _q.m_p[i].m_y : _q.m_p[i].m_z);
+            int e;
+            float m = frexpf(v,&e);
+            // m * 2^24 is the integer mantissa of v, worth 2^(e-24)
+            long mantissa = (long)ldexpf(m,24);
+            _out[i][c] = BigInt(mantissa, v != 0.0f ? e-minExponent : 0);
+        }
+    }
+}
+
+static int exactOrient3d(const Query &_q)
+{
+    BigInt p[5][3];
+    toIntegers(_q,4,p);
+    BigInt ad[3], bd[3], cd[3];
+    for(int c=0; c<3; ++c)
+    {
+        ad[c] = p[0][c] - p[3][c];
+        bd[c] = p[1][c] - p[3][c];
+        cd[c] = p[2][c] - p[3][c];
+    }
+    BigInt det = ad[2]*(bd[0]*cd[1] - cd[0]*bd[1])
+               + bd[2]*(cd[0]*ad[1] - ad[0]*cd[1])
+               + cd[2]*(ad[0]*bd[1] - bd[0]*ad[1]);
+    return det.sign();
+}
+
+static int exactInsphere(const Query &_q)
+{
+    BigInt p[5][3];
+    toIntegers(_q,5,p);
+    BigInt d[4][3], lift[4];
+    for(int i=0; i<4; ++i)
+    {
+        for(int c=0; c<3; ++c)
+        {
+            d[i][c] = p[i][c] - p[4][c];
+        }
+        lift[i] = d[i][0]*d[i][0] + d[i][1]*d[i][1] + d[i][2]*d[i][2];
+    }
+    // same expansion as Predicates::insphere
+    BigInt ab = d[0][0]*d[1][1] - d[1][0]*d[0][1];
+    BigInt bc = d[1][0]*d[2][1] - d[2][0]*d[1][1];
+    BigInt cd = d[2][0]*d[3][1] - d[3][0]*d[2][1];
+    BigInt da = d[3][0]*d[0][1] - d[0][0]*d[3][1];
+    BigInt ac = d[0][0]*d[2][1] - d[2][0]*d[0][1];
+    BigInt bd = d[1][0]*d[3][1] - d[3][0]*d[1][1];
+    BigInt abc = d[0][2]*bc - d[1][2]*ac + d[2][2]*ab;
+    BigInt bcd = d[1][2]*cd - d[2][2]*bd + d[3][2]*bc;
+    BigInt cda = d[2][2]*da + d[3][2]*ac + d[0][2]*cd;
+    BigInt dab = d[3][2]*ab + d[0][2]*bd + d[1][2]*da;
+    BigInt det = (lift[3]*abc - lift[2]*dab) + (lift[1]*cda - lift[0]*bcd);
+    return det.sign();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Workloads
+//----------------------------------------------------------------------------------------------------------------------
+static float uniform(float _min, float _max)
+{
+    return _min + (_max-_min)*(rand()/(float)RAND_MAX);
+}
+
+static ngl::Vec3 uniformPoint(float _min, float _max)
+{
+    return ngl::Vec3(uniform(_min,_max),uniform(_min,_max),uniform(_min,_max));
+}
+
+static ngl::Vec3 onSphere(ngl::Vec3 _centre, float _radius)
+{
+    ngl::Vec3 d;
+    float length;
+    do
+    {
+        d = uniformPoint(-1.0,1.0);
+        length = std::sqrt(d.m_x*d.m_x + d.m_y*d.m_y + d.m_z*d.m_z);
+    }
+    while(length < 0.1f || length > 1.0f);
+    return ngl::Vec3(_centre.m_x + _radius*d.m_x/length,
+                     _centre.m_y + _radius*d.m_y/length,
+                     _centre.m_z + _radius*d.m_z/length);
+}
+
+enum Workload { UNIFORM = 0, CLUSTERED, NEAR_COPLANAR, NEAR_COSPHERICAL, LARGE_OFFSET, WORKLOADS };
+static const char *s_workloadNames[WORKLOADS] = { "uniform", "clustered", "near-coplanar", "near-cospherical", "large-offset" };
+
+static std::vector<Query> makeQueries(Workload _workload, int _count)
+{
+    std::vector<Query> queries(_count);
+    std::vector<ngl::Vec3> centres;
+    for(int i=0; i<8; ++i)
+    {
+        centres.push_back(uniformPoint(-1.0,1.0));
+    }
+    for(int i=0; i<_count; ++i)
+    {
+        Query &q = queries[i];
+        switch(_workload)
+        {
+            case UNIFORM :
+                for(int k=0; k<5; ++k)
+                {
+                    q.m_p[k] = uniformPoint(-1.0,1.0);
+                }
+                break;
+            case CLUSTERED :
+            {
+                // tight clusters, the predicates see tiny differences of large coordinates
+                ngl::Vec3 c = centres[rand()%centres.size()];
+                for(int k=0; k<5; ++k)
+                {
+                    q.m_p[k] = c + uniformPoint(-0.001f,0.001f);
+                }
+                break;
+            }
+            case NEAR_COPLANAR :
+            {
+                // d and e are affine combinations of a, b and c, rounded to float
+                for(int k=0; k<3; ++k)
+                {
+                    q.m_p[k] = uniformPoint(-1.0,1.0);
+                }
+                for(int k=3; k<5; ++k)
+                {
+                    float u = uniform(-1.0,2.0), v = uniform(-1.0,2.0);
+                    q.m_p[k] = q.m_p[0] + (q.m_p[1]-q.m_p[0])*u + (q.m_p[2]-q.m_p[0])*v;
+                }
+                break;
+            }
+            case NEAR_COSPHERICAL :
+            {
+                ngl::Vec3 c = uniformPoint(-1.0,1.0);
+                float r = uniform(0.1f,1.0f);
+                for(int k=0; k<5; ++k)
+                {
+                    q.m_p[k] = onSphere(c,r);
+                }
+                break;
+            }
+            case LARGE_OFFSET :
+            {
+                // a unit box far from the origin
+                ngl::Vec3 offset(4096.0,-8192.0,2048.0);
+                for(int k=0; k<5; ++k)
+                {
+                    q.m_p[k] = offset + uniformPoint(-1.0,1.0);
+                }
+                break;
+            }
+            default :
+                break;
+        }
+    }
+    return queries;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+// Timing and report
+//----------------------------------------------------------------------------------------------------------------------
+static double now()
+{
+    timeval t;
+    gettimeofday(&t,NULL);
+    return t.tv_sec + t.tv_usec*1e-6;
+}
+
+static void report(const char *_workload, const char *_predicate, double _seconds, unsigned long _calls,
+                   const unsigned long *_stages, int _mismatches)
+{
+    unsigned long total = 0;
+    for(int s=SEMI_STATIC; s<=EXACT; ++s)
+    {
+        total += _stages[s];
+    }
+    total = total == 0 ? 1 : total;
+    printf("%-17s %-10s %8.1f  %6.2f %6.2f %6.2f %6.2f %6.2f  %d\n",_workload,_predicate,1e9*_seconds/_calls,
+           100.0*_stages[SEMI_STATIC]/total,100.0*_stages[DYNAMIC_FILTER]/total,100.0*_stages[ADAPTIVE_B]/total,
+           100.0*_stages[ADAPTIVE_C]/total,100.0*_stages[EXACT]/total,_mismatches);
+}
+
+int main(int argc, char **argv)
+{
+    int count = argc > 1 ? atoi(argv[1]) : 100000;
+    int repetitions = argc > 2 ? atoi(argv[2]) : 10;
+    int mismatches = 0;
+    srand(1);
+
+    printf("%-17s %-10s %8s  %6s %6s %6s %6s %6s  %s\n","workload","predicate","ns/call",
+           "static","filter","adaptB","adaptC","exact","mismatches");
+    for(int w=0; w<WORKLOADS; ++w)
+    {
+        std::vector<Query> queries = makeQueries((Workload)w,count);
+
+        // the semi-static bounds come from the box of the workload, as in Delaunay::compute
+        ngl::Vec3 minBound = queries[0].m_p[0];
+        ngl::Vec3 maxBound = queries[0].m_p[0];
+        for(int i=0; i<count; ++i)
+        {
+            for(int k=0; k<5; ++k)
+            {
+                ngl::Vec3 p = queries[i].m_p[k];
+                minBound = ngl::Vec3(std::min(minBound.m_x,p.m_x),std::min(minBound.m_y,p.m_y),std::min(minBound.m_z,p.m_z));
+                maxBound = ngl::Vec3(std::max(maxBound.m_x,p.m_x),std::max(maxBound.m_y,p.m_y),std::max(maxBound.m_z,p.m_z));
+            }
+        }
+        Predicates predicates;
+        predicates.setBounds(minBound,maxBound);
+        // raw signs, so that they can be compared with the exact ones
+        predicates.setPerturbation(false);
+
+        std::vector<Tetrahedron> tets;
+        tets.reserve(count);
+        for(int i=0; i<count; ++i)
+        {
+            const Query &q = queries[i];
+            tets.push_back(Tetrahedron(q.m_p[0],q.m_p[1],q.m_p[2],q.m_p[3]));
+        }
+        // a predicates object of its own, so its counts are those of the oriented test alone
+        Predicates oriented;
+        oriented.setBounds(minBound,maxBound);
+        oriented.setPerturbation(false);
+
+        std::vector<float> orientation(count), sphere(count), sphere3d(count);
+        double start = now();
+        for(int r=0; r<repetitions; ++r)
+        {
+            for(int i=0; i<count; ++i)
+            {
+                const Query &q = queries[i];
+                orientation[i] = predicates.orient3d(q.m_p[0],q.m_p[1],q.m_p[2],q.m_p[3]);
+            }
+        }
+        double orientSeconds = now() - start;
+
+        start = now();
+        for(int r=0; r<repetitions; ++r)
+        {
+            for(int i=0; i<count; ++i)
+            {
+                const Query &q = queries[i];
+                sphere[i] = predicates.insphere(q.m_p[0],q.m_p[1],q.m_p[2],q.m_p[3],q.m_p[4]);
+            }
+        }
+        double sphereSeconds = now() - start;
+
+        start = now();
+        for(int r=0; r<repetitions; ++r)
+        {
+            for(int i=0; i<count; ++i)
+            {
+                sphere3d[i] = oriented.insphere3d(&tets[i],queries[i].m_p[4]);
+            }
+        }
+        double sphere3dSeconds = now() - start;
+
+        int orientMismatches = 0, sphereMismatches = 0, sphere3dMismatches = 0;
+        for(int i=0; i<count; ++i)
+        {
+            int o = (orientation[i] > 0) - (orientation[i] < 0);
+            int s = (sphere[i] > 0) - (sphere[i] < 0);
+            int s3d = (sphere3d[i] > 0) - (sphere3d[i] < 0);
+            int exactO = exactOrient3d(queries[i]);
+            int exactS = exactInsphere(queries[i]);
+            orientMismatches += o != exactO;
+            sphereMismatches += s != exactS;
+            // insphere3d reads the sign of insphere by the orientation, positive inside
+            sphere3dMismatches += s3d != exactO*exactS;
+        }
+
+        const PredicateStats &stats = predicates.getStats();
+        unsigned long calls = (unsigned long)count*repetitions;
+        report(s_workloadNames[w],"orient3d",orientSeconds,calls,stats.m_orient3d,orientMismatches);
+        report(s_workloadNames[w],"insphere",sphereSeconds,calls,stats.m_insphere,sphereMismatches);
+        // the stages are those of its insphere, each call also takes one orient3d
+        report(s_workloadNames[w],"insphere3d",sphere3dSeconds,calls,oriented.getStats().m_insphere,
+               sphere3dMismatches);
+        mismatches += orientMismatches + sphereMismatches + sphere3dMismatches;
+    }
+    if(mismatches != 0)
+    {
+        fprintf(stderr,"%d signs differ from the exact evaluation\n",mismatches);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
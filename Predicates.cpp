@@ -19,13 +19,12 @@
 
 #include "include/Predicates.h"
 
-#include "ngl/Mat3.h"
-#include "ngl/Mat4.h"
-
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 #include <time.h>
+#include <float.h>
+#include <vector>
 #include "Predicates.h"
 
 /* On some machines, the exact arithmetic routines might be defeated by the  */
@@ -40,6 +39,14 @@
 #define INEXACT                          /* Nothing */
 /* #define INEXACT volatile */
 
+/* A fused multiply-add rounds a * b + c once where Two_Product and the     */
+/*   expansions expect two roundings, so contracting them breaks the error-  */
+/*   free transforms and the signs of the adaptive stages.  GCC contracts by */
+/*   default for targets with FMA (-march=native); the Makefile passes      */
+/*   -ffp-contract=off and this keeps the file safe under any other flags.   */
+
+#pragma GCC optimize ("fp-contract=off")
+
 //#define float double                      /* float or double */
 #define floatPRINT doubleprint
 #define floatRAND doublerand
@@ -55,6 +62,11 @@
 #define Absolute(a)  ((a) >= 0.0 ? (a) : -(a))
 /* #define Absolute(a)  fabs(a) */
 
+/* True if a coordinate difference fits the box given to setBounds().        */
+
+#define Inside_Box(x, y, z) \
+  ((Absolute(x) <= m_boxX) && (Absolute(y) <= m_boxY) && (Absolute(z) <= m_boxZ))
+
 /* Many of the operations are broken up into two pieces, a main part that    */
 /*   performs an approximate operation, and a "tail" that computes the       */
 /*   roundoff error of that operation.                                       */
@@ -280,6 +292,200 @@ float isperrboundA, isperrboundB, isperrboundC;
 Predicates::Predicates()
 {
     exactinit();
+    clearBounds();
+    clearSnapGrid();
+    resetStats();
+    m_perturb = true;
+}
+
+/*****************************************************************************/
+/*                                                                           */
+/*  setBounds()   Semi-static filter.                                        */
+/*                                                                           */
+/*  When the coordinate differences of a call are no larger than the extent  */
+/*  of a known box, so is the "permanent" the fast paths compute on every    */
+/*  call.  Multiplying that worst-case permanent by the error coefficient    */
+/*  gives one bound for the whole run; a determinant larger than it has a    */
+/*  certain sign without looking at the permanent at all.  Calls reaching    */
+/*  outside the box (the vertices of the big tetrahedron) and the ones the   */
+/*  constant cannot decide go on to the dynamic filter and adaptive code.    */
+/*                                                                           */
+/*****************************************************************************/
+
+static float roundUp(double _value)
+{
+  float result = (float) _value;
+  if (result < _value) {
+    result = nextafterf(result, FLT_MAX);
+  }
+  return result;
+}
+
+void Predicates::setBounds(ngl::Vec3 _min, ngl::Vec3 _max)
+{
+  /* A rounded difference can exceed the exact one by half an ulp. */
+  double slack = 1.0 + 2.0 * epsilon;
+  double dx = ((double) _max.m_x - (double) _min.m_x) * slack;
+  double dy = ((double) _max.m_y - (double) _min.m_y) * slack;
+  double dz = ((double) _max.m_z - (double) _min.m_z) * slack;
+  m_boxX = roundUp(dx);
+  m_boxY = roundUp(dy);
+  m_boxZ = roundUp(dz);
+  double lift = dx * dx + dy * dy + dz * dz;
+
+  /* orient3d: three terms of (|bdx*cdy| + |cdx*bdy|) * |adz|. */
+  double o3dpermanent = 6.0 * dx * dy * dz;
+  /* insphere: four lifts, each times three terms of two products by a z. */
+  double isppermanent = 24.0 * dx * dy * dz * lift;
+
+  /* Cover the roundoff of the permanent the fast paths would compute. */
+  slack = 1.0 + 16.0 * epsilon;
+  m_o3dStaticBound = roundUp(o3derrboundA * o3dpermanent * slack);
+  m_ispStaticBound = roundUp(isperrboundA * isppermanent * slack);
+}
+
+void Predicates::clearBounds()
+{
+  /* No finite determinant passes a bound of FLT_MAX. */
+  m_o3dStaticBound = FLT_MAX;
+  m_ispStaticBound = FLT_MAX;
+  m_boxX = 0.0;
+  m_boxY = 0.0;
+  m_boxZ = 0.0;
+}
+
+void Predicates::resetStats()
+{
+  for (int i = 0; i < PREDICATE_STAGES; i++) {
+    m_stats.m_orient3d[i] = 0;
+    m_stats.m_insphere[i] = 0;
+  }
+}
+
+/*****************************************************************************/
+/*                                                                           */
+/*  setSnapGrid()   Integer snapped mode.                                    */
+/*                                                                           */
+/*  Points are rounded to a grid of power of two spacing h anchored at an    */
+/*  origin o that is itself a multiple of h.  The integer predicates hold    */
+/*  the points within 2^(s_snapBits - 1) nodes of o; a call with any point   */
+/*  outside that box, such as a vertex of the big tetrahedron, goes through  */
+/*  the floating point stages, which are exact on the same inputs.  For a    */
+/*  node x the difference x - o is a multiple of h below 2^s_snapBits * h,   */
+/*  so it is exact in a float and (x - o) / h recovers the integer without   */
+/*  rounding.                                                                */
+/*                                                                           */
+/*  With integers of at most 2^23 in magnitude the differences fit in 25     */
+/*  bits, the 2x2 minors and the lifts in 64 bits, and the orient3d and      */
+/*  insphere determinants (at most 3 * 2^73 and 9 * 2^123) in 128 bits.      */
+/*  Both tests are then exact with a fixed sequence of integer operations,   */
+/*  and give the same answer on every machine.                               */
+/*                                                                           */
+/*****************************************************************************/
+
+typedef long long SnapInt;
+typedef __int128 SnapWide;
+
+#define Sign(x)  ((float) (((x) > 0) - ((x) < 0)))
+
+float Predicates::snapSpacing(float _maxCoordinate)
+{
+  int exponent;
+  /* _maxCoordinate < 2^exponent, so it is below 2^(s_snapBits - 1) nodes. */
+  frexpf(_maxCoordinate, &exponent);
+  return ldexpf(1.0f, exponent - (s_snapBits - 1));
+}
+
+void Predicates::setSnapGrid(ngl::Vec3 _origin, float _spacing)
+{
+  m_snapped = true;
+  m_snapSpacing = _spacing;
+  m_invSnapSpacing = 1.0f / _spacing;
+  m_snapOrigin = _origin;
+  m_snapReach = ldexpf(_spacing, s_snapBits - 1);
+}
+
+void Predicates::clearSnapGrid()
+{
+  m_snapped = false;
+  m_snapSpacing = 1.0f;
+  m_invSnapSpacing = 1.0f;
+  m_snapOrigin = ngl::Vec3(0.0, 0.0, 0.0);
+  m_snapReach = 0.0f;
+}
+
+ngl::Vec3 Predicates::snap(ngl::Vec3 _p) const
+{
+  /* rintf rounds halfway cases to even, the same way everywhere. */
+  return ngl::Vec3(m_snapOrigin.m_x + rintf((_p.m_x - m_snapOrigin.m_x) * m_invSnapSpacing) * m_snapSpacing,
+                   m_snapOrigin.m_y + rintf((_p.m_y - m_snapOrigin.m_y) * m_invSnapSpacing) * m_snapSpacing,
+                   m_snapOrigin.m_z + rintf((_p.m_z - m_snapOrigin.m_z) * m_invSnapSpacing) * m_snapSpacing);
+}
+
+float Predicates::orient3dSnapped(ngl::Vec3 _a, ngl::Vec3 _b, ngl::Vec3 _c, ngl::Vec3 _p)
+{
+  SnapInt px = (SnapInt) ((_p.m_x - m_snapOrigin.m_x) * m_invSnapSpacing);
+  SnapInt py = (SnapInt) ((_p.m_y - m_snapOrigin.m_y) * m_invSnapSpacing);
+  SnapInt pz = (SnapInt) ((_p.m_z - m_snapOrigin.m_z) * m_invSnapSpacing);
+
+  SnapInt adx = (SnapInt) ((_a.m_x - m_snapOrigin.m_x) * m_invSnapSpacing) - px;
+  SnapInt bdx = (SnapInt) ((_b.m_x - m_snapOrigin.m_x) * m_invSnapSpacing) - px;
+  SnapInt cdx = (SnapInt) ((_c.m_x - m_snapOrigin.m_x) * m_invSnapSpacing) - px;
+  SnapInt ady = (SnapInt) ((_a.m_y - m_snapOrigin.m_y) * m_invSnapSpacing) - py;
+  SnapInt bdy = (SnapInt) ((_b.m_y - m_snapOrigin.m_y) * m_invSnapSpacing) - py;
+  SnapInt cdy = (SnapInt) ((_c.m_y - m_snapOrigin.m_y) * m_invSnapSpacing) - py;
+  SnapInt adz = (SnapInt) ((_a.m_z - m_snapOrigin.m_z) * m_invSnapSpacing) - pz;
+  SnapInt bdz = (SnapInt) ((_b.m_z - m_snapOrigin.m_z) * m_invSnapSpacing) - pz;
+  SnapInt cdz = (SnapInt) ((_c.m_z - m_snapOrigin.m_z) * m_invSnapSpacing) - pz;
+
+  SnapWide det = (SnapWide) adz * (bdx * cdy - cdx * bdy)
+               + (SnapWide) bdz * (cdx * ady - adx * cdy)
+               + (SnapWide) cdz * (adx * bdy - bdx * ady);
+
+  m_stats.m_orient3d[SNAPPED_EXACT]++;
+  return Sign(det);
+}
+
+float Predicates::insphereSnapped(ngl::Vec3 _a, ngl::Vec3 _b, ngl::Vec3 _c, ngl::Vec3 _d, ngl::Vec3 _p)
+{
+  SnapInt px = (SnapInt) ((_p.m_x - m_snapOrigin.m_x) * m_invSnapSpacing);
+  SnapInt py = (SnapInt) ((_p.m_y - m_snapOrigin.m_y) * m_invSnapSpacing);
+  SnapInt pz = (SnapInt) ((_p.m_z - m_snapOrigin.m_z) * m_invSnapSpacing);
+
+  SnapInt aex = (SnapInt) ((_a.m_x - m_snapOrigin.m_x) * m_invSnapSpacing) - px;
+  SnapInt bex = (SnapInt) ((_b.m_x - m_snapOrigin.m_x) * m_invSnapSpacing) - px;
+  SnapInt cex = (SnapInt) ((_c.m_x - m_snapOrigin.m_x) * m_invSnapSpacing) - px;
+  SnapInt dex = (SnapInt) ((_d.m_x - m_snapOrigin.m_x) * m_invSnapSpacing) - px;
+  SnapInt aey = (SnapInt) ((_a.m_y - m_snapOrigin.m_y) * m_invSnapSpacing) - py;
+  SnapInt bey = (SnapInt) ((_b.m_y - m_snapOrigin.m_y) * m_invSnapSpacing) - py;
+  SnapInt cey = (SnapInt) ((_c.m_y - m_snapOrigin.m_y) * m_invSnapSpacing) - py;
+  SnapInt dey = (SnapInt) ((_d.m_y - m_snapOrigin.m_y) * m_invSnapSpacing) - py;
+  SnapInt aez = (SnapInt) ((_a.m_z - m_snapOrigin.m_z) * m_invSnapSpacing) - pz;
+  SnapInt bez = (SnapInt) ((_b.m_z - m_snapOrigin.m_z) * m_invSnapSpacing) - pz;
+  SnapInt cez = (SnapInt) ((_c.m_z - m_snapOrigin.m_z) * m_invSnapSpacing) - pz;
+  SnapInt dez = (SnapInt) ((_d.m_z - m_snapOrigin.m_z) * m_invSnapSpacing) - pz;
+
+  SnapInt ab = aex * bey - bex * aey;
+  SnapInt bc = bex * cey - cex * bey;
+  SnapInt cd = cex * dey - dex * cey;
+  SnapInt da = dex * aey - aex * dey;
+  SnapInt ac = aex * cey - cex * aey;
+  SnapInt bd = bex * dey - dex * bey;
+
+  SnapWide abc = (SnapWide) aez * bc - (SnapWide) bez * ac + (SnapWide) cez * ab;
+  SnapWide bcd = (SnapWide) bez * cd - (SnapWide) cez * bd + (SnapWide) dez * bc;
+  SnapWide cda = (SnapWide) cez * da + (SnapWide) dez * ac + (SnapWide) aez * cd;
+  SnapWide dab = (SnapWide) dez * ab + (SnapWide) aez * bd + (SnapWide) bez * da;
+
+  SnapInt alift = aex * aex + aey * aey + aez * aez;
+  SnapInt blift = bex * bex + bey * bey + bez * bez;
+  SnapInt clift = cex * cex + cey * cey + cez * cez;
+  SnapInt dlift = dex * dex + dey * dey + dez * dez;
+
+  SnapWide det = (dlift * abc - clift * dab) + (blift * cda - alift * bcd);
+
+  m_stats.m_insphere[SNAPPED_EXACT]++;
+  return Sign(det);
 }
 
 //Ekstra: random()
@@ -1289,7 +1495,8 @@ ngl::Vec3pd;
   return deter[deterlen - 1];
 }
 
-float orient3dadapt(ngl::Vec3 pa,ngl::Vec3 pb,ngl::Vec3 pc,ngl::Vec3 pd,float permanent)
+float orient3dadapt(ngl::Vec3 pa,ngl::Vec3 pb,ngl::Vec3 pc,ngl::Vec3 pd,float permanent,
+                   unsigned long *stages)
 {
   INEXACT float adx, bdx, cdx, ady, bdy, cdy, adz, bdz, cdz;
   float det, errbound;
@@ -1376,6 +1583,7 @@ float orient3dadapt(ngl::Vec3 pa,ngl::Vec3 pb,ngl::Vec3 pc,ngl::Vec3 pd,float pe
   det = estimate(finlength, fin1);
   errbound = o3derrboundB * permanent;
   if ((det >= errbound) || (-det >= errbound)) {
+    stages[ADAPTIVE_B]++;
     return det;
   }
 
@@ -1392,6 +1600,7 @@ float orient3dadapt(ngl::Vec3 pa,ngl::Vec3 pb,ngl::Vec3 pc,ngl::Vec3 pd,float pe
   if ((adxtail == 0.0) && (bdxtail == 0.0) && (cdxtail == 0.0)
       && (adytail == 0.0) && (bdytail == 0.0) && (cdytail == 0.0)
       && (adztail == 0.0) && (bdztail == 0.0) && (cdztail == 0.0)) {
+    stages[ADAPTIVE_C]++;
     return det;
   }
 
@@ -1406,6 +1615,7 @@ float orient3dadapt(ngl::Vec3 pa,ngl::Vec3 pb,ngl::Vec3 pc,ngl::Vec3 pd,float pe
                  - (ady * bdxtail + bdx * adytail))
           + cdztail * (adx * bdy - ady * bdx));
   if ((det >= errbound) || (-det >= errbound)) {
+    stages[ADAPTIVE_C]++;
     return det;
   }
 
@@ -1686,10 +1896,11 @@ float orient3dadapt(ngl::Vec3 pa,ngl::Vec3 pb,ngl::Vec3 pc,ngl::Vec3 pd,float pe
     finswap = finnow; finnow = finother; finother = finswap;
   }
 
+  stages[EXACT]++;
   return finnow[finlength - 1];
 }
 
-float Predicates::orient3d(ngl::Vec3 _a,ngl::Vec3 _b,ngl::Vec3 _c,ngl::Vec3 _p)
+float Predicates::orient3dFiltered(ngl::Vec3 _a,ngl::Vec3 _b,ngl::Vec3 _c,ngl::Vec3 _p)
 {
   float adx, bdx, cdx, ady, bdy, cdy, adz, bdz, cdz;
   float bdxcdy, cdxbdy, cdxady, adxcdy, adxbdy, bdxady;
@@ -1719,15 +1930,23 @@ float Predicates::orient3d(ngl::Vec3 _a,ngl::Vec3 _b,ngl::Vec3 _c,ngl::Vec3 _p)
       + bdz * (cdxady - adxcdy)
       + cdz * (adxbdy - bdxady);
 
+  if (((det > m_o3dStaticBound) || (-det > m_o3dStaticBound))
+      && Inside_Box(adx, ady, adz) && Inside_Box(bdx, bdy, bdz)
+      && Inside_Box(cdx, cdy, cdz)) {
+    m_stats.m_orient3d[SEMI_STATIC]++;
+    return det;
+  }
+
   permanent = (Absolute(bdxcdy) + Absolute(cdxbdy)) * Absolute(adz)
             + (Absolute(cdxady) + Absolute(adxcdy)) * Absolute(bdz)
             + (Absolute(adxbdy) + Absolute(bdxady)) * Absolute(cdz);
   errbound = o3derrboundA * permanent;
   if ((det > errbound) || (-det > errbound)) {
+    m_stats.m_orient3d[DYNAMIC_FILTER]++;
     return det;
   }
 
-  return orient3dadapt(_a, _b, _c, _p, permanent);
+  return orient3dadapt(_a, _b, _c, _p, permanent, m_stats.m_orient3d);
 }
 
 /*****************************************************************************/
@@ -2009,7 +2228,8 @@ float insphereexact(ngl::Vec3 pa,ngl::Vec3 pb,ngl::Vec3 pc,ngl::Vec3 pd,ngl::Vec
   return deter[deterlen - 1];
 }
 
-float insphereadapt(ngl::Vec3 pa,ngl::Vec3 pb,ngl::Vec3 pc,ngl::Vec3 pd,ngl::Vec3 pe,float permanent)
+float insphereadapt(ngl::Vec3 pa,ngl::Vec3 pb,ngl::Vec3 pc,ngl::Vec3 pd,ngl::Vec3 pe,float permanent,
+                    unsigned long *stages)
 /*
 ngl::Vec3pa;
 ngl::Vec3pb;
@@ -2169,6 +2389,7 @@ float permanent;
   det = estimate(finlength, fin1);
   errbound = isperrboundB * permanent;
   if ((det >= errbound) || (-det >= errbound)) {
+    stages[ADAPTIVE_B]++;
     return det;
   }
 
@@ -2188,6 +2409,7 @@ float permanent;
       && (bextail == 0.0) && (beytail == 0.0) && (beztail == 0.0)
       && (cextail == 0.0) && (ceytail == 0.0) && (ceztail == 0.0)
       && (dextail == 0.0) && (deytail == 0.0) && (deztail == 0.0)) {
+    stages[ADAPTIVE_C]++;
     return det;
   }
 
@@ -2225,13 +2447,15 @@ float permanent;
                  + (cex * cextail + cey * ceytail + cez * ceztail)
                  * (dez * ab3 + aez * bd3 + bez * da3)));
   if ((det >= errbound) || (-det >= errbound)) {
+    stages[ADAPTIVE_C]++;
     return det;
   }
 
+  stages[EXACT]++;
   return insphereexact(pa, pb, pc, pd, pe);
 }
 
-float Predicates::insphere(ngl::Vec3 _a,ngl::Vec3 _b,ngl::Vec3 _c,ngl::Vec3 _d,ngl::Vec3 _p)
+float Predicates::insphereFiltered(ngl::Vec3 _a,ngl::Vec3 _b,ngl::Vec3 _c,ngl::Vec3 _d,ngl::Vec3 _p)
 {
   float aex, bex, cex, dex;
   float aey, bey, cey, dey;
@@ -2293,6 +2517,13 @@ float Predicates::insphere(ngl::Vec3 _a,ngl::Vec3 _b,ngl::Vec3 _c,ngl::Vec3 _d,n
 
   det = (dlift * abc - clift * dab) + (blift * cda - alift * bcd);
 
+  if (((det > m_ispStaticBound) || (-det > m_ispStaticBound))
+      && Inside_Box(aex, aey, aez) && Inside_Box(bex, bey, bez)
+      && Inside_Box(cex, cey, cez) && Inside_Box(dex, dey, dez)) {
+    m_stats.m_insphere[SEMI_STATIC]++;
+    return det;
+  }
+
   aezplus = Absolute(aez);
   bezplus = Absolute(bez);
   cezplus = Absolute(cez);
@@ -2327,29 +2558,418 @@ float Predicates::insphere(ngl::Vec3 _a,ngl::Vec3 _b,ngl::Vec3 _c,ngl::Vec3 _d,n
             * dlift;
   errbound = isperrboundA * permanent;
   if ((det > errbound) || (-det > errbound)) {
+    m_stats.m_insphere[DYNAMIC_FILTER]++;
     return det;
   }
 
-  return insphereadapt(_a, _b, _c, _d, _p, permanent);
+  return insphereadapt(_a, _b, _c, _d, _p, permanent, m_stats.m_insphere);
 }
 
 
+/*****************************************************************************/
+/*                                                                           */
+/*  orient2dexact()   Exact 2D orientation of three points, used for the     */
+/*                    minors of the perturbed orient3d().                    */
+/*                                                                           */
+/*  Returns a positive value if pa, pb, and pc occur in counterclockwise     */
+/*  order, a negative value if they occur in clockwise order, and zero if    */
+/*  they are collinear.  The result is the determinant of the matrix with    */
+/*  rows (pa[0], pa[1], 1), (pb[0], pb[1], 1) and (pc[0], pc[1], 1).         */
+/*                                                                           */
+/*****************************************************************************/
+
+float orient2dexact(float *pa, float *pb, float *pc)
+{
+  INEXACT float axby1, axcy1, bxcy1, bxay1, cxay1, cxby1;
+  float axby0, axcy0, bxcy0, bxay0, cxay0, cxby0;
+  float aterms[4], bterms[4], cterms[4];
+  INEXACT float aterms3, bterms3, cterms3;
+  float v[8], w[12];
+  int vlength, wlength;
+
+  INEXACT float bvirt;
+  float avirt, bround, around;
+  INEXACT float c;
+  INEXACT float abig;
+  float ahi, alo, bhi, blo;
+  float err1, err2, err3;
+  INEXACT float _i, _j;
+  float _0;
+
+  Two_Product(pa[0], pb[1], axby1, axby0);
+  Two_Product(pa[0], pc[1], axcy1, axcy0);
+  Two_Two_Diff(axby1, axby0, axcy1, axcy0,
+               aterms3, aterms[2], aterms[1], aterms[0]);
+  aterms[3] = aterms3;
+
+  Two_Product(pb[0], pc[1], bxcy1, bxcy0);
+  Two_Product(pb[0], pa[1], bxay1, bxay0);
+  Two_Two_Diff(bxcy1, bxcy0, bxay1, bxay0,
+               bterms3, bterms[2], bterms[1], bterms[0]);
+  bterms[3] = bterms3;
+
+  Two_Product(pc[0], pa[1], cxay1, cxay0);
+  Two_Product(pc[0], pb[1], cxby1, cxby0);
+  Two_Two_Diff(cxay1, cxay0, cxby1, cxby0,
+               cterms3, cterms[2], cterms[1], cterms[0]);
+  cterms[3] = cterms3;
+
+  vlength = fast_expansion_sum_zeroelim(4, aterms, 4, bterms, v);
+  wlength = fast_expansion_sum_zeroelim(vlength, v, 4, cterms, w);
+
+  return w[wlength - 1];
+}
+
+/*****************************************************************************/
+/*                                                                           */
+/*  Symbolic perturbation (simulation of simplicity).                        */
+/*                                                                           */
+/*  orient3d() and insphere() are the signs of the determinants              */
+/*                                                                           */
+/*    | ax ay az 1 |          | ax ay az alift 1 |                           */
+/*    | bx by bz 1 |          | bx by bz blift 1 |                           */
+/*    | cx cy cz 1 |   and    |       ...        |                           */
+/*    | dx dy dz 1 |          | ex ey ez elift 1 |                           */
+/*                                                                           */
+/*  When one of them is exactly zero, every entry but the ones is taken to   */
+/*  be perturbed by its own infinitesimal, eps^(2^bit), and the sign of the  */
+/*  perturbed determinant is returned instead.  The perturbed determinant    */
+/*  is a polynomial whose terms are the minors of the unperturbed matrix,    */
+/*  one for each set of perturbed entries in distinct rows and columns; a    */
+/*  set with a smaller sum of 2^bit gives a larger term, so the sets are     */
+/*  visited by increasing bit mask and the first nonzero minor decides.     */
+/*  Once three entries of orient3d() (four of insphere()) are taken, the     */
+/*  minor left is the 1 in the last column, so the search always ends.       */
+/*                                                                           */
+/*  Bits are given by the lexicographic rank of the points, so a point has   */
+/*  the same perturbation in every call and the tests stay consistent with   */
+/*  each other: the triangulation built is the Delaunay triangulation of     */
+/*  the perturbed points, which are in general position.  The lifts get the  */
+/*  lowest bits of insphere(), so for a tetrahedron that is not flat the     */
+/*  answer is the exact orient3d() of four of the five points; the other     */
+/*  minors are only needed when all five points are coplanar.                */
+/*                                                                           */
+/*  Points must be distinct.                                                 */
+/*                                                                           */
+/*****************************************************************************/
+
+typedef std::vector<float> Expansion;
+
+static Expansion expansionSum(const Expansion &e, const Expansion &f)
+{
+  Expansion h(e.size() + f.size());
+  int hlength = fast_expansion_sum_zeroelim(e.size(), (float *) &e[0],
+                                            f.size(), (float *) &f[0], &h[0]);
+  h.resize(hlength);
+  return h;
+}
+
+static Expansion expansionProduct(const Expansion &e, const Expansion &f)
+{
+  Expansion h(1, 0.0);
+  Expansion scaled(2 * e.size());
+  for (unsigned int i = 0; i < f.size(); i++) {
+    int slength = scale_expansion_zeroelim(e.size(), (float *) &e[0], f[i],
+                                           &scaled[0]);
+    h = expansionSum(h, Expansion(scaled.begin(), scaled.begin() + slength));
+  }
+  return h;
+}
+
+/* Exact determinant of a k by k matrix of expansions, by cofactors along    */
+/*   the first row.  Only used on the rare fully degenerate path.            */
+
+static Expansion expansionDeterminant(const std::vector<Expansion> &_m, int _k)
+{
+  if (_k == 1) {
+    return _m[0];
+  }
+  Expansion det(1, 0.0);
+  std::vector<Expansion> minor((_k - 1) * (_k - 1));
+  for (int col = 0; col < _k; col++) {
+    for (int i = 1; i < _k; i++) {
+      int mj = 0;
+      for (int j = 0; j < _k; j++) {
+        if (j != col) {
+          minor[(i - 1) * (_k - 1) + mj++] = _m[i * _k + j];
+        }
+      }
+    }
+    Expansion term = expansionProduct(_m[col], expansionDeterminant(minor, _k - 1));
+    if (col & 1) {
+      for (unsigned int i = 0; i < term.size(); i++) {
+        term[i] = -term[i];
+      }
+    }
+    det = expansionSum(det, term);
+  }
+  return det;
+}
+
+static float expansionSign(const Expansion &e)
+{
+  float top = e[e.size() - 1];
+  return (float) ((top > 0.0) - (top < 0.0));
+}
+
+/* Lexicographic order on the coordinates, the rank used for the bits.       */
+
+static bool lexLess(const ngl::Vec3 &_a, const ngl::Vec3 &_b)
+{
+  if (_a.m_x != _b.m_x) {
+    return _a.m_x < _b.m_x;
+  }
+  if (_a.m_y != _b.m_y) {
+    return _a.m_y < _b.m_y;
+  }
+  return _a.m_z < _b.m_z;
+}
+
+/* Sorts the points by rank, and their weights with them when there are     */
+/*   some; returns the sign of the row permutation.                          */
+
+static float sortByRank(ngl::Vec3 *_p, int _n, float *_w = NULL)
+{
+  float parity = 1.0;
+  for (int i = 1; i < _n; i++) {
+    for (int j = i; (j > 0) && lexLess(_p[j], _p[j - 1]); j--) {
+      ngl::Vec3 swap = _p[j];
+      _p[j] = _p[j - 1];
+      _p[j - 1] = swap;
+      if (_w != NULL) {
+        float wswap = _w[j];
+        _w[j] = _w[j - 1];
+        _w[j - 1] = wswap;
+      }
+      parity = -parity;
+    }
+  }
+  return parity;
+}
+
+/* Sign with which the minor of the perturbed entries (_row[i], _col[i])     */
+/*   enters the expansion: (-1)^(sum of rows + sum of columns) times the     */
+/*   sign of the permutation taking the rows, in order, to their columns.    */
+
+static float termSign(const int *_row, const int *_col, int _count)
+{
+  int sum = 0;
+  for (int i = 0; i < _count; i++) {
+    sum += _row[i] + _col[i];
+    for (int j = i + 1; j < _count; j++) {
+      sum += (_col[j] < _col[i]);
+    }
+  }
+  return (sum & 1) ? -1.0 : 1.0;
+}
+
+static float coordinate(const ngl::Vec3 &_p, int _c)
+{
+  return (_c == 0) ? _p.m_x : ((_c == 1) ? _p.m_y : _p.m_z);
+}
+
+static float orient3dPerturbed(ngl::Vec3 _a, ngl::Vec3 _b, ngl::Vec3 _c, ngl::Vec3 _d)
+{
+  ngl::Vec3 p[4] = { _a, _b, _c, _d };
+  float parity = sortByRank(p, 4);
+
+  /* Entry (row r, coordinate c) has bit 3 * r + c. */
+  for (int mask = 1; mask < (1 << 12); mask++) {
+    int row[3], col[3];
+    int count = 0;
+    int usedRows = 0, usedCols = 0;
+    bool valid = true;
+    for (int bit = 0; (bit < 12) && valid; bit++) {
+      if (mask & (1 << bit)) {
+        int r = bit / 3, c = bit % 3;
+        valid = !(usedRows & (1 << r)) && !(usedCols & (1 << c));
+        usedRows |= 1 << r;
+        usedCols |= 1 << c;
+        row[count] = r;
+        col[count++] = c;
+      }
+    }
+    if (!valid) {
+      continue;
+    }
+
+    int freeRows[3], freeCols[2];
+    int nrows = 0, ncols = 0;
+    for (int r = 0; r < 4; r++) {
+      if (!(usedRows & (1 << r))) {
+        freeRows[nrows++] = r;
+      }
+    }
+    for (int c = 0; c < 3; c++) {
+      if (!(usedCols & (1 << c))) {
+        freeCols[ncols++] = c;
+      }
+    }
+
+    float minor;
+    if (count == 1) {
+      float q[3][2];
+      for (int i = 0; i < 3; i++) {
+        q[i][0] = coordinate(p[freeRows[i]], freeCols[0]);
+        q[i][1] = coordinate(p[freeRows[i]], freeCols[1]);
+      }
+      minor = orient2dexact(q[0], q[1], q[2]);
+    } else if (count == 2) {
+      float u = coordinate(p[freeRows[0]], freeCols[0]);
+      float v = coordinate(p[freeRows[1]], freeCols[0]);
+      minor = (float) ((u > v) - (u < v));
+    } else {
+      minor = 1.0;
+    }
+    if (minor != 0.0) {
+      return (minor > 0.0 ? 1.0 : -1.0) * termSign(row, col, count) * parity;
+    }
+  }
+  /* Not reached: some set of three entries leaves the minor 1. */
+  return 0.0;
+}
+
+/* The power test is the same determinant with every lift lowered by the    */
+/*   weight of its point, _weights is NULL for insphere().                   */
+
+static float inspherePerturbed(ngl::Vec3 _a, ngl::Vec3 _b, ngl::Vec3 _c, ngl::Vec3 _d, ngl::Vec3 _e,
+                               const float *_weights)
+{
+  ngl::Vec3 p[5] = { _a, _b, _c, _d, _e };
+  float w[5] = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+  if (_weights != NULL) {
+    for (int i = 0; i < 5; i++) {
+      w[i] = _weights[i];
+    }
+  }
+  float parity = sortByRank(p, 5, w);
+  std::vector<Expansion> lift;
+
+  /* Column 3 holds the lifts; entry (row r, lift) has bit r and entry       */
+  /*   (row r, coordinate c) has bit 5 + 3 * r + c.                          */
+  for (int mask = 1; mask < (1 << 20); mask++) {
+    int row[4], col[4];
+    int count = 0;
+    int usedRows = 0, usedCols = 0;
+    bool valid = true;
+    for (int bit = 0; (bit < 20) && valid; bit++) {
+      if (mask & (1 << bit)) {
+        int r = (bit < 5) ? bit : (bit - 5) / 3;
+        int c = (bit < 5) ? 3 : (bit - 5) % 3;
+        valid = (count < 4) && !(usedRows & (1 << r)) && !(usedCols & (1 << c));
+        usedRows |= 1 << r;
+        usedCols |= 1 << c;
+        row[count] = r;
+        col[count++] = c;
+      }
+    }
+    if (!valid) {
+      continue;
+    }
+    /* The entries are visited by bit, sort them by row for termSign(). */
+    for (int i = 1; i < count; i++) {
+      for (int j = i; (j > 0) && (row[j] < row[j - 1]); j--) {
+        int swap = row[j]; row[j] = row[j - 1]; row[j - 1] = swap;
+        swap = col[j]; col[j] = col[j - 1]; col[j - 1] = swap;
+      }
+    }
+
+    int freeRows[5], freeCols[4];
+    int nrows = 0, ncols = 0;
+    for (int r = 0; r < 5; r++) {
+      if (!(usedRows & (1 << r))) {
+        freeRows[nrows++] = r;
+      }
+    }
+    for (int c = 0; c < 4; c++) {
+      if (!(usedCols & (1 << c))) {
+        freeCols[ncols++] = c;
+      }
+    }
+
+    float minor;
+    if ((count == 1) && (col[0] == 3)) {
+      minor = orient3dexact(p[freeRows[0]], p[freeRows[1]],
+                            p[freeRows[2]], p[freeRows[3]]);
+    } else if (count == 4) {
+      minor = 1.0;
+    } else {
+      if (lift.empty()) {
+        for (int r = 0; r < 5; r++) {
+          Expansion x(1, p[r].m_x), y(1, p[r].m_y), z(1, p[r].m_z);
+          lift.push_back(expansionSum(expansionSum(expansionSum(expansionProduct(x, x),
+                                                                expansionProduct(y, y)),
+                                                   expansionProduct(z, z)),
+                                      Expansion(1, -w[r])));
+        }
+      }
+      /* The remaining columns, then the column of ones. */
+      std::vector<Expansion> m(nrows * nrows);
+      for (int i = 0; i < nrows; i++) {
+        for (int j = 0; j < ncols; j++) {
+          m[i * nrows + j] = (freeCols[j] == 3) ? lift[freeRows[i]]
+                             : Expansion(1, coordinate(p[freeRows[i]], freeCols[j]));
+        }
+        m[i * nrows + ncols] = Expansion(1, 1.0);
+      }
+      minor = expansionSign(expansionDeterminant(m, nrows));
+    }
+    if (minor != 0.0) {
+      return (minor > 0.0 ? 1.0 : -1.0) * termSign(row, col, count) * parity;
+    }
+  }
+  /* Not reached: some set of four entries leaves the minor 1. */
+  return 0.0;
+}
+
+void Predicates::setPerturbation(bool _perturb)
+{
+  m_perturb = _perturb;
+}
+
+float Predicates::orient3d(ngl::Vec3 _a,ngl::Vec3 _b,ngl::Vec3 _c,ngl::Vec3 _p)
+{
+  float det = m_snapped && onGrid(_a) && onGrid(_b) && onGrid(_c) && onGrid(_p)
+            ? orient3dSnapped(_a, _b, _c, _p)
+            : orient3dFiltered(_a, _b, _c, _p);
+  if ((det == 0.0) && m_perturb) {
+    m_stats.m_orient3d[PERTURBED]++;
+    return orient3dPerturbed(_a, _b, _c, _p);
+  }
+  return det;
+}
+
+float Predicates::insphere(ngl::Vec3 _a,ngl::Vec3 _b,ngl::Vec3 _c,ngl::Vec3 _d,ngl::Vec3 _p)
+{
+  float det = m_snapped && onGrid(_a) && onGrid(_b) && onGrid(_c) && onGrid(_d) && onGrid(_p)
+            ? insphereSnapped(_a, _b, _c, _d, _p)
+            : insphereFiltered(_a, _b, _c, _d, _p);
+  if ((det == 0.0) && m_perturb) {
+    m_stats.m_insphere[PERTURBED]++;
+    return inspherePerturbed(_a, _b, _c, _d, _p, NULL);
+  }
+  return det;
+}
+
 // insphere3d returns positve if point is inside
 // insphere3d returns negative if point is outside
-// insphere3d returns 0 if point is on sphere
+// insphere3d returns 0 if point is on sphere, which only happens with the perturbation off
 float Predicates::insphere3d(Tetrahedron* _t, ngl::Vec3 _point)
 {
     float result = 0.0;
-    ngl::Vec3 r1 = _t->getVertexData()[0];
-    ngl::Vec3 r2 = _t->getVertexData()[1];
-    ngl::Vec3 r3 = _t->getVertexData()[2];
-    ngl::Vec3 r4 = _t->getVertexData()[3];
-
-    if(orient3d(r1,r2,r3,r4)>0)
+    const ngl::Vec3 *verts = _t->getVertexData();
+    ngl::Vec3 r1 = verts[0];
+    ngl::Vec3 r2 = verts[1];
+    ngl::Vec3 r3 = verts[2];
+    ngl::Vec3 r4 = verts[3];
+
+    // the orientation decides how the sign of insphere is read, evaluate it once
+    float orientation = orient3d(r1,r2,r3,r4);
+    if(orientation>0)
     {
         return(insphere(r1,r2,r3,r4,_point));
     }
-    else if(orient3d(r1,r2,r3,r4)<0)
+    else if(orientation<0)
     {
         float res = insphere(r1,r2,r3,r4,_point);
         if(res>0)
@@ -2368,5 +2988,128 @@ float Predicates::insphere3d(Tetrahedron* _t, ngl::Vec3 _point)
     return result;
 }
 
+/*****************************************************************************/
+/*                                                                           */
+/*  power()   The power test of a weighted point against four others.        */
+/*                                                                           */
+/*  Lifting every point to x^2 + y^2 + z^2 - w in a fourth coordinate turns  */
+/*  the weighted (regular) triangulation into the lower hull of the lifted   */
+/*  points, and the power test into the orientation of the lifted point p    */
+/*  against the hyperplane through the four lifted others: the determinant   */
+/*  of insphere() with every lift lowered by its weight.  It is positive     */
+/*  when p is closer, in power distance, than the sphere orthogonal to the   */
+/*  four points, for a, b, c and d in positive orientation.                  */
+/*                                                                           */
+/*  The weights keep the lifts off the float fast paths, so the filter is    */
+/*  one evaluation in double with a dynamic error bound, which is exact      */
+/*  enough for almost every call.  The rest are evaluated exactly on         */
+/*  expansions, and an exact zero goes to the symbolic perturbation with     */
+/*  the weighted lifts.                                                      */
+/*                                                                           */
+/*****************************************************************************/
+
+static float powerExact(ngl::Vec3 _a, ngl::Vec3 _b, ngl::Vec3 _c, ngl::Vec3 _d, ngl::Vec3 _p,
+                        const float *_weights)
+{
+  const ngl::Vec3 rows[4] = { _a, _b, _c, _d };
+  Expansion wp(1, _weights[4]);
+  std::vector<Expansion> m(16);
+  for (int i = 0; i < 4; i++) {
+    Expansion lift(1, 0.0);
+    for (int c = 0; c < 3; c++) {
+      Expansion delta = expansionSum(Expansion(1, coordinate(rows[i], c)),
+                                     Expansion(1, -coordinate(_p, c)));
+      m[i * 4 + c] = delta;
+      lift = expansionSum(lift, expansionProduct(delta, delta));
+    }
+    m[i * 4 + 3] = expansionSum(expansionSum(lift, Expansion(1, -_weights[i])), wp);
+  }
+  return expansionSign(expansionDeterminant(m, 4));
+}
+
+float Predicates::power(ngl::Vec3 _a, ngl::Vec3 _b, ngl::Vec3 _c, ngl::Vec3 _d, ngl::Vec3 _p,
+                        const ngl::Real *_weights)
+{
+  double aex = (double) _a.m_x - _p.m_x, aey = (double) _a.m_y - _p.m_y, aez = (double) _a.m_z - _p.m_z;
+  double bex = (double) _b.m_x - _p.m_x, bey = (double) _b.m_y - _p.m_y, bez = (double) _b.m_z - _p.m_z;
+  double cex = (double) _c.m_x - _p.m_x, cey = (double) _c.m_y - _p.m_y, cez = (double) _c.m_z - _p.m_z;
+  double dex = (double) _d.m_x - _p.m_x, dey = (double) _d.m_y - _p.m_y, dez = (double) _d.m_z - _p.m_z;
+
+  double aexbey = aex * bey, bexaey = bex * aey;
+  double bexcey = bex * cey, cexbey = cex * bey;
+  double cexdey = cex * dey, dexcey = dex * cey;
+  double dexaey = dex * aey, aexdey = aex * dey;
+  double aexcey = aex * cey, cexaey = cex * aey;
+  double bexdey = bex * dey, dexbey = dex * bey;
+  double ab = aexbey - bexaey;
+  double bc = bexcey - cexbey;
+  double cd = cexdey - dexcey;
+  double da = dexaey - aexdey;
+  double ac = aexcey - cexaey;
+  double bd = bexdey - dexbey;
+
+  double abc = aez * bc - bez * ac + cez * ab;
+  double bcd = bez * cd - cez * bd + dez * bc;
+  double cda = cez * da + dez * ac + aez * cd;
+  double dab = dez * ab + aez * bd + bez * da;
+
+  double asq = aex * aex + aey * aey + aez * aez;
+  double bsq = bex * bex + bey * bey + bez * bez;
+  double csq = cex * cex + cey * cey + cez * cez;
+  double dsq = dex * dex + dey * dey + dez * dez;
+  double aw = (double) _weights[0] - _weights[4];
+  double bw = (double) _weights[1] - _weights[4];
+  double cw = (double) _weights[2] - _weights[4];
+  double dw = (double) _weights[3] - _weights[4];
+
+  double det = ((dsq - dw) * abc - (csq - cw) * dab) + ((bsq - bw) * cda - (asq - aw) * bcd);
+
+  /* The permanent of insphere() with the magnitudes of the weights added   */
+  /*   to the lifts, and a coefficient that covers the two extra roundings. */
+  double permanent = ((fabs(cexdey) + fabs(dexcey)) * fabs(bez)
+                      + (fabs(dexbey) + fabs(bexdey)) * fabs(cez)
+                      + (fabs(bexcey) + fabs(cexbey)) * fabs(dez))
+                   * (asq + fabs(aw))
+                   + ((fabs(dexaey) + fabs(aexdey)) * fabs(cez)
+                      + (fabs(aexcey) + fabs(cexaey)) * fabs(dez)
+                      + (fabs(cexdey) + fabs(dexcey)) * fabs(aez))
+                   * (bsq + fabs(bw))
+                   + ((fabs(aexbey) + fabs(bexaey)) * fabs(dez)
+                      + (fabs(bexdey) + fabs(dexbey)) * fabs(aez)
+                      + (fabs(dexaey) + fabs(aexdey)) * fabs(bez))
+                   * (csq + fabs(cw))
+                   + ((fabs(bexcey) + fabs(cexbey)) * fabs(aez)
+                      + (fabs(cexaey) + fabs(aexcey)) * fabs(bez)
+                      + (fabs(aexbey) + fabs(bexaey)) * fabs(cez))
+                   * (dsq + fabs(dw));
+  double errbound = 20.0 * DBL_EPSILON * permanent;
+  if ((det > errbound) || (-det > errbound)) {
+    m_stats.m_insphere[DYNAMIC_FILTER]++;
+    return det > 0.0 ? 1.0 : -1.0;
+  }
 
+  m_stats.m_insphere[EXACT]++;
+  float exact = powerExact(_a, _b, _c, _d, _p, _weights);
+  if ((exact == 0.0) && m_perturb) {
+    m_stats.m_insphere[PERTURBED]++;
+    return inspherePerturbed(_a, _b, _c, _d, _p, _weights);
+  }
+  return exact;
+}
+
+// power3d is positive if the point is in conflict with the tetrahedron and negative if it is not, the weighted
+// version of insphere3d
+float Predicates::power3d(Tetrahedron* _t, ngl::Vec3 _point, ngl::Real _weight)
+{
+    const ngl::Vec3 *verts = _t->getVertexData();
+    const ngl::Real *w = _t->getWeightData();
+    ngl::Real weights[5] = { w[0], w[1], w[2], w[3], _weight };
 
+    float orientation = orient3d(verts[0],verts[1],verts[2],verts[3]);
+    float res = power(verts[0],verts[1],verts[2],verts[3],_point,weights);
+    if(orientation<0)
+    {
+        return -res;
+    }
+    return orientation>0 ? res : 0.0;
+}
@@ -3,30 +3,132 @@
 
 #include "ngl/Vec3.h"
 #include "Tetrahedron.h"
+#include <cmath>
 
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Predicates.h
 /// @author Maria Vineeta Bagya Seelan
-/// @version 1.0
+/// @version 1.2
 /// @date 16/08/13
 /// Revision History :
 /// Initial Version 16/08/13
+/// 1.1 power and power3d, the weighted insphere of a regular triangulation
+/// 1.2 the snap grid is anchored at an origin and bounded, calls outside it use the floating point stages
 /// @class Predicates
 /// @brief This is the class that defines the two basic geometric tests required
 /// @brief for constructing Delaunay Tetraherons
 //----------------------------------------------------------------------------------------------------------------------
 
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the filter stage at which a predicate call was resolved, PERTURBED counts the calls that
+/// were exactly zero at their stage and were decided by the symbolic perturbation
+//----------------------------------------------------------------------------------------------------------------------
+enum PredicateStage
+{
+    SEMI_STATIC = 0,
+    DYNAMIC_FILTER,
+    ADAPTIVE_B,
+    ADAPTIVE_C,
+    EXACT,
+    SNAPPED_EXACT,
+    PERTURBED,
+    PREDICATE_STAGES
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief structure that counts the predicate calls resolved at each filter stage
+//----------------------------------------------------------------------------------------------------------------------
+struct PredicateStats
+{
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief number of orient3d calls resolved at each stage
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned long m_orient3d[PREDICATE_STAGES];
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief number of insphere calls resolved at each stage, the power tests of a weighted build included
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned long m_insphere[PREDICATE_STAGES];
+};
+
 class Predicates
 {
 public:
     Predicates();
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief derives the semi-static error bounds from the box that holds the input points, calls whose
+    /// coordinate differences do not fit in it fall back to the dynamic filter
+    /// @param _min minimum corner of the bounding box
+    /// @param _max maximum corner of the bounding box
+    //----------------------------------------------------------------------------------------------------------------------
+    void setBounds(ngl::Vec3 _min, ngl::Vec3 _max);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief disables the semi-static stage, every call goes through the dynamic filter again
+    //----------------------------------------------------------------------------------------------------------------------
+    void clearBounds();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the predicate call counters
+    //----------------------------------------------------------------------------------------------------------------------
+    const PredicateStats& getStats() const { return m_stats; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief sets all the predicate call counters to zero
+    //----------------------------------------------------------------------------------------------------------------------
+    void resetStats();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief switches orient3d and insphere to exact integer evaluation for the calls whose points all lie within
+    /// 2^(s_snapBits - 1) nodes of the origin, the other calls keep the floating point stages. Every point passed in
+    /// afterwards that lies in that box must be a node of the grid (see snap)
+    /// @param _origin the origin of the grid, a node of the power of two grid of the same spacing anchored at zero
+    /// @param _spacing the grid spacing, a power of two as returned by snapSpacing
+    //----------------------------------------------------------------------------------------------------------------------
+    void setSnapGrid(ngl::Vec3 _origin, float _spacing);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief switches back to the floating point predicates
+    //----------------------------------------------------------------------------------------------------------------------
+    void clearSnapGrid();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief returns true if the integer snapped mode is on
+    //----------------------------------------------------------------------------------------------------------------------
+    inline bool isSnapped() const { return m_snapped; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief rounds a point to the nearest node of the snap grid
+    /// @param _p the point to be snapped
+    //----------------------------------------------------------------------------------------------------------------------
+    ngl::Vec3 snap(ngl::Vec3 _p) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief returns true if the point lies in the box of the snap grid, where the integer predicates hold it
+    /// @param _p the point to be tested
+    //----------------------------------------------------------------------------------------------------------------------
+    inline bool onGrid(ngl::Vec3 _p) const
+    {
+      return std::abs(_p.m_x - m_snapOrigin.m_x) <= m_snapReach &&
+             std::abs(_p.m_y - m_snapOrigin.m_y) <= m_snapReach &&
+             std::abs(_p.m_z - m_snapOrigin.m_z) <= m_snapReach;
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief finds the smallest power of two spacing whose grid of 2^s_snapBits nodes per axis
+    /// covers the coordinates in [-_maxCoordinate,_maxCoordinate] about its origin
+    /// @param _maxCoordinate the largest distance to the origin along an axis
+    //----------------------------------------------------------------------------------------------------------------------
+    static float snapSpacing(float _maxCoordinate);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief number of bits of the snapped integer coordinates, chosen so that every snapped point is
+    /// exact as a float and insphere fits in 128 bits
+    //----------------------------------------------------------------------------------------------------------------------
+    static const int s_snapBits = 24;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief turns the symbolic perturbation on or off, when on (the default) orient3d and insphere never
+    /// return zero for distinct points
+    /// @param _perturb true to perturb degenerate configurations
+    //----------------------------------------------------------------------------------------------------------------------
+    void setPerturbation(bool _perturb);
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief this method is called when a point p is checked if it is above,
     /// below or on a plane enclosed by points a,b,c
     /// @param _a Point A of the plane
     /// @param _b Point B of the plane
     /// @param _c Point C of the plane
     /// @param _p Point to be checked
+    /// @returns the determinant, in snapped mode or when perturbed only its sign
     //----------------------------------------------------------------------------------------------------------------------
     float orient3d(ngl::Vec3 _a, ngl::Vec3 _b, ngl::Vec3 _c, ngl::Vec3 _p);
     //----------------------------------------------------------------------------------------------------------------------
@@ -37,6 +139,7 @@ public:
     /// @param _c Point C of the sphere
     /// @param _d Point D of the sphere
     /// @param _p Point to be checked
+    /// @returns the determinant, in snapped mode or when perturbed only its sign
     //----------------------------------------------------------------------------------------------------------------------
     float insphere(ngl::Vec3 _a, ngl::Vec3 _b, ngl::Vec3 _c, ngl::Vec3 _d, ngl::Vec3 _p);
     //----------------------------------------------------------------------------------------------------------------------
@@ -47,6 +150,28 @@ public:
     //----------------------------------------------------------------------------------------------------------------------
     float insphere3d(Tetrahedron *_t, ngl::Vec3 _point);
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the power test of a weighted point p against the sphere orthogonal to a,b,c,d, the orientation of the
+    /// lifted p against the lifted a,b,c,d with every point lifted to x^2+y^2+z^2-w. It is exact and ignores the snap
+    /// grid, with zero weights it has the sign of insphere
+    /// @param _a Point A of the sphere
+    /// @param _b Point B of the sphere
+    /// @param _c Point C of the sphere
+    /// @param _d Point D of the sphere
+    /// @param _p Point to be checked
+    /// @param _weights the weights of a, b, c, d and p
+    /// @returns positive if p is in conflict with the sphere, when perturbed never zero, only the sign is meaningful
+    //----------------------------------------------------------------------------------------------------------------------
+    float power(ngl::Vec3 _a, ngl::Vec3 _b, ngl::Vec3 _c, ngl::Vec3 _d, ngl::Vec3 _p, const ngl::Real *_weights);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief this method is called when a weighted point p is checked against the orthogonal sphere of a Tetrahedron
+    /// whatever its orientation
+    /// @param _t defines a Tetrahedron with four weighted vertices
+    /// @param _point Point to be checked
+    /// @param _weight the weight of the point
+    /// @returns positive if the point is in conflict with the tetrahedron, negative if not
+    //----------------------------------------------------------------------------------------------------------------------
+    float power3d(Tetrahedron *_t, ngl::Vec3 _point, ngl::Real _weight);
+    //----------------------------------------------------------------------------------------------------------------------
 
 private :
     //----------------------------------------------------------------------------------------------------------------------
@@ -54,6 +179,55 @@ private :
     //----------------------------------------------------------------------------------------------------------------------
     void exactinit();
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief orient3d through the semi-static, dynamic and adaptive stages
+    //----------------------------------------------------------------------------------------------------------------------
+    float orient3dFiltered(ngl::Vec3 _a, ngl::Vec3 _b, ngl::Vec3 _c, ngl::Vec3 _p);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief insphere through the semi-static, dynamic and adaptive stages
+    //----------------------------------------------------------------------------------------------------------------------
+    float insphereFiltered(ngl::Vec3 _a, ngl::Vec3 _b, ngl::Vec3 _c, ngl::Vec3 _d, ngl::Vec3 _p);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief orient3d evaluated exactly on the integer grid coordinates
+    //----------------------------------------------------------------------------------------------------------------------
+    float orient3dSnapped(ngl::Vec3 _a, ngl::Vec3 _b, ngl::Vec3 _c, ngl::Vec3 _p);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief insphere evaluated exactly on the integer grid coordinates
+    //----------------------------------------------------------------------------------------------------------------------
+    float insphereSnapped(ngl::Vec3 _a, ngl::Vec3 _b, ngl::Vec3 _c, ngl::Vec3 _d, ngl::Vec3 _p);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief error bound of orient3d valid for every point inside the box given to setBounds
+    //----------------------------------------------------------------------------------------------------------------------
+    float m_o3dStaticBound;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief error bound of insphere valid for every point inside the box given to setBounds
+    //----------------------------------------------------------------------------------------------------------------------
+    float m_ispStaticBound;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief extent of the box given to setBounds, the largest coordinate difference the bounds hold for
+    //----------------------------------------------------------------------------------------------------------------------
+    float m_boxX, m_boxY, m_boxZ;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief counts the calls resolved at each filter stage
+    //----------------------------------------------------------------------------------------------------------------------
+    PredicateStats m_stats;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true if the predicates run on the snap grid
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_snapped;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief spacing of the snap grid and its inverse, both powers of two
+    //----------------------------------------------------------------------------------------------------------------------
+    float m_snapSpacing;
+    float m_invSnapSpacing;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief origin of the snap grid and the largest coordinate difference to it the integer predicates hold
+    //----------------------------------------------------------------------------------------------------------------------
+    ngl::Vec3 m_snapOrigin;
+    float m_snapReach;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief true if zero results are resolved by the symbolic perturbation
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_perturb;
 
 };
 
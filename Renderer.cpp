@@ -41,6 +41,11 @@ Renderer::Renderer(
   m_origY=0;
   m_pointType = 0;
   m_mesh = new MeshSampler();
+  m_worker = new MeshWorker(m_mesh,this);
+  // both are queued since the worker emits them from its own thread
+  connect(m_worker,SIGNAL(finished()),this,SLOT(jobFinished()));
+  connect(m_worker,SIGNAL(progress(int,int,int)),this,SLOT(reportProgress(int,int,int)));
+  connect(m_worker,SIGNAL(snapshotReady()),this,SLOT(applySnapshot()));
   m_isSurfacePoints = false;
   m_isHitPoints = false;
   m_dCompute = false;
@@ -56,6 +61,8 @@ Renderer::~Renderer()
   ngl::NGLInit *Init = ngl::NGLInit::instance();
   std::cout<<"Shutting down NGL, removing VAO's and Shaders\n";
   Init->NGLQuit();
+  m_worker->cancel();
+  m_worker->wait();
   delete m_mesh;
 }
 
@@ -113,6 +120,39 @@ void Renderer::initializeGL()
     shader->bindAttribute("Colour",0,"inVert");
     shader->linkProgramObject("Colour");
 
+    // Per vertex colour shader for the batched tetrahedra
+    shader->createShaderProgram("TetColour");
+
+    shader->attachShader("TetColourVertex",ngl::VERTEX);
+    shader->attachShader("TetColourFragment",ngl::FRAGMENT);
+    shader->loadShaderSource("TetColourVertex","shaders/TetColour.vs");
+    shader->loadShaderSource("TetColourFragment","shaders/TetColour.fs");
+
+    shader->compileShader("TetColourVertex");
+    shader->compileShader("TetColourFragment");
+    shader->attachShaderToProgram("TetColour","TetColourVertex");
+    shader->attachShaderToProgram("TetColour","TetColourFragment");
+
+    shader->bindAttribute("TetColour",0,"inVert");
+    shader->bindAttribute("TetColour",1,"inColour");
+    shader->linkProgramObject("TetColour");
+
+    shader->createShaderProgram("PointInstance");
+
+    shader->attachShader("PointInstanceVertex",ngl::VERTEX);
+    shader->attachShader("PointInstanceFragment",ngl::FRAGMENT);
+    shader->loadShaderSource("PointInstanceVertex","shaders/PointInstance.vs");
+    shader->loadShaderSource("PointInstanceFragment","shaders/PointInstance.fs");
+
+    shader->compileShader("PointInstanceVertex");
+    shader->compileShader("PointInstanceFragment");
+    shader->attachShaderToProgram("PointInstance","PointInstanceVertex");
+    shader->attachShaderToProgram("PointInstance","PointInstanceFragment");
+
+    shader->bindAttribute("PointInstance",0,"inVert");
+    shader->bindAttribute("PointInstance",1,"inOffset");
+    shader->linkProgramObject("PointInstance");
+
     // load the mesh
     m_mesh->loadMesh();
     // calculate, calls the sampling function
@@ -304,6 +344,7 @@ void Renderer::setObjFilename(
                                std::string _filename
                              )
 {
+    stopWorker();
     m_mesh->setObjFilename(_filename);
     m_mesh->loadMesh();
     calculate();
@@ -357,6 +398,7 @@ void Renderer::isHitPointsActivated( int _isCheckBoxEnabled  )
 void Renderer::updateMethod(int _method)
 {
     m_method = _method;
+    stopWorker();
     m_mesh->setMethod(_method);
     m_dCompute = false;
     calculate();
@@ -382,6 +424,7 @@ void Renderer::isVoronoiComputeClicked()
 void Renderer::pointLocation( int _location )
 {
     m_pointType = _location;
+    stopWorker();
     m_mesh->setPointLocationType(_location);
     m_dCompute = false;
     calculate();
@@ -405,6 +448,7 @@ void Renderer::isDelaunayWireframeClicked( int _isCheckBoxEnabled )
 //----------------------------------------------------------------------------------------------------------------------
 void Renderer::updateDensity(int _density)
 {
+    stopWorker();
     m_mesh->setDensity(_density);
     calculate();
     m_dCompute = false;
@@ -413,13 +457,123 @@ void Renderer::updateDensity(int _density)
 //----------------------------------------------------------------------------------------------------------------------
 void Renderer::computeDelaunay()
 {
-    m_mesh->delaunay();
+    startJob(MeshWorker::TRIANGULATE);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void Renderer::calculate()
 {
-   m_mesh->SampleMesh();
+    startJob(MeshWorker::SAMPLE);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Renderer::startJob( MeshWorker::Job _job )
+{
+    stopWorker();
+    if(_job == MeshWorker::SAMPLE)
+    {
+        emit statusChanged(QString("Sampling the mesh..."));
+    }
+    else
+    {
+        emit statusChanged(QString("Building the Delaunay tetrahedralization..."));
+        if(m_worker->isProgressive())
+        {
+            // the snapshots carry the ids of the new build, so nothing of the old mesh may stay in the batch
+            makeCurrent();
+            m_mesh->clearDelaunayBuffers();
+        }
+    }
+    m_worker->startJob(_job);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Renderer::stopWorker()
+{
+    if(m_worker->isRunning())
+    {
+        m_worker->cancel();
+        m_worker->wait();
+        // a finished sampling is still uploaded, only a cancelled triangulation has nothing to hand over
+        if(!finishJob())
+        {
+            if(m_worker->isProgressive())
+            {
+                // the snapshots replaced the previous mesh in the buffers, the mesh itself was kept
+                makeCurrent();
+                m_mesh->uploadDelaunay();
+            }
+            emit statusChanged(QString("Triangulation cancelled"));
+        }
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool Renderer::finishJob()
+{
+    MeshWorker::Job job = m_worker->takeResult();
+    if(job == MeshWorker::NONE)
+    {
+        return false;
+    }
+    // the results are only touched by the GL thread from here on
+    makeCurrent();
+    if(job == MeshWorker::SAMPLE)
+    {
+        m_mesh->uploadSamples();
+    }
+    else
+    {
+        m_mesh->uploadDelaunay();
+    }
+    emit statusChanged(QString("Ready"));
+    updateGL();
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Renderer::jobFinished()
+{
+    // a later job may have been started since, stopWorker has then uploaded this one already
+    if(!m_worker->isRunning())
+    {
+        finishJob();
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Renderer::applySnapshot()
+{
+    // a snapshot delivered after the job has finished is already covered by the full upload
+    if(!m_worker->isRunning())
+    {
+        return;
+    }
+    m_worker->takeSnapshot(m_snapshot);
+    makeCurrent();
+    m_mesh->uploadDelta(m_snapshot);
+    m_snapshot.clear();
+    updateGL();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Renderer::toggleProgressive()
+{
+    m_worker->setProgressive(!m_worker->isProgressive());
+    emit statusChanged(m_worker->isProgressive() ? QString("Progressive triangulation on") : QString("Progressive triangulation off"));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Renderer::toggleSnapToGrid()
+{
+    m_worker->setSnapToGrid(!m_worker->isSnapToGrid());
+    emit statusChanged(m_worker->isSnapToGrid() ? QString("Snapped triangulation on") : QString("Snapped triangulation off"));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Renderer::reportProgress( int _inserted, int _total, int _alive )
+{
+    emit statusChanged(QString("Inserted %1 of %2 points, %3 tetrahedra").arg(_inserted).arg(_total).arg(_alive));
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -5,10 +5,12 @@
 /// @file Renderer.h
 /// @brief a basic Qt class for Rendering
 /// @author Maria Vineeta Bagya Seelan
-/// @version 1.0
+/// @version 1.2
 /// @date 16/08/13
 /// Revision History :
 /// Initial Version 16/08/13
+/// 1.1 sampling and triangulation run on a MeshWorker thread
+/// 1.2 toggleSnapToGrid for the snapped triangulation
 /// @class Renderer
 /// @brief our main glwindow widget for the application and all drawing elements are
 /// included in this file
@@ -22,6 +24,7 @@
 #include "ngl/Camera.h"
 #include "ngl/TransformStack.h"
 #include "MeshSampler.h"
+#include "MeshWorker.h"
 
 class Renderer : public QGLWidget
 {
@@ -43,6 +46,14 @@ public :
     /// @param [in] _filename stores the filename
     //----------------------------------------------------------------------------------------------------------------------
     void setObjFilename( std::string _filename );
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief turns the progressive display of the triangulation on or off
+    //----------------------------------------------------------------------------------------------------------------------
+    void toggleProgressive();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief turns the snapped triangulation on or off
+    //----------------------------------------------------------------------------------------------------------------------
+    void toggleSnapToGrid();
 
 public slots :
     //----------------------------------------------------------------------------------------------------------------------
@@ -101,6 +112,30 @@ public slots :
     //----------------------------------------------------------------------------------------------------------------------
     void pointLocation( int _location );
 
+signals :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief emitted when the state of the background job changes
+    /// @param [in] _message the text to show in the status bar
+    //----------------------------------------------------------------------------------------------------------------------
+    void statusChanged( const QString &_message );
+
+private slots :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief slot called on the GUI thread when the worker has finished a job
+    //----------------------------------------------------------------------------------------------------------------------
+    void jobFinished();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief slot that receives the progress of the triangulation from the worker
+    /// @param [in] _inserted the number of points processed so far
+    /// @param [in] _total the number of points
+    /// @param [in] _alive the number of tetrahedra in the current mesh
+    //----------------------------------------------------------------------------------------------------------------------
+    void reportProgress( int _inserted, int _total, int _alive );
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief slot that uploads the snapshot published by a progressive triangulation
+    //----------------------------------------------------------------------------------------------------------------------
+    void applySnapshot();
+
 private :
     /// @brief used to store the x rotation mouse value
     int m_spinXFace;
@@ -135,6 +170,14 @@ private :
     //----------------------------------------------------------------------------------------------------------------------
     MeshSampler *m_mesh;
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the thread that samples and triangulates m_mesh so the GUI stays responsive
+    //----------------------------------------------------------------------------------------------------------------------
+    MeshWorker *m_worker;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the snapshot being applied, kept so its storage goes back to the worker with the next take
+    //----------------------------------------------------------------------------------------------------------------------
+    TetDelta m_snapshot;
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief store the value when show/hide points checkbox is activated
     //----------------------------------------------------------------------------------------------------------------------
     bool m_showPoints;
@@ -246,6 +289,21 @@ private :
     /// @brief a function that calculates the sample points for the mesh
     //----------------------------------------------------------------------------------------------------------------------
     void calculate();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a function that stops the running job and starts a new one on the worker
+    /// @param [in] _job the job to start
+    //----------------------------------------------------------------------------------------------------------------------
+    void startJob( MeshWorker::Job _job );
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a function that cancels the running job and waits for it, it must be called before the settings of m_mesh
+    /// are changed
+    //----------------------------------------------------------------------------------------------------------------------
+    void stopWorker();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a function that uploads the results of the finished job, the worker must not be running
+    /// @param [out] returns false if there was nothing to upload
+    //----------------------------------------------------------------------------------------------------------------------
+    bool finishJob();
 };
 
 #endif // RENDERER_H
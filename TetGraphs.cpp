@@ -0,0 +1,157 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file TetGraphs.cpp
+/// @brief Class that builds the adjacency graphs of a tetrahedralization in compressed sparse row form
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "TetGraphs.h"
+#include "Parallel.h"
+#include "Trace.h"
+#include "AllocStats.h"
+#include <algorithm>
+
+// Every graph is built in two parallel passes over its nodes. The first one counts the neighbours of each node, the
+// offsets are then summed up on one thread and the second pass writes each list into its own range. The lists are
+// sorted, so the arrays only depend on the topology and a solver walking a node's neighbours reads them in order.
+// The site to tetrahedron graph is the one TetTopology already holds and is copied
+
+namespace
+{
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief turns the counts from m_offsets[1] on into offsets
+//----------------------------------------------------------------------------------------------------------------------
+void sumOffsets(std::vector<unsigned int> &io_offsets)
+{
+    for(unsigned int i=1; i<io_offsets.size(); ++i)
+    {
+        io_offsets[i] += io_offsets[i-1];
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief counts or, once setIndices is called, writes the neighbours of a range of tetrahedra
+//----------------------------------------------------------------------------------------------------------------------
+class TetTetTask : public ParallelTask
+{
+public:
+    TetTetTask(const TetTopology &_topology, std::vector<unsigned int> &io_offsets) :
+        m_topology(_topology), m_offsets(io_offsets), m_indices(NULL) {}
+
+    void setIndices(std::vector<unsigned int> &o_indices) { m_indices = &o_indices; }
+
+    void run(unsigned int _begin, unsigned int _end)
+    {
+        for(unsigned int t=_begin; t<_end; ++t)
+        {
+            unsigned int neighbours[4];
+            unsigned int count = 0;
+            for(int i=0; i<4; ++i)
+            {
+                int n = m_topology.tetNeighbour(t,i);
+                if(n >= 0)
+                {
+                    neighbours[count++] = n;
+                }
+            }
+            if(m_indices == NULL)
+            {
+                m_offsets[t+1] = count;
+                continue;
+            }
+            // at most four, an insertion sort is all it takes
+            for(unsigned int i=1; i<count; ++i)
+            {
+                for(unsigned int j=i; j>0 && neighbours[j] < neighbours[j-1]; --j)
+                {
+                    std::swap(neighbours[j],neighbours[j-1]);
+                }
+            }
+            std::copy(neighbours,neighbours+count,m_indices->begin()+m_offsets[t]);
+        }
+    }
+
+private:
+    const TetTopology &m_topology;
+    std::vector<unsigned int> &m_offsets;
+    std::vector<unsigned int> *m_indices;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief counts or, once setIndices is called, writes the Delaunay neighbours of a range of sites, found among the
+/// vertices of the tetrahedra around each site
+//----------------------------------------------------------------------------------------------------------------------
+class SiteSiteTask : public ParallelTask
+{
+public:
+    SiteSiteTask(const TetTopology &_topology, std::vector<unsigned int> &io_offsets) :
+        m_topology(_topology), m_offsets(io_offsets), m_indices(NULL) {}
+
+    void setIndices(std::vector<unsigned int> &o_indices) { m_indices = &o_indices; }
+
+    void run(unsigned int _begin, unsigned int _end)
+    {
+        const std::vector<unsigned int> &siteTets = m_topology.getSiteTets();
+        std::vector<unsigned int> neighbours;
+        for(unsigned int s=_begin; s<_end; ++s)
+        {
+            neighbours.clear();
+            for(unsigned int i=m_topology.siteTetsBegin(s); i<m_topology.siteTetsEnd(s); ++i)
+            {
+                for(int j=0; j<4; ++j)
+                {
+                    unsigned int other = m_topology.tetSite(siteTets[i],j);
+                    if(other != s)
+                    {
+                        neighbours.push_back(other);
+                    }
+                }
+            }
+            std::sort(neighbours.begin(),neighbours.end());
+            neighbours.erase(std::unique(neighbours.begin(),neighbours.end()),neighbours.end());
+            if(m_indices == NULL)
+            {
+                m_offsets[s+1] = neighbours.size();
+                continue;
+            }
+            std::copy(neighbours.begin(),neighbours.end(),m_indices->begin()+m_offsets[s]);
+        }
+    }
+
+private:
+    const TetTopology &m_topology;
+    std::vector<unsigned int> &m_offsets;
+    std::vector<unsigned int> *m_indices;
+};
+
+} // end anonymous namespace
+
+void TetGraphs::build(const TetTopology &_topology)
+{
+    TRACE_ZONE("TetGraphs::build");
+    ALLOC_PHASE(VORONOI);
+    unsigned int sites = _topology.siteCount();
+    unsigned int tets = _topology.tetCount();
+
+    m_vertexTet.m_offsets.resize(sites+1);
+    for(unsigned int s=0; s<=sites; ++s)
+    {
+        m_vertexTet.m_offsets[s] = s < sites ? _topology.siteTetsBegin(s) : _topology.getSiteTets().size();
+    }
+    m_vertexTet.m_indices = _topology.getSiteTets();
+
+    m_tetTet.m_offsets.assign(tets+1,0);
+    TetTetTask tetTask(_topology,m_tetTet.m_offsets);
+    Parallel::forRange(tets,1024,tetTask);
+    sumOffsets(m_tetTet.m_offsets);
+    m_tetTet.m_indices.resize(m_tetTet.m_offsets.back());
+    tetTask.setIndices(m_tetTet.m_indices);
+    Parallel::forRange(tets,1024,tetTask);
+
+    m_vertexVertex.m_offsets.assign(sites+1,0);
+    SiteSiteTask siteTask(_topology,m_vertexVertex.m_offsets);
+    Parallel::forRange(sites,256,siteTask);
+    sumOffsets(m_vertexVertex.m_offsets);
+    m_vertexVertex.m_indices.resize(m_vertexVertex.m_offsets.back());
+    siteTask.setIndices(m_vertexVertex.m_indices);
+    Parallel::forRange(sites,256,siteTask);
+}
@@ -0,0 +1,69 @@
+#ifndef TETGRAPHS_H
+#define TETGRAPHS_H
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file TetGraphs.h
+/// @author Maria Vineeta Bagya Seelan
+/// @version 1.0
+/// @date 16/08/13
+/// Revision History :
+/// Initial Version 16/08/13
+/// @class TetGraphs
+/// @brief the adjacency of a tetrahedralization as compressed sparse row graphs, for solvers that want flat arrays:
+/// @brief the Delaunay edges between the sites, the tetrahedra around every site and the neighbours of every
+/// @brief tetrahedron. The edges from a site are also the faces of its voronoi cell, so the site graph is the cell to
+/// @brief face incidence as well
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "TetTopology.h"
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a graph in compressed sparse row form, the neighbours of node i are m_indices from m_offsets[i] up to
+/// m_offsets[i+1], in increasing order
+//----------------------------------------------------------------------------------------------------------------------
+struct CSRGraph
+{
+    std::vector<unsigned int> m_offsets;
+    std::vector<unsigned int> m_indices;
+
+    CSRGraph() : m_offsets(1,0) {}
+    unsigned int nodeCount() const { return m_offsets.size()-1; }
+    unsigned int begin(unsigned int _node) const { return m_offsets[_node]; }
+    unsigned int end(unsigned int _node) const { return m_offsets[_node+1]; }
+};
+
+class TetGraphs
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that builds the three graphs in parallel, the nodes are numbered as in the topology and the
+    /// result does not depend on the number of threads
+    /// @param [in] _topology an indexed tetrahedralization with its sites
+    //----------------------------------------------------------------------------------------------------------------------
+    void build(const TetTopology &_topology);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the site to site graph, an entry for every Delaunay edge in both directions. Entry k of a
+    /// site is the face of its voronoi cell towards that neighbour, for a bounded cell in the order CellProperties
+    /// lists its faces
+    //----------------------------------------------------------------------------------------------------------------------
+    const CSRGraph& getVertexVertex() const { return m_vertexVertex; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the site to tetrahedron graph, the tetrahedra that have the site as a vertex
+    //----------------------------------------------------------------------------------------------------------------------
+    const CSRGraph& getVertexTet() const { return m_vertexTet; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the tetrahedron to tetrahedron graph, the neighbours across the faces, up to four as the
+    /// faces on the convex hull have none
+    //----------------------------------------------------------------------------------------------------------------------
+    const CSRGraph& getTetTet() const { return m_tetTet; }
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the three graphs
+    //----------------------------------------------------------------------------------------------------------------------
+    CSRGraph m_vertexVertex;
+    CSRGraph m_vertexTet;
+    CSRGraph m_tetTet;
+};
+
+#endif // TETGRAPHS_H
@@ -0,0 +1,377 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file TetMeshRenderer.cpp
+/// @brief Class that builds and draws the GPU buffers of a tetrahedralization
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "TetMeshRenderer.h"
+#include "ngl/Random.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstddef>
+
+// All the tetrahedra live in one vertex buffer, four vertices per tetrahedron carrying its colour, and one index
+// buffer holding the four faces of every slot, so the whole mesh is drawn with a single glDrawElements. A removed
+// tetrahedron leaves a free slot whose vertices are collapsed to one point, and the next tetrahedron added takes it.
+// Nothing moves, so an update only uploads the slots it touched, which keeps the snapshots of a progressive build
+// proportional to the change rather than to the mesh. The voronoi edges of a progressive build are kept the same way
+// by DynamicVoronoi, two vertices per slot, and uploaded here from its dirty slots
+
+namespace
+{
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief turns the dirty slots into runs of consecutive slots, as begin and end pairs, when they are too scattered
+/// one range covering them all is cheaper than many small calls
+//----------------------------------------------------------------------------------------------------------------------
+void dirtyRuns(std::vector<unsigned int> &io_dirty, std::vector<unsigned int> &o_runs)
+{
+    std::sort(io_dirty.begin(),io_dirty.end());
+    io_dirty.erase(std::unique(io_dirty.begin(),io_dirty.end()),io_dirty.end());
+    o_runs.clear();
+    for(unsigned int i=0; i<io_dirty.size(); ++i)
+    {
+        if(o_runs.empty() || io_dirty[i] != o_runs.back())
+        {
+            o_runs.push_back(io_dirty[i]);
+            o_runs.push_back(io_dirty[i]+1);
+        }
+        else
+        {
+            o_runs.back() = io_dirty[i]+1;
+        }
+    }
+    if(o_runs.size() > 2*64)
+    {
+        o_runs[1] = o_runs.back();
+        o_runs.resize(2);
+    }
+}
+
+} // end anonymous namespace
+
+TetMeshRenderer::TetMeshRenderer()
+{
+    reset();
+    m_capacity = 0;
+    m_vao = 0;
+    m_vbo = 0;
+    m_ibo = 0;
+    m_voronoiVAO = 0;
+    m_liveVoronoiVao = 0;
+    m_liveVoronoiVbo = 0;
+    m_liveVoronoiSlots = 0;
+    m_liveVoronoiCapacity = 0;
+}
+
+TetMeshRenderer::~TetMeshRenderer()
+{
+    clear();
+    if(m_vao!=0)
+    {
+        glDeleteBuffers(1,&m_vbo);
+        glDeleteBuffers(1,&m_ibo);
+        glDeleteVertexArrays(1,&m_vao);
+    }
+    if(m_liveVoronoiVao!=0)
+    {
+        glDeleteBuffers(1,&m_liveVoronoiVbo);
+        glDeleteVertexArrays(1,&m_liveVoronoiVao);
+    }
+}
+
+void TetMeshRenderer::reset()
+{
+    m_vertices.clear();
+    m_slotTet.clear();
+    m_slotOf.clear();
+    m_freeSlots.clear();
+    m_dirtySlots.clear();
+    m_liveCount = 0;
+}
+
+void TetMeshRenderer::clear()
+{
+    reset();
+    if(m_voronoiVAO!=0)
+    {
+        delete m_voronoiVAO;
+        m_voronoiVAO = 0;
+    }
+    // the buffer is kept for the next build, with no slots it draws nothing
+    m_liveVoronoiSlots = 0;
+}
+
+void TetMeshRenderer::build(const std::vector<Tetrahedron*> &_tetrahedra)
+{
+    // the ids of a new mesh say nothing about the old one, so start from an empty batch
+    reset();
+    update(_tetrahedra);
+}
+
+void TetMeshRenderer::update(const std::vector<Tetrahedron*> &_tetrahedra)
+{
+    // mark the ids still in the mesh
+    int maxId = m_slotOf.size();
+    for(unsigned int i=0; i<_tetrahedra.size(); ++i)
+    {
+        maxId = std::max(maxId,_tetrahedra[i]->m_tetid+1);
+    }
+    m_slotOf.resize(maxId,-1);
+    std::vector<bool> live(maxId,false);
+    for(unsigned int i=0; i<_tetrahedra.size(); ++i)
+    {
+        live[_tetrahedra[i]->m_tetid] = true;
+    }
+
+    for(unsigned int slot=0; slot<m_slotTet.size(); ++slot)
+    {
+        if(m_slotTet[slot] >= 0 && !live[m_slotTet[slot]])
+        {
+            removeSlot(slot);
+        }
+    }
+    for(unsigned int i=0; i<_tetrahedra.size(); ++i)
+    {
+        if(m_slotOf[_tetrahedra[i]->m_tetid] < 0)
+        {
+            addSlot(_tetrahedra[i]->m_tetid,_tetrahedra[i]->getVertexData());
+        }
+    }
+    upload();
+}
+
+void TetMeshRenderer::applyDelta(const TetDelta &_delta)
+{
+    int maxId = m_slotOf.size();
+    for(unsigned int i=0; i<_delta.m_created.size(); ++i)
+    {
+        maxId = std::max(maxId,_delta.m_created[i].m_tetid+1);
+    }
+    m_slotOf.resize(maxId,-1);
+
+    // adding first means a tetrahedron created and killed within the same delta is simply gone again
+    for(unsigned int i=0; i<_delta.m_created.size(); ++i)
+    {
+        const TetRecord &r = _delta.m_created[i];
+        if(m_slotOf[r.m_tetid] < 0)
+        {
+            addSlot(r.m_tetid,r.m_verts);
+        }
+    }
+    for(unsigned int i=0; i<_delta.m_killed.size(); ++i)
+    {
+        // the killed list also names tetrahedra that were never shown, such as those on the big tetrahedron
+        int id = _delta.m_killed[i];
+        if(id < maxId && m_slotOf[id] >= 0)
+        {
+            removeSlot(m_slotOf[id]);
+        }
+    }
+    upload();
+}
+
+void TetMeshRenderer::addSlot(int _tetid, const ngl::Vec3 *_verts)
+{
+    unsigned int slot;
+    if(m_freeSlots.empty())
+    {
+        slot = m_slotTet.size();
+        m_slotTet.push_back(-1);
+        m_vertices.resize(4*m_slotTet.size());
+    }
+    else
+    {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+
+    ngl::Colour c = ngl::Random::instance()->getRandomColour();
+    for(int i=0; i<4; ++i)
+    {
+        TetVertex &v = m_vertices[4*slot+i];
+        v.m_x = _verts[i].m_x;
+        v.m_y = _verts[i].m_y;
+        v.m_z = _verts[i].m_z;
+        v.m_colour[0] = (GLubyte)(c.m_r*255.0f);
+        v.m_colour[1] = (GLubyte)(c.m_g*255.0f);
+        v.m_colour[2] = (GLubyte)(c.m_b*255.0f);
+        v.m_colour[3] = (GLubyte)(c.m_a*255.0f);
+    }
+    m_slotTet[slot] = _tetid;
+    m_slotOf[_tetid] = slot;
+    m_dirtySlots.push_back(slot);
+    ++m_liveCount;
+}
+
+void TetMeshRenderer::removeSlot(unsigned int _slot)
+{
+    m_slotOf[m_slotTet[_slot]] = -1;
+    m_slotTet[_slot] = -1;
+    // a tetrahedron with all four vertices on one point has no area to draw
+    for(int i=1; i<4; ++i)
+    {
+        m_vertices[4*_slot+i] = m_vertices[4*_slot];
+    }
+    m_freeSlots.push_back(_slot);
+    m_dirtySlots.push_back(_slot);
+    --m_liveCount;
+}
+
+void TetMeshRenderer::upload()
+{
+    TRACE_ZONE("TetMeshRenderer::upload");
+    unsigned int slots = m_slotTet.size();
+    if(m_vao == 0)
+    {
+        glGenVertexArrays(1,&m_vao);
+        glGenBuffers(1,&m_vbo);
+        glGenBuffers(1,&m_ibo);
+        glBindVertexArray(m_vao);
+        glBindBuffer(GL_ARRAY_BUFFER,m_vbo);
+        // vertex is attribute 0 with x,y,z, the colour attribute 1 with normalised r,g,b,a bytes
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(TetVertex),(const GLvoid *)offsetof(TetVertex,m_x));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1,4,GL_UNSIGNED_BYTE,GL_TRUE,sizeof(TetVertex),(const GLvoid *)offsetof(TetVertex,m_colour));
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m_ibo);
+        glBindVertexArray(0);
+    }
+
+    if(slots > m_capacity)
+    {
+        // grow geometrically so a growing mesh reallocates rarely, the index pattern is the same for every slot
+        m_capacity = std::max(slots,std::max(2*m_capacity,1024u));
+        const std::vector<Face>& faces = Tetrahedron::getFaceData();
+        std::vector<GLuint> indices;
+        indices.reserve(12*m_capacity);
+        for(unsigned int s=0; s<m_capacity; ++s)
+        {
+            for(unsigned int f=0; f<4; ++f)
+            {
+                for(unsigned int j=0; j<3; ++j)
+                {
+                    indices.push_back(4*s+faces[f].m_vert[j]);
+                }
+            }
+        }
+        glBindVertexArray(m_vao);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m_ibo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER,indices.size()*sizeof(GLuint),&indices[0],GL_STATIC_DRAW);
+        glBindVertexArray(0);
+
+        // the new store is empty, so everything is uploaded
+        glBindBuffer(GL_ARRAY_BUFFER,m_vbo);
+        glBufferData(GL_ARRAY_BUFFER,4*m_capacity*sizeof(TetVertex),NULL,GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER,0,4*slots*sizeof(TetVertex),&m_vertices[0]);
+        glBindBuffer(GL_ARRAY_BUFFER,0);
+        m_dirtySlots.clear();
+        return;
+    }
+    if(m_dirtySlots.empty())
+    {
+        return;
+    }
+
+    std::vector<unsigned int> runs;
+    dirtyRuns(m_dirtySlots,runs);
+    glBindBuffer(GL_ARRAY_BUFFER,m_vbo);
+    for(unsigned int r=0; r<runs.size(); r+=2)
+    {
+        glBufferSubData(GL_ARRAY_BUFFER,4*runs[r]*sizeof(TetVertex),4*(runs[r+1]-runs[r])*sizeof(TetVertex),&m_vertices[4*runs[r]]);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER,0);
+    m_dirtySlots.clear();
+}
+
+void TetMeshRenderer::buildVoronoi(const Voronoi &_voronoi)
+{
+    if(m_voronoiVAO!=0)
+    {
+        delete m_voronoiVAO;
+        m_voronoiVAO = 0;
+    }
+    const std::vector<ngl::Vec3>& edges = _voronoi.getEdges();
+    if(edges.empty())
+    {
+        return;
+    }
+
+    // first we grab an instance of our VOA
+    m_voronoiVAO= ngl::VertexArrayObject::createVOA(GL_LINES);
+    // next we bind it so it's active for setting data
+    m_voronoiVAO->bind();
+    // vertex is attribute 0 with x,y,z(3) parts of type GL_FLOAT
+    m_voronoiVAO->setData(edges.size()*sizeof(ngl::Vec3),edges[0].m_x);
+    m_voronoiVAO->setVertexAttributePointer(0,3,GL_FLOAT,sizeof(ngl::Vec3),0);
+    m_voronoiVAO->setNumIndices(edges.size());
+    // finally we have finished for now so time to unbind the VAO
+    m_voronoiVAO->unbind();
+}
+
+void TetMeshRenderer::updateVoronoi(const DynamicVoronoi &_voronoi)
+{
+    TRACE_ZONE("TetMeshRenderer::updateVoronoi");
+    m_liveVoronoiSlots = _voronoi.slotCount();
+    if(m_liveVoronoiSlots == 0)
+    {
+        return;
+    }
+    const std::vector<ngl::Vec3> &edges = _voronoi.getEdges();
+    if(m_liveVoronoiVao == 0)
+    {
+        glGenVertexArrays(1,&m_liveVoronoiVao);
+        glGenBuffers(1,&m_liveVoronoiVbo);
+        glBindVertexArray(m_liveVoronoiVao);
+        glBindBuffer(GL_ARRAY_BUFFER,m_liveVoronoiVbo);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,sizeof(ngl::Vec3),0);
+        glBindVertexArray(0);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER,m_liveVoronoiVbo);
+    if(m_liveVoronoiSlots > m_liveVoronoiCapacity)
+    {
+        // grown as the batch is, the new store gets every slot at once
+        m_liveVoronoiCapacity = std::max(m_liveVoronoiSlots,std::max(2*m_liveVoronoiCapacity,1024u));
+        glBufferData(GL_ARRAY_BUFFER,2*m_liveVoronoiCapacity*sizeof(ngl::Vec3),NULL,GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER,0,2*m_liveVoronoiSlots*sizeof(ngl::Vec3),&edges[0]);
+    }
+    else
+    {
+        std::vector<unsigned int> dirty(_voronoi.getDirtySlots());
+        std::vector<unsigned int> runs;
+        dirtyRuns(dirty,runs);
+        for(unsigned int r=0; r<runs.size(); r+=2)
+        {
+            glBufferSubData(GL_ARRAY_BUFFER,2*runs[r]*sizeof(ngl::Vec3),2*(runs[r+1]-runs[r])*sizeof(ngl::Vec3),&edges[2*runs[r]]);
+        }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER,0);
+}
+
+void TetMeshRenderer::drawTetrahedra()
+{
+    if(m_vao!=0 && m_liveCount!=0)
+    {
+        // free slots are drawn too, they are degenerate and produce no fragments
+        glBindVertexArray(m_vao);
+        glDrawElements(GL_TRIANGLES,12*m_slotTet.size(),GL_UNSIGNED_INT,0);
+        glBindVertexArray(0);
+    }
+}
+
+void TetMeshRenderer::drawVoronoi()
+{
+    if(m_voronoiVAO!=0)
+    {
+        m_voronoiVAO->bind();
+        m_voronoiVAO->draw();
+        m_voronoiVAO->unbind();
+    }
+    if(m_liveVoronoiVao!=0 && m_liveVoronoiSlots!=0)
+    {
+        glBindVertexArray(m_liveVoronoiVao);
+        glDrawArrays(GL_LINES,0,2*m_liveVoronoiSlots);
+        glBindVertexArray(0);
+    }
+}
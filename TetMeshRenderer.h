@@ -0,0 +1,167 @@
+#ifndef TETMESHRENDERER_H
+#define TETMESHRENDERER_H
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file TetMeshRenderer.h
+/// @author Maria Vineeta Bagya Seelan
+/// @version 1.3
+/// @date 16/08/13
+/// Revision History :
+/// Initial Version 16/08/13
+/// 1.1 all tetrahedra packed into one vertex/index buffer drawn with a single call
+/// 1.2 freed slots are reused instead of compacted so a change only uploads the slots it touches
+/// 1.3 the voronoi edges of a progressive build are kept in slots too and updated from a DynamicVoronoi
+/// @class TetMeshRenderer
+/// @brief render adapter that builds the GPU buffers for a finished tetrahedral mesh and its voronoi diagram,
+/// @brief the Tetrahedron and Voronoi classes hold no OpenGL state so they can be built headless
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "ngl/Vec3.h"
+#include "ngl/VertexArrayObject.h"
+#include "Tetrahedron.h"
+#include "Voronoi.h"
+#include "Delaunay.h"
+#include "DynamicVoronoi.h"
+
+class TetMeshRenderer
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief Constructor for TetMeshRenderer, does not need a GL context
+    //----------------------------------------------------------------------------------------------------------------------
+    TetMeshRenderer();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief Destructor for TetMeshRenderer, releases the GPU buffers
+    //----------------------------------------------------------------------------------------------------------------------
+    ~TetMeshRenderer();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that replaces the batch with the tetrahedra of a new mesh
+    /// @param [in] _tetrahedra the finished tetrahedralization
+    //----------------------------------------------------------------------------------------------------------------------
+    void build(const std::vector<Tetrahedron*> &_tetrahedra);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that brings the batch in line with a changed version of the same mesh, tetrahedra are matched by
+    /// their id so only the added and removed ones are rewritten and only the changed range is uploaded
+    /// @param [in] _tetrahedra the current tetrahedra of the mesh
+    //----------------------------------------------------------------------------------------------------------------------
+    void update(const std::vector<Tetrahedron*> &_tetrahedra);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that applies a snapshot of a progressive build, only the slots of the created and killed
+    /// tetrahedra are rewritten and uploaded
+    /// @param [in] _delta the changes since the last snapshot
+    //----------------------------------------------------------------------------------------------------------------------
+    void applyDelta(const TetDelta &_delta);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that creates the vertex array object for the voronoi edges
+    /// @param [in] _voronoi the voronoi diagram of the tetrahedralization
+    //----------------------------------------------------------------------------------------------------------------------
+    void buildVoronoi(const Voronoi &_voronoi);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that brings the live voronoi edges in line with a DynamicVoronoi, only its dirty slots are
+    /// uploaded. They are drawn with the edges of buildVoronoi, an empty DynamicVoronoi draws nothing
+    /// @param [in] _voronoi the edges of the progressive build, its dirty slots are left for the caller to clear
+    //----------------------------------------------------------------------------------------------------------------------
+    void updateVoronoi(const DynamicVoronoi &_voronoi);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that empties the batch and releases the voronoi edges, the live ones included
+    //----------------------------------------------------------------------------------------------------------------------
+    void clear();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the number of tetrahedra in the batch
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int getTetCount() const { return m_liveCount; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief method that draws all the tetrahedra with one call, expects a shader with the vertex at attribute 0 and
+    /// the colour at attribute 1
+    //----------------------------------------------------------------------------------------------------------------------
+    void drawTetrahedra();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief method that draws the voronoi edges
+    //----------------------------------------------------------------------------------------------------------------------
+    void drawVoronoi();
+
+private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief one vertex of the batch, a tetrahedron owns four consecutive ones
+    //----------------------------------------------------------------------------------------------------------------------
+    struct TetVertex
+    {
+        GLfloat m_x;
+        GLfloat m_y;
+        GLfloat m_z;
+        GLubyte m_colour[4];
+    };
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief CPU copy of the vertex buffer, a free slot has its four vertices collapsed to one point so it draws nothing
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<TetVertex> m_vertices;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the tetrahedron id held by each slot, -1 for a free slot
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<int> m_slotTet;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the slot of each tetrahedron id, -1 if it is not in the batch
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<int> m_slotOf;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the free slots, reused before the batch grows
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<unsigned int> m_freeSlots;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the slots changed since the last upload
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<unsigned int> m_dirtySlots;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief number of slots holding a tetrahedron
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int m_liveCount;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief number of slots the GPU buffers have room for
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int m_capacity;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief vertex array, vertex buffer and index buffer of the batch, 0 until the first upload
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_vao;
+    GLuint m_vbo;
+    GLuint m_ibo;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the vertex array object of the voronoi edges
+    //----------------------------------------------------------------------------------------------------------------------
+    ngl::VertexArrayObject *m_voronoiVAO;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief vertex array and vertex buffer of the live voronoi edges, 0 until the first update, with the number of
+    /// edge slots drawn and the number the buffer has room for
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_liveVoronoiVao;
+    GLuint m_liveVoronoiVbo;
+    unsigned int m_liveVoronoiSlots;
+    unsigned int m_liveVoronoiCapacity;
+
+private :
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that puts a tetrahedron in a free slot, or a new one, with a random colour
+    /// @param [in] _tetid the id of the tetrahedron
+    /// @param [in] _verts its four vertices
+    //----------------------------------------------------------------------------------------------------------------------
+    void addSlot(int _tetid, const ngl::Vec3 *_verts);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that frees a slot
+    //----------------------------------------------------------------------------------------------------------------------
+    void removeSlot(unsigned int _slot);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that empties the batch without releasing the GPU buffers
+    //----------------------------------------------------------------------------------------------------------------------
+    void reset();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that uploads the changed slots, growing the GPU buffers when they are too small
+    //----------------------------------------------------------------------------------------------------------------------
+    void upload();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief TetMeshRenderer owns GPU buffers so it is not copyable
+    //----------------------------------------------------------------------------------------------------------------------
+    TetMeshRenderer(const TetMeshRenderer &);
+    TetMeshRenderer& operator=(const TetMeshRenderer &);
+};
+
+#endif // TETMESHRENDERER_H
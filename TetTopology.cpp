@@ -0,0 +1,225 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file TetTopology.cpp
+/// @brief Class that indexes the sites and the neighbours of a tetrahedralization
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "TetTopology.h"
+#include "Parallel.h"
+#include "Trace.h"
+#include <algorithm>
+#include <iostream>
+
+// The vertices of a tetrahedron are copies of the input points, so a vertex is matched to its site by a binary
+// search over the sites sorted by their exact coordinates, and a neighbour pointer to its index through a table
+// indexed by m_tetid. Both are done per tetrahedron in parallel, the lists of tetrahedra around the sites are then
+// counted and filled in one pass each
+
+namespace
+{
+
+bool positionLess(const ngl::Vec3 &_a, const ngl::Vec3 &_b)
+{
+    if(_a.m_x != _b.m_x) { return _a.m_x < _b.m_x; }
+    if(_a.m_y != _b.m_y) { return _a.m_y < _b.m_y; }
+    return _a.m_z < _b.m_z;
+}
+
+bool positionEqual(const ngl::Vec3 &_a, const ngl::Vec3 &_b)
+{
+    return _a.m_x == _b.m_x && _a.m_y == _b.m_y && _a.m_z == _b.m_z;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief orders site indices by position, duplicated points by index so the first one is found
+//----------------------------------------------------------------------------------------------------------------------
+struct SiteOrder
+{
+    const std::vector<ngl::Vec3> *m_sites;
+
+    bool operator()(unsigned int _a, unsigned int _b) const
+    {
+        const ngl::Vec3 &a = (*m_sites)[_a];
+        const ngl::Vec3 &b = (*m_sites)[_b];
+        if(positionLess(a,b)) { return true; }
+        if(positionLess(b,a)) { return false; }
+        return _a < _b;
+    }
+    bool operator()(unsigned int _a, const ngl::Vec3 &_b) const { return positionLess((*m_sites)[_a],_b); }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief fills the neighbours of a range of tetrahedra
+//----------------------------------------------------------------------------------------------------------------------
+class NeighbourTask : public ParallelTask
+{
+public:
+    NeighbourTask(const std::vector<Tetrahedron*> &_tetrahedra, const std::vector<int> &_idToIndex,
+                  std::vector<int> &o_tetNeighbours) :
+        m_tetrahedra(_tetrahedra), m_idToIndex(_idToIndex), m_tetNeighbours(o_tetNeighbours) {}
+
+    void run(unsigned int _begin, unsigned int _end)
+    {
+        for(unsigned int t=_begin; t<_end; ++t)
+        {
+            for(int i=0; i<4; ++i)
+            {
+                // the neighbours outside the list are the ones on the big tetrahedron, removed by the clean up
+                const Tetrahedron *n = m_tetrahedra[t]->m_neighbours[i];
+                bool listed = n != NULL && n->m_tetid >= 0 && n->m_tetid < (int)m_idToIndex.size();
+                m_tetNeighbours[4*t+i] = listed ? m_idToIndex[n->m_tetid] : -1;
+            }
+        }
+    }
+
+private:
+    const std::vector<Tetrahedron*> &m_tetrahedra;
+    const std::vector<int> &m_idToIndex;
+    std::vector<int> &m_tetNeighbours;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief fills the sites of a range of tetrahedra
+//----------------------------------------------------------------------------------------------------------------------
+class SiteTask : public ParallelTask
+{
+public:
+    SiteTask(const std::vector<Tetrahedron*> &_tetrahedra, const std::vector<ngl::Vec3> &_sites,
+             const std::vector<unsigned int> &_order, std::vector<unsigned int> &o_tetSites) :
+        m_tetrahedra(_tetrahedra), m_sites(_sites), m_order(_order), m_tetSites(o_tetSites), m_missing(false)
+    {
+        m_search.m_sites = &_sites;
+    }
+
+    void run(unsigned int _begin, unsigned int _end)
+    {
+        for(unsigned int t=_begin; t<_end; ++t)
+        {
+            const ngl::Vec3 *verts = m_tetrahedra[t]->getVertexData();
+            for(int i=0; i<4; ++i)
+            {
+                std::vector<unsigned int>::const_iterator found =
+                        std::lower_bound(m_order.begin(),m_order.end(),verts[i],m_search);
+                if(found == m_order.end() || !positionEqual(m_sites[*found],verts[i]))
+                {
+                    m_missing = true;
+                    m_tetSites[4*t+i] = 0;
+                }
+                else
+                {
+                    m_tetSites[4*t+i] = *found;
+                }
+            }
+        }
+    }
+
+    bool missing() const { return m_missing; }
+
+private:
+    const std::vector<Tetrahedron*> &m_tetrahedra;
+    const std::vector<ngl::Vec3> &m_sites;
+    const std::vector<unsigned int> &m_order;
+    std::vector<unsigned int> &m_tetSites;
+    SiteOrder m_search;
+    // only ever set to true, so the threads need no lock for it
+    volatile bool m_missing;
+};
+
+} // end anonymous namespace
+
+TetTopology::TetTopology()
+{
+    m_siteTetOffsets.push_back(0);
+}
+
+void TetTopology::build(const std::vector<Tetrahedron*> &_tetrahedra, const std::vector<ngl::Vec3> &_sites)
+{
+    TRACE_ZONE("TetTopology::build");
+    unsigned int tets = _tetrahedra.size();
+    buildNeighbours(_tetrahedra);
+
+    m_sites = _sites;
+    if(m_sites.empty())
+    {
+        m_sites.reserve(4*tets);
+        for(unsigned int t=0; t<tets; ++t)
+        {
+            m_sites.insert(m_sites.end(),_tetrahedra[t]->getVertexData(),_tetrahedra[t]->getVertexData()+4);
+        }
+        std::sort(m_sites.begin(),m_sites.end(),positionLess);
+        m_sites.erase(std::unique(m_sites.begin(),m_sites.end(),positionEqual),m_sites.end());
+    }
+    std::vector<unsigned int> order(m_sites.size());
+    for(unsigned int i=0; i<order.size(); ++i)
+    {
+        order[i] = i;
+    }
+    SiteOrder siteOrder;
+    siteOrder.m_sites = &m_sites;
+    std::sort(order.begin(),order.end(),siteOrder);
+
+    m_tetSites.resize(4*tets);
+    SiteTask index(_tetrahedra,m_sites,order,m_tetSites);
+    Parallel::forRange(tets,1024,index);
+    if(index.missing())
+    {
+        std::cerr<<"TetTopology : a vertex is not one of the sites, indexing the vertices instead"<<std::endl;
+        build(_tetrahedra,std::vector<ngl::Vec3>());
+        return;
+    }
+
+    // the tetrahedra around each site, in increasing order
+    m_siteTetOffsets.assign(m_sites.size()+1,0);
+    for(unsigned int i=0; i<m_tetSites.size(); ++i)
+    {
+        ++m_siteTetOffsets[m_tetSites[i]+1];
+    }
+    for(unsigned int s=0; s<m_sites.size(); ++s)
+    {
+        m_siteTetOffsets[s+1] += m_siteTetOffsets[s];
+    }
+    m_siteTets.resize(m_tetSites.size());
+    std::vector<unsigned int> fill(m_siteTetOffsets.begin(),m_siteTetOffsets.end()-1);
+    for(unsigned int i=0; i<m_tetSites.size(); ++i)
+    {
+        m_siteTets[fill[m_tetSites[i]]++] = i/4;
+    }
+}
+
+void TetTopology::buildNeighbours(const std::vector<Tetrahedron*> &_tetrahedra)
+{
+    unsigned int tets = _tetrahedra.size();
+    int maxId = -1;
+    for(unsigned int t=0; t<tets; ++t)
+    {
+        maxId = std::max(maxId,_tetrahedra[t]->m_tetid);
+    }
+    std::vector<int> idToIndex(maxId+1,-1);
+    for(unsigned int t=0; t<tets; ++t)
+    {
+        if(_tetrahedra[t]->m_tetid >= 0)
+        {
+            idToIndex[_tetrahedra[t]->m_tetid] = t;
+        }
+    }
+
+    m_sites.clear();
+    m_tetSites.clear();
+    m_siteTetOffsets.assign(1,0);
+    m_siteTets.clear();
+    m_tetNeighbours.resize(4*tets);
+    NeighbourTask neighbours(_tetrahedra,idToIndex,m_tetNeighbours);
+    Parallel::forRange(tets,1024,neighbours);
+}
+
+int TetTopology::slotOf(unsigned int _tet, unsigned int _site) const
+{
+    const unsigned int *sites = &m_tetSites[4*_tet];
+    for(int i=0; i<4; ++i)
+    {
+        if(sites[i] == _site)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,99 @@
+#ifndef TETTOPOLOGY_H
+#define TETTOPOLOGY_H
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file TetTopology.h
+/// @author Maria Vineeta Bagya Seelan
+/// @version 1.1
+/// @date 16/08/13
+/// Revision History :
+/// Initial Version 16/08/13
+/// 1.1 buildNeighbours for the users that need no sites
+/// @class TetTopology
+/// @brief an indexed copy of the connectivity of a tetrahedralization. The tetrahedra keep their vertices as
+/// @brief positions and their neighbours as pointers, here every vertex is a site index, every neighbour a tetrahedron
+/// @brief index and the tetrahedra around each site are listed, so the dual can be walked without comparing positions
+/// @brief or chasing pointers. Building it leaves the tetrahedra untouched
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Tetrahedron.h"
+
+class TetTopology
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief Constructor for an empty TetTopology
+    //----------------------------------------------------------------------------------------------------------------------
+    TetTopology();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that indexes a tetrahedralization
+    /// @param [in] _tetrahedra the tetrahedra, the index of a tetrahedron is its position in here
+    /// @param [in] _sites the points the tetrahedralization was built from, a site index is then the position of the
+    /// point and duplicated points share the first one. When empty the distinct vertices of the tetrahedra are the sites,
+    /// in lexicographic order
+    //----------------------------------------------------------------------------------------------------------------------
+    void build(const std::vector<Tetrahedron*> &_tetrahedra, const std::vector<ngl::Vec3> &_sites);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that indexes only the neighbours of a tetrahedralization, the sites are left empty
+    /// @param [in] _tetrahedra the tetrahedra, the index of a tetrahedron is its position in here
+    //----------------------------------------------------------------------------------------------------------------------
+    void buildNeighbours(const std::vector<Tetrahedron*> &_tetrahedra);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessors for the number of sites and tetrahedra
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int siteCount() const { return m_sites.size(); }
+    unsigned int tetCount() const { return m_tetNeighbours.size()/4; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the position of every site
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<ngl::Vec3>& getSites() const { return m_sites; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the site at a vertex of a tetrahedron
+    /// @param [in] _tet the tetrahedron
+    /// @param [in] _i the vertex, 0 to 3 as in the tetrahedron
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int tetSite(unsigned int _tet, int _i) const { return m_tetSites[4*_tet+_i]; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the neighbour across a face of a tetrahedron
+    /// @param [in] _tet the tetrahedron
+    /// @param [in] _i the face, the one opposite vertex _i
+    /// @returns the neighbour, -1 on the convex hull
+    //----------------------------------------------------------------------------------------------------------------------
+    int tetNeighbour(unsigned int _tet, int _i) const { return m_tetNeighbours[4*_tet+_i]; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the position of a site in a tetrahedron
+    /// @param [in] _tet the tetrahedron
+    /// @param [in] _site the site
+    /// @returns the vertex 0 to 3, -1 if the site is not a vertex of the tetrahedron
+    //----------------------------------------------------------------------------------------------------------------------
+    int slotOf(unsigned int _tet, unsigned int _site) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessors for the tetrahedra around a site, they are the entries from siteTetsBegin(_site) up to
+    /// siteTetsEnd(_site) of getSiteTets
+    /// @param [in] _site the site
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int siteTetsBegin(unsigned int _site) const { return m_siteTetOffsets[_site]; }
+    unsigned int siteTetsEnd(unsigned int _site) const { return m_siteTetOffsets[_site+1]; }
+    const std::vector<unsigned int>& getSiteTets() const { return m_siteTets; }
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the position of every site
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<ngl::Vec3> m_sites;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the four sites of every tetrahedron
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<unsigned int> m_tetSites;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the four neighbours of every tetrahedron, -1 on the convex hull
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<int> m_tetNeighbours;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the tetrahedra around every site, those of site i start at m_siteTetOffsets[i]
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<unsigned int> m_siteTetOffsets;
+    std::vector<unsigned int> m_siteTets;
+};
+
+#endif // TETTOPOLOGY_H
@@ -4,171 +4,120 @@
 //----------------------------------------------------------------------------------------------------------------------
 
 #include "Tetrahedron.h"
-#include "ngl/Random.h"
-#include "ngl/Mat4.h"
 #include "cstdlib"
 
+// Construction only stores the vertices, most tetrahedra created by the flips are replaced
+// again before anything asks for their circumsphere, so it is computed on first access
+// and cached. Nothing in here touches OpenGL, TetMeshRenderer builds the GPU buffers from
+// a finished mesh
+
 Tetrahedron::Tetrahedron()
 {
-    m_verts.clear();
     m_modified = false;
     m_tetid = 0;
-    m_vao = false;
+    m_sphereCached = false;
+    for(int i=0; i<4; ++i)
+    {
+        m_neighbours[i] = NULL;
+        m_faceMap[i] = 0;
+        m_weights[i] = 0.0;
+    }
 }
 
 Tetrahedron::Tetrahedron(ngl::Vec3 _a, ngl::Vec3 _b, ngl::Vec3 _c, ngl::Vec3 _d)
 {
-    m_verts.push_back(_a);
-    m_verts.push_back(_b);
-    m_verts.push_back(_c);
-    m_verts.push_back(_d);
+    m_verts[0] = _a;
+    m_verts[1] = _b;
+    m_verts[2] = _c;
+    m_verts[3] = _d;
     m_modified = false;
     m_tetid = 0;
-    m_vao = false;
-    calculateFormula();
-    findCenter();
-    findRadius();
-    createFaces();
-    setColour();
+    m_sphereCached = false;
+    for(int i=0; i<4; ++i)
+    {
+        m_neighbours[i] = NULL;
+        m_faceMap[i] = 0;
+        m_weights[i] = 0.0;
+    }
 }
 
 Tetrahedron::Tetrahedron(std::vector<ngl::Vec3> _vertexArray)
 {
-    m_verts = _vertexArray;
+    for(unsigned int i=0; i<4 && i<_vertexArray.size(); ++i)
+    {
+        m_verts[i] = _vertexArray[i];
+    }
     m_modified = false;
     m_tetid = 0;
-    m_vao = false;
-    calculateFormula();
-    findCenter();
-    findRadius();
-    createFaces();
-    setColour();
-}
-
-void Tetrahedron::setColour()
-{
-    ngl::Random *rng=ngl::Random::instance();
-    m_tetraColour = rng->getRandomColour();
+    m_sphereCached = false;
+    for(int i=0; i<4; ++i)
+    {
+        m_neighbours[i] = NULL;
+        m_faceMap[i] = 0;
+        m_weights[i] = 0.0;
+    }
 }
 
-void Tetrahedron::calculateFormula()
+void Tetrahedron::setWeights(const ngl::Real *_weights)
 {
-    ngl::Vec3 a = m_verts[1] - m_verts[0];
-    ngl::Vec3 b = m_verts[2] - m_verts[0];
-    ngl::Vec3 c = m_verts[3] - m_verts[0];
-    m_formulaN = (a.dot(a)*(b.cross(c)) + b.dot(b)*(c.cross(a)) + c.dot(c)*(a.cross(b)));
-    m_formulaD = a.dot(b.cross(c));
+    for(int i=0; i<4; ++i)
+    {
+        m_weights[i] = _weights[i];
+    }
+    m_sphereCached = false;
 }
 
-void Tetrahedron::createFaces()
+ngl::Vec3 Tetrahedron::getCirCenter() const
 {
-    Face f1,f2,f3,f4;
-    f1.m_vert.push_back(0);
-    f1.m_vert.push_back(1);
-    f1.m_vert.push_back(2);
-    m_face.push_back(f1);
-
-    f2.m_vert.push_back(0);
-    f2.m_vert.push_back(2);
-    f2.m_vert.push_back(3);
-    m_face.push_back(f2);
-
-    f3.m_vert.push_back(0);
-    f3.m_vert.push_back(3);
-    f3.m_vert.push_back(1);
-    m_face.push_back(f3);
-
-    f4.m_vert.push_back(1);
-    f4.m_vert.push_back(2);
-    f4.m_vert.push_back(3);
-    m_face.push_back(f4);
+    if(!m_sphereCached)
+    {
+        findSphere();
+    }
+    return m_circumcenter;
 }
 
-void Tetrahedron::findCenter()
+ngl::Real Tetrahedron::getCirRadius() const
 {
-    m_circumcenter = m_verts[0] + m_formulaN/(2*m_formulaD);
+    if(!m_sphereCached)
+    {
+        findSphere();
+    }
+    return m_circumradius;
 }
 
-void Tetrahedron::findRadius()
+void Tetrahedron::findSphere() const
 {
     ngl::Vec3 a = m_verts[1] - m_verts[0];
     ngl::Vec3 b = m_verts[2] - m_verts[0];
     ngl::Vec3 c = m_verts[3] - m_verts[0];
-
-    m_circumradius = m_formulaN.length()/(2*std::abs(m_formulaD));
+    // the centre x solves 2(v_i-v_0).(x-v_0) = |v_i-v_0|^2 - (w_i-w_0), with zero weights it is the circumcentre
+    ngl::Real la = a.dot(a) - (m_weights[1]-m_weights[0]);
+    ngl::Real lb = b.dot(b) - (m_weights[2]-m_weights[0]);
+    ngl::Real lc = c.dot(c) - (m_weights[3]-m_weights[0]);
+    ngl::Vec3 n = (la*(b.cross(c)) + lb*(c.cross(a)) + lc*(a.cross(b)));
+    ngl::Real d = a.dot(b.cross(c));
+
+    m_circumcenter = m_verts[0] + n/(2*d);
+    ngl::Real r2 = n.dot(n)/(4*d*d) - m_weights[0];
+    m_circumradius = r2 > 0 ? std::sqrt(r2) : 0;
+    m_sphereCached = true;
 }
 
-Tetrahedron::~Tetrahedron()
+// the face table is built during static initialisation so reading it from worker threads is safe
+static std::vector<Face> createFaceTable()
 {
-    m_face.erase(m_face.begin(),m_face.end());
-    glDeleteBuffers(1,&m_vboBuffers);
-    if(m_vaoTetrahedron!=0)
+    static const unsigned long int faceVerts[4][3] = { {0,1,2}, {0,2,3}, {0,3,1}, {1,2,3} };
+    std::vector<Face> faces(4);
+    for(unsigned int i=0;i<4;++i)
     {
-       delete m_vaoTetrahedron;
+        faces[i].m_vert.assign(faceVerts[i],faceVerts[i]+3);
     }
+    return faces;
 }
 
-void Tetrahedron::draw()
-{
-   if(m_vao == true)
-   {
-     m_vaoTetrahedron->bind();
-     m_vaoTetrahedron->draw();
-     m_vaoTetrahedron->unbind();
-   }
-}
+static const std::vector<Face> s_faceTable = createFaceTable();
 
-void Tetrahedron::createVAO()
+const std::vector<Face>& Tetrahedron::getFaceData()
 {
-     // if we have already created a VBO just return.
-     if(m_vao == true)
-     {
-         std::cout<<"VAO exist so returning\n";
-         return;
-     }
-
-     // now we are going to process and pack the mesh into an ngl::VertexArrayObject
-     std::vector <ngl::Vec3> vboMesh;
-     ngl::Vec3 d;
-     int loopFaceCount=3;
-
-     // loop for each of the faces
-     for(unsigned int i=0;i<4;++i)
-     {
-        // now for each triangle in the face (remember we ensured tri above)
-        for(int j=0;j<loopFaceCount;++j)
-        {
-          // pack in the vertex data first
-          d.m_x=m_verts[m_face[i].m_vert[j]].m_x;
-          d.m_y=m_verts[m_face[i].m_vert[j]].m_y;
-          d.m_z=m_verts[m_face[i].m_vert[j]].m_z;
-          vboMesh.push_back(d);
-        }
-     }
-
-     // first we grab an instance of our VOA
-     m_vaoTetrahedron= ngl::VertexArrayObject::createVOA(GL_TRIANGLES);
-     // next we bind it so it's active for setting data
-     m_vaoTetrahedron->bind();
-     m_tetrahedronSize=vboMesh.size();
-     // now we have our data add it to the VAO, we need to tell the VAO the following
-     // how much (in bytes) data we are copying
-     // a pointer to the first element of data (in this case the address of the first element of the
-     // std::vector
-     m_vaoTetrahedron->setData(m_tetrahedronSize*sizeof(ngl::Vec3),vboMesh[0].m_x);
-     // so we need to set the vertexAttributePointer so the correct size and type as follows
-     // vertex is attribute 0 with x,y,z(3) parts of type GL_FLOAT, our complete packed data is
-     // sizeof(vertData) and the offset into the data structure for the first x component is 0
-     m_vaoTetrahedron->setVertexAttributePointer(0,3,GL_FLOAT,sizeof(ngl::Vec3),0);
-     // now we have set the vertex attributes we tell the VAO class how many indices to draw when
-     // glDrawArrays is called, in this case we use buffSize (but if we wished less of the sphere to be drawn we could
-     // specify less (in steps of 3))
-     m_vaoTetrahedron->setNumIndices(m_tetrahedronSize);
-     // finally we have finished for now so time to unbind the VAO
-     m_vaoTetrahedron->unbind();
-     // indicate we have a vao now
-     m_vao=true;
+    return s_faceTable;
 }
-
-
-
@@ -4,17 +4,18 @@
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Tetrahedron.h
 /// @author Maria Vineeta Bagya Seelan
-/// @version 1.0
+/// @version 1.2
 /// @date 16/08/13
 /// Revision History :
 /// Initial Version 16/08/13
+/// 1.1 render resources moved to TetMeshRenderer so the mesh can be built without a GL context
+/// 1.2 a weight per vertex, the sphere of a weighted tetrahedron is its orthogonal sphere
 /// @class Tetrahedron
 /// @brief This is the class that defines the functions required to construct a tetrahedron
 //----------------------------------------------------------------------------------------------------------------------
 
 #include "ngl/Vec3.h"
-#include "ngl/VertexArrayObject.h"
-#include "ngl/Colour.h"
+#include <vector>
 
 //----------------------------------------------------------------------------------------------------------------------
 /// @class Face
@@ -50,39 +51,41 @@ public:
     //----------------------------------------------------------------------------------------------------------------------
     Tetrahedron( ngl::Vec3 _a, ngl::Vec3 _b, ngl::Vec3 _c, ngl::Vec3 _d );
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief Destructor for Tetrahedron
-    //----------------------------------------------------------------------------------------------------------------------
-    ~Tetrahedron();
-    //----------------------------------------------------------------------------------------------------------------------
     /// @brief accessor for the vertex data
-    /// @returns a std::vector containing the vert data
+    /// @returns a pointer to the four vertices
     //----------------------------------------------------------------------------------------------------------------------
-    std::vector<ngl::Vec3> getVertexData(){ return m_verts; }
+    const ngl::Vec3* getVertexData() const { return m_verts; }
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief accessor for the Face data
-    /// @returns a std::vector containing the face data
+    /// @brief accessor for the weights of the four vertices, all zero unless setWeights was called
     //----------------------------------------------------------------------------------------------------------------------
-    std::vector <Face> getFaceData(){ return m_face; }
+    const ngl::Real* getWeightData() const { return m_weights; }
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief accessor to get the Circumsphere radius
+    /// @brief function that sets the weights of the vertices, in the order of the vertices
+    /// @param [in] _weights the four weights
     //----------------------------------------------------------------------------------------------------------------------
-    inline ngl::Real getCirRadius()const { return m_circumradius; }
+    void setWeights(const ngl::Real *_weights);
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief accessor to get the Circumcenter
+    /// @brief accessor for the Face data, the faces are the same for every tetrahedron
+    /// @returns a std::vector containing the face data
     //----------------------------------------------------------------------------------------------------------------------
-    inline ngl::Vec3 getCirCenter()const { return m_circumcenter; }
+    static const std::vector <Face>& getFaceData();
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief accessor to get the Tetrahedron colour
+    /// @brief accessor to get the Circumsphere radius, computed on first access. For weighted vertices it is the radius
+    /// of the sphere orthogonal to the four vertex spheres, zero if there is none
     //----------------------------------------------------------------------------------------------------------------------
-    inline ngl::Colour getColour()const { return m_tetraColour; }
+    ngl::Real getCirRadius() const;
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief method that draws the terahedron
+    /// @brief accessor to get the Circumcenter, computed on first access. For weighted vertices it is the power centre,
+    /// the point with the same power distance to the four vertices and the vertex of their power diagram
     //----------------------------------------------------------------------------------------------------------------------
-    void draw();
+    ngl::Vec3 getCirCenter() const;
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief Creates vertex array object for the tetrahedron
+    /// @brief accessor for the face map
+    /// @param [in] _face the face shared with the neighbour
+    /// @param [in] _i the position of one of our vertices
+    /// @returns the position of vertex _i in the neighbour across _face, for _i == _face the neighbour's opposite vertex
     //----------------------------------------------------------------------------------------------------------------------
-    void createVAO();
+    inline int acrossFace(int _face, int _i) const { return (m_faceMap[_face] >> (2*_i)) & 3; }
 
 public :
     //----------------------------------------------------------------------------------------------------------------------
@@ -90,6 +93,12 @@ public :
     //----------------------------------------------------------------------------------------------------------------------
     Tetrahedron* m_neighbours[4];
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief for each face, the position in the neighbour across it of each of our four vertices, packed two bits per
+    /// vertex. The vertex opposite the face maps to the neighbour's opposite vertex, so the flips never search for
+    /// vertices or back pointers
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned char m_faceMap[4];
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief is true if the tetrahedron is flipped or modified
     //----------------------------------------------------------------------------------------------------------------------
     bool m_modified;
@@ -100,71 +109,31 @@ public :
 
 private :
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief Pointer to the Vertex list
-    //----------------------------------------------------------------------------------------------------------------------
-    std::vector<ngl::Vec3> m_verts;
-        //----------------------------------------------------------------------------------------------------------------------
-    /// @brief Pointer to the Face list
-    //----------------------------------------------------------------------------------------------------------------------
-    std::vector<Face> m_face;
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief Center of the circumsphere
-    //----------------------------------------------------------------------------------------------------------------------
-    ngl::Vec3 m_circumcenter;
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief Radius of the circumsphere
-    //----------------------------------------------------------------------------------------------------------------------
-    ngl::Real m_circumradius;
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief Flag to indicate if a VBO has been created
+    /// @brief the four vertices, stored inline so a tetrahedron needs no extra allocation
     //----------------------------------------------------------------------------------------------------------------------
-    bool m_vao;
+    ngl::Vec3 m_verts[4];
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief A pointer to our VBO data
+    /// @brief the weights of the vertices, the squared radii of the spheres they stand for
     //----------------------------------------------------------------------------------------------------------------------
-    GLuint m_vboBuffers;
+    ngl::Real m_weights[4];
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief id for our vertexArray object
+    /// @brief Center of the circumsphere, valid once m_sphereCached is set
     //----------------------------------------------------------------------------------------------------------------------
-    ngl::VertexArrayObject *m_vaoTetrahedron;
+    mutable ngl::Vec3 m_circumcenter;
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief Size of the vbo data
+    /// @brief Radius of the circumsphere, valid once m_sphereCached is set
     //----------------------------------------------------------------------------------------------------------------------
-    unsigned int m_tetrahedronSize;
+    mutable ngl::Real m_circumradius;
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief Colour of the tetrahedron
+    /// @brief true once the circumsphere has been computed
     //----------------------------------------------------------------------------------------------------------------------
-    ngl::Colour m_tetraColour;
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief stores value needed for calculating the center and radius
-    //----------------------------------------------------------------------------------------------------------------------
-    ngl::Vec3 m_formulaN;
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief stores value needed for calculating the center and radius
-    //----------------------------------------------------------------------------------------------------------------------
-    ngl::Real m_formulaD;
+    mutable bool m_sphereCached;
 
 private:
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that sets the faces according to the vertex index
-    //----------------------------------------------------------------------------------------------------------------------
-    void createFaces();
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief method that randomly sets the colour of the tetrahedron
-    //----------------------------------------------------------------------------------------------------------------------
-    void setColour();
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief method that calculates the circumcenter of the tetrahedron
-    //----------------------------------------------------------------------------------------------------------------------
-    void findCenter();
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that calculates the radius of the circumsphere
-    //----------------------------------------------------------------------------------------------------------------------
-    void findRadius();
-    //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that calculates the formula required to find the circumcenter and radius
+    /// @brief function that calculates the circumcenter and the radius of the circumsphere
     //----------------------------------------------------------------------------------------------------------------------
-    void calculateFormula();
+    void findSphere() const;
 };
 
 #endif // TETRAHEDRON_H
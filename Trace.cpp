@@ -0,0 +1,158 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Trace.cpp
+/// @brief Recording and writing of the timeline zones, empty unless DELAUNAY_TRACE is defined
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Trace.h"
+
+#ifdef DELAUNAY_TRACE
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+
+// Every thread appends to its own buffer, so recording a zone takes no lock. The buffers are registered once per
+// thread and kept until exit, when they are written out together
+
+namespace
+{
+
+struct TraceEvent
+{
+    const char *m_name;
+    long long m_start;
+    // a counter has no duration, -1, and its value
+    long long m_duration;
+    double m_value;
+};
+
+struct TraceThread
+{
+    long m_tid;
+    std::string m_name;
+    std::vector<TraceEvent> m_events;
+};
+
+pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+std::vector<TraceThread*> s_threads;
+__thread TraceThread *s_current = NULL;
+
+long long nowMicroseconds()
+{
+    timeval tv;
+    gettimeofday(&tv,NULL);
+    return tv.tv_sec*1000000LL + tv.tv_usec;
+}
+
+TraceThread* currentThread()
+{
+    if(s_current == NULL)
+    {
+        s_current = new TraceThread;
+        s_current->m_tid = syscall(SYS_gettid);
+        s_current->m_events.reserve(4096);
+        pthread_mutex_lock(&s_lock);
+        s_threads.push_back(s_current);
+        pthread_mutex_unlock(&s_lock);
+    }
+    return s_current;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief writes the timeline when the program exits, it is defined after s_threads so it is destroyed first
+//----------------------------------------------------------------------------------------------------------------------
+struct TraceWriter
+{
+    ~TraceWriter()
+    {
+        const char *filename = getenv("DELAUNAY_TRACE_FILE");
+        filename = filename != NULL ? filename : "delaunay_trace.json";
+        if(Trace::write(filename))
+        {
+            fprintf(stderr,"trace written to %s\n",filename);
+        }
+    }
+} s_writer;
+
+} // end anonymous namespace
+
+TraceZone::TraceZone(const char *_name)
+{
+    m_name = _name;
+    m_start = nowMicroseconds();
+}
+
+TraceZone::TraceZone(const char *_name, bool _record)
+{
+    m_name = _record ? _name : NULL;
+    m_start = _record ? nowMicroseconds() : 0;
+}
+
+TraceZone::~TraceZone()
+{
+    if(m_name != NULL)
+    {
+        TraceEvent event = { m_name, m_start, nowMicroseconds()-m_start, 0.0 };
+        currentThread()->m_events.push_back(event);
+    }
+}
+
+void Trace::setThreadName(const char *_name)
+{
+    currentThread()->m_name = _name;
+}
+
+void Trace::counter(const char *_name, double _value)
+{
+    TraceEvent event = { _name, nowMicroseconds(), -1, _value };
+    currentThread()->m_events.push_back(event);
+}
+
+bool Trace::write(const char *_filename)
+{
+    FILE *out = fopen(_filename,"w");
+    if(out == NULL)
+    {
+        return false;
+    }
+    long pid = getpid();
+    bool first = true;
+    fprintf(out,"{\"traceEvents\":[");
+    pthread_mutex_lock(&s_lock);
+    for(unsigned int t=0; t<s_threads.size(); ++t)
+    {
+        const TraceThread &thread = *s_threads[t];
+        if(!thread.m_name.empty())
+        {
+            fprintf(out,"%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%ld,\"tid\":%ld,\"args\":{\"name\":\"%s\"}}",
+                    first ? "" : ",",pid,thread.m_tid,thread.m_name.c_str());
+            first = false;
+        }
+        for(unsigned int i=0; i<thread.m_events.size(); ++i)
+        {
+            const TraceEvent &e = thread.m_events[i];
+            if(e.m_duration < 0)
+            {
+                fprintf(out,"%s\n{\"name\":\"%s\",\"cat\":\"mesh\",\"ph\":\"C\",\"ts\":%lld,\"pid\":%ld,\"tid\":%ld,"
+                        "\"args\":{\"value\":%.17g}}",first ? "" : ",",e.m_name,e.m_start,pid,thread.m_tid,e.m_value);
+            }
+            else
+            {
+                fprintf(out,"%s\n{\"name\":\"%s\",\"cat\":\"mesh\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":%ld,\"tid\":%ld}",
+                        first ? "" : ",",e.m_name,e.m_start,e.m_duration,pid,thread.m_tid);
+            }
+            first = false;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    fprintf(out,"\n],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(out);
+    return true;
+}
+
+#endif // DELAUNAY_TRACE
@@ -0,0 +1,93 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Trace.h
+/// @author Maria Vineeta Bagya Seelan
+/// @version 1.1
+/// @date 16/08/13
+/// Revision History :
+/// Initial Version 16/08/13
+/// 1.1 sampled zones and counters for the work done once per point
+/// @brief scoped timeline zones of the meshing pipeline. They are compiled out unless DELAUNAY_TRACE is defined, then
+/// @brief every zone is recorded with its thread and the timeline is written at exit as a Chrome trace-event JSON
+/// @brief (chrome://tracing or ui.perfetto.dev) to $DELAUNAY_TRACE_FILE, or delaunay_trace.json by default. Work done
+/// @brief once per point would flood the timeline, its zones and counters are sampled once every so many calls
+//----------------------------------------------------------------------------------------------------------------------
+
+#ifdef DELAUNAY_TRACE
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class TraceZone
+/// @brief records the time from its construction to its destruction as one event of the calling thread
+//----------------------------------------------------------------------------------------------------------------------
+class TraceZone
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief starts the zone
+    /// @param [in] _name the name shown on the timeline, it must be a string literal as only the pointer is kept
+    //----------------------------------------------------------------------------------------------------------------------
+    TraceZone(const char *_name);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief starts a zone that is only recorded when _record is true
+    /// @param [in] _name the name shown on the timeline, a string literal
+    /// @param [in] _record false to skip the zone
+    //----------------------------------------------------------------------------------------------------------------------
+    TraceZone(const char *_name, bool _record);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief ends the zone and records it
+    //----------------------------------------------------------------------------------------------------------------------
+    ~TraceZone();
+
+private:
+    const char *m_name;
+    long long m_start;
+
+    TraceZone(const TraceZone &);
+    TraceZone& operator=(const TraceZone &);
+};
+
+namespace Trace
+{
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief names the calling thread on the timeline
+    /// @param [in] _name the name of the thread
+    //----------------------------------------------------------------------------------------------------------------------
+    void setThreadName(const char *_name);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief records the value of a counter of the calling thread, drawn as a graph under the timeline
+    /// @param [in] _name the name of the counter, a string literal
+    /// @param [in] _value its value from now on
+    //----------------------------------------------------------------------------------------------------------------------
+    void counter(const char *_name, double _value);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief writes the zones recorded so far, the other threads must not be recording while it runs
+    /// @param [in] _filename the JSON file
+    /// @param [out] returns false if the file can't be written
+    //----------------------------------------------------------------------------------------------------------------------
+    bool write(const char *_filename);
+}
+
+#define TRACE_CONCAT_INNER(_a,_b) _a##_b
+#define TRACE_CONCAT(_a,_b) TRACE_CONCAT_INNER(_a,_b)
+#define TRACE_ZONE(_name) TraceZone TRACE_CONCAT(traceZone,__LINE__)(_name)
+#define TRACE_THREAD_NAME(_name) Trace::setThreadName(_name)
+// the count of calls is kept per thread and per place in the code, so the sampling needs no lock
+#define TRACE_ZONE_SAMPLED(_name,_every) \
+    static __thread unsigned int TRACE_CONCAT(traceCalls,__LINE__) = 0; \
+    TraceZone TRACE_CONCAT(traceZone,__LINE__)(_name,TRACE_CONCAT(traceCalls,__LINE__)++%(_every) == 0)
+#define TRACE_COUNTER_SAMPLED(_name,_value,_every) \
+    do { static __thread unsigned int traceCalls = 0; \
+         if(traceCalls++%(_every) == 0) { Trace::counter(_name,(double)(_value)); } } while(0)
+
+#else
+
+#define TRACE_ZONE(_name)
+#define TRACE_THREAD_NAME(_name)
+#define TRACE_ZONE_SAMPLED(_name,_every)
+#define TRACE_COUNTER_SAMPLED(_name,_value,_every)
+
+#endif // DELAUNAY_TRACE
+
+#endif // TRACE_H
@@ -0,0 +1,738 @@
+//----------------------------------------------------------------------------------------------------------------------
+/// @file TriangleBVH.cpp
+/// @brief Class that indexes the triangles of a mesh in a bounding volume hierarchy
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "TriangleBVH.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
+
+// The tree is built top down with an explicit stack. A node owns a contiguous run of the triangle order, splitting it
+// reorders the run so the leaves need no lists of their own. The centres of a node are dropped into a few bins along
+// each axis and the split between two bins with the lowest surface area heuristic, the areas of the two sides times
+// their triangle counts, is taken, so large and small triangles end up apart and a ray visits few leaves. Below a
+// fixed depth the split falls back to the median, which keeps the depth bounded for the fixed traversal stacks.
+// Every node also keeps the far field of its triangles for the winding number, after Barill et al., Fast Winding
+// Numbers for Soups and Clouds: seen from further than a few times its radius, a node's solid angle is that of one
+// dipole, the sum of the area weighted normals of its triangles at their centre
+
+namespace
+{
+
+// the most triangles a leaf holds
+const unsigned int s_leafSize = 4;
+// the number of bins the centres of a node are sorted into along each axis
+const int s_bins = 12;
+// past this depth nodes are split at the median, the depth then grows by at most 32 more levels
+const unsigned int s_sahDepth = 32;
+// room for the depth of the tree
+const unsigned int s_stackSize = 128;
+// a node further from the point than this many times its radius is taken as a dipole by the winding number
+const double s_farRatio = 2.0;
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a triangle while the tree is built, its bounds and centre travel with it so a node's triangles stay together
+/// in memory as they are reordered
+//----------------------------------------------------------------------------------------------------------------------
+struct BuildTriangle
+{
+    ngl::Vec3 m_min;
+    ngl::Vec3 m_max;
+    ngl::Vec3 m_centre;
+    unsigned int m_index;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief orders triangles by the coordinate of their centres along one axis
+//----------------------------------------------------------------------------------------------------------------------
+struct CentreOrder
+{
+    int m_axis;
+
+    bool operator()(const BuildTriangle &_a, const BuildTriangle &_b) const
+    {
+        return _a.m_centre[m_axis] < _b.m_centre[m_axis];
+    }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief tells whether a triangle's centre falls in a bin before the split
+//----------------------------------------------------------------------------------------------------------------------
+struct BinSide
+{
+    int m_axis;
+    ngl::Real m_min;
+    ngl::Real m_scale;
+    int m_split;
+
+    int bin(const BuildTriangle &_t) const
+    {
+        int b = (int)((_t.m_centre[m_axis]-m_min)*m_scale);
+        return std::min(std::max(b,0),s_bins-1);
+    }
+
+    bool operator()(const BuildTriangle &_t) const
+    {
+        return bin(_t) < m_split;
+    }
+};
+
+void growBounds(ngl::Vec3 &io_min, ngl::Vec3 &io_max, const ngl::Vec3 &_p)
+{
+    for(int k=0; k<3; ++k)
+    {
+        io_min[k] = std::min(io_min[k],_p[k]);
+        io_max[k] = std::max(io_max[k],_p[k]);
+    }
+}
+
+ngl::Real halfArea(const ngl::Vec3 &_min, const ngl::Vec3 &_max)
+{
+    ngl::Vec3 d = _max-_min;
+    return d.m_x*d.m_y+d.m_y*d.m_z+d.m_z*d.m_x;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief finds the binned split of a node with the lowest surface area heuristic
+/// @param [in] _triangles the triangles of the node
+/// @param [in] _count the number of them
+/// @param [in] _minC the minimum corner of the centres
+/// @param [in] _maxC the maximum corner of the centres
+/// @param [out] o_side receives the axis, bins and split of the best split
+/// @param [out] returns false if no split puts triangles on both sides
+//----------------------------------------------------------------------------------------------------------------------
+bool findSplit(const BuildTriangle *_triangles, unsigned int _count, const ngl::Vec3 &_minC, const ngl::Vec3 &_maxC,
+               BinSide &o_side)
+{
+    ngl::Real bestCost = 0.0;
+    bool found = false;
+    BinSide side;
+    for(int axis=0; axis<3; ++axis)
+    {
+        ngl::Real extent = _maxC[axis]-_minC[axis];
+        if(extent <= 0.0)
+        {
+            continue;
+        }
+        side.m_axis = axis;
+        side.m_min = _minC[axis];
+        side.m_scale = s_bins/extent;
+        unsigned int counts[s_bins] = { 0 };
+        ngl::Vec3 minB[s_bins];
+        ngl::Vec3 maxB[s_bins];
+        for(unsigned int i=0; i<_count; ++i)
+        {
+            const BuildTriangle &t = _triangles[i];
+            int b = side.bin(t);
+            if(counts[b]++ == 0)
+            {
+                minB[b] = t.m_min;
+                maxB[b] = t.m_max;
+            }
+            else
+            {
+                growBounds(minB[b],maxB[b],t.m_min);
+                growBounds(minB[b],maxB[b],t.m_max);
+            }
+        }
+        // the costs of the left sides are swept forwards, then the right sides backwards against them
+        ngl::Real leftCost[s_bins];
+        unsigned int left = 0;
+        ngl::Vec3 minL, maxL;
+        for(int b=0; b<s_bins-1; ++b)
+        {
+            if(counts[b] > 0)
+            {
+                if(left == 0)
+                {
+                    minL = minB[b];
+                    maxL = maxB[b];
+                }
+                else
+                {
+                    growBounds(minL,maxL,minB[b]);
+                    growBounds(minL,maxL,maxB[b]);
+                }
+                left += counts[b];
+            }
+            leftCost[b] = left > 0 ? left*halfArea(minL,maxL) : 0.0;
+        }
+        unsigned int right = 0;
+        ngl::Vec3 minR, maxR;
+        for(int b=s_bins-1; b>0; --b)
+        {
+            if(counts[b] > 0)
+            {
+                if(right == 0)
+                {
+                    minR = minB[b];
+                    maxR = maxB[b];
+                }
+                else
+                {
+                    growBounds(minR,maxR,minB[b]);
+                    growBounds(minR,maxR,maxB[b]);
+                }
+                right += counts[b];
+            }
+            if(right == 0 || right == _count)
+            {
+                continue;
+            }
+            ngl::Real cost = leftCost[b-1]+right*halfArea(minR,maxR);
+            if(!found || cost < bestCost)
+            {
+                found = true;
+                bestCost = cost;
+                side.m_split = b;
+                o_side = side;
+            }
+        }
+    }
+    return found;
+}
+
+bool overlaps(const BVHNode &_node, const ngl::Vec3 &_min, const ngl::Vec3 &_max)
+{
+    for(int k=0; k<3; ++k)
+    {
+        if(_node.m_min[k] > _max[k] || _node.m_max[k] < _min[k])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the three vertices of entry i of the packed triangles, relative to a point
+//----------------------------------------------------------------------------------------------------------------------
+void packedCorners(const ngl::Real *_packed, unsigned int _n, unsigned int _i, const ngl::Vec3 &_p, double o_a[3],
+                   double o_b[3], double o_c[3])
+{
+    for(int k=0; k<3; ++k)
+    {
+        double v0 = _packed[k*_n+_i];
+        o_a[k] = v0-_p[k];
+        o_b[k] = v0+_packed[(3+k)*_n+_i]-_p[k];
+        o_c[k] = v0+_packed[(6+k)*_n+_i]-_p[k];
+    }
+}
+
+double dot(const double *_a, const double *_b)
+{
+    return _a[0]*_b[0]+_a[1]*_b[1]+_a[2]*_b[2];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the squared distance from the origin to the triangle a b c, by the regions of Ericson's closest point test
+//----------------------------------------------------------------------------------------------------------------------
+double squaredTriangleDistance(const double *_a, const double *_b, const double *_c)
+{
+    double ab[3], ac[3];
+    for(int k=0; k<3; ++k)
+    {
+        ab[k] = _b[k]-_a[k];
+        ac[k] = _c[k]-_a[k];
+    }
+    double d1 = -dot(ab,_a), d2 = -dot(ac,_a);
+    if(d1 <= 0.0 && d2 <= 0.0)
+    {
+        return dot(_a,_a);
+    }
+    double d3 = -dot(ab,_b), d4 = -dot(ac,_b);
+    if(d3 >= 0.0 && d4 <= d3)
+    {
+        return dot(_b,_b);
+    }
+    double d5 = -dot(ab,_c), d6 = -dot(ac,_c);
+    if(d6 >= 0.0 && d5 <= d6)
+    {
+        return dot(_c,_c);
+    }
+    double s = 0.0, t = 0.0;
+    double vc = d1*d4 - d3*d2;
+    double vb = d5*d2 - d1*d6;
+    double va = d3*d6 - d5*d4;
+    if(vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0)
+    {
+        s = d1/(d1-d3);
+    }
+    else if(vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0)
+    {
+        t = d2/(d2-d6);
+    }
+    else if(va <= 0.0 && d4-d3 >= 0.0 && d5-d6 >= 0.0)
+    {
+        s = (d4-d3)/((d4-d3)+(d5-d6));
+        t = 1.0-s;
+    }
+    else
+    {
+        double denominator = 1.0/(va+vb+vc);
+        s = vb*denominator;
+        t = vc*denominator;
+    }
+    double q[3];
+    for(int k=0; k<3; ++k)
+    {
+        q[k] = _a[k] + s*ab[k] + t*ac[k];
+    }
+    return dot(q,q);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the signed solid angle of the triangle a b c seen from the origin, by Van Oosterom and Strackee
+//----------------------------------------------------------------------------------------------------------------------
+double solidAngle(const double *_a, const double *_b, const double *_c)
+{
+    double la = std::sqrt(dot(_a,_a)), lb = std::sqrt(dot(_b,_b)), lc = std::sqrt(dot(_c,_c));
+    double bc[3] = { _b[1]*_c[2]-_b[2]*_c[1], _b[2]*_c[0]-_b[0]*_c[2], _b[0]*_c[1]-_b[1]*_c[0] };
+    double denominator = la*lb*lc + dot(_a,_b)*lc + dot(_b,_c)*la + dot(_c,_a)*lb;
+    return 2.0*std::atan2(dot(_a,bc),denominator);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the squared distance from a point to the box of a node, 0 inside it
+//----------------------------------------------------------------------------------------------------------------------
+double squaredBoxDistance(const BVHNode &_node, const ngl::Vec3 &_p)
+{
+    double distance = 0.0;
+    for(int k=0; k<3; ++k)
+    {
+        double d = std::max(std::max((double)_node.m_min[k]-_p[k],(double)_p[k]-_node.m_max[k]),0.0);
+        distance += d*d;
+    }
+    return distance;
+}
+
+} // end anonymous namespace
+
+TriangleBVH::TriangleBVH()
+{
+}
+
+void TriangleBVH::build(const std::vector<ngl::Vec3> &_vertTri)
+{
+    TRACE_ZONE("TriangleBVH::build");
+    unsigned int triangles = _vertTri.size()/3;
+    m_nodes.clear();
+    m_dipoles.clear();
+    m_packed.clear();
+    m_rayPad = 0.0;
+    m_triangles.resize(triangles);
+    if(triangles == 0)
+    {
+        return;
+    }
+    std::vector<BuildTriangle> order(triangles);
+    for(unsigned int t=0; t<triangles; ++t)
+    {
+        BuildTriangle &b = order[t];
+        b.m_index = t;
+        b.m_centre = (_vertTri[3*t]+_vertTri[3*t+1]+_vertTri[3*t+2])/3.0;
+        b.m_min = _vertTri[3*t];
+        b.m_max = _vertTri[3*t];
+        growBounds(b.m_min,b.m_max,_vertTri[3*t+1]);
+        growBounds(b.m_min,b.m_max,_vertTri[3*t+2]);
+    }
+    m_nodes.reserve(2*(triangles/s_leafSize+1));
+
+    BVHNode root;
+    root.m_first = 0;
+    root.m_count = triangles;
+    m_nodes.push_back(root);
+    // the nodes still to split with their depths
+    std::vector<std::pair<unsigned int,unsigned int> > stack(1,std::make_pair(0u,0u));
+    CentreOrder median;
+    BinSide side;
+    while(!stack.empty())
+    {
+        unsigned int n = stack.back().first;
+        unsigned int depth = stack.back().second;
+        stack.pop_back();
+        unsigned int first = m_nodes[n].m_first;
+        unsigned int count = m_nodes[n].m_count;
+
+        ngl::Vec3 minB = order[first].m_min;
+        ngl::Vec3 maxB = order[first].m_max;
+        ngl::Vec3 minC = order[first].m_centre;
+        ngl::Vec3 maxC = minC;
+        for(unsigned int i=first+1; i<first+count; ++i)
+        {
+            growBounds(minB,maxB,order[i].m_min);
+            growBounds(minB,maxB,order[i].m_max);
+            growBounds(minC,maxC,order[i].m_centre);
+        }
+        m_nodes[n].m_min = minB;
+        m_nodes[n].m_max = maxB;
+
+        ngl::Vec3 extent = maxC-minC;
+        median.m_axis = 0;
+        if(extent.m_y > extent[median.m_axis]) { median.m_axis = 1; }
+        if(extent.m_z > extent[median.m_axis]) { median.m_axis = 2; }
+        // triangles with the same centre can't be told apart by a split, they stay in one leaf
+        if(count <= s_leafSize || extent[median.m_axis] <= 0.0)
+        {
+            continue;
+        }
+        unsigned int half = 0;
+        if(depth < s_sahDepth && findSplit(&order[first],count,minC,maxC,side))
+        {
+            half = std::partition(order.begin()+first,order.begin()+first+count,side)-(order.begin()+first);
+        }
+        if(half == 0 || half == count)
+        {
+            half = count/2;
+            std::nth_element(order.begin()+first,order.begin()+first+half,order.begin()+first+count,median);
+        }
+
+        BVHNode child;
+        child.m_first = first;
+        child.m_count = half;
+        unsigned int left = m_nodes.size();
+        m_nodes.push_back(child);
+        child.m_first = first+half;
+        child.m_count = count-half;
+        m_nodes.push_back(child);
+        m_nodes[n].m_first = left;
+        m_nodes[n].m_count = 0;
+        stack.push_back(std::make_pair(left+1,depth+1));
+        stack.push_back(std::make_pair(left,depth+1));
+    }
+
+    m_packed.resize(9*triangles);
+    for(unsigned int i=0; i<triangles; ++i)
+    {
+        unsigned int t = order[i].m_index;
+        m_triangles[i] = t;
+        ngl::Vec3 v0 = _vertTri[3*t];
+        ngl::Vec3 edge1 = _vertTri[3*t+1]-v0;
+        ngl::Vec3 edge2 = _vertTri[3*t+2]-v0;
+        for(int k=0; k<3; ++k)
+        {
+            m_packed[k*triangles+i] = v0[k];
+            m_packed[(3+k)*triangles+i] = edge1[k];
+            m_packed[(6+k)*triangles+i] = edge2[k];
+        }
+        // the coordinates may be 0.001 past each edge, a hit is then a few thousandths of the edges outside
+        m_rayPad = std::max(m_rayPad,(ngl::Real)(0.01*(edge1.length()+edge2.length())));
+    }
+
+    // the far fields bottom up, a child is always after its parent. The centres are weighted by area, a node whose
+    // triangles have no area takes the plain mean of their centroids
+    m_dipoles.resize(m_nodes.size());
+    std::vector<double> areas(m_nodes.size());
+    for(unsigned int n=m_nodes.size(); n-- > 0;)
+    {
+        const BVHNode &node = m_nodes[n];
+        BVHDipole &dipole = m_dipoles[n];
+        double centre[3] = { 0.0, 0.0, 0.0 };
+        double mean[3] = { 0.0, 0.0, 0.0 };
+        double normal[3] = { 0.0, 0.0, 0.0 };
+        double area = 0.0;
+        unsigned int parts = node.m_count > 0 ? node.m_count : 2;
+        for(unsigned int j=0; j<parts; ++j)
+        {
+            double partCentre[3];
+            double partNormal[3];
+            double partArea;
+            if(node.m_count > 0)
+            {
+                unsigned int i = node.m_first+j;
+                double a[3], b[3], c[3];
+                packedCorners(&m_packed[0],triangles,i,ngl::Vec3(0.0,0.0,0.0),a,b,c);
+                double e1[3] = { b[0]-a[0], b[1]-a[1], b[2]-a[2] };
+                double e2[3] = { c[0]-a[0], c[1]-a[1], c[2]-a[2] };
+                partNormal[0] = 0.5*(e1[1]*e2[2]-e1[2]*e2[1]);
+                partNormal[1] = 0.5*(e1[2]*e2[0]-e1[0]*e2[2]);
+                partNormal[2] = 0.5*(e1[0]*e2[1]-e1[1]*e2[0]);
+                partArea = std::sqrt(dot(partNormal,partNormal));
+                for(int k=0; k<3; ++k)
+                {
+                    partCentre[k] = (a[k]+b[k]+c[k])/3.0;
+                }
+            }
+            else
+            {
+                unsigned int child = node.m_first+j;
+                for(int k=0; k<3; ++k)
+                {
+                    partCentre[k] = m_dipoles[child].m_centre[k];
+                    partNormal[k] = m_dipoles[child].m_normal[k];
+                }
+                partArea = areas[child];
+            }
+            for(int k=0; k<3; ++k)
+            {
+                centre[k] += partArea*partCentre[k];
+                mean[k] += partCentre[k]/parts;
+                normal[k] += partNormal[k];
+            }
+            area += partArea;
+        }
+        double radius = 0.0;
+        for(int k=0; k<3; ++k)
+        {
+            centre[k] = area > 0.0 ? centre[k]/area : mean[k];
+            double d = std::max(centre[k]-node.m_min[k],node.m_max[k]-centre[k]);
+            radius += d*d;
+        }
+        areas[n] = area;
+        dipole.m_centre = ngl::Vec3(centre[0],centre[1],centre[2]);
+        dipole.m_normal = ngl::Vec3(normal[0],normal[1],normal[2]);
+        dipole.m_radius = std::sqrt(radius);
+    }
+}
+
+void TriangleBVH::query(const ngl::Vec3 &_min, const ngl::Vec3 &_max, std::vector<unsigned int> &o_triangles) const
+{
+    o_triangles.clear();
+    if(m_nodes.empty())
+    {
+        return;
+    }
+    // the build bounds the depth, a fixed stack is plenty
+    unsigned int stack[s_stackSize];
+    unsigned int top = 0;
+    stack[top++] = 0;
+    while(top > 0)
+    {
+        const BVHNode &node = m_nodes[stack[--top]];
+        if(!overlaps(node,_min,_max))
+        {
+            continue;
+        }
+        if(node.m_count > 0)
+        {
+            o_triangles.insert(o_triangles.end(),m_triangles.begin()+node.m_first,
+                               m_triangles.begin()+node.m_first+node.m_count);
+        }
+        else
+        {
+            stack[top++] = node.m_first+1;
+            stack[top++] = node.m_first;
+        }
+    }
+}
+
+void TriangleBVH::intersect(const ngl::Vec3 &_start, const ngl::Vec3 &_end, std::vector<unsigned int> &o_triangles) const
+{
+    o_triangles.clear();
+    if(m_nodes.empty())
+    {
+        return;
+    }
+    ngl::Vec3 dir = _start-_end;
+    // the slabs are crossed along _end-_start, an axis the ray does not move along only checks the start is inside
+    ngl::Real inverse[3];
+    for(int k=0; k<3; ++k)
+    {
+        inverse[k] = dir[k] != 0.0 ? -1.0/dir[k] : 0.0;
+    }
+    unsigned int n = m_triangles.size();
+    const ngl::Real *v0x = &m_packed[0], *v0y = v0x+n, *v0z = v0y+n;
+    const ngl::Real *e1x = v0z+n, *e1y = e1x+n, *e1z = e1y+n;
+    const ngl::Real *e2x = e1z+n, *e2y = e2x+n, *e2z = e2y+n;
+
+    unsigned int stack[s_stackSize];
+    unsigned int top = 0;
+    stack[top++] = 0;
+    while(top > 0)
+    {
+        const BVHNode &node = m_nodes[stack[--top]];
+        ngl::Real enter = 0.0;
+        ngl::Real leave = 0.0;
+        bool miss = false;
+        bool bounded = false;
+        for(int k=0; k<3 && !miss; ++k)
+        {
+            ngl::Real lo = node.m_min[k]-m_rayPad;
+            ngl::Real hi = node.m_max[k]+m_rayPad;
+            if(dir[k] == 0.0)
+            {
+                miss = _start[k] < lo || _start[k] > hi;
+                continue;
+            }
+            ngl::Real t0 = (lo-_start[k])*inverse[k];
+            ngl::Real t1 = (hi-_start[k])*inverse[k];
+            if(t0 > t1)
+            {
+                std::swap(t0,t1);
+            }
+            enter = std::max(enter,t0);
+            leave = bounded ? std::min(leave,t1) : t1;
+            bounded = true;
+            miss = enter > leave;
+        }
+        if(miss)
+        {
+            continue;
+        }
+        if(node.m_count == 0)
+        {
+            stack[top++] = node.m_first+1;
+            stack[top++] = node.m_first;
+            continue;
+        }
+        // the triangles of a leaf are tested s_leafSize at a time with no branches, the same arithmetic as rayHit. A
+        // leaf whose triangles share their centre cannot be split and may hold more than s_leafSize of them
+        bool hit[s_leafSize];
+        unsigned int end = node.m_first+node.m_count;
+        for(unsigned int first=node.m_first; first<end; first+=s_leafSize)
+        {
+            unsigned int count = std::min(s_leafSize,end-first);
+            for(unsigned int j=0; j<count; ++j)
+            {
+                unsigned int i = first+j;
+                ngl::Real px = dir.m_y*e2z[i] - dir.m_z*e2y[i];
+                ngl::Real py = dir.m_z*e2x[i] - dir.m_x*e2z[i];
+                ngl::Real pz = dir.m_x*e2y[i] - dir.m_y*e2x[i];
+                ngl::Real det = e1x[i]*px + e1y[i]*py + e1z[i]*pz;
+                ngl::Real invDet = 1.0f / det;
+                ngl::Real tx = _start.m_x-v0x[i];
+                ngl::Real ty = _start.m_y-v0y[i];
+                ngl::Real tz = _start.m_z-v0z[i];
+                ngl::Real u = (tx*px + ty*py + tz*pz) * invDet;
+                ngl::Real qx = ty*e1z[i] - tz*e1y[i];
+                ngl::Real qy = tz*e1x[i] - tx*e1z[i];
+                ngl::Real qz = tx*e1y[i] - ty*e1x[i];
+                ngl::Real v = (dir.m_x*qx + dir.m_y*qy + dir.m_z*qz) * invDet;
+                ngl::Real w = (e2x[i]*qx + e2y[i]*qy + e2z[i]*qz) * invDet;
+                hit[j] = !(det > -0.00001f && det < 0.00001) & !(u < -0.001f || u > 1.001f) &
+                         !(v < -0.001f || u + v > 1.001f) & !(w >= 0);
+            }
+            for(unsigned int j=0; j<count; ++j)
+            {
+                if(hit[j])
+                {
+                    o_triangles.push_back(m_triangles[first+j]);
+                }
+            }
+        }
+    }
+    std::sort(o_triangles.begin(),o_triangles.end());
+}
+
+bool TriangleBVH::rayHit(const ngl::Vec3 &_v0, const ngl::Vec3 &_edge1, const ngl::Vec3 &_edge2,
+                         const ngl::Vec3 &_start, const ngl::Vec3 &_dir)
+{
+    ngl::Vec3 pvec = _dir.cross(_edge2);
+    ngl::Real det = _edge1.dot(pvec);
+    // if this is 0 no hit
+    if (det > -0.00001f && det < 0.00001)
+    {
+        return false;
+    }
+    ngl::Real invDet = 1.0f / det;
+    ngl::Vec3 tvec = _start - _v0;
+    ngl::Real u = tvec.dot(pvec) * invDet;
+    if (u < -0.001f || u > 1.001f)
+    {
+        return false;
+    }
+    ngl::Vec3 qvec = tvec.cross(_edge1);
+    ngl::Real v = _dir.dot(qvec) * invDet;
+    if (v < -0.001f || u + v > 1.001f)
+    {
+        return false;
+    }
+    // the distance along _dir, the triangle is in front of the ray when it is negative
+    return _edge2.dot(qvec) * invDet < 0;
+}
+
+double TriangleBVH::nearestDistance(const ngl::Vec3 &_p) const
+{
+    double best = HUGE_VAL;
+    if(m_nodes.empty())
+    {
+        return best;
+    }
+    unsigned int n = m_triangles.size();
+    unsigned int stack[s_stackSize];
+    unsigned int top = 0;
+    stack[top++] = 0;
+    while(top > 0)
+    {
+        const BVHNode &node = m_nodes[stack[--top]];
+        if(squaredBoxDistance(node,_p) >= best)
+        {
+            continue;
+        }
+        if(node.m_count > 0)
+        {
+            for(unsigned int i=node.m_first; i<node.m_first+node.m_count; ++i)
+            {
+                double a[3], b[3], c[3];
+                packedCorners(&m_packed[0],n,i,_p,a,b,c);
+                best = std::min(best,squaredTriangleDistance(a,b,c));
+            }
+            continue;
+        }
+        // the nearer child goes on top, so it is searched first and the further one is more often skipped
+        unsigned int near = node.m_first;
+        unsigned int far = node.m_first+1;
+        if(squaredBoxDistance(m_nodes[far],_p) < squaredBoxDistance(m_nodes[near],_p))
+        {
+            std::swap(near,far);
+        }
+        stack[top++] = far;
+        stack[top++] = near;
+    }
+    return std::sqrt(best);
+}
+
+double TriangleBVH::windingNumber(const ngl::Vec3 &_p) const
+{
+    double angle = 0.0;
+    if(m_nodes.empty())
+    {
+        return angle;
+    }
+    unsigned int n = m_triangles.size();
+    unsigned int stack[s_stackSize];
+    unsigned int top = 0;
+    stack[top++] = 0;
+    while(top > 0)
+    {
+        unsigned int index = stack[--top];
+        const BVHNode &node = m_nodes[index];
+        const BVHDipole &dipole = m_dipoles[index];
+        double r[3] = { dipole.m_centre.m_x-_p.m_x, dipole.m_centre.m_y-_p.m_y, dipole.m_centre.m_z-_p.m_z };
+        double distance = std::sqrt(dot(r,r));
+        if(distance > s_farRatio*dipole.m_radius)
+        {
+            double normal[3] = { dipole.m_normal.m_x, dipole.m_normal.m_y, dipole.m_normal.m_z };
+            angle += dot(r,normal)/(distance*distance*distance);
+        }
+        else if(node.m_count > 0)
+        {
+            for(unsigned int i=node.m_first; i<node.m_first+node.m_count; ++i)
+            {
+                double a[3], b[3], c[3];
+                packedCorners(&m_packed[0],n,i,_p,a,b,c);
+                angle += solidAngle(a,b,c);
+            }
+        }
+        else
+        {
+            stack[top++] = node.m_first+1;
+            stack[top++] = node.m_first;
+        }
+    }
+    return angle/(4.0*M_PI);
+}
+
+double TriangleBVH::triangleDistance(const ngl::Vec3 &_p, const ngl::Vec3 &_a, const ngl::Vec3 &_b,
+                                     const ngl::Vec3 &_c)
+{
+    double a[3], b[3], c[3];
+    for(int k=0; k<3; ++k)
+    {
+        a[k] = (double)_a[k]-_p[k];
+        b[k] = (double)_b[k]-_p[k];
+        c[k] = (double)_c[k]-_p[k];
+    }
+    return std::sqrt(squaredTriangleDistance(a,b,c));
+}
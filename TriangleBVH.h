@@ -0,0 +1,137 @@
+#ifndef TRIANGLEBVH_H
+#define TRIANGLEBVH_H
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file TriangleBVH.h
+/// @author Maria Vineeta Bagya Seelan
+/// @version 1.2
+/// @date 16/08/13
+/// Revision History :
+/// Initial Version 16/08/13
+/// 1.1 surface area heuristic splits and intersect for the triangles a ray crosses
+/// 1.2 nearestDistance, windingNumber and triangleDistance, the parts of a signed distance to the mesh
+/// @class TriangleBVH
+/// @brief bounding volume hierarchy over the triangles of a mesh, it finds the triangles near a box or along a ray
+/// @brief without testing every triangle of the mesh
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "ngl/Vec3.h"
+#include <vector>
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the far field of the triangles under a node for the winding number: the sum of their area weighted normals
+/// placed at their area weighted centre, and the radius of a ball about the centre that holds them
+//----------------------------------------------------------------------------------------------------------------------
+struct BVHDipole
+{
+    ngl::Vec3 m_centre;
+    ngl::Vec3 m_normal;
+    ngl::Real m_radius;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a node of the hierarchy, a leaf holds m_count triangles from m_first in the triangle order of the tree, an
+/// inner node has m_count 0 and its children at m_first and m_first+1
+//----------------------------------------------------------------------------------------------------------------------
+struct BVHNode
+{
+    ngl::Vec3 m_min;
+    ngl::Vec3 m_max;
+    unsigned int m_first;
+    unsigned int m_count;
+};
+
+class TriangleBVH
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief Constructor for an empty TriangleBVH
+    //----------------------------------------------------------------------------------------------------------------------
+    TriangleBVH();
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that builds the hierarchy, each node is split where the surface area heuristic over a few bins
+    /// of the triangle centres is lowest
+    /// @param [in] _vertTri three vertices per triangle, the index of a triangle is its position in here divided by 3
+    //----------------------------------------------------------------------------------------------------------------------
+    void build(const std::vector<ngl::Vec3> &_vertTri);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that finds the triangles whose bounds overlap a box
+    /// @param [in] _min the minimum corner of the box
+    /// @param [in] _max the maximum corner of the box
+    /// @param [out] o_triangles receives the triangle indices, it is cleared first
+    //----------------------------------------------------------------------------------------------------------------------
+    void query(const ngl::Vec3 &_min, const ngl::Vec3 &_max, std::vector<unsigned int> &o_triangles) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that finds the triangles crossed by the ray from _start through _end and beyond, with the
+    /// Moller-Trumbore test of rayHit
+    /// @param [in] _start the origin of the ray
+    /// @param [in] _end a second point on the ray
+    /// @param [out] o_triangles receives the triangle indices in increasing order, it is cleared first
+    //----------------------------------------------------------------------------------------------------------------------
+    void intersect(const ngl::Vec3 &_start, const ngl::Vec3 &_end, std::vector<unsigned int> &o_triangles) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that tests a ray against one triangle by Moller-Trumbore. The barycentric coordinates may be
+    /// 0.001 outside the triangle so a ray through an edge hits both sides, and a triangle almost parallel to the ray
+    /// is missed
+    /// @param [in] _v0 the first vertex of the triangle
+    /// @param [in] _edge1 the second vertex minus the first
+    /// @param [in] _edge2 the third vertex minus the first
+    /// @param [in] _start the origin of the ray
+    /// @param [in] _dir the origin minus a second point on the ray, the ray runs the other way
+    /// @param [out] returns true if the ray crosses the triangle in front of its origin
+    //----------------------------------------------------------------------------------------------------------------------
+    static bool rayHit(const ngl::Vec3 &_v0, const ngl::Vec3 &_edge1, const ngl::Vec3 &_edge2, const ngl::Vec3 &_start,
+                       const ngl::Vec3 &_dir);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that finds the distance from a point to the closest triangle, the nodes are visited nearest
+    /// first and skipped once their box is further than the closest triangle found so far
+    /// @param [in] _p the point
+    /// @param [out] returns the distance, infinite if there are no triangles
+    //----------------------------------------------------------------------------------------------------------------------
+    double nearestDistance(const ngl::Vec3 &_p) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that finds the generalized winding number of the mesh around a point, the solid angle of the
+    /// triangles seen from it over 4 pi. It is close to 1 inside a closed mesh whose normals face out, -1 if they face
+    /// in, and 0 outside. The triangles of a node far from the point are taken together as a dipole, so only the
+    /// triangles near the point are summed one by one
+    /// @param [in] _p the point
+    /// @param [out] returns the winding number
+    //----------------------------------------------------------------------------------------------------------------------
+    double windingNumber(const ngl::Vec3 &_p) const;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief function that finds the distance from a point to one triangle, in double precision
+    /// @param [in] _p the point
+    /// @param [in] _a, _b, _c the vertices of the triangle
+    /// @param [out] returns the distance
+    //----------------------------------------------------------------------------------------------------------------------
+    static double triangleDistance(const ngl::Vec3 &_p, const ngl::Vec3 &_a, const ngl::Vec3 &_b, const ngl::Vec3 &_c);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor that tells whether the hierarchy holds no triangles
+    //----------------------------------------------------------------------------------------------------------------------
+    bool empty() const { return m_triangles.empty(); }
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the nodes, the root is the first one
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<BVHNode> m_nodes;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the far field of every node for windingNumber, in the order of m_nodes
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<BVHDipole> m_dipoles;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the triangle indices in the order of the leaves
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<unsigned int> m_triangles;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores the first vertex and the two edges of every triangle in the order of the leaves, one array per
+    /// coordinate, so a leaf is tested by a loop the compiler can vectorize. Coordinate c of entry i is at c*n+i
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<ngl::Real> m_packed;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief stores how far the tolerance of rayHit reaches outside a triangle, the boxes are grown by it for rays
+    //----------------------------------------------------------------------------------------------------------------------
+    ngl::Real m_rayPad;
+};
+
+#endif // TRIANGLEBVH_H
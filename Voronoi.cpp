@@ -1,32 +1,304 @@
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Voronoi.cpp
-/// @brief Class that has all elements of a single voronoi cell
+/// @brief Class that has all elements of a single voronoi cell, TetMeshRenderer draws the edges
 //----------------------------------------------------------------------------------------------------------------------
 
 #include "include/Voronoi.h"
-#include "ngl/Random.h"
+#include "Parallel.h"
+#include "Trace.h"
+#include "AllocStats.h"
+#include <algorithm>
+
+// A cell is built from the tetrahedra around its site alone. Its faces are the Delaunay edges from the site, and the
+// vertices of a face are the circumcentres of the tetrahedra around that edge, in the order they are met turning
+// around it through the neighbours. The cells are independent, so they are built in parallel.
+// The edges are found per block of tetrahedra, each block counts its edges first so it knows where to write them and
+// the result does not depend on the number of threads
+
+namespace
+{
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the site of a tetrahedron that is none of the three given
+//----------------------------------------------------------------------------------------------------------------------
+unsigned int fourthSite(const TetTopology &_topology, unsigned int _tet, unsigned int _a, unsigned int _b, unsigned int _c)
+{
+    for(int i=0; i<4; ++i)
+    {
+        unsigned int s = _topology.tetSite(_tet,i);
+        if(s != _a && s != _b && s != _c)
+        {
+            return s;
+        }
+    }
+    return _a;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief turns around the edge _v _w from a tetrahedron, away from its site _a and towards its site _b, and
+/// collects the tetrahedra passed until the ring closes or the hull is reached
+/// @param [out] returns true if the ring closed
+//----------------------------------------------------------------------------------------------------------------------
+bool turnAroundEdge(const TetTopology &_topology, unsigned int _v, unsigned int _w, unsigned int _tet,
+                    unsigned int _a, unsigned int _b, unsigned int _limit, std::vector<unsigned int> *o_tets,
+                    unsigned int &o_last, unsigned int &o_lastA, unsigned int &o_lastB)
+{
+    unsigned int t = _tet;
+    for(unsigned int step=0; step<_limit; ++step)
+    {
+        if(o_tets != NULL)
+        {
+            o_tets->push_back(t);
+        }
+        o_last = t;
+        o_lastA = _a;
+        o_lastB = _b;
+        // the face opposite _a holds the edge and _b, the neighbour across it is the next one around the edge
+        int n = _topology.tetNeighbour(t,_topology.slotOf(t,_a));
+        if(n < 0)
+        {
+            return false;
+        }
+        if((unsigned int)n == _tet)
+        {
+            return true;
+        }
+        _a = _b;
+        _b = fourthSite(_topology,n,_v,_w,_a);
+        t = n;
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief builds the face dual to the Delaunay edge from _v to _w, starting from a tetrahedron on the edge
+//----------------------------------------------------------------------------------------------------------------------
+void buildFace(const TetTopology &_topology, unsigned int _v, unsigned int _w, unsigned int _tet, unsigned int _limit,
+               VFace &o_face)
+{
+    const std::vector<ngl::Vec3> &sites = _topology.getSites();
+    unsigned int a = _v;
+    unsigned int b = _v;
+    for(int i=0; i<4; ++i)
+    {
+        unsigned int s = _topology.tetSite(_tet,i);
+        if(s != _v && s != _w)
+        {
+            (a == _v ? a : b) = s;
+        }
+    }
+    // turning from a to b has to be counter clockwise about v->w, the face then faces away from v
+    const ngl::Vec3 &v = sites[_v];
+    double ex = sites[_w].m_x-v.m_x, ey = sites[_w].m_y-v.m_y, ez = sites[_w].m_z-v.m_z;
+    double ax = sites[a].m_x-v.m_x, ay = sites[a].m_y-v.m_y, az = sites[a].m_z-v.m_z;
+    double bx = sites[b].m_x-v.m_x, by = sites[b].m_y-v.m_y, bz = sites[b].m_z-v.m_z;
+    if(ex*(ay*bz-az*by) + ey*(az*bx-ax*bz) + ez*(ax*by-ay*bx) < 0)
+    {
+        std::swap(a,b);
+    }
+
+    // an open ring is walked from its end on the hull, so turn the other way first to find it
+    unsigned int start = _tet;
+    unsigned int last = _tet;
+    unsigned int lastA = a;
+    unsigned int lastB = b;
+    o_face.m_site = _w;
+    o_face.m_closed = turnAroundEdge(_topology,_v,_w,_tet,b,a,_limit,NULL,last,lastA,lastB);
+    if(!o_face.m_closed)
+    {
+        start = last;
+        a = lastB;
+        b = lastA;
+    }
+    o_face.m_vert.clear();
+    turnAroundEdge(_topology,_v,_w,start,a,b,_limit,&o_face.m_vert,last,lastA,lastB);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief builds the cell of a site
+//----------------------------------------------------------------------------------------------------------------------
+void buildCell(const TetTopology &_topology, unsigned int _site, VCell &o_cell)
+{
+    const std::vector<unsigned int> &star = _topology.getSiteTets();
+    unsigned int begin = _topology.siteTetsBegin(_site);
+    unsigned int end = _topology.siteTetsEnd(_site);
+    o_cell.m_vert.assign(star.begin()+begin,star.begin()+end);
+    o_cell.m_bounded = begin != end;
+
+    // every Delaunay edge from the site with a tetrahedron on it, the edges are found once per tetrahedron around them
+    std::vector< std::pair<unsigned int,unsigned int> > edges;
+    edges.reserve(3*(end-begin));
+    for(unsigned int k=begin; k<end; ++k)
+    {
+        for(int i=0; i<4; ++i)
+        {
+            unsigned int s = _topology.tetSite(star[k],i);
+            if(s != _site)
+            {
+                edges.push_back(std::make_pair(s,star[k]));
+            }
+        }
+    }
+    std::sort(edges.begin(),edges.end());
+
+    o_cell.m_faces.clear();
+    for(unsigned int e=0; e<edges.size(); ++e)
+    {
+        if(e > 0 && edges[e].first == edges[e-1].first)
+        {
+            continue;
+        }
+        o_cell.m_faces.push_back(VFace());
+        buildFace(_topology,_site,edges[e].first,edges[e].second,end-begin,o_cell.m_faces.back());
+        o_cell.m_bounded = o_cell.m_bounded && o_cell.m_faces.back().m_closed;
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief builds the cells of a range of sites
+//----------------------------------------------------------------------------------------------------------------------
+class CellTask : public ParallelTask
+{
+public:
+    CellTask(const TetTopology &_topology, std::vector<VCell> &o_cells) : m_topology(_topology), m_cells(o_cells) {}
+
+    void run(unsigned int _begin, unsigned int _end)
+    {
+        for(unsigned int s=_begin; s<_end; ++s)
+        {
+            buildCell(m_topology,s,m_cells[s]);
+        }
+    }
+
+private:
+    const TetTopology &m_topology;
+    std::vector<VCell> &m_cells;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief computes the circumcentres of a range of tetrahedra, each one is cached by the only thread that touches it
+//----------------------------------------------------------------------------------------------------------------------
+class CentreTask : public ParallelTask
+{
+public:
+    CentreTask(const std::vector<Tetrahedron*> &_tetrahedra, std::vector<ngl::Vec3> &o_vertices) :
+        m_tetrahedra(_tetrahedra), m_vertices(o_vertices) {}
+
+    void run(unsigned int _begin, unsigned int _end)
+    {
+        for(unsigned int t=_begin; t<_end; ++t)
+        {
+            m_vertices[t] = m_tetrahedra[t]->getCirCenter();
+        }
+    }
+
+private:
+    const std::vector<Tetrahedron*> &m_tetrahedra;
+    std::vector<ngl::Vec3> &m_vertices;
+};
+
+// the tetrahedra are split into blocks of this size to place the edges
+const unsigned int s_edgeBlock = 4096;
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the edges of the blocks in a range of tetrahedra, counted when m_edgeIndices is NULL and written to the
+/// offsets of their block otherwise
+//----------------------------------------------------------------------------------------------------------------------
+class EdgeTask : public ParallelTask
+{
+public:
+    EdgeTask(const TetTopology &_topology, std::vector<unsigned int> &_blockEdges,
+             std::vector<unsigned int> *o_edgeIndices) :
+        m_topology(_topology), m_blockEdges(_blockEdges), m_edgeIndices(o_edgeIndices) {}
+
+    void run(unsigned int _begin, unsigned int _end)
+    {
+        for(unsigned int block=_begin; block<_end; ++block)
+        {
+            unsigned int first = block*s_edgeBlock;
+            unsigned int last = std::min(first+s_edgeBlock,m_topology.tetCount());
+            unsigned int count = 0;
+            unsigned int *out = NULL;
+            if(m_edgeIndices != NULL && !m_edgeIndices->empty())
+            {
+                out = &(*m_edgeIndices)[0]+2*m_blockEdges[block];
+            }
+            for(unsigned int t=first; t<last; ++t)
+            {
+                for(int f=0; f<4; ++f)
+                {
+                    int n = m_topology.tetNeighbour(t,f);
+                    if(n > (int)t)
+                    {
+                        if(out != NULL)
+                        {
+                            out[2*count] = t;
+                            out[2*count+1] = n;
+                        }
+                        ++count;
+                    }
+                }
+            }
+            if(m_edgeIndices == NULL)
+            {
+                m_blockEdges[block] = count;
+            }
+        }
+    }
+
+private:
+    const TetTopology &m_topology;
+    std::vector<unsigned int> &m_blockEdges;
+    std::vector<unsigned int> *m_edgeIndices;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief expands a range of edges to their end points
+//----------------------------------------------------------------------------------------------------------------------
+class EdgePointTask : public ParallelTask
+{
+public:
+    EdgePointTask(const std::vector<ngl::Vec3> &_vertices, const std::vector<unsigned int> &_edgeIndices,
+                  std::vector<ngl::Vec3> &o_edges) :
+        m_vertices(_vertices), m_edgeIndices(_edgeIndices), m_edges(o_edges) {}
+
+    void run(unsigned int _begin, unsigned int _end)
+    {
+        for(unsigned int i=_begin; i<_end; ++i)
+        {
+            m_edges[i] = m_vertices[m_edgeIndices[i]];
+        }
+    }
+
+private:
+    const std::vector<ngl::Vec3> &m_vertices;
+    const std::vector<unsigned int> &m_edgeIndices;
+    std::vector<ngl::Vec3> &m_edges;
+};
+
+} // end anonymous namespace
 
 Voronoi::Voronoi()
 {
     m_vertices.clear();
     m_tetrahedra.clear();
-    m_faces.clear();
+    m_cells.clear();
 }
 
 Voronoi::Voronoi(std::vector<Tetrahedron*> _t)
 {
+    TRACE_ZONE("Voronoi::Voronoi");
+    ALLOC_PHASE(VORONOI);
     m_tetrahedra = _t;
     setCenter();
     setEdge();
-    createVAOLines();
 }
 
 void Voronoi::setCenter()
 {
-    for(unsigned int i=0; i<m_tetrahedra.size();++i)
-    {
-        m_vertices.push_back(m_tetrahedra[i]->getCirCenter());
-    }
+    m_vertices.resize(m_tetrahedra.size());
+    CentreTask centres(m_tetrahedra,m_vertices);
+    Parallel::forRange(m_tetrahedra.size(),1024,centres);
 }
 
 void Voronoi::setVertex(ngl::Vec3 _v)
@@ -37,59 +309,42 @@ void Voronoi::setVertex(ngl::Vec3 _v)
 
 void Voronoi::setEdge()
 {
-    for(unsigned int i=0; i<m_tetrahedra.size();++i)
+    // the neighbours outside the list are on the big tetrahedron and have no voronoi vertex
+    m_topology.buildNeighbours(m_tetrahedra);
+    unsigned int blocks = (m_tetrahedra.size()+s_edgeBlock-1)/s_edgeBlock;
+    std::vector<unsigned int> blockEdges(blocks+1,0);
+    EdgeTask count(m_topology,blockEdges,NULL);
+    Parallel::forRange(blocks,1,count);
+
+    unsigned int edges = 0;
+    for(unsigned int b=0; b<=blocks; ++b)
     {
-       m_tetrahedra[i]->m_modified = true;
-       for(int j=0;j<4;++j)
-       {
-          Tetrahedron *temp = m_tetrahedra[i]->m_neighbours[j];
-          if(temp!=NULL)
-          {
-            if(temp->m_modified!=true)
-            {
-                  m_edges.push_back(m_vertices[i]);
-                  m_edges.push_back(temp->getCirCenter());
-            }
-          }
-       }
+        unsigned int n = blockEdges[b];
+        blockEdges[b] = edges;
+        edges += n;
     }
-}
-
-
-void Voronoi::createVAOLines()
-{
-
-        // first we grab an instance of our VOA
-        m_vaoMesh= ngl::VertexArrayObject::createVOA(GL_LINES);
-        // next we bind it so it's active for setting data
-        m_vaoMesh->bind();
-        // now we have our data add it to the VAO, we need to tell the VAO the following
-        // how much (in bytes) data we are copying
-        // a pointer to the first element of data (in this case the address of the first element of the
-        // std::vector
-        m_vaoMesh->setData(m_edges.size()*sizeof(ngl::Vec3),m_edges[0].m_x);
-        // so we need to set the vertexAttributePointer so the correct size and type as follows
-        // vertex is attribute 0 with x,y,z(3) parts of type GL_FLOAT, our complete packed data is
-        // sizeof(vertData) and the offset into the data structure for the first x component is 0
-        m_vaoMesh->setVertexAttributePointer(0,3,GL_FLOAT,sizeof(ngl::Vec3),0);
-        // now we have set the vertex attributes we tell the VAO class how many indices to draw when
-        // glDrawArrays is called, in this case we use buffSize (but if we wished less of the sphere to be drawn we could
-        // specify less (in steps of 3))
-        m_vaoMesh->setNumIndices(m_edges.size());
-        // finally we have finished for now so time to unbind the VAO
-        m_vaoMesh->unbind();
-        // indicate we have a vao now
-        m_vao=true;
+    m_edgeIndices.resize(2*edges);
+    EdgeTask write(m_topology,blockEdges,&m_edgeIndices);
+    Parallel::forRange(blocks,1,write);
 
+    m_edges.resize(m_edgeIndices.size());
+    EdgePointTask points(m_vertices,m_edgeIndices,m_edges);
+    Parallel::forRange(m_edges.size(),4096,points);
 }
 
-void Voronoi::draw()
+void Voronoi::buildCells(const std::vector<ngl::Vec3> &_sites)
 {
-    if(m_vao == true)
-    {
-     m_vaoMesh->bind();
-     m_vaoMesh->draw();
-     m_vaoMesh->unbind();
-    }
+    TRACE_ZONE("Voronoi::buildCells");
+    ALLOC_PHASE(VORONOI);
+    buildTopology(_sites);
+    m_cells.clear();
+    m_cells.resize(m_topology.siteCount());
+    CellTask cells(m_topology,m_cells);
+    Parallel::forRange(m_cells.size(),256,cells);
 }
 
+void Voronoi::buildTopology(const std::vector<ngl::Vec3> &_sites)
+{
+    ALLOC_PHASE(VORONOI);
+    m_topology.build(m_tetrahedra,_sites);
+}
@@ -2,17 +2,47 @@
 #define VORONOI_H
 
 #include "Tetrahedron.h"
+#include "TetTopology.h"
 
 class VFace
 {
 public:
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief The vertices index
+    /// @brief The vertices index, counter clockwise seen from outside the cell
     //----------------------------------------------------------------------------------------------------------------------
     std::vector<unsigned int> m_vert;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the site on the other side of the face, the face is dual to the Delaunay edge to it
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int m_site;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief false when the Delaunay edge is on the convex hull, the face is then unbounded and m_vert is the open
+    /// chain of its finite vertices
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_closed;
+};
 
-
+//----------------------------------------------------------------------------------------------------------------------
+/// @class VCell
+/// @brief the voronoi cell of one site, a polyhedron with a face for every Delaunay edge from the site
+//----------------------------------------------------------------------------------------------------------------------
+class VCell
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief The vertices index, one for every tetrahedron around the site
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<unsigned int> m_vert;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief The faces of the cell
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<VFace> m_faces;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief false for the sites on the convex hull, whose cells are unbounded, and for sites that are no vertex
+    //----------------------------------------------------------------------------------------------------------------------
+    bool m_bounded;
 };
+
 class Voronoi
 {
 public:
@@ -24,18 +54,41 @@ public:
     /// @brief Constructor for Voronoi that sets the tetrahedra list
     //----------------------------------------------------------------------------------------------------------------------
     Voronoi(std::vector<Tetrahedron*> _t);
-    std::vector<ngl::Vec3> getVertices() const { return m_vertices; }
-    std::vector<ngl::Vec3> getEdges() const { return m_edges; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the voronoi vertices, the circumcentre of every tetrahedron in the order they were given
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<ngl::Vec3>& getVertices() const { return m_vertices; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the voronoi edges as pairs of indices into getVertices, one for every pair of neighbouring
+    /// tetrahedra
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<unsigned int>& getEdgeIndices() const { return m_edgeIndices; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the voronoi edges as pairs of end points, in the order of getEdgeIndices
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<ngl::Vec3>& getEdges() const { return m_edges; }
     void setVertex(ngl::Vec3 _v);
-    void setFace(VFace _f);
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that draws the voronoi edges
+    /// @brief function that builds the cell of every site in parallel, the vertex indices of the cells are those of
+    /// getVertices, the circumcentres of the tetrahedra in the order they were given
+    /// @param [in] _sites the points the tetrahedra were built from, cell i is the cell of point i. When empty the
+    /// distinct vertices of the tetrahedra are the sites, in lexicographic order
     //----------------------------------------------------------------------------------------------------------------------
-    void draw();
+    void buildCells(const std::vector<ngl::Vec3> &_sites);
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that creates the voronoi edges
+    /// @brief function that only indexes the tetrahedralization with its sites, as buildCells does before it builds the
+    /// cells, for the users that work on the topology alone
+    /// @param [in] _sites the points the tetrahedra were built from, as for buildCells
     //----------------------------------------------------------------------------------------------------------------------
-    void createVAOLines();
+    void buildTopology(const std::vector<ngl::Vec3> &_sites);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the cells of the last buildCells
+    //----------------------------------------------------------------------------------------------------------------------
+    const std::vector<VCell>& getCells() const { return m_cells; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the indexed tetrahedralization of the last buildCells or buildTopology, the sites are its sites
+    //----------------------------------------------------------------------------------------------------------------------
+    const TetTopology& getTopology() const { return m_topology; }
     //----------------------------------------------------------------------------------------------------------------------
 
 
@@ -49,21 +102,21 @@ private:
     //----------------------------------------------------------------------------------------------------------------------
     std::vector<ngl::Vec3> m_vertices;
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief stores the Voronoi edges
+    /// @brief stores the Voronoi edges as pairs of vertex indices
     //----------------------------------------------------------------------------------------------------------------------
-    std::vector<ngl::Vec3> m_edges;
+    std::vector<unsigned int> m_edgeIndices;
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief stores the Voronoi faces
+    /// @brief stores the Voronoi edges as pairs of end points, for drawing
     //----------------------------------------------------------------------------------------------------------------------
-    std::vector<VFace> m_faces;
+    std::vector<ngl::Vec3> m_edges;
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief id for our vertexArray object
+    /// @brief stores the Voronoi cells, one per site
     //----------------------------------------------------------------------------------------------------------------------
-    ngl::VertexArrayObject *m_vaoMesh;
+    std::vector<VCell> m_cells;
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief flag to indicate if a VBO has been created
+    /// @brief stores the indexed tetrahedralization the cells are built from
     //----------------------------------------------------------------------------------------------------------------------
-    bool m_vao;
+    TetTopology m_topology;
 
 private :
     //----------------------------------------------------------------------------------------------------------------------
@@ -71,7 +124,8 @@ private :
     //----------------------------------------------------------------------------------------------------------------------
     void setCenter();
     //----------------------------------------------------------------------------------------------------------------------
-    /// @brief function that creates the voronoi edge
+    /// @brief function that creates the voronoi edges, each pair of neighbouring tetrahedra gives one edge that is
+    /// found from the one with the lower index. The tetrahedra are only read
     //----------------------------------------------------------------------------------------------------------------------
     void setEdge();
 };
@@ -0,0 +1,83 @@
+#ifndef HEADLESS_NGL_RANDOM_H
+#define HEADLESS_NGL_RANDOM_H
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Random.h
+/// @author Maria Vineeta Bagya Seelan
+/// @version 1.0
+/// @date 16/08/13
+/// Revision History :
+/// Initial Version 16/08/13
+/// @class Random
+/// @brief GL-free stand in for the ngl::Random singleton, a seedable linear congruential generator so headless runs
+/// @brief are reproducible
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Vec3.h"
+
+namespace ngl
+{
+
+class Random
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessor for the singleton
+    //----------------------------------------------------------------------------------------------------------------------
+    static Random* instance()
+    {
+        static Random s_instance;
+        return &s_instance;
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief restarts the sequence
+    /// @param [in] _seed the new seed
+    //----------------------------------------------------------------------------------------------------------------------
+    void setSeed(unsigned int _seed) { m_state = _seed; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief returns a number in [0,_mult]
+    /// @param [in] _mult the upper bound
+    //----------------------------------------------------------------------------------------------------------------------
+    Real randomPositiveNumber(Real _mult=1)
+    {
+        return next()*_mult;
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief returns a number in [-_mult,_mult]
+    /// @param [in] _mult the bound
+    //----------------------------------------------------------------------------------------------------------------------
+    Real randomNumber(Real _mult=1)
+    {
+        return (next()*2.0f - 1.0f)*_mult;
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief returns a vector with every component in [-_mult,_mult]
+    /// @param [in] _mult the bound
+    //----------------------------------------------------------------------------------------------------------------------
+    Vec3 getRandomVec3(Real _mult=1)
+    {
+        Real x = randomNumber(_mult);
+        Real y = randomNumber(_mult);
+        Real z = randomNumber(_mult);
+        return Vec3(x,y,z);
+    }
+
+private:
+    Random() : m_state(1){}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief advances the generator and returns a value in [0,1]
+    //----------------------------------------------------------------------------------------------------------------------
+    Real next()
+    {
+        m_state = m_state*1664525u + 1013904223u;
+        return (m_state>>8) / (Real)0xffffff;
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the generator state
+    //----------------------------------------------------------------------------------------------------------------------
+    unsigned int m_state;
+};
+
+} // end ngl namespace
+
+#endif // HEADLESS_NGL_RANDOM_H
@@ -0,0 +1,44 @@
+#ifndef HEADLESS_NGL_TYPES_H
+#define HEADLESS_NGL_TYPES_H
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Types.h
+/// @author Maria Vineeta Bagya Seelan
+/// @version 1.0
+/// @date 16/08/13
+/// Revision History :
+/// Initial Version 16/08/13
+/// @brief GL-free stand in for ngl/Types.h used by the headless core build, it is put first on the include path so
+/// @brief the core classes compile unchanged without NGL, Qt or a GL context
+//----------------------------------------------------------------------------------------------------------------------
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the floating point type used by NGL
+//----------------------------------------------------------------------------------------------------------------------
+typedef float Real;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the tolerance used by the fuzzy comparisons, the same value as NGL
+//----------------------------------------------------------------------------------------------------------------------
+const static Real EPSILON = 0.001f;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief fuzzy float compare
+/// @param [in] _a the first value
+/// @param [in] _b the second value
+//----------------------------------------------------------------------------------------------------------------------
+inline bool FCompare(Real _a, Real _b)
+{
+    return ((_a)-EPSILON) < (_b) && ((_a)+EPSILON) > (_b);
+}
+
+} // end ngl namespace
+
+#endif // HEADLESS_NGL_TYPES_H
@@ -0,0 +1,47 @@
+#ifndef HEADLESS_NGL_UTIL_H
+#define HEADLESS_NGL_UTIL_H
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Util.h
+/// @author Maria Vineeta Bagya Seelan
+/// @version 1.0
+/// @date 16/08/13
+/// Revision History :
+/// Initial Version 16/08/13
+/// @brief GL-free stand in for the ngl/Util.h helpers the sampler uses
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Vec3.h"
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief linear interpolation between two values
+/// @param [in] _a the start value
+/// @param [in] _b the end value
+/// @param [in] _t the blend, 0 gives _a and 1 gives _b
+//----------------------------------------------------------------------------------------------------------------------
+template <typename T> T lerp(T _a, T _b, Real _t)
+{
+    T p;
+    p = _a + (_b - _a)*_t;
+    return p;
+}
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief calculates the unit normal of a triangle
+/// @param [in] _p1 the first vertex
+/// @param [in] _p2 the second vertex
+/// @param [in] _p3 the third vertex
+//----------------------------------------------------------------------------------------------------------------------
+inline Vec3 calcNormal(const Vec3 &_p1, const Vec3 &_p2, const Vec3 &_p3)
+{
+    Real coa = -(_p1.m_y*(_p2.m_z-_p3.m_z) + _p2.m_y*(_p3.m_z-_p1.m_z) + _p3.m_y*(_p1.m_z-_p2.m_z));
+    Real cob = -(_p1.m_z*(_p2.m_x-_p3.m_x) + _p2.m_z*(_p3.m_x-_p1.m_x) + _p3.m_z*(_p1.m_x-_p2.m_x));
+    Real coc = -(_p1.m_x*(_p2.m_y-_p3.m_y) + _p2.m_x*(_p3.m_y-_p1.m_y) + _p3.m_x*(_p1.m_y-_p2.m_y));
+    Real absvec = std::sqrt(coa*coa + cob*cob + coc*coc);
+    return Vec3(coa/absvec, cob/absvec, coc/absvec);
+}
+
+} // end ngl namespace
+
+#endif // HEADLESS_NGL_UTIL_H
@@ -0,0 +1,92 @@
+#ifndef HEADLESS_NGL_VEC3_H
+#define HEADLESS_NGL_VEC3_H
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Vec3.h
+/// @author Maria Vineeta Bagya Seelan
+/// @version 1.0
+/// @date 16/08/13
+/// Revision History :
+/// Initial Version 16/08/13
+/// @class Vec3
+/// @brief GL-free stand in for ngl::Vec3 with the part of its interface the core uses, the layout and the fuzzy
+/// @brief equality are the same as NGL
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "Types.h"
+
+namespace ngl
+{
+
+class Vec3
+{
+public:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief Constructors for Vec3, the default is the origin
+    //----------------------------------------------------------------------------------------------------------------------
+    Vec3() : m_x(0.0), m_y(0.0), m_z(0.0){}
+    Vec3(Real _x, Real _y, Real _z) : m_x(_x), m_y(_y), m_z(_z){}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief component access, 0 is x, 1 is y and 2 is z
+    //----------------------------------------------------------------------------------------------------------------------
+    Real& operator[](int _i) { return (&m_x)[_i]; }
+    const Real& operator[](int _i) const { return (&m_x)[_i]; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief arithmetic operators
+    //----------------------------------------------------------------------------------------------------------------------
+    Vec3 operator+(const Vec3 &_v) const { return Vec3(m_x+_v.m_x,m_y+_v.m_y,m_z+_v.m_z); }
+    Vec3 operator-(const Vec3 &_v) const { return Vec3(m_x-_v.m_x,m_y-_v.m_y,m_z-_v.m_z); }
+    Vec3 operator-() const { return Vec3(-m_x,-m_y,-m_z); }
+    Vec3 operator*(Real _s) const { return Vec3(m_x*_s,m_y*_s,m_z*_s); }
+    Vec3 operator/(Real _s) const { return Vec3(m_x/_s,m_y/_s,m_z/_s); }
+    void operator+=(const Vec3 &_v) { m_x+=_v.m_x; m_y+=_v.m_y; m_z+=_v.m_z; }
+    void operator-=(const Vec3 &_v) { m_x-=_v.m_x; m_y-=_v.m_y; m_z-=_v.m_z; }
+    void operator*=(Real _s) { m_x*=_s; m_y*=_s; m_z*=_s; }
+    void operator/=(Real _s) { m_x/=_s; m_y/=_s; m_z/=_s; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief fuzzy equality within EPSILON on every component, as in NGL
+    //----------------------------------------------------------------------------------------------------------------------
+    bool operator==(const Vec3 &_v) const
+    {
+        return FCompare(m_x,_v.m_x) && FCompare(m_y,_v.m_y) && FCompare(m_z,_v.m_z);
+    }
+    bool operator!=(const Vec3 &_v) const { return !(*this==_v); }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief dot and cross products
+    //----------------------------------------------------------------------------------------------------------------------
+    Real dot(const Vec3 &_v) const { return m_x*_v.m_x + m_y*_v.m_y + m_z*_v.m_z; }
+    Vec3 cross(const Vec3 &_v) const
+    {
+        return Vec3(m_y*_v.m_z - m_z*_v.m_y, m_z*_v.m_x - m_x*_v.m_z, m_x*_v.m_y - m_y*_v.m_x);
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief length of the vector and normalisation in place
+    //----------------------------------------------------------------------------------------------------------------------
+    Real length() const { return std::sqrt(dot(*this)); }
+    Real lengthSquared() const { return dot(*this); }
+    void normalize()
+    {
+        Real l = length();
+        if(l > 0)
+        {
+            m_x/=l; m_y/=l; m_z/=l;
+        }
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the components, public as in NGL
+    //----------------------------------------------------------------------------------------------------------------------
+    Real m_x;
+    Real m_y;
+    Real m_z;
+};
+
+inline Vec3 operator*(Real _s, const Vec3 &_v) { return _v*_s; }
+
+inline std::ostream& operator<<(std::ostream &_output, const Vec3 &_v)
+{
+    return _output<<"["<<_v.m_x<<","<<_v.m_y<<","<<_v.m_z<<"]";
+}
+
+} // end ngl namespace
+
+#endif // HEADLESS_NGL_VEC3_H
@@ -0,0 +1,348 @@
+#ifndef HEADLESS_SDF_SIGNED_DISTANCE_FIELD_FROM_MESH_HPP
+#define HEADLESS_SDF_SIGNED_DISTANCE_FIELD_FROM_MESH_HPP
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @file signed_distance_field_from_mesh.hpp
+/// @author Maria Vineeta Bagya Seelan
+/// @version 1.1
+/// @date 16/08/13
+/// Revision History :
+/// Initial Version 16/08/13
+/// 1.1 a grid over the mesh and a TriangleBVH take the place of the loop over every triangle
+/// @class signed_distance_field_from_mesh
+/// @brief stand in for the sdf-lite field so the headless core links without the library. It reads the triangles of
+/// @brief an Obj and evaluates the distance to the nearest triangle, negative where the winding number of the mesh
+/// @brief around the point is above one half. Loading builds a grid over the mesh: a cell the surface may cross is
+/// @brief evaluated exactly from a TriangleBVH, any other cell knows its side and its closest triangle, so most
+/// @brief evaluations cost one distance to one triangle
+//----------------------------------------------------------------------------------------------------------------------
+
+#include "TriangleBVH.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace sdf
+{
+
+// The grid holds for every cell the closest triangle to its centre and their distance. The cells within a cell of a
+// triangle get it from the triangle itself, so they are exact, and the others take it from their neighbours by eight
+// sweeps, one per direction, as in the fast sweeping of distance fields. A cell whose centre is further from the
+// surface than half its diagonal cannot hold any of it, so its whole cell is on one side. Those cells are split into
+// connected regions and one winding number per region gives its side
+
+class signed_distance_field_from_mesh
+{
+public:
+    signed_distance_field_from_mesh() : m_cell(0.0), m_valid(false)
+    {
+        for(int k=0; k<3; ++k)
+        {
+            m_min[k] = 0.0f;
+            m_max[k] = 0.0f;
+            m_res[k] = 0;
+        }
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief reads the vertices and faces of an Obj, the faces are split into fans of triangles, and builds the grid
+    /// @param [in] _filename the Obj file
+    /// @param [out] returns false if the file has no triangles
+    //----------------------------------------------------------------------------------------------------------------------
+    bool load_from_file(const std::string &_filename)
+    {
+        std::vector<ngl::Vec3> verts;
+        m_triangles.clear();
+        std::ifstream in(_filename.c_str());
+        std::string line;
+        std::vector<int> face;
+        while(std::getline(in,line))
+        {
+            const char *c = line.c_str();
+            while(*c == ' ' || *c == '\t')
+            {
+                ++c;
+            }
+            if(c[0] == 'v' && (c[1] == ' ' || c[1] == '\t'))
+            {
+                char *end;
+                ngl::Real x = strtod(c+1,&end);
+                ngl::Real y = strtod(end,&end);
+                ngl::Real z = strtod(end,&end);
+                verts.push_back(ngl::Vec3(x,y,z));
+            }
+            else if(c[0] == 'f' && (c[1] == ' ' || c[1] == '\t'))
+            {
+                // only the vertex of each v/vt/vn entry, a negative index counts back from the last vertex
+                face.clear();
+                bool valid = true;
+                ++c;
+                while(true)
+                {
+                    char *end;
+                    long index = strtol(c,&end,10);
+                    if(end == c)
+                    {
+                        break;
+                    }
+                    index = index < 0 ? (long)verts.size()+index : index-1;
+                    valid = valid && index >= 0 && index < (long)verts.size();
+                    face.push_back(index);
+                    for(c=end; *c != '\0' && *c != ' ' && *c != '\t'; ++c)
+                    {
+                    }
+                }
+                for(unsigned int i=2; i<face.size() && valid; ++i)
+                {
+                    m_triangles.push_back(verts[face[0]]);
+                    m_triangles.push_back(verts[face[i-1]]);
+                    m_triangles.push_back(verts[face[i]]);
+                }
+            }
+        }
+        m_valid = !m_triangles.empty();
+        for(unsigned int i=0; i<m_triangles.size(); ++i)
+        {
+            for(int k=0; k<3; ++k)
+            {
+                m_min[k] = i == 0 ? m_triangles[i][k] : std::min(m_min[k],m_triangles[i][k]);
+                m_max[k] = i == 0 ? m_triangles[i][k] : std::max(m_max[k],m_triangles[i][k]);
+            }
+        }
+        m_bvh.build(m_triangles);
+        buildGrid();
+        return m_valid;
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief returns true once a mesh with triangles has been read
+    //----------------------------------------------------------------------------------------------------------------------
+    bool is_valid() const { return m_valid; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief accessors for the corners of the bounding box of the mesh, three floats each
+    //----------------------------------------------------------------------------------------------------------------------
+    const float* maximum_bound() const { return m_max; }
+    const float* minimum_bound() const { return m_min; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief evaluates the field, it only reads the mesh and the grid so several threads may call it at once. The sign
+    /// is exact and so is the distance in the cells the surface may cross, further away the distance is the one to the
+    /// triangle the sweeps found closest to the centre of the cell, an upper bound close to the true distance
+    /// @param [in] _x, _y, _z the point
+    /// @param [out] returns the distance to the mesh, negative inside
+    //----------------------------------------------------------------------------------------------------------------------
+    float operator()(float _x, float _y, float _z) const
+    {
+        ngl::Vec3 p(_x,_y,_z);
+        int cell = cellOf(p);
+        if(cell >= 0 && m_side[cell] != 0)
+        {
+            unsigned int t = 3*m_closest[cell];
+            float distance = (float)TriangleBVH::triangleDistance(p,m_triangles[t],m_triangles[t+1],m_triangles[t+2]);
+            return m_side[cell] < 0 ? -distance : distance;
+        }
+        // either orientation of the faces counts as inside
+        bool inside = std::fabs(m_bvh.windingNumber(p)) > 0.5;
+        float distance = (float)m_bvh.nearestDistance(p);
+        return inside ? -distance : distance;
+    }
+
+private:
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of cells along the longest side of the box, from the number of triangles so a cell holds a
+    /// few of them
+    //----------------------------------------------------------------------------------------------------------------------
+    int resolution() const
+    {
+        int cells = (int)(2.0*std::pow((double)(m_triangles.size()/3),1.0/3.0));
+        return std::min(std::max(cells,16),128);
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the index of the cell of a point, -1 outside the grid
+    //----------------------------------------------------------------------------------------------------------------------
+    int cellOf(const ngl::Vec3 &_p) const
+    {
+        int index[3];
+        for(int k=0; k<3; ++k)
+        {
+            double c = std::floor(((double)_p[k]-m_origin[k])/m_cell);
+            if(!(c >= 0.0 && c < m_res[k]))
+            {
+                return -1;
+            }
+            index[k] = (int)c;
+        }
+        return (index[2]*m_res[1]+index[1])*m_res[0]+index[0];
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the centre of a cell
+    //----------------------------------------------------------------------------------------------------------------------
+    ngl::Vec3 centre(int _x, int _y, int _z) const
+    {
+        return ngl::Vec3(m_origin[0]+(_x+0.5)*m_cell,m_origin[1]+(_y+0.5)*m_cell,m_origin[2]+(_z+0.5)*m_cell);
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief takes triangle _t for the cell if it is closer to its centre than the one it has
+    //----------------------------------------------------------------------------------------------------------------------
+    void offer(int _cell, const ngl::Vec3 &_centre, int _t)
+    {
+        if(_t < 0 || _t == m_closest[_cell])
+        {
+            return;
+        }
+        double d = TriangleBVH::triangleDistance(_centre,m_triangles[3*_t],m_triangles[3*_t+1],m_triangles[3*_t+2]);
+        if(m_closest[_cell] < 0 || d < m_distance[_cell])
+        {
+            m_closest[_cell] = _t;
+            m_distance[_cell] = d;
+        }
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief builds the grid over the box of the mesh grown by a cell, see above
+    //----------------------------------------------------------------------------------------------------------------------
+    void buildGrid()
+    {
+        m_closest.clear();
+        m_distance.clear();
+        m_side.clear();
+        if(!m_valid)
+        {
+            return;
+        }
+        double extent = 0.0;
+        for(int k=0; k<3; ++k)
+        {
+            extent = std::max(extent,(double)m_max[k]-m_min[k]);
+        }
+        m_cell = extent > 0.0 ? extent/resolution() : 1.0;
+        for(int k=0; k<3; ++k)
+        {
+            m_origin[k] = m_min[k]-m_cell;
+            m_res[k] = (int)std::ceil(((double)m_max[k]-m_min[k])/m_cell)+2;
+        }
+        int cells = m_res[0]*m_res[1]*m_res[2];
+        m_closest.assign(cells,-1);
+        m_distance.assign(cells,0.0f);
+        m_side.assign(cells,0);
+
+        // every triangle is offered to the cells within a cell of its box
+        for(unsigned int t=0; t<m_triangles.size()/3; ++t)
+        {
+            int lo[3], hi[3];
+            for(int k=0; k<3; ++k)
+            {
+                double a = std::min(std::min(m_triangles[3*t][k],m_triangles[3*t+1][k]),m_triangles[3*t+2][k]);
+                double b = std::max(std::max(m_triangles[3*t][k],m_triangles[3*t+1][k]),m_triangles[3*t+2][k]);
+                lo[k] = std::max((int)std::floor((a-m_origin[k])/m_cell)-1,0);
+                hi[k] = std::min((int)std::floor((b-m_origin[k])/m_cell)+1,m_res[k]-1);
+            }
+            for(int z=lo[2]; z<=hi[2]; ++z)
+            {
+                for(int y=lo[1]; y<=hi[1]; ++y)
+                {
+                    for(int x=lo[0]; x<=hi[0]; ++x)
+                    {
+                        offer((z*m_res[1]+y)*m_res[0]+x,centre(x,y,z),t);
+                    }
+                }
+            }
+        }
+
+        // each sweep passes the closest triangles on along one of the eight diagonal directions
+        int step[3] = { 1, m_res[0], m_res[0]*m_res[1] };
+        for(int sweep=0; sweep<8; ++sweep)
+        {
+            int dir[3] = { sweep&1 ? -1 : 1, sweep&2 ? -1 : 1, sweep&4 ? -1 : 1 };
+            for(int iz=0; iz<m_res[2]; ++iz)
+            {
+                int z = dir[2] > 0 ? iz : m_res[2]-1-iz;
+                for(int iy=0; iy<m_res[1]; ++iy)
+                {
+                    int y = dir[1] > 0 ? iy : m_res[1]-1-iy;
+                    for(int ix=0; ix<m_res[0]; ++ix)
+                    {
+                        int x = dir[0] > 0 ? ix : m_res[0]-1-ix;
+                        int cell = (z*m_res[1]+y)*m_res[0]+x;
+                        int index[3] = { x, y, z };
+                        ngl::Vec3 c = centre(x,y,z);
+                        for(int k=0; k<3; ++k)
+                        {
+                            int previous = index[k]-dir[k];
+                            if(previous >= 0 && previous < m_res[k])
+                            {
+                                offer(cell,c,m_closest[cell-dir[k]*step[k]]);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // the cells the surface cannot reach are flooded region by region, the first cell of a region gives its side
+        double reach = 0.5*std::sqrt(3.0)*m_cell;
+        std::vector<int> stack;
+        for(int seed=0; seed<cells; ++seed)
+        {
+            if(m_side[seed] != 0 || m_closest[seed] < 0 || m_distance[seed] <= reach)
+            {
+                continue;
+            }
+            int x = seed%m_res[0], y = (seed/m_res[0])%m_res[1], z = seed/(m_res[0]*m_res[1]);
+            signed char side = std::fabs(m_bvh.windingNumber(centre(x,y,z))) > 0.5 ? -1 : 1;
+            m_side[seed] = side;
+            stack.push_back(seed);
+            while(!stack.empty())
+            {
+                int cell = stack.back();
+                stack.pop_back();
+                int index[3] = { cell%m_res[0], (cell/m_res[0])%m_res[1], cell/(m_res[0]*m_res[1]) };
+                for(int k=0; k<3; ++k)
+                {
+                    for(int d=-1; d<=1; d+=2)
+                    {
+                        int next = index[k]+d;
+                        int neighbour = cell+d*step[k];
+                        if(next < 0 || next >= m_res[k] || m_side[neighbour] != 0 || m_closest[neighbour] < 0 ||
+                           m_distance[neighbour] <= reach)
+                        {
+                            continue;
+                        }
+                        m_side[neighbour] = side;
+                        stack.push_back(neighbour);
+                    }
+                }
+            }
+        }
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the triangles of the mesh, three vertices each
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<ngl::Vec3> m_triangles;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the hierarchy over the triangles, for the cells the surface may cross
+    //----------------------------------------------------------------------------------------------------------------------
+    TriangleBVH m_bvh;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the grid: the corner of its first cell, the side of a cell and the number of cells along each axis
+    //----------------------------------------------------------------------------------------------------------------------
+    double m_origin[3];
+    double m_cell;
+    int m_res[3];
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief for every cell, x fastest, the closest triangle to its centre, their distance and the side of the whole
+    /// cell, -1 inside, 1 outside and 0 where the surface may cross the cell
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<int> m_closest;
+    std::vector<float> m_distance;
+    std::vector<signed char> m_side;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the bounding box of the mesh
+    //----------------------------------------------------------------------------------------------------------------------
+    float m_min[3];
+    float m_max[3];
+    bool m_valid;
+};
+
+} // end sdf namespace
+
+#endif // HEADLESS_SDF_SIGNED_DISTANCE_FIELD_FROM_MESH_HPP
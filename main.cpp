@@ -5,9 +5,11 @@
 
 #include <QtGui/QApplication>
 #include "MainWindow.h"
+#include "Trace.h"
 
 int main(int argc, char *argv[])
 {
+  TRACE_THREAD_NAME("GUI");
   // make an instance of the QApplication
   QApplication a(argc, argv);
   // Create a new MainWindow
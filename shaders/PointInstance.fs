@@ -0,0 +1,9 @@
+#version 150
+// fragment shader for the instanced point markers, one colour for the whole set
+uniform vec4 Colour;
+out vec4 outColour;
+
+void main()
+{
+  outColour = Colour;
+}
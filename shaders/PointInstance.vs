@@ -0,0 +1,10 @@
+#version 150
+// vertex shader for the instanced point markers, every instance is the marker sphere moved to one point
+uniform mat4 MVP;
+in vec3 inVert;
+in vec3 inOffset;
+
+void main()
+{
+  gl_Position = MVP*vec4(inVert+inOffset,1.0);
+}
@@ -0,0 +1,9 @@
+#version 150
+// fragment shader for the batched tetrahedra
+in vec4 vertColour;
+out vec4 outColour;
+
+void main()
+{
+  outColour = vertColour;
+}
@@ -0,0 +1,12 @@
+#version 150
+// vertex shader for the batched tetrahedra, the colour comes with each vertex
+uniform mat4 MVP;
+in vec3 inVert;
+in vec4 inColour;
+out vec4 vertColour;
+
+void main()
+{
+  vertColour = inColour;
+  gl_Position = MVP*vec4(inVert,1.0);
+}